@@ -0,0 +1,473 @@
+// GenCpCheck.cpp
+
+//
+// Host side check of the parts of asynGenicam that need no camera:
+// register map compile, load and lookup, formula evaluation, the register
+// cache, the ack timeout estimate, and the parsing and encoding of the U, N
+// and W commands of the ascii protocol.
+// Run by make runtests.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "epicsUnitTest.h"
+#include "testMain.h"
+#include "GenCpCommand.h"
+#include "GenCpFormula.h"
+#include "GenCpRegCache.h"
+#include "GenCpRegMap.h"
+#include "GenCpRtt.h"
+#include "GenCpXml.h"
+
+static const char	checkXml[]	=
+	"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+	"<RegisterDescription ModelName=\"GenCpCheck\" VendorName=\"asynGenicam\">\n"
+	"  <Integer Name=\"Width\"><pValue>WidthReg</pValue></Integer>\n"
+	"  <IntReg Name=\"WidthReg\"><Address>0x1000</Address><Length>4</Length>\n"
+	"    <AccessMode>RW</AccessMode><Endianess>BigEndian</Endianess></IntReg>\n"
+	"  <IntReg Name=\"Gain24\"><Address>0x1010</Address><Length>3</Length>\n"
+	"    <AccessMode>RW</AccessMode><Endianess>BigEndian</Endianess></IntReg>\n"
+	"  <IntReg Name=\"LittleReg\"><Address>0x1020</Address><Length>4</Length>\n"
+	"    <AccessMode>RW</AccessMode><Endianess>LittleEndian</Endianess></IntReg>\n"
+	"  <MaskedIntReg Name=\"Mode\"><Address>0x1030</Address><Length>4</Length>\n"
+	"    <AccessMode>RW</AccessMode><LSB>4</LSB><MSB>7</MSB><Endianess>LittleEndian</Endianess></MaskedIntReg>\n"
+	"  <MaskedIntReg Name=\"ModeBE\"><Address>0x1034</Address><Length>4</Length>\n"
+	"    <AccessMode>RW</AccessMode><LSB>27</LSB><MSB>24</MSB><Endianess>BigEndian</Endianess></MaskedIntReg>\n"
+	"  <MaskedIntReg Name=\"ModeWO\"><Address>0x1038</Address><Length>4</Length>\n"
+	"    <AccessMode>WO</AccessMode><LSB>0</LSB><MSB>3</MSB><Endianess>BigEndian</Endianess></MaskedIntReg>\n"
+	"  <FloatReg Name=\"Exposure\"><Address>0x1040</Address><Length>8</Length>\n"
+	"    <AccessMode>RW</AccessMode><Endianess>BigEndian</Endianess></FloatReg>\n"
+	"  <FloatReg Name=\"ExposureLE\"><Address>0x1048</Address><Length>4</Length>\n"
+	"    <AccessMode>RW</AccessMode><Endianess>LittleEndian</Endianess></FloatReg>\n"
+	"  <SwissKnife Name=\"LineTimeCalc\"><pVariable Name=\"W\">WidthReg</pVariable>\n"
+	"    <Constant Name=\"K\">2</Constant><Formula>W * K + 1</Formula></SwissKnife>\n"
+	"  <Float Name=\"LineTime\"><pValue>LineTimeCalc</pValue></Float>\n"
+	"  <Enumeration Name=\"TriggerMode\"><pValue>TriggerReg</pValue>\n"
+	"    <EnumEntry Name=\"Off\"><Value>0</Value></EnumEntry>\n"
+	"    <EnumEntry Name=\"On\"><Value>1</Value></EnumEntry></Enumeration>\n"
+	"  <IntReg Name=\"TriggerReg\"><Address>0x1050</Address><Length>4</Length>\n"
+	"    <AccessMode>RW</AccessMode><Endianess>BigEndian</Endianess></IntReg>\n"
+	"  <IntReg Name=\"HeightMaxReg\"><pInvalidator>WidthReg</pInvalidator><Address>0x1060</Address><Length>4</Length>\n"
+	"    <AccessMode>RO</AccessMode><Endianess>BigEndian</Endianess></IntReg>\n"
+	"  <IntReg Name=\"OffsetMaxReg\"><pInvalidator>HeightMaxReg</pInvalidator><Address>0x1064</Address><Length>4</Length>\n"
+	"    <AccessMode>RO</AccessMode><Endianess>BigEndian</Endianess></IntReg>\n"
+	"  <Integer Name=\"GainSelector\"><pValue>GainSelectorReg</pValue><pSelected>Gain24</pSelected></Integer>\n"
+	"  <IntReg Name=\"GainSelectorReg\"><Address>0x1070</Address><Length>4</Length>\n"
+	"    <AccessMode>RW</AccessMode><Endianess>BigEndian</Endianess></IntReg>\n"
+	"</RegisterDescription>\n";
+
+/// Parse pXml, true if it parses to an element w/ attribute and text as expected
+static bool	parseXml(
+	const char			*	pXml,
+	const char			*	pAttr,
+	const char			*	pText	)
+{
+	std::string				errorMsg;
+	GenCpXmlNode		*	pRoot	= GenCpXmlParse( pXml, strlen( pXml ), errorMsg );
+	bool					fOk		= pRoot != NULL;
+	if ( pRoot != NULL && pAttr != NULL )
+		fOk	= pRoot->Attr( "a" ) != NULL && strcmp( pRoot->Attr( "a" ), pAttr ) == 0 && pRoot->m_text == pText;
+	delete pRoot;
+	return fOk;
+}
+
+static void	checkXmlText( )
+{
+	testDiag( "XML character references" );
+	testOk(	parseXml( "<x a=\"&#x1F600;\">&#233;&#x20AC;&lt;</x>", "\xF0\x9F\x98\x80", "\xC3\xA9\xE2\x82\xAC<" ),
+			"2, 3 and 4 byte utf-8" );
+	testOk( !parseXml( "<x>&#xD800;</x>", NULL, NULL ), "surrogate refused" );
+	testOk( !parseXml( "<x a=\"&#x110000;\"/>", NULL, NULL ), "code point above 0x10FFFF refused" );
+}
+
+/// N command for feature pName, a read if pValue is NULL, compared to pExpected
+static void	checkFeature(
+	const GenCpRegMap	&	regMap,
+	const char			*	pName,
+	const char			*	pValue,
+	const char			*	pExpected	)
+{
+	const GenCpRegMapEntry	*	pEntry	= regMap.Find( pName );
+	std::string					command;
+	const char				*	pError	= pEntry ? GenCpFeatureCommand( pEntry, pValue, command ) : "not in map";
+	if ( pError != NULL )
+		testOk( 0, "N %s %s%s: %s", pName, pValue ? "=" : "?", pValue ? pValue : "", pError );
+	else
+		testOk(	command == pExpected, "N %s %s%s -> %s (expected %s)", pName,
+				pValue ? "=" : "?", pValue ? pValue : "", command.c_str(), pExpected );
+}
+
+static void	checkRegMap( )
+{
+	static const uint8_t	sha1[20]	= { 0xC0, 0xFF, 0xEE };
+	char					mapDir[]	= "/tmp/GenCpCheckXXXXXX";
+	char					fileName[256];
+	std::vector<uint8_t>	image;
+	std::string				errorMsg;
+	GenCpRegMap				regMap;
+
+	testDiag( "Register map compile, load and Find" );
+	// Arguments are evaluated in any order, so each result is taken before its message
+	bool					fOk;
+	fOk	= GenCpRegMapCompile( checkXml, strlen( checkXml ), sha1, image, errorMsg ) == GENCP_STATUS_SUCCESS;
+	testOk( fOk, "compile %s", errorMsg.c_str() );
+	if ( mkdtemp( mapDir ) == NULL )
+		testAbort( "mkdtemp %s failed", mapDir );
+	fOk	= GenCpRegMapWrite( mapDir, sha1, image, errorMsg ) == GENCP_STATUS_SUCCESS;
+	testOk( fOk, "write %s", errorMsg.c_str() );
+	fOk	= regMap.Load( mapDir, sha1, errorMsg ) == GENCP_STATUS_SUCCESS;
+	testOk( fOk, "load %s", errorMsg.c_str() );
+	GenCpRegMapFileName( mapDir, sha1, fileName, sizeof(fileName) );
+	unlink( fileName );
+	rmdir( mapDir );
+	if ( !regMap.IsLoaded() )
+		testAbort( "no register map to check" );
+
+	static const char	*	names[]	= { "Width", "WidthReg", "Gain24", "LittleReg", "Mode", "ModeBE",
+										"Exposure", "ExposureLE", "LineTime", "TriggerMode", "TriggerReg" };
+	size_t					nFound	= 0;
+	for ( size_t iName = 0; iName < sizeof(names) / sizeof(names[0]); iName++ )
+	{
+		const GenCpRegMapEntry	*	pEntry	= regMap.Find( names[iName] );
+		if ( pEntry != NULL && strcmp( regMap.Name( pEntry ), names[iName] ) == 0 )
+			nFound++;
+		else
+			testDiag( "%s not found by name", names[iName] );
+	}
+	testOk( nFound == sizeof(names) / sizeof(names[0]), "Find round trips %zu names", nFound );
+	testOk1( regMap.Find( "NoSuchFeature" ) == NULL );
+
+	const GenCpRegMapEntry	*	pWidth	= regMap.Find( "Width" );
+	testOk(	pWidth != NULL && pWidth->address == 0x1000 && pWidth->length == 4
+		&&	pWidth->endian == GENCP_REGMAP_ENDIAN_BIG, "Width resolves to its register" );
+	const GenCpRegMapEntry	*	pMode	= regMap.Find( "Mode" );
+	const GenCpRegMapEntry	*	pModeBE	= regMap.Find( "ModeBE" );
+	testOk(	pMode != NULL && ( pMode->flags & GENCP_REGMAP_FLAG_MASKED ) && pMode->lsb == 4 && pMode->msb == 7,
+			"little endian bit field 7..4" );
+	testOk(	pModeBE != NULL && ( pModeBE->flags & GENCP_REGMAP_FLAG_MASKED ) && pModeBE->lsb == 4 && pModeBE->msb == 7,
+			"big endian bit field numbered from the MSB" );
+	int64_t						enumValue	= -1;
+	fOk	= regMap.EnumValue( regMap.Find( "TriggerMode" ), "On", &enumValue ) && enumValue == 1;
+	testOk( fOk, "TriggerMode On = %lld", (long long int) enumValue );
+
+	// Decode of raw register bytes as read from the wire
+	static const uint8_t	modeBytes[4]	= { 0x50, 0x00, 0x00, 0x00 };
+	static const uint8_t	modeBEBytes[4]	= { 0x00, 0x00, 0x00, 0x50 };
+	static const uint8_t	littleBytes[4]	= { 0x78, 0x56, 0x34, 0x12 };
+	testOk1( pMode != NULL && GenCpRegMapDecodeInt( pMode, modeBytes ) == 5 );
+	testOk1( pModeBE != NULL && GenCpRegMapDecodeInt( pModeBE, modeBEBytes ) == 5 );
+	testOk1( GenCpRegMapDecodeInt( regMap.Find( "LittleReg" ), littleBytes ) == 0x12345678 );
+
+	// A formula feature reads its variables from the registers they name
+	const GenCpRegMapEntry	*	pLineTime	= regMap.Find( "LineTime" );
+	const GenCpRegMapFormula *	pFormula	= pLineTime ? regMap.Formula( pLineTime ) : NULL;
+	double						result		= 0.0;
+	if ( pFormula != NULL && pFormula->nVars == 1 )
+	{
+		const uint32_t	*	pVars	= regMap.FormulaVars( pFormula );
+		double				width	= 640;
+		testOk(	regMap.Entry( pVars[0] ) == regMap.Find( "WidthReg" ), "LineTime reads WidthReg" );
+		fOk	= GenCpFormulaEval(	regMap.FormulaCode( pFormula ), pFormula->nCode,
+								regMap.FormulaConsts( pFormula ), pFormula->nConsts,
+								&width, 1, pFormula->fInteger, &result ) && result == 1281.0;
+		testOk( fOk, "LineTime = %g", result );
+	}
+	else
+	{
+		testOk( 0, "LineTime is a formula of one variable" );
+		testOk( 0, "LineTime evaluated" );
+	}
+
+	// A write invalidates the registers that name it, and in turn the ones naming those
+	std::vector< std::pair<uint64_t, uint32_t> >	targets;
+	regMap.Invalidated( 0x1002, 1, targets );
+	std::sort( targets.begin(), targets.end() );
+	fOk	=	targets.size() == 2
+		&&	targets[0] == std::make_pair( (uint64_t) 0x1060, (uint32_t) 4 )
+		&&	targets[1] == std::make_pair( (uint64_t) 0x1064, (uint32_t) 4 );
+	testOk( fOk, "a write to WidthReg invalidates HeightMaxReg and OffsetMaxReg, %zu registers", targets.size() );
+	targets.clear();
+	regMap.Invalidated( 0x1060, 4, targets );
+	fOk	= targets.size() == 1 && targets[0].first == 0x1064;
+	testOk( fOk, "HeightMaxReg invalidates OffsetMaxReg only" );
+	targets.clear();
+	regMap.Invalidated( 0x1064, 4, targets );
+	regMap.Invalidated( 0x1010, 3, targets );
+	testOk( targets.empty(), "registers w/o pInvalidator links invalidate nothing" );
+
+	// A selector switches which register its selected features read
+	const GenCpRegMapEntry	*	pSelector	= regMap.Find( "GainSelector" );
+	testOk(	pSelector != NULL && ( pSelector->flags & GENCP_REGMAP_FLAG_SELECTOR )
+		&&	!( pWidth->flags & GENCP_REGMAP_FLAG_SELECTOR ), "GainSelector flagged a selector" );
+	regMap.Invalidated( 0x1070, 4, targets );
+	fOk	= targets.size() == 1 && targets[0] == std::make_pair( (uint64_t) 0x1010, (uint32_t) 3 );
+	testOk( fOk, "a write to GainSelector invalidates Gain24" );
+
+	testDiag( "N commands" );
+	checkFeature( regMap, "Width",		NULL,			"U32 0x1000 ?" );
+	checkFeature( regMap, "Width",		"640",			"U32 0x1000 =640" );
+	checkFeature( regMap, "Gain24",		"0x123456",		"U24 0x1010 =1193046" );
+	checkFeature( regMap, "LittleReg",	"0x12345678",	"U32 0x1020 =2018915346" );
+	checkFeature( regMap, "Mode",		"5",			"U32 0x1030 &=~0xF0000000 |=0x50000000" );
+	checkFeature( regMap, "ModeBE",		"5",			"U32 0x1034 &=~0xF0 |=0x50" );
+	checkFeature( regMap, "ModeBE",		"0x15",			"U32 0x1034 &=~0xF0 |=0x50" );
+	checkFeature( regMap, "Exposure",	NULL,			"F64 0x1040 ?" );
+	checkFeature( regMap, "Exposure",	"1.5",			"F64 0x1040 =1.5" );
+	checkFeature( regMap, "ExposureLE",	NULL,			"U32 0x1048 ?" );
+	checkFeature( regMap, "ExposureLE",	"1.0",			"U32 0x1048 =32831" );
+	std::string					command;
+	testOk1( GenCpFeatureCommand( pWidth, "abc", command ) != NULL );
+	const GenCpRegMapEntry	*	pModeWO	= regMap.Find( "ModeWO" );
+	testOk(	pModeWO != NULL && GenCpFeatureCommand( pModeWO, "5", command ) != NULL,
+			"write of a bit field of a write only register refused" );
+}
+
+/// Compile and evaluate pFormula w/ A = 4 and B = 0, compared to expected
+static void	checkFormulaValue(
+	const GenCpFormulaSymbols	&	symbols,
+	const char				*	pFormula,
+	bool						fInteger,
+	double						expected	)
+{
+	std::vector<uint32_t>		code;
+	std::vector<double>			consts;
+	std::string					errorMsg;
+	double						vars[2]	= { 4, 0 };
+	double						result	= 0.0;
+	if ( !GenCpFormulaCompile( pFormula, symbols, code, consts, errorMsg ) )
+		testOk( 0, "%s: %s", pFormula, errorMsg.c_str() );
+	else if ( !GenCpFormulaEval(	&code[0], code.size(), consts.empty() ? NULL : &consts[0], consts.size(),
+									vars, 2, fInteger, &result ) )
+		testOk( 0, "%s%s failed to evaluate", fInteger ? "integer " : "", pFormula );
+	else
+		testOk( result == expected, "%s%s = %g (expected %g)", fInteger ? "integer " : "", pFormula, result, expected );
+}
+
+/// Compile pFormula and check its evaluation w/ A = 4 and B = 0 fails
+static void	checkFormulaFails(
+	const GenCpFormulaSymbols	&	symbols,
+	const char				*	pFormula,
+	bool						fInteger	)
+{
+	std::vector<uint32_t>		code;
+	std::vector<double>			consts;
+	std::string					errorMsg;
+	double						vars[2]	= { 4, 0 };
+	double						result	= 0.0;
+	bool						fOk		= GenCpFormulaCompile( pFormula, symbols, code, consts, errorMsg )
+		&&	!GenCpFormulaEval(	&code[0], code.size(), consts.empty() ? NULL : &consts[0], consts.size(),
+								vars, 2, fInteger, &result );
+	testOk( fOk, "%s%s fails", fInteger ? "integer " : "", pFormula );
+}
+
+static void	checkFormula( )
+{
+	GenCpFormulaSymbols		symbols;
+	std::vector<uint32_t>	code;
+	std::vector<double>		consts;
+	std::string				errorMsg;
+	double					vars[2]	= { 4, 0 };
+	double					result	= 0.0;
+
+	testDiag( "Formulas" );
+	symbols.variables["A"]	= 0;
+	symbols.variables["B"]	= 1;
+	symbols.constants["K"]	= 10;
+	symbols.expressions["TWICE_A"]	= "A * 2";
+
+	checkFormulaValue( symbols, "(A + 1) / 2",				false,	2.5 );
+	checkFormulaValue( symbols, "(A + 1) / 2",				true,	2.0 );
+	checkFormulaValue( symbols, "A > 3 ? TWICE_A + K : 0",	false,	18.0 );
+	checkFormulaValue( symbols, "(A << 4) | 3",				true,	67.0 );
+	checkFormulaValue( symbols, "(1 << 62) * -2",			true,	-9223372036854775808.0 );
+
+	// Results outside int64_t are errors, not undefined behavior
+	checkFormulaFails( symbols, "1e30",						true );
+	checkFormulaFails( symbols, "-(1 << 63)",				true );
+	checkFormulaFails( symbols, "(1 << 63) / -1",			true );
+	checkFormulaFails( symbols, "(1 << 62) * A",			true );
+	checkFormulaFails( symbols, "1e30 & 1",					false );
+	testOk(	GenCpFormulaCompile( "A / B", symbols, code, consts, errorMsg )
+		&&	!GenCpFormulaEval( &code[0], code.size(), consts.empty() ? NULL : &consts[0], consts.size(),
+								vars, 2, true, &result ), "integer division by zero fails" );
+	code.clear();
+	consts.clear();
+	bool					fOk	= !GenCpFormulaCompile( "A + C", symbols, code, consts, errorMsg );
+	testOk( fOk, "unknown name: %s", errorMsg.c_str() );
+}
+
+static void	checkUint( )
+{
+	GenCpUintCommand		uintCommand;
+	uint64_t				andMask, orBits, xorBits;
+	uint8_t					bytes[8];
+	static const uint8_t	bytes24[3]	= { 0x12, 0x34, 0x56 };
+
+	testDiag( "U commands" );
+	testOk(	GenCpParseUint( "U32 0x100 ?", &uintCommand ) && uintCommand.nBits == 32
+		&&	uintCommand.regAddr == 0x100 && uintCommand.cGetSet == '?', "U32 read" );
+	testOk(	GenCpParseUint( "U8 0x101 ?", &uintCommand ) && uintCommand.nBits == 8, "U8 read" );
+	testOk(	GenCpParseUint( "U24 0x100 =0x123456", &uintCommand ) && uintCommand.cGetSet == '='
+		&&	uintCommand.value == 0x123456 && uintCommand.pOps == NULL, "U24 write" );
+	testOk(	GenCpParseUint( "U64 0x8 =0xFFFFFFFFFFFFFFFF", &uintCommand ) && uintCommand.value == ~0ULL,
+			"U64 values above 2^63 aren't clamped" );
+	testOk1( !GenCpParseUint( "U12 0x100 ?", &uintCommand ) );
+	testOk1( !GenCpParseUint( "U72 0x100 ?", &uintCommand ) );
+	testOk1( !GenCpParseUint( "U32 0x100", &uintCommand ) );
+	testOk1( !GenCpParseUint( "U32 0x100 =", &uintCommand ) );
+	testOk(	GenCpParseUint( "U32 0x100 &=~0x30 |=0x10", &uintCommand ) && uintCommand.cGetSet == '='
+		&&	uintCommand.pOps != NULL, "U32 read-modify-write" );
+	testOk1( !GenCpParseUint( "U32 0x100 &=0x30 junk", &uintCommand ) );
+
+	testOk(	GenCpParseModifyOps( "&=~0x30 |=0x10", &andMask, &orBits, &xorBits )
+		&&	( ( ( 0xFFULL & andMask ) | orBits ) ^ xorBits ) == 0xDF, "&=~0x30 |=0x10 of 0xFF" );
+	testOk(	GenCpParseModifyOps( "|=0xF0 ^=0x11 &=0x1F", &andMask, &orBits, &xorBits )
+		&&	( ( ( 0x0FULL & andMask ) | orBits ) ^ xorBits ) == 0x0E, "ops apply left to right" );
+	testOk1( !GenCpParseModifyOps( "=5", &andMask, &orBits, &xorBits ) );
+
+	GenCpEncodeUint( 0x123456, 3, bytes );
+	testOk(	memcmp( bytes, bytes24, 3 ) == 0, "U24 encodes big endian" );
+	testOk1( GenCpDecodeUint( bytes24, 3 ) == 0x123456 );
+	testOk1( GenCpSwapBytes( 0x12345678, 4 ) == 0x78563412 );
+	testOk1( GenCpSwapBytes( 0x1234, 3 ) == 0x341200 );
+	testOk1( GenCpValidUintBits( 8 ) && GenCpValidUintBits( 40 ) && !GenCpValidUintBits( 0 ) && !GenCpValidUintBits( 4 ) );
+}
+
+/// Hit and miss counts of a cache, from its report
+static void	cacheCounts(
+	GenCpRegCache		&	cache,
+	unsigned long		*	pHits,
+	unsigned long		*	pMisses	)
+{
+	char					line[256]	= "";
+	FILE				*	fp			= tmpfile( );
+	const char			*	pCounts		= NULL;
+	*pHits		= 0;
+	*pMisses	= 0;
+	if ( fp == NULL )
+		return;
+	cache.Report( fp, 0 );
+	rewind( fp );
+	if ( fgets( line, sizeof(line), fp ) != NULL && ( pCounts = strstr( line, "ranges, " ) ) != NULL )
+		sscanf( pCounts, "ranges, %lu hits, %lu misses", pHits, pMisses );
+	fclose( fp );
+}
+
+static void	checkRegCache( )
+{
+	GenCpRegCache			cache;
+	static const uint8_t	regBytes[4]	= { 0x12, 0x34, 0x56, 0x78 };
+	uint8_t					bytes[4]	= { 0 };
+	unsigned long			nHits, nMisses;
+
+	testDiag( "Register cache" );
+	cache.Update( 0x200, regBytes, 4 );
+	testOk( !cache.Lookup( 0x200, bytes, 4 ), "registers outside the cacheable ranges aren't kept" );
+	cache.SetCacheable( 0x100, 8, true );
+	cache.Update( 0x100, regBytes, 4 );
+	testOk(	cache.Lookup( 0x100, bytes, 4 ) && memcmp( bytes, regBytes, 4 ) == 0, "cacheable register hit" );
+	testOk(	cache.Lookup( 0x102, bytes, 2 ) && bytes[0] == 0x56 && bytes[1] == 0x78, "part of an entry hits" );
+	cache.Invalidate( 0x103, 1 );
+	testOk( !cache.Lookup( 0x100, bytes, 4 ), "a write to any byte invalidates the entry" );
+	cacheCounts( cache, &nHits, &nMisses );
+	testOk( nHits == 2 && nMisses == 1, "%lu hits, %lu misses, only cacheable misses count", nHits, nMisses );
+	cache.Update( 0x100, regBytes, 4 );
+	cache.SetCacheable( 0x100, 8, false );
+	testOk( !cache.IsCacheable( 0x100, 4 ) && !cache.Lookup( 0x100, bytes, 4 ), "an uncacheable range drops its entries" );
+	cache.SetCacheable( 0x100, 8, true );
+	cache.Update( 0x100, regBytes, 4 );
+	cache.InvalidateAll( );
+	testOk( cache.IsCacheable( 0x100, 4 ) && !cache.Lookup( 0x100, bytes, 4 ), "InvalidateAll keeps the ranges" );
+
+	// Recent reads keep any register for a while, until a write may have changed it
+	cache.SetRecentAge( 60.0 );
+	cache.Update( 0x100, regBytes, 4 );
+	cache.Update( 0x200, regBytes, 4 );
+	testOk( cache.Lookup( 0x200, bytes, 4 ), "a recent read of an uncacheable register hits" );
+	cache.InvalidateRecent( );
+	bool	fOk	= !cache.Lookup( 0x200, bytes, 4 ) && cache.Lookup( 0x100, bytes, 4 );
+	testOk( fOk, "InvalidateRecent drops the recent reads, keeps the cacheable ones" );
+}
+
+/// Check an estimator value to well within the precision of its doubles
+static void	checkRttValue(
+	const char				*	pName,
+	double						value,
+	double						expected	)
+{
+	testOk( fabs( value - expected ) < 1e-9, "%s %g (expected %g)", pName, value, expected );
+}
+
+static void	checkRtt( )
+{
+	GenCpRttEstimator		rtt;
+
+	testDiag( "Ack timeout estimate" );
+	testOk( rtt.Timeout( ) == 0.0, "no timeout w/o samples" );
+
+	// The first sample sets srtt = r, rttvar = r / 2, RFC 6298 2.2
+	rtt.Sample( 0.1 );
+	checkRttValue( "first timeout", rtt.Timeout( ), 0.3 );
+
+	// Then rttvar = 3/4 rttvar + 1/4 |srtt - r| and srtt = 7/8 srtt + 1/8 r, 2.3
+	rtt.Sample( 0.2 );
+	checkRttValue( "rttvar", rtt.RttVar( ), 0.0625 );
+	checkRttValue( "srtt", rtt.Srtt( ), 0.1125 );
+	checkRttValue( "second timeout", rtt.Timeout( ), 0.3625 );
+
+	rtt.Backoff( );
+	checkRttValue( "timeout after a backoff", rtt.Timeout( ), 0.725 );
+	for ( int iTimeout = 1; iTimeout < 10; iTimeout++ )
+		rtt.Backoff( );
+	checkRttValue( "timeout after 10 backoffs, 64x at most", rtt.Timeout( ), 23.2 );
+	bool	fOk	= rtt.NumTimeouts( ) == 10;
+	testOk( fOk, "%lu timeouts counted", rtt.NumTimeouts( ) );
+
+	rtt.Sample( 0.1125 );
+	checkRttValue( "a sample clears the backoff", rtt.Timeout( ), 0.1125 + 4 * 0.046875 );
+	rtt.Reset( );
+	fOk	= rtt.Timeout( ) == 0.0 && rtt.NumSamples( ) == 0 && rtt.NumTimeouts( ) == 10;
+	testOk( fOk, "Reset drops the samples, keeps the timeout count" );
+}
+
+static void	checkWait( )
+{
+	GenCpWaitCommand		wait;
+
+	testDiag( "W commands" );
+	testOk(	GenCpParseWait( "W32 0x100 =1 &0x1 ==0 5000", &wait ) == NULL
+		&&	wait.nBits == 32 && wait.fAddress && wait.regAddr == 0x100 && wait.fWrite && wait.writeValue == 1
+		&&	wait.mask == 1 && wait.fEqual && wait.expected == 0 && wait.fTimeout && wait.timeout == 5.0,
+			"write, mask, condition and timeout" );
+	testOk(	GenCpParseWait( "W32 AcquisitionStatus &0x4 !=0 2000", &wait ) == NULL
+		&&	!wait.fAddress && strcmp( wait.regName, "AcquisitionStatus" ) == 0 && !wait.fWrite
+		&&	wait.mask == 4 && !wait.fEqual, "feature name and != condition" );
+	testOk(	GenCpParseWait( "W16 0x100=1 ==1", &wait ) == NULL && wait.fAddress && wait.regAddr == 0x100
+		&&	wait.fWrite && wait.writeValue == 1 && !wait.fTimeout, "the name ends at =" );
+	testOk1( GenCpParseWait( "W32 0x100 =1", &wait ) != NULL );
+	testOk1( GenCpParseWait( "W20 0x100 ==1", &wait ) != NULL );
+	testOk1( GenCpParseWait( "W32 0x100 ==x", &wait ) != NULL );
+	testOk(	GenCpParseWait( "W32 0x100 ==1 10000", &wait ) == NULL && wait.timeout == GENCP_WAIT_MAX_SEC,
+			"timeout of the max" );
+	testOk( GenCpParseWait( "W32 0x100 ==1 10001", &wait ) != NULL, "timeout above the max" );
+	testOk( GenCpParseWait( "W32 0x100 ==1 -1", &wait ) != NULL, "negative timeout" );
+}
+
+MAIN( GenCpCheck )
+{
+	testPlan( 93 );
+	checkXmlText( );
+	checkRegMap( );
+	checkFormula( );
+	checkUint( );
+	checkRegCache( );
+	checkRtt( );
+	checkWait( );
+	return testDone( );
+}
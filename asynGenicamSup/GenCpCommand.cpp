@@ -0,0 +1,307 @@
+// GenCpCommand.cpp
+
+//
+// Parsing and encoding of the asynGenicam ascii protocol register commands.
+// See GenCpCommand.h
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "GenCpCommand.h"
+
+bool	GenCpValidUintBits(
+	unsigned int		nBits	)
+{
+	return nBits >= 8 && nBits <= 64 && nBits % 8 == 0;
+}
+
+uint64_t	GenCpSwapBytes(
+	uint64_t			value,
+	size_t				nBytes	)
+{
+	uint64_t	swapped	= 0;
+	for ( size_t iByte = 0; iByte < nBytes; iByte++ )
+	{
+		swapped	= ( swapped << 8 ) | ( value & 0xFF );
+		value >>= 8;
+	}
+	return swapped;
+}
+
+void	GenCpEncodeUint(
+	uint64_t			value,
+	size_t				nBytes,
+	uint8_t			*	pData	)
+{
+	for ( size_t iByte = 0; iByte < nBytes; iByte++ )
+		pData[iByte]	= static_cast<uint8_t>( value >> ( 8 * ( nBytes - 1 - iByte ) ) );
+}
+
+uint64_t	GenCpDecodeUint(
+	const uint8_t	*	pData,
+	size_t				nBytes	)
+{
+	uint64_t	value	= 0;
+	for ( size_t iByte = 0; iByte < nBytes; iByte++ )
+		value	= ( value << 8 ) | pData[iByte];
+	return value;
+}
+
+bool	GenCpParseUint(
+	const char		*	pCommand,
+	GenCpUintCommand *	pUint	)
+{
+	long long int		regAddr	= 0;
+	int					nParsed	= 0;
+
+	pUint->nBits	= 0;
+	pUint->regAddr	= 0;
+	pUint->cGetSet	= 0;
+	pUint->value	= 0;
+	pUint->pOps		= NULL;
+	if ( sscanf( pCommand, "U%u %Li %n", &pUint->nBits, &regAddr, &nParsed ) != 2 || nParsed == 0 )
+		return false;
+	if ( !GenCpValidUintBits( pUint->nBits ) )
+		return false;
+	pUint->regAddr	= static_cast<uint64_t>( regAddr );
+
+	const char		*	pRest	= pCommand + nParsed;
+	if ( *pRest == '&' || *pRest == '|' || *pRest == '^' )
+	{
+		// Read-modify-write, a write of the register w/ the ops applied
+		uint64_t	andMask, orBits, xorBits;
+		pUint->cGetSet	= '=';
+		pUint->pOps		= pRest;
+		return GenCpParseModifyOps( pRest, &andMask, &orBits, &xorBits );
+	}
+	pUint->cGetSet	= *pRest;
+	if ( *pRest == '?' )
+		return true;
+	if ( *pRest != '=' )
+		return false;
+
+	// Unsigned, so U64 values above 2^63 aren't clamped, negative ones still wrap
+	char			*	pEnd;
+	pUint->value	= strtoull( pRest + 1, &pEnd, 0 );
+	return pEnd != pRest + 1;
+}
+
+bool	GenCpParseModifyOps(
+	const char		*	pOps,
+	uint64_t		*	pAndMask,
+	uint64_t		*	pOrBits,
+	uint64_t		*	pXorBits	)
+{
+	const char		*	pOp		= pOps;
+	size_t				nOps	= 0;
+	uint64_t			andMask	= ~0ULL;
+	uint64_t			orBits	= 0;
+	uint64_t			xorBits	= 0;
+	for ( ;; )
+	{
+		while ( *pOp == ' ' || *pOp == '\t' || *pOp == '\r' || *pOp == '\n' )
+			pOp++;
+		char		op		= *pOp;
+		if ( ( op != '&' && op != '|' && op != '^' ) || pOp[1] != '=' )
+			break;
+		pOp	+= 2;
+		bool		fInvert	= ( *pOp == '~' );
+		if ( fInvert )
+			pOp++;
+		char	*	pEnd;
+		uint64_t	operand	= strtoull( pOp, &pEnd, 0 );
+		if ( pEnd == pOp )
+			break;
+		pOp	= pEnd;
+		nOps++;
+		if ( fInvert )
+			operand	= ~operand;
+
+		// Ops apply left to right, ((v & a) | b) ^ c, folded into one of each
+		if ( op == '&' )
+		{
+			andMask	&= operand;
+			orBits	&= operand;
+			xorBits	&= operand;
+		}
+		else if ( op == '|' )
+		{
+			andMask	|= operand;
+			orBits	|= operand;
+			xorBits	&= ~operand;
+		}
+		else
+			xorBits	^= operand;
+	}
+	*pAndMask	= andMask;
+	*pOrBits	= orBits;
+	*pXorBits	= xorBits;
+	return nOps > 0 && *pOp == '\0';
+}
+
+const char *	GenCpParseWait(
+	const char		*	pCommand,
+	GenCpWaitCommand *	pWait	)
+{
+	int					nParsed		= 0;
+	bool				fCondition	= false;
+	char			*	pRegEnd		= NULL;
+
+	pWait->nBits		= 0;
+	pWait->regName[0]	= '\0';
+	pWait->fAddress		= false;
+	pWait->regAddr		= 0;
+	pWait->fWrite		= false;
+	pWait->writeValue	= 0;
+	pWait->mask			= ~0ULL;
+	pWait->fEqual		= true;
+	pWait->expected		= 0;
+	pWait->fTimeout		= false;
+	pWait->timeout		= 0.0;
+
+	// The name ends at '=', so W32 0x100=1 writes 1 to 0x100
+	if ( sscanf( pCommand, "W%u %127[^= \t\r\n] %n", &pWait->nBits, pWait->regName, &nParsed ) != 2 || nParsed == 0 )
+		return "syntax error";
+	if ( !GenCpValidUintBits( pWait->nBits ) )
+		return "unsupported register length";
+	pWait->regAddr	= strtoull( pWait->regName, &pRegEnd, 0 );
+	pWait->fAddress	= ( pRegEnd != pWait->regName && *pRegEnd == '\0' );
+
+	for ( const char * pToken = pCommand + nParsed; *pToken != '\0'; )
+	{
+		char			*	pEnd;
+		if ( *pToken == ' ' || *pToken == '\t' || *pToken == '\r' || *pToken == '\n' )
+		{
+			pToken++;
+			continue;
+		}
+		if ( ( pToken[0] == '=' || pToken[0] == '!' ) && pToken[1] == '=' )
+		{
+			pWait->fEqual	= ( pToken[0] == '=' );
+			pWait->expected	= strtoull( pToken + 2, &pEnd, 0 );
+			fCondition		= true;
+			pEnd			= ( pEnd == pToken + 2 ) ? NULL : pEnd;
+		}
+		else if ( pToken[0] == '=' )
+		{
+			pWait->fWrite		= true;
+			pWait->writeValue	= strtoull( pToken + 1, &pEnd, 0 );
+			pEnd				= ( pEnd == pToken + 1 ) ? NULL : pEnd;
+		}
+		else if ( pToken[0] == '&' )
+		{
+			pWait->mask		= strtoull( pToken + 1, &pEnd, 0 );
+			pEnd			= ( pEnd == pToken + 1 ) ? NULL : pEnd;
+		}
+		else
+		{
+			pWait->timeout	= strtod( pToken, &pEnd ) / 1000.0;
+			pWait->fTimeout	= true;
+			if ( pEnd != pToken && ( pWait->timeout < 0.0 || pWait->timeout > GENCP_WAIT_MAX_SEC ) )
+				return "timeout out of range";
+			pEnd			= ( pEnd == pToken ) ? NULL : pEnd;
+		}
+		if ( pEnd == NULL )
+			return "syntax error";
+		pToken	= pEnd;
+	}
+	if ( !fCondition )
+		return "missing ==<value> or !=<value> condition";
+	return NULL;
+}
+
+const char *	GenCpFeatureCommand(
+	const GenCpRegMapEntry	*	pEntry,
+	const char		*	pValue,
+	std::string		&	command	)
+{
+	char				buffer[64];
+	unsigned long long	regAddr		= pEntry->address;
+	unsigned int		nBits		= pEntry->length * 8;
+	bool				fNumeric	= pEntry->type != GENCP_REGMAP_TYPE_STRING && pEntry->type != GENCP_REGMAP_TYPE_REGISTER;
+	bool				fFloat		= pEntry->type == GENCP_REGMAP_TYPE_FLOAT && !( pEntry->flags & GENCP_REGMAP_FLAG_MASKED );
+
+	command.clear();
+	if ( !fNumeric )
+	{
+		// Strings and raw registers go as is
+		if ( pValue == NULL )
+			snprintf( buffer, sizeof(buffer), "C%u 0x%llX ?", pEntry->length, regAddr );
+		else
+			snprintf( buffer, sizeof(buffer), "C%u 0x%llX =", pEntry->length, regAddr );
+		command	= std::string( buffer ) + ( pValue != NULL ? pValue : "" );
+		return NULL;
+	}
+	if ( pEntry->length == 0 || pEntry->length > sizeof(uint64_t) )
+		return "unsupported register length";
+
+	if ( pValue == NULL )
+	{
+		// Big endian floats use the F encoding, everything else is decoded per the feature
+		if ( fFloat && pEntry->endian == GENCP_REGMAP_ENDIAN_BIG )
+			snprintf( buffer, sizeof(buffer), "F%u 0x%llX ?", nBits, regAddr );
+		else
+			snprintf( buffer, sizeof(buffer), "U%u 0x%llX ?", nBits, regAddr );
+	}
+	else if ( ( pEntry->flags & GENCP_REGMAP_FLAG_MASKED ) && !( pEntry->access & GENCP_REGMAP_ACCESS_RO ) )
+		return "bit field of a write only register";
+	else if ( pEntry->flags & GENCP_REGMAP_FLAG_MASKED )
+	{
+		// Bit fields are written by a read-modify-write of the register
+		char		*	pEnd;
+		long long int	intValue	= strtoll( pValue, &pEnd, 0 );
+		unsigned int	nFieldBits	= pEntry->msb - pEntry->lsb + 1;
+		uint64_t		fieldMask	= ( nFieldBits < 64 ) ? ( 1ULL << nFieldBits ) - 1 : ~0ULL;
+		if ( pEnd == pValue )
+			return "invalid value";
+		uint64_t		mask		= fieldMask << pEntry->lsb;
+		uint64_t		bits		= ( static_cast<uint64_t>( intValue ) & fieldMask ) << pEntry->lsb;
+		if ( pEntry->endian != GENCP_REGMAP_ENDIAN_BIG )
+		{
+			mask	= GenCpSwapBytes( mask, pEntry->length );
+			bits	= GenCpSwapBytes( bits, pEntry->length );
+		}
+		snprintf(	buffer, sizeof(buffer), "U%u 0x%llX &=~0x%llX |=0x%llX", nBits, regAddr,
+					(long long unsigned int) mask, (long long unsigned int) bits );
+	}
+	else if ( fFloat && nBits != 32 && nBits != 64 )
+		return "unsupported float length";
+	else if ( fFloat )
+	{
+		char	*	pEnd;
+		double		doubleValue	= strtod( pValue, &pEnd );
+		uint64_t	rawValue;
+		if ( pEnd == pValue )
+			return "invalid value";
+		if ( pEntry->endian == GENCP_REGMAP_ENDIAN_BIG )
+			snprintf( buffer, sizeof(buffer), "F%u 0x%llX =%.17g", nBits, regAddr, doubleValue );
+		else
+		{
+			if ( nBits == 32 )
+			{
+				float		floatValue	= static_cast<float>( doubleValue );
+				uint32_t	rawValue32;
+				memcpy( &rawValue32, &floatValue, sizeof(rawValue32) );
+				rawValue	= rawValue32;
+			}
+			else
+				memcpy( &rawValue, &doubleValue, sizeof(rawValue) );
+			rawValue	= GenCpSwapBytes( rawValue, pEntry->length );
+			snprintf( buffer, sizeof(buffer), "U%u 0x%llX =%llu", nBits, regAddr, (long long unsigned int) rawValue );
+		}
+	}
+	else
+	{
+		char		*	pEnd;
+		long long int	intValue	= strtoll( pValue, &pEnd, 0 );
+		if ( pEnd == pValue )
+			return "invalid value";
+		uint64_t		rawValue	= static_cast<uint64_t>( intValue );
+		if ( pEntry->endian != GENCP_REGMAP_ENDIAN_BIG )
+			rawValue	= GenCpSwapBytes( rawValue, pEntry->length );
+		snprintf( buffer, sizeof(buffer), "U%u 0x%llX =%llu", nBits, regAddr, (long long unsigned int) rawValue );
+	}
+	command	= buffer;
+	return NULL;
+}
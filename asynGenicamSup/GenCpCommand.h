@@ -0,0 +1,91 @@
+// GenCpCommand.h
+
+//
+// Parsing and encoding of the register commands of the asynGenicam ascii
+// protocol: U reads, writes and read-modify-writes, N feature commands and
+// W waits.  Nothing here does I/O, so asynGenicam and the host side
+// GenCpCheck share the same code.
+//
+
+#ifndef	GENCP_COMMAND_H
+#define	GENCP_COMMAND_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include "GenCpRegMap.h"
+
+#define	GENCP_COMMAND_NAME_MAX		128		// Feature names in N and W commands, w/ the NULL
+
+// Longest W command wait, as it holds the port throughout, sec
+#define	GENCP_WAIT_MAX_SEC			10.0
+
+/// U<bits> <addr> ?  or  =<value>  or  <ops>, see GenCpParseModifyOps()
+typedef struct
+{
+	unsigned int	nBits;
+	uint64_t		regAddr;
+	char			cGetSet;		// '?' is a read, '=' a write of value or of the ops applied
+	uint64_t		value;
+	const char	*	pOps;			// Read-modify-write ops in the command, NULL if none
+}	GenCpUintCommand;
+
+/// W<bits> <addr or feature> [=<value>] [&<mask>] ==|!=<expected> [<timeout ms>]
+typedef struct
+{
+	unsigned int	nBits;
+	char			regName[GENCP_COMMAND_NAME_MAX];
+	bool			fAddress;		// regName is a number, in regAddr
+	uint64_t		regAddr;
+	bool			fWrite;
+	uint64_t		writeValue;
+	uint64_t		mask;
+	bool			fEqual;			// Wait for ==, else for !=
+	uint64_t		expected;
+	bool			fTimeout;		// Timeout given, else the caller's applies
+	double			timeout;		// sec, up to GENCP_WAIT_MAX_SEC
+}	GenCpWaitCommand;
+
+/// U commands take whole bytes, U8 through U64
+bool			GenCpValidUintBits(		unsigned int		nBits	);
+
+/// Reverse the order of the low nBytes of value
+uint64_t		GenCpSwapBytes(			uint64_t			value,
+										size_t				nBytes	);
+
+/// Low nBytes of value as big endian register bytes, the U command byte order
+void			GenCpEncodeUint(		uint64_t			value,
+										size_t				nBytes,
+										uint8_t			*	pData	);
+
+/// Value of nBytes big endian register bytes
+uint64_t		GenCpDecodeUint(		const uint8_t	*	pData,
+										size_t				nBytes	);
+
+/// Parse a U command, false on a syntax error or unsupported length
+bool			GenCpParseUint(			const char		*	pCommand,
+										GenCpUintCommand *	pUint	);
+
+/// Fold read-modify-write ops, e.g. "&=~0x30 |=0x10", applied left to right,
+/// into a new value of ( ( value & andMask ) | orBits ) ^ xorBits
+/// Returns false unless the whole string is one or more ops
+bool			GenCpParseModifyOps(	const char		*	pOps,
+										uint64_t		*	pAndMask,
+										uint64_t		*	pOrBits,
+										uint64_t		*	pXorBits	);
+
+/// Parse a W command, returns NULL, or the error
+/// Timeouts below 0 or above GENCP_WAIT_MAX_SEC are errors
+const char	*	GenCpParseWait(			const char		*	pCommand,
+										GenCpWaitCommand *	pWait	);
+
+/// Translate an N command for a register backed feature into the C, U or F
+/// command for its register, per its length, byte order and bit field
+/// pValue is the text after '=' of a write, NULL for a read
+/// Returns NULL, or the error, e.g. for a write of a bit field that can't
+/// be read back for its read-modify-write
+const char	*	GenCpFeatureCommand(	const GenCpRegMapEntry	*	pEntry,
+										const char		*	pValue,
+										std::string		&	command	);
+
+#endif	/* GENCP_COMMAND_H */
@@ -0,0 +1,618 @@
+// GenCpFormula.cpp
+
+//
+// Bytecode for GenICam SwissKnife, IntSwissKnife and Converter formulas.
+// See GenCpFormula.h
+//
+
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits>
+#include "GenCpFormula.h"
+
+// Nesting limits for parentheses and Expression elements
+#define	GENCP_FORMULA_MAX_DEPTH		64
+#define	GENCP_FORMULA_MAX_EXPAND	8
+
+/// Binary operators, lowest precedence level first
+typedef struct
+{
+	const char	*	pText;
+	int				level;
+	int				opcode;
+}	GenCpFormulaBinaryOp;
+
+// Longer spellings before their prefixes
+static const GenCpFormulaBinaryOp	formulaBinaryOps[]	=
+{
+	{ "||",	1,	GENCP_FOP_LOR	},
+	{ "&&",	2,	GENCP_FOP_LAND	},
+	{ "|",	3,	GENCP_FOP_OR	},
+	{ "^",	4,	GENCP_FOP_XOR	},
+	{ "&",	5,	GENCP_FOP_AND	},
+	{ "==",	6,	GENCP_FOP_EQ	},
+	{ "=",	6,	GENCP_FOP_EQ	},
+	{ "<>",	6,	GENCP_FOP_NE	},
+	{ ">=",	7,	GENCP_FOP_GE	},
+	{ "<=",	7,	GENCP_FOP_LE	},
+	{ "<<",	8,	GENCP_FOP_SHL	},
+	{ ">>",	8,	GENCP_FOP_SHR	},
+	{ ">",	7,	GENCP_FOP_GT	},
+	{ "<",	7,	GENCP_FOP_LT	},
+	{ "+",	9,	GENCP_FOP_ADD	},
+	{ "-",	9,	GENCP_FOP_SUB	},
+	{ "**",	11,	GENCP_FOP_POW	},
+	{ "*",	10,	GENCP_FOP_MUL	},
+	{ "/",	10,	GENCP_FOP_DIV	},
+	{ "%",	10,	GENCP_FOP_MOD	},
+};
+#define	GENCP_FORMULA_MAX_LEVEL		11		// ** is right associative
+
+/// Built in functions
+typedef struct
+{
+	const char	*	pName;
+	int				nArgs;
+	int				opcode;
+}	GenCpFormulaFunction;
+
+static const GenCpFormulaFunction	formulaFunctions[]	=
+{
+	{ "SGN",	1,	GENCP_FOP_SGN	},
+	{ "NEG",	1,	GENCP_FOP_NEG	},
+	{ "ABS",	1,	GENCP_FOP_ABS	},
+	{ "EXP",	1,	GENCP_FOP_EXP	},
+	{ "LN",		1,	GENCP_FOP_LN	},
+	{ "LG",		1,	GENCP_FOP_LG	},
+	{ "SQRT",	1,	GENCP_FOP_SQRT	},
+	{ "TRUNC",	1,	GENCP_FOP_TRUNC	},
+	{ "FLOOR",	1,	GENCP_FOP_FLOOR	},
+	{ "CEIL",	1,	GENCP_FOP_CEIL	},
+	{ "SIN",	1,	GENCP_FOP_SIN	},
+	{ "COS",	1,	GENCP_FOP_COS	},
+	{ "TAN",	1,	GENCP_FOP_TAN	},
+	{ "ASIN",	1,	GENCP_FOP_ASIN	},
+	{ "ACOS",	1,	GENCP_FOP_ACOS	},
+	{ "ATAN",	1,	GENCP_FOP_ATAN	},
+	{ "ROUND",	2,	GENCP_FOP_ROUND	},	// Precision is optional
+};
+
+/// Recursive descent parser emitting postfix code
+class GenCpFormulaParser
+{
+public:
+	GenCpFormulaParser(	const char					*	pFormula,
+						const GenCpFormulaSymbols	&	symbols,
+						std::vector<uint32_t>		&	code,
+						std::vector<double>			&	consts,
+						int								expandDepth	)
+		:	m_p( pFormula ), m_symbols( symbols ), m_code( code ), m_consts( consts ),
+			m_stack( 0 ), m_maxStack( 0 ), m_expandDepth( expandDepth ), m_error( )
+	{
+	}
+
+	bool				ParseFormula( );
+	int					MaxStack( ) const	{ return m_maxStack; }
+	const std::string &	Error( ) const		{ return m_error; }
+
+private:
+	bool	Fail( const std::string & msg );
+	void	SkipSpace( );
+	bool	Match( const char * pText );
+	void	Emit( int opcode, uint32_t arg, int stackChange );
+	bool	EmitConst( double value );
+	bool	ParseTernary( int depth );
+	bool	ParseBinary( int level, int depth );
+	bool	ParseUnary( int depth );
+	bool	ParsePrimary( int depth );
+	bool	ParseName( int depth );
+
+	const char					*	m_p;
+	const GenCpFormulaSymbols	&	m_symbols;
+	std::vector<uint32_t>		&	m_code;
+	std::vector<double>			&	m_consts;
+	int								m_stack;
+	int								m_maxStack;
+	int								m_expandDepth;
+	std::string						m_error;
+};
+
+bool	GenCpFormulaParser::Fail( const std::string & msg )
+{
+	if ( m_error.empty() )
+		m_error	= msg;
+	return false;
+}
+
+void	GenCpFormulaParser::SkipSpace( )
+{
+	while ( isspace( static_cast<unsigned char>( *m_p ) ) )
+		m_p++;
+}
+
+bool	GenCpFormulaParser::Match( const char * pText )
+{
+	SkipSpace();
+	size_t	len	= strlen( pText );
+	if ( strncmp( m_p, pText, len ) != 0 )
+		return false;
+	m_p	+= len;
+	return true;
+}
+
+void	GenCpFormulaParser::Emit( int opcode, uint32_t arg, int stackChange )
+{
+	m_code.push_back( GENCP_FORMULA_OP( opcode, arg ) );
+	m_stack	+= stackChange;
+	if ( m_stack > m_maxStack )
+		m_maxStack	= m_stack;
+}
+
+bool	GenCpFormulaParser::EmitConst( double value )
+{
+	if ( m_consts.size() >= GENCP_FORMULA_MAX_ARG )
+		return Fail( "too many constants" );
+	Emit( GENCP_FOP_CONST, m_consts.size(), 1 );
+	m_consts.push_back( value );
+	return true;
+}
+
+bool	GenCpFormulaParser::ParseFormula( )
+{
+	if ( !ParseTernary( 0 ) )
+		return false;
+	SkipSpace();
+	if ( *m_p != '\0' )
+		return Fail( std::string( "unexpected text: " ) + m_p );
+	if ( m_maxStack > GENCP_FORMULA_MAX_STACK )
+		return Fail( "formula too deeply nested" );
+	return true;
+}
+
+bool	GenCpFormulaParser::ParseTernary( int depth )
+{
+	if ( depth > GENCP_FORMULA_MAX_DEPTH )
+		return Fail( "formula too deeply nested" );
+	if ( !ParseBinary( 1, depth ) )
+		return false;
+	if ( !Match( "?" ) )
+		return true;
+
+	// cond JZ else; a JMP end; else: b; end:
+	size_t	iJumpElse	= m_code.size();
+	Emit( GENCP_FOP_JZ, 0, -1 );
+	if ( !ParseTernary( depth + 1 ) )
+		return false;
+	size_t	iJumpEnd	= m_code.size();
+	Emit( GENCP_FOP_JMP, 0, -1 );	// Only one branch is left on the stack
+	if ( !Match( ":" ) )
+		return Fail( "missing : in ?:" );
+	m_code[iJumpElse]	= GENCP_FORMULA_OP( GENCP_FOP_JZ, m_code.size() );
+	if ( !ParseTernary( depth + 1 ) )
+		return false;
+	m_code[iJumpEnd]	= GENCP_FORMULA_OP( GENCP_FOP_JMP, m_code.size() );
+	return true;
+}
+
+bool	GenCpFormulaParser::ParseBinary( int level, int depth )
+{
+	if ( level > GENCP_FORMULA_MAX_LEVEL )
+		return ParseUnary( depth );
+	if ( !ParseBinary( level + 1, depth ) )
+		return false;
+	for ( ;; )
+	{
+		const GenCpFormulaBinaryOp	*	pOp	= NULL;
+		SkipSpace();
+		for ( size_t iOp = 0; iOp < sizeof(formulaBinaryOps) / sizeof(formulaBinaryOps[0]); iOp++ )
+		{
+			size_t	len	= strlen( formulaBinaryOps[iOp].pText );
+			if ( strncmp( m_p, formulaBinaryOps[iOp].pText, len ) == 0 )
+			{
+				pOp	= &formulaBinaryOps[iOp];
+				break;
+			}
+		}
+		if ( pOp == NULL || pOp->level != level )
+			return true;
+		m_p	+= strlen( pOp->pText );
+		if ( !ParseBinary( ( level == GENCP_FORMULA_MAX_LEVEL ) ? level : level + 1, depth + 1 ) )
+			return false;
+		Emit( pOp->opcode, 0, -1 );
+	}
+}
+
+bool	GenCpFormulaParser::ParseUnary( int depth )
+{
+	if ( depth > GENCP_FORMULA_MAX_DEPTH )
+		return Fail( "formula too deeply nested" );
+	SkipSpace();
+	int		opcode	= 0;
+	if ( *m_p == '-' )
+		opcode	= GENCP_FOP_NEG;
+	else if ( *m_p == '!' )
+		opcode	= GENCP_FOP_NOT;
+	else if ( *m_p == '~' )
+		opcode	= GENCP_FOP_BITNOT;
+	else if ( *m_p != '+' )
+		return ParsePrimary( depth );
+	m_p++;
+	if ( !ParseUnary( depth + 1 ) )
+		return false;
+	if ( opcode != 0 )
+		Emit( opcode, 0, 0 );
+	return true;
+}
+
+bool	GenCpFormulaParser::ParsePrimary( int depth )
+{
+	SkipSpace();
+	if ( *m_p == '(' )
+	{
+		m_p++;
+		if ( !ParseTernary( depth + 1 ) )
+			return false;
+		if ( !Match( ")" ) )
+			return Fail( "missing )" );
+		return true;
+	}
+	if ( isdigit( static_cast<unsigned char>( *m_p ) ) || *m_p == '.' )
+	{
+		char	*	pEnd;
+		double		value;
+		if ( m_p[0] == '0' && ( m_p[1] == 'x' || m_p[1] == 'X' ) )
+			value	= static_cast<double>( strtoull( m_p, &pEnd, 16 ) );
+		else
+			value	= strtod( m_p, &pEnd );
+		if ( pEnd == m_p )
+			return Fail( std::string( "invalid number: " ) + m_p );
+		m_p	= pEnd;
+		return EmitConst( value );
+	}
+	if ( isalpha( static_cast<unsigned char>( *m_p ) ) || *m_p == '_' )
+		return ParseName( depth );
+	return Fail( std::string( "unexpected text: " ) + m_p );
+}
+
+bool	GenCpFormulaParser::ParseName( int depth )
+{
+	const char	*	pStart	= m_p;
+	while ( isalnum( static_cast<unsigned char>( *m_p ) ) || *m_p == '_' || *m_p == '.' )
+		m_p++;
+	std::string		name( pStart, m_p - pStart );
+
+	SkipSpace();
+	if ( *m_p == '(' )
+	{
+		const GenCpFormulaFunction	*	pFunction	= NULL;
+		for ( size_t iFunc = 0; iFunc < sizeof(formulaFunctions) / sizeof(formulaFunctions[0]); iFunc++ )
+		{
+			if ( name == formulaFunctions[iFunc].pName )
+				pFunction	= &formulaFunctions[iFunc];
+		}
+		if ( pFunction == NULL )
+			return Fail( "unknown function " + name );
+		m_p++;
+		int		nArgs	= 0;
+		if ( !Match( ")" ) )
+		{
+			do
+			{
+				if ( !ParseTernary( depth + 1 ) )
+					return false;
+				nArgs++;
+			}	while ( Match( "," ) );
+			if ( !Match( ")" ) )
+				return Fail( "missing ) after arguments of " + name );
+		}
+		if ( pFunction->opcode == GENCP_FOP_ROUND && nArgs == 1 )
+		{
+			if ( !EmitConst( 0.0 ) )
+				return false;
+			nArgs++;
+		}
+		if ( nArgs != pFunction->nArgs )
+			return Fail( "wrong number of arguments for " + name );
+		Emit( pFunction->opcode, 0, 1 - nArgs );
+		return true;
+	}
+
+	std::map<std::string, uint32_t>::const_iterator		itVar	= m_symbols.variables.find( name );
+	if ( itVar != m_symbols.variables.end() )
+	{
+		Emit( GENCP_FOP_VAR, itVar->second, 1 );
+		return true;
+	}
+	std::map<std::string, double>::const_iterator		itConst	= m_symbols.constants.find( name );
+	if ( itConst != m_symbols.constants.end() )
+		return EmitConst( itConst->second );
+	std::map<std::string, std::string>::const_iterator	itExpr	= m_symbols.expressions.find( name );
+	if ( itExpr != m_symbols.expressions.end() )
+	{
+		if ( m_expandDepth >= GENCP_FORMULA_MAX_EXPAND )
+			return Fail( "Expression nesting too deep at " + name );
+		GenCpFormulaParser	expr( itExpr->second.c_str(), m_symbols, m_code, m_consts, m_expandDepth + 1 );
+		if ( !expr.ParseFormula() )
+			return Fail( name + ": " + expr.Error() );
+		if ( m_stack + expr.MaxStack() > m_maxStack )
+			m_maxStack	= m_stack + expr.MaxStack();
+		m_stack++;
+		return true;
+	}
+	if ( name == "PI" )
+		return EmitConst( M_PI );
+	if ( name == "E" )
+		return EmitConst( M_E );
+	return Fail( "unknown name " + name );
+}
+
+bool	GenCpFormulaCompile(
+	const char					*	pFormula,
+	const GenCpFormulaSymbols	&	symbols,
+	std::vector<uint32_t>		&	code,
+	std::vector<double>			&	consts,
+	std::string					&	errorMsg	)
+{
+	GenCpFormulaParser	parser( pFormula, symbols, code, consts, 0 );
+	if ( !parser.ParseFormula() )
+	{
+		errorMsg	= parser.Error();
+		return false;
+	}
+	return true;
+}
+
+/// Shift w/ the count clamped, shifting an int64_t by >= 64 is undefined
+static int64_t	GenCpFormulaShift( int64_t value, int64_t count, bool fLeft )
+{
+	if ( count <= -64 || count >= 64 )
+		return 0;
+	if ( count < 0 )
+	{
+		count	= -count;
+		fLeft	= !fLeft;
+	}
+	return fLeft ? static_cast<int64_t>( static_cast<uint64_t>( value ) << count ) : ( value >> count );
+}
+
+// Converting a double outside the int64_t range, or NaN, is undefined,
+// so the integer machine and the bit operators check every conversion
+static bool	GenCpFormulaConvert( double value, double & result )
+{
+	result	= value;
+	return true;
+}
+
+static bool	GenCpFormulaConvert( int64_t value, int64_t & result )
+{
+	result	= value;
+	return true;
+}
+
+static bool	GenCpFormulaConvert( double value, int64_t & result )
+{
+	// -2^63 and 2^63 are exact doubles, INT64_MAX isn't
+	if ( !( value >= -9223372036854775808.0 && value < 9223372036854775808.0 ) )
+		return false;
+	result	= static_cast<int64_t>( value );
+	return true;
+}
+
+/// True if an int64_t binary operator overflows, which is undefined
+static bool	GenCpFormulaOverflows( int opcode, int64_t a, int64_t b )
+{
+	const int64_t	maxValue	= std::numeric_limits<int64_t>::max();
+	const int64_t	minValue	= std::numeric_limits<int64_t>::min();
+	switch ( opcode )
+	{
+	case GENCP_FOP_ADD:	return ( b > 0 && a > maxValue - b ) || ( b < 0 && a < minValue - b );
+	case GENCP_FOP_SUB:	return ( b < 0 && a > maxValue + b ) || ( b > 0 && a < minValue + b );
+	case GENCP_FOP_MUL:
+		if ( a == 0 || b == 0 )
+			return false;
+		if ( ( a > 0 ) == ( b > 0 ) )
+			return ( a > 0 ) ? a > maxValue / b : a < maxValue / b;
+		return ( a > 0 ) ? b < minValue / a : a < minValue / b;
+	case GENCP_FOP_DIV:
+	case GENCP_FOP_MOD:	return a == minValue && b == -1;
+	default:			return false;
+	}
+}
+
+/// Doubles take IEEE infinities instead
+static bool	GenCpFormulaOverflows( int, double, double )
+{
+	return false;
+}
+
+/// Stack machine for one numeric type, int64_t for IntSwissKnife, double otherwise
+template <typename T>
+static bool	GenCpFormulaRun(
+	const uint32_t		*	pCode,
+	size_t					nCode,
+	const double		*	pConsts,
+	size_t					nConsts,
+	const double		*	pVars,
+	size_t					nVars,
+	double				*	pResult		)
+{
+	T			stack[GENCP_FORMULA_MAX_STACK];
+	size_t		nStack	= 0;
+	size_t		pc		= 0;
+	size_t		nSteps	= 0;
+	bool		fOk;
+
+	while ( pc < nCode )
+	{
+		uint32_t	op		= pCode[pc++];
+		uint32_t	arg		= GENCP_FORMULA_ARG( op );
+		int			opcode	= GENCP_FORMULA_OPCODE( op );
+
+		// Jumps only go forward, this is a guard against corrupt code
+		if ( ++nSteps > nCode )
+			return false;
+
+		if ( opcode == GENCP_FOP_CONST || opcode == GENCP_FOP_VAR )
+		{
+			if ( nStack >= GENCP_FORMULA_MAX_STACK )
+				return false;
+			if ( opcode == GENCP_FOP_CONST && arg < nConsts )
+				fOk	= GenCpFormulaConvert( pConsts[arg], stack[nStack] );
+			else if ( opcode == GENCP_FOP_VAR && arg < nVars )
+				fOk	= GenCpFormulaConvert( pVars[arg], stack[nStack] );
+			else
+				return false;
+			if ( !fOk )
+				return false;
+			nStack++;
+			continue;
+		}
+		if ( opcode == GENCP_FOP_JMP )
+		{
+			if ( arg > nCode )
+				return false;
+			pc	= arg;
+			continue;
+		}
+		if ( nStack < 1 )
+			return false;
+		if ( opcode == GENCP_FOP_JZ )
+		{
+			if ( arg > nCode )
+				return false;
+			if ( stack[--nStack] == 0 )
+				pc	= arg;
+			continue;
+		}
+
+		T	&	a	= stack[nStack - 1];
+		double	x	= static_cast<double>( a );
+		int64_t	ia	= 0;
+		// -INT64_MIN doesn't fit an int64_t
+		bool	fNegOverflows	= std::numeric_limits<T>::is_integer && a == std::numeric_limits<T>::min();
+		if ( opcode >= GENCP_FOP_SGN && opcode < GENCP_FOP_ROUND )
+		{
+			switch ( opcode )
+			{
+			case GENCP_FOP_SGN:		a	= ( a > 0 ) ? 1 : ( a < 0 ) ? -1 : 0;	continue;
+			case GENCP_FOP_ABS:
+				if ( fNegOverflows )
+					return false;
+				a	= ( a < 0 ) ? -a : a;
+				continue;
+			case GENCP_FOP_EXP:		x	= exp( x );		break;
+			case GENCP_FOP_LN:		x	= log( x );		break;
+			case GENCP_FOP_LG:		x	= log10( x );	break;
+			case GENCP_FOP_SQRT:	x	= sqrt( x );	break;
+			case GENCP_FOP_TRUNC:	x	= trunc( x );	break;
+			case GENCP_FOP_FLOOR:	x	= floor( x );	break;
+			case GENCP_FOP_CEIL:	x	= ceil( x );	break;
+			case GENCP_FOP_SIN:		x	= sin( x );		break;
+			case GENCP_FOP_COS:		x	= cos( x );		break;
+			case GENCP_FOP_TAN:		x	= tan( x );		break;
+			case GENCP_FOP_ASIN:	x	= asin( x );	break;
+			case GENCP_FOP_ACOS:	x	= acos( x );	break;
+			case GENCP_FOP_ATAN:	x	= atan( x );	break;
+			default:				return false;
+			}
+			if ( !GenCpFormulaConvert( x, a ) )
+				return false;
+			continue;
+		}
+		switch ( opcode )
+		{
+		case GENCP_FOP_NEG:
+			if ( fNegOverflows )
+				return false;
+			a	= -a;
+			continue;
+		case GENCP_FOP_NOT:		a	= ( a == 0 ) ? 1 : 0;							continue;
+		case GENCP_FOP_BITNOT:
+			if ( !GenCpFormulaConvert( a, ia ) )
+				return false;
+			a	= static_cast<T>( ~ia );
+			continue;
+		default:				break;
+		}
+
+		// Binary operators
+		if ( nStack < 2 )
+			return false;
+		T		b	= stack[--nStack];
+		T	&	r	= stack[nStack - 1];
+		x	= static_cast<double>( r );
+		double	y	= static_cast<double>( b );
+		int64_t	ib	= 0;
+		bool	fInts	= GenCpFormulaConvert( r, ia ) && GenCpFormulaConvert( b, ib );
+		if ( !fInts && ( opcode == GENCP_FOP_MOD || ( opcode >= GENCP_FOP_AND && opcode <= GENCP_FOP_SHR ) ) )
+			return false;
+		if ( GenCpFormulaOverflows( opcode, r, b ) )
+			return false;
+		switch ( opcode )
+		{
+		case GENCP_FOP_ADD:		r	= r + b;		break;
+		case GENCP_FOP_SUB:		r	= r - b;		break;
+		case GENCP_FOP_MUL:		r	= r * b;		break;
+		case GENCP_FOP_DIV:
+			if ( b == 0 )
+				return false;
+			r	= r / b;
+			break;
+		case GENCP_FOP_MOD:
+			if ( ib == 0 )
+				return false;
+			if ( std::numeric_limits<T>::is_integer )
+				r	= static_cast<T>( ia % ib );
+			else
+				r	= static_cast<T>( fmod( x, y ) );
+			break;
+		case GENCP_FOP_POW:
+			if ( !GenCpFormulaConvert( pow( x, y ), r ) )
+				return false;
+			break;
+		case GENCP_FOP_AND:		r	= static_cast<T>( ia & ib );								break;
+		case GENCP_FOP_OR:		r	= static_cast<T>( ia | ib );								break;
+		case GENCP_FOP_XOR:		r	= static_cast<T>( ia ^ ib );								break;
+		case GENCP_FOP_SHL:		r	= static_cast<T>( GenCpFormulaShift( ia, ib, true ) );		break;
+		case GENCP_FOP_SHR:		r	= static_cast<T>( GenCpFormulaShift( ia, ib, false ) );		break;
+		case GENCP_FOP_LAND:	r	= ( r != 0 && b != 0 ) ? 1 : 0;	break;
+		case GENCP_FOP_LOR:		r	= ( r != 0 || b != 0 ) ? 1 : 0;	break;
+		case GENCP_FOP_EQ:		r	= ( r == b ) ? 1 : 0;			break;
+		case GENCP_FOP_NE:		r	= ( r != b ) ? 1 : 0;			break;
+		case GENCP_FOP_GT:		r	= ( r >  b ) ? 1 : 0;			break;
+		case GENCP_FOP_GE:		r	= ( r >= b ) ? 1 : 0;			break;
+		case GENCP_FOP_LT:		r	= ( r <  b ) ? 1 : 0;			break;
+		case GENCP_FOP_LE:		r	= ( r <= b ) ? 1 : 0;			break;
+		case GENCP_FOP_ROUND:
+		{
+			double	scale	= pow( 10.0, y );
+			if ( !GenCpFormulaConvert( round( x * scale ) / scale, r ) )
+				return false;
+			break;
+		}
+		default:
+			return false;
+		}
+	}
+	if ( nStack != 1 )
+		return false;
+	*pResult	= static_cast<double>( stack[0] );
+	return true;
+}
+
+bool	GenCpFormulaEval(
+	const uint32_t		*	pCode,
+	size_t					nCode,
+	const double		*	pConsts,
+	size_t					nConsts,
+	const double		*	pVars,
+	size_t					nVars,
+	bool					fInteger,
+	double				*	pResult		)
+{
+	if ( fInteger )
+		return GenCpFormulaRun<int64_t>( pCode, nCode, pConsts, nConsts, pVars, nVars, pResult );
+	return GenCpFormulaRun<double>( pCode, nCode, pConsts, nConsts, pVars, nVars, pResult );
+}
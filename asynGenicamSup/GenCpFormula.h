@@ -0,0 +1,104 @@
+// GenCpFormula.h
+
+//
+// Bytecode for GenICam SwissKnife, IntSwissKnife and Converter formulas.
+// Formulas are compiled once, w/ the register map, into a postfix program
+// of 32 bit ops for a small stack machine: the top 8 bits are the opcode,
+// the low 24 bits an operand (constant, variable or jump target index).
+// Evaluation needs no parsing or allocation, so a formula feature costs
+// little more than reading the registers it depends on.
+//
+
+#ifndef	GENCP_FORMULA_H
+#define	GENCP_FORMULA_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#define	GENCP_FORMULA_MAX_STACK		32
+#define	GENCP_FORMULA_MAX_ARG		0x00FFFFFF
+
+#define	GENCP_FORMULA_OP(op,arg)	( ( static_cast<uint32_t>( op ) << 24 ) | ( ( arg ) & GENCP_FORMULA_MAX_ARG ) )
+#define	GENCP_FORMULA_OPCODE(x)		( ( x ) >> 24 )
+#define	GENCP_FORMULA_ARG(x)		( ( x ) & GENCP_FORMULA_MAX_ARG )
+
+/// Opcodes, binary ops pop b then a and push a op b
+enum GenCpFormulaOpcode
+{
+	GENCP_FOP_CONST	= 1,	// Push constant arg
+	GENCP_FOP_VAR,			// Push variable arg
+	GENCP_FOP_JZ,			// Pop, jump to arg if 0
+	GENCP_FOP_JMP,			// Jump to arg
+	GENCP_FOP_NEG,
+	GENCP_FOP_NOT,			// !
+	GENCP_FOP_BITNOT,		// ~
+	GENCP_FOP_ADD,
+	GENCP_FOP_SUB,
+	GENCP_FOP_MUL,
+	GENCP_FOP_DIV,
+	GENCP_FOP_MOD,
+	GENCP_FOP_POW,			// **
+	GENCP_FOP_AND,			// &
+	GENCP_FOP_OR,			// |
+	GENCP_FOP_XOR,			// ^
+	GENCP_FOP_SHL,
+	GENCP_FOP_SHR,
+	GENCP_FOP_LAND,			// &&
+	GENCP_FOP_LOR,			// ||
+	GENCP_FOP_EQ,			// =
+	GENCP_FOP_NE,			// <>
+	GENCP_FOP_GT,
+	GENCP_FOP_GE,
+	GENCP_FOP_LT,
+	GENCP_FOP_LE,
+	GENCP_FOP_SGN,			// Functions of one argument
+	GENCP_FOP_ABS,
+	GENCP_FOP_EXP,
+	GENCP_FOP_LN,
+	GENCP_FOP_LG,
+	GENCP_FOP_SQRT,
+	GENCP_FOP_TRUNC,
+	GENCP_FOP_FLOOR,
+	GENCP_FOP_CEIL,
+	GENCP_FOP_SIN,
+	GENCP_FOP_COS,
+	GENCP_FOP_TAN,
+	GENCP_FOP_ASIN,
+	GENCP_FOP_ACOS,
+	GENCP_FOP_ATAN,
+	GENCP_FOP_ROUND,		// ROUND(x, precision)
+	GENCP_FOP_END
+};
+
+/// Names a formula may refer to besides its operators and functions
+typedef struct
+{
+	std::map<std::string, uint32_t>		variables;		// Name to variable index
+	std::map<std::string, double>		constants;		// Constant elements, and variables w/ a fixed value
+	std::map<std::string, std::string>	expressions;	// Expression elements, expanded inline
+}	GenCpFormulaSymbols;
+
+/// Compile formula text to code, appending literals to consts
+/// Returns false w/ errorMsg set on a syntax error or unknown name
+bool	GenCpFormulaCompile(	const char					*	pFormula,
+								const GenCpFormulaSymbols	&	symbols,
+								std::vector<uint32_t>		&	code,
+								std::vector<double>			&	consts,
+								std::string					&	errorMsg	);
+
+/// Evaluate compiled code w/ the given variable values
+/// IntSwissKnife formulas set fInteger for 64 bit integer arithmetic
+/// Returns false on a malformed program, a division by zero, or an integer
+/// result out of the int64_t range
+bool	GenCpFormulaEval(		const uint32_t				*	pCode,
+								size_t							nCode,
+								const double				*	pConsts,
+								size_t							nConsts,
+								const double				*	pVars,
+								size_t							nVars,
+								bool							fInteger,
+								double						*	pResult		);
+
+#endif	/* GENCP_FORMULA_H */
@@ -137,10 +137,10 @@ GENCP_STATUS	GenCpValidateReadMemAck(
 	}
 
 	uint16_t	ccdScdLength	= __be16_to_cpu( pPacket->ccd.ccdScdLength );
-	if ( ccdScdLength > GENCP_READMEM_MAX_BYTES )
+	if ( ccdScdLength > GENCP_PACKET_MAX_BYTES )
 	{
 		fprintf( stderr, "%s Error: Req %u, SCD Length %u greater than max %u\n", funcName,
-				ccdRequestId, ccdScdLength, GENCP_READMEM_MAX_BYTES );
+				ccdRequestId, ccdScdLength, GENCP_PACKET_MAX_BYTES );
 		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
 	}
 
@@ -449,10 +449,10 @@ GENCP_STATUS	GenCpValidateWriteMemAck(
 	}
 
 	uint16_t	ccdScdLength	= __be16_to_cpu( pPacket->ccd.ccdScdLength );
-	if ( ccdScdLength > GENCP_READMEM_MAX_BYTES )
+	if ( ccdScdLength > GENCP_PACKET_MAX_BYTES )
 	{
 		fprintf( stderr, "%s Error: Req %u, SCD Length %u greater than max %u\n", funcName,
-				ccdRequestId, ccdScdLength, GENCP_READMEM_MAX_BYTES );
+				ccdRequestId, ccdScdLength, GENCP_PACKET_MAX_BYTES );
 		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
 	}
 
@@ -490,6 +490,11 @@ GENCP_STATUS	GenCpInitWriteMemPacket(
 		*pnBytesSend = 0;
 	if ( pPacket == NULL )
 		return GENCP_STATUS_GENERIC_ERROR | GENCP_SC_ERROR;
+	if ( numBytes > GENCP_PACKET_MAX_BYTES )
+	{
+		fprintf( stderr, "%s Error: numBytes %zu greater than max %u\n", funcName, numBytes, GENCP_PACKET_MAX_BYTES );
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
 
 	uint16_t	ccdScdLength = sizeof( uint64_t ) + numBytes;
 	pPacket->serialPrefix.prefixPreamble	= __cpu_to_be16( GENCP_SERIAL_PREAMBLE );
@@ -500,7 +505,6 @@ GENCP_STATUS	GenCpInitWriteMemPacket(
 	pPacket->ccd.ccdRequestId				= __cpu_to_be16( requestId );
 	pPacket->scd.scdRegAddr					= __cpu_to_be64( regAddr );
 
-	assert( numBytes < GENCP_READMEM_MAX_BYTES );
 	memcpy( (char *) &pPacket->scd.scdWriteData[0], pString, numBytes );
 
 	// Compute CCD and SCD Checksums
@@ -768,6 +772,158 @@ GENCP_STATUS	GenCpInitWriteMemPacket(
 	return GENCP_STATUS_SUCCESS;
 }
 
+/// GenCpSetWriteMemReqAck() Set or clear the request for an ack of an initialized WriteMem packet
+GENCP_STATUS	GenCpSetWriteMemReqAck(
+	GenCpWriteMemPacket		*	pPacket,
+	bool						fReqAck )
+{
+	if ( pPacket == NULL )
+		return GENCP_STATUS_GENERIC_ERROR | GENCP_SC_ERROR;
+
+	// Flags are covered by both checksums
+	uint16_t	ccdScdLength = __be16_to_cpu( pPacket->ccd.ccdScdLength );
+	pPacket->ccd.ccdFlags					= __cpu_to_be16( fReqAck ? GENCP_CCD_FLAG_REQACK : 0 );
+	uint32_t	ckSumCCD	= GenCpChecksum16(	reinterpret_cast<uint8_t *>( &pPacket->serialPrefix.prefixChannelId ),
+												sizeof(uint16_t) + sizeof(GenCpCCDRequest) );
+	uint32_t	ckSumSCD	= GenCpChecksum16(	reinterpret_cast<uint8_t *>( &pPacket->serialPrefix.prefixChannelId ),
+												sizeof(uint16_t) + sizeof(GenCpCCDRequest) + ccdScdLength );
+	pPacket->serialPrefix.prefixCkSumCCD	= __cpu_to_be16( ckSumCCD );
+	pPacket->serialPrefix.prefixCkSumSCD	= __cpu_to_be16( ckSumSCD );
+	return GENCP_STATUS_SUCCESS;
+}
+
+/// GenCpProcessPendingAck() Validate a pending ack and get the additional time needed in ms
+GENCP_STATUS	GenCpProcessPendingAck(
+	GenCpPendingAck			*	pPacket,
+	uint32_t					expectedRequestId,
+	uint16_t				*	pmsTimeout )
+{
+	const	char 			*	funcName = "GenCpProcessPendingAck";
+	if ( pPacket == NULL || pmsTimeout == NULL )
+		return GENCP_STATUS_GENERIC_ERROR | GENCP_SC_ERROR;
+
+	uint16_t	prefixPreamble	= __be16_to_cpu( pPacket->serialPrefix.prefixPreamble );
+	uint16_t	ccdRequestId	= __be16_to_cpu( pPacket->ccd.ccdRequestId );
+	uint16_t	ccdCommandId	= __be16_to_cpu( pPacket->ccd.ccdCommandId );
+	uint16_t	ccdScdLength	= __be16_to_cpu( pPacket->ccd.ccdScdLength );
+	if ( prefixPreamble	!= GENCP_SERIAL_PREAMBLE )
+	{
+		fprintf( stderr, "%s Error: Req %u, Invalid preamble, 0x%02X\n", funcName, ccdRequestId, prefixPreamble );
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
+	if ( ccdCommandId != GENCP_ID_PENDING_ACK || ccdScdLength < sizeof(GenCpSCDPendingAck) )
+	{
+		fprintf( stderr, "%s Error: Req %u, Invalid commandId 0x%02X, SCD length %u\n", funcName,
+				ccdRequestId, ccdCommandId, ccdScdLength );
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
+	if ( expectedRequestId != ccdRequestId )
+	{
+		fprintf( stderr, "%s Error: Req %u, expected req %u\n", funcName, ccdRequestId, expectedRequestId );
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
+
+	uint16_t	ckSumSCD	= GenCpChecksum16(	reinterpret_cast<uint8_t *>( &pPacket->serialPrefix.prefixChannelId ),
+												sizeof(uint16_t) + sizeof(GenCpCCDAck) + ccdScdLength );
+	if ( ckSumSCD != __be16_to_cpu( pPacket->serialPrefix.prefixCkSumSCD ) )
+	{
+		fprintf( stderr, "%s Error: Req %u, Packet SCD cksum, 0x%04X, computed 0x%04X\n", funcName,
+				ccdRequestId, __be16_to_cpu( pPacket->serialPrefix.prefixCkSumSCD ), ckSumSCD );
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
+
+	*pmsTimeout	= __be16_to_cpu( pPacket->scd.scdPendingTimeout );
+	return GENCP_STATUS_SUCCESS;
+}
+
+/// GenCpMaxReadMemPayload() Max ReadMem payload that fits the device's max acknowledge transfer length
+/// The transfer length covers the whole ack, serial prefix included
+size_t	GenCpMaxReadMemPayload(	uint32_t	maxAckTransferLength )
+{
+	size_t	sOverhead	= sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDAck);
+	if ( maxAckTransferLength <= sOverhead )
+		return GENCP_READMEM_MAX_BYTES;
+	size_t	maxPayload	= maxAckTransferLength - sOverhead;
+	if ( maxPayload > GENCP_PACKET_MAX_BYTES )
+		maxPayload = GENCP_PACKET_MAX_BYTES;
+	return maxPayload;
+}
+
+/// GenCpMaxWriteMemPayload() Max WriteMem payload that fits the device's max command transfer length
+/// The transfer length covers the whole command, serial prefix and register address included
+size_t	GenCpMaxWriteMemPayload( uint32_t	maxCmdTransferLength )
+{
+	size_t	sOverhead	= sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDRequest) + sizeof(uint64_t);
+	if ( maxCmdTransferLength <= sOverhead )
+		return GENCP_READMEM_MAX_BYTES;
+	size_t	maxPayload	= maxCmdTransferLength - sOverhead;
+	if ( maxPayload > GENCP_PACKET_MAX_BYTES )
+		maxPayload = GENCP_PACKET_MAX_BYTES;
+	return maxPayload;
+}
+
+/// GenCpSbrmBaudRate() Baud rate for bit iBit of the SBRM baud rate registers, 0 if unknown
+unsigned int	GenCpSbrmBaudRate( unsigned int	iBit )
+{
+	static const unsigned int	sbrmBaudRates[GENCP_SBRM_BAUD_NUM_RATES] =
+	{	9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600	};
+	if ( iBit >= GENCP_SBRM_BAUD_NUM_RATES )
+		return 0;
+	return sbrmBaudRates[iBit];
+}
+
+static uint32_t	GenCpBrmUint32( const uint8_t * pBrm, unsigned int regAddr )
+{
+	return __be32_to_cpu( *reinterpret_cast<const __be32 *>( pBrm + regAddr ) );
+}
+
+static uint64_t	GenCpBrmUint64( const uint8_t * pBrm, unsigned int regAddr )
+{
+	return __be64_to_cpu( *reinterpret_cast<const __be64 *>( pBrm + regAddr ) );
+}
+
+static void		GenCpBrmString( const uint8_t * pBrm, unsigned int regAddr, char * pString )
+{
+	// BRM strings are only NULL terminated if shorter than the register
+	memcpy( pString, pBrm + regAddr, GENCP_BRM_STRING_SIZE );
+	pString[GENCP_BRM_STRING_SIZE] = 0;
+}
+
+/// GenCpParseBrm() Decode a big endian image of the BRM, at least GENCP_BRM_SIZE bytes
+GENCP_STATUS	GenCpParseBrm(
+	const uint8_t			*	pBrm,
+	size_t						sBrm,
+	GenCpDeviceInfo			*	pInfo )
+{
+	if ( pBrm == NULL || pInfo == NULL || sBrm < GENCP_BRM_SIZE )
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+
+	pInfo->gencpVersion				= GenCpBrmUint32( pBrm, REG_BRM_GENCP_VERSION );
+	GenCpBrmString( pBrm, REG_BRM_MANUFACTURER_NAME,	pInfo->manufacturerName );
+	GenCpBrmString( pBrm, REG_BRM_MODEL_NAME,			pInfo->modelName );
+	GenCpBrmString( pBrm, REG_BRM_FAMILY_NAME,			pInfo->familyName );
+	GenCpBrmString( pBrm, REG_BRM_DEVICE_VERSION,		pInfo->deviceVersion );
+	GenCpBrmString( pBrm, REG_BRM_MANUFACTURER_INFO,	pInfo->manufacturerInfo );
+	GenCpBrmString( pBrm, REG_BRM_SERIAL_NUMBER,		pInfo->serialNumber );
+	GenCpBrmString( pBrm, REG_BRM_USER_DEFINED_NAME,	pInfo->userDefinedName );
+	pInfo->deviceCapability			= GenCpBrmUint64( pBrm, REG_BRM_DEVICE_CAPABILITY );
+	pInfo->maxDeviceResponseTime	= GenCpBrmUint32( pBrm, REG_BRM_MAX_DEVICE_RESPONSE_TIME );
+	pInfo->manifestTableAddress		= GenCpBrmUint64( pBrm, REG_BRM_MANIFEST_TABLE_ADDRESS );
+	pInfo->sbrmAddress				= GenCpBrmUint64( pBrm, REG_BRM_SBRM_ADDRESS );
+	pInfo->deviceConfiguration		= GenCpBrmUint64( pBrm, REG_BRM_DEVICE_CONFIGURATION );
+	pInfo->heartbeatTimeout			= GenCpBrmUint32( pBrm, REG_BRM_HEARTBEAT_TIMEOUT );
+	pInfo->messageChannelId			= GenCpBrmUint32( pBrm, REG_BRM_MESSAGE_CHANNEL_ID );
+	pInfo->timestampIncrement		= GenCpBrmUint64( pBrm, REG_BRM_TIMESTAMP_INCREMENT );
+	pInfo->protocolEndianess		= GenCpBrmUint32( pBrm, REG_BRM_PROTOCOL_ENDIANESS );
+	pInfo->implementationEndianess	= GenCpBrmUint32( pBrm, REG_BRM_IMPLEMENTATION_ENDIANESS );
+	return GENCP_STATUS_SUCCESS;
+}
+
+uint16_t	GenCpBigEndianToCpu( uint16_t	be16Value )
+{
+	return __be16_to_cpu( static_cast<__be16>(be16Value) );
+}
+
 uint32_t	GenCpBigEndianToCpu( uint32_t	be32Value )
 {
 	return __be32_to_cpu( static_cast<__be32>(be32Value) );
@@ -777,3 +933,18 @@ uint64_t	GenCpBigEndianToCpu( uint64_t	be64Value )
 {
 	return __be64_to_cpu( static_cast<__be64>(be64Value) );
 }
+
+uint16_t	GenCpCpuToBigEndian( uint16_t	cpu16Value )
+{
+	return static_cast<uint16_t>( __cpu_to_be16( cpu16Value ) );
+}
+
+uint32_t	GenCpCpuToBigEndian( uint32_t	cpu32Value )
+{
+	return static_cast<uint32_t>( __cpu_to_be32( cpu32Value ) );
+}
+
+uint64_t	GenCpCpuToBigEndian( uint64_t	cpu64Value )
+{
+	return static_cast<uint64_t>( __cpu_to_be64( cpu64Value ) );
+}
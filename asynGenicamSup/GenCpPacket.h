@@ -80,8 +80,12 @@
 #define	GENCP_STATUS_WRONG_CONFIG		0x000F	// Current receiver configuration does not allow command
 #define	GENCP_STATUS_GENERIC_ERROR		0x0FFF	// Command not implemented
 
-//#define GENCP_READMEM_MAX_BYTES			384		// 100 is recommended max per GenCP standard
+/// GENCP_READMEM_MAX_BYTES is the payload size used until the device's SBRM has been read.
+/// GENCP_PACKET_MAX_BYTES is the compile time ceiling for SCD payload storage.
+/// The payload size actually used is negotiated at connect time from the SBRM
+/// maximum command and acknowledge transfer lengths, clamped to GENCP_PACKET_MAX_BYTES.
 #define GENCP_READMEM_MAX_BYTES			64		// 100 is recommended max per GenCP standard
+#define GENCP_PACKET_MAX_BYTES			1024	// GenCP recommends packets <= 1KB
 
 typedef	uint32_t	GENCP_STATUS;
 
@@ -153,7 +157,7 @@ typedef struct GENCP_ATTR
 /// Specific Command Data ReadMem Acknowledge Layout (SCD)
 typedef struct GENCP_ATTR
 {
-	uint8_t			scdReadData[GENCP_READMEM_MAX_BYTES];	// Packet payload
+	uint8_t			scdReadData[GENCP_PACKET_MAX_BYTES];	// Packet payload
 }	GenCpSCDReadAck;
 
 
@@ -161,7 +165,7 @@ typedef struct GENCP_ATTR
 typedef struct GENCP_ATTR
 {
 	uint64_t		scdRegAddr;		// Register address
-	uint8_t			scdWriteData[GENCP_READMEM_MAX_BYTES];	// Packet payload
+	uint8_t			scdWriteData[GENCP_PACKET_MAX_BYTES];	// Packet payload
 	// Remaining data bytes per scdReadSize follow
 }	GenCpSCDWriteMem;
 
@@ -218,6 +222,18 @@ typedef struct	GENCP_ATTR
 	GenCpSCDWriteAck	scd;
 }	GenCpWriteMemAck;
 
+///
+/// GenCP Pending Acknowledge Packet
+/// Sent by the device instead of the ack when a command needs more than
+/// the max device response time
+///
+typedef struct	GENCP_ATTR
+{
+	GenCpSerialPrefix	serialPrefix;
+	GenCpCCDAck			ccd;
+	GenCpSCDPendingAck	scd;
+}	GenCpPendingAck;
+
 ///
 /// GenCP Packet function declarations
 ///
@@ -312,8 +328,34 @@ GENCP_STATUS	GenCpInitWriteMemPacket(GenCpWriteMemPacket		*	pPacket,
 										double						regValue,
 										size_t					*	pnBytesSend );
 
+/// GenCpSetWriteMemReqAck() Set or clear the request for an ack of an initialized WriteMem packet
+GENCP_STATUS	GenCpSetWriteMemReqAck(	GenCpWriteMemPacket		*	pPacket,
+										bool						fReqAck );
+
+/// GenCpProcessPendingAck() Validate a pending ack and get the additional time needed in ms
+GENCP_STATUS	GenCpProcessPendingAck(	GenCpPendingAck			*	pPacket,
+										uint32_t					expectedRequestId,
+										uint16_t				*	pmsTimeout );
+
+/// GenCpMaxReadMemPayload() Max ReadMem payload that fits the device's max acknowledge transfer length
+size_t			GenCpMaxReadMemPayload(	uint32_t maxAckTransferLength );
+
+/// GenCpMaxWriteMemPayload() Max WriteMem payload that fits the device's max command transfer length
+size_t			GenCpMaxWriteMemPayload( uint32_t maxCmdTransferLength );
+
+/// GenCpSbrmBaudRate() Baud rate for bit iBit of the SBRM baud rate registers, 0 if unknown
+unsigned int	GenCpSbrmBaudRate( unsigned int iBit );
+
+/// GenCpParseBrm() Decode a big endian image of the BRM, at least GENCP_BRM_SIZE bytes
+struct GenCpDeviceInfo;
+GENCP_STATUS	GenCpParseBrm( const uint8_t * pBrm, size_t sBrm, struct GenCpDeviceInfo * pInfo );
+
 /// Convenience functions to hide __be32_to_cpu() and other variants
+extern uint16_t	GenCpBigEndianToCpu( uint16_t	be16Value );
 extern uint32_t	GenCpBigEndianToCpu( uint32_t	be32Value );
 extern uint64_t	GenCpBigEndianToCpu( uint64_t	be64Value );
+extern uint16_t	GenCpCpuToBigEndian( uint16_t	cpu16Value );
+extern uint32_t	GenCpCpuToBigEndian( uint32_t	cpu32Value );
+extern uint64_t	GenCpCpuToBigEndian( uint64_t	cpu64Value );
 
 #endif	/* GENCP_PACKET_H */
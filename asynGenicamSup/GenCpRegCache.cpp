@@ -0,0 +1,206 @@
+// GenCpRegCache.cpp
+
+//
+// Register cache for GenCP devices.
+// See GenCpRegCache.h
+//
+
+#include <string.h>
+#include "GenCpRegCache.h"
+
+GenCpRegCache::GenCpRegCache(
+	const char	*	pName	)
+	:	m_pName(					pName	),
+		m_lock(		epicsMutexMustCreate( )	),
+		m_recentAge(				0.0		),
+		m_entries(							),
+		m_updated(							),
+		m_cacheable(						),
+		m_nHits(					0		),
+		m_nMisses(					0		)
+{
+}
+
+GenCpRegCache::~GenCpRegCache( )
+{
+	epicsMutexDestroy( m_lock );
+}
+
+void	GenCpRegCache::SetRecentAge(
+	double			recentAge	)
+{
+	epicsMutexMustLock( m_lock );
+	m_recentAge	= ( recentAge > 0.0 ) ? recentAge : 0.0;
+	InvalidateRecent( );
+	epicsMutexUnlock( m_lock );
+}
+
+void	GenCpRegCache::SetCacheable(
+	uint64_t		regAddr,
+	size_t			numBytes,
+	bool			fCacheable	)
+{
+	uint64_t		regEnd	= regAddr + numBytes;
+	if ( numBytes == 0 )
+		return;
+
+	epicsMutexMustLock( m_lock );
+
+	// Trim or split any ranges overlapping the new one
+	RangeMap::iterator	it	= m_cacheable.lower_bound( regAddr );
+	if ( it != m_cacheable.begin() )
+		--it;
+	while ( it != m_cacheable.end() && it->first < regEnd )
+	{
+		uint64_t	rangeStart	= it->first;
+		uint64_t	rangeEnd	= it->second;
+		if ( rangeEnd <= regAddr )
+		{
+			++it;
+			continue;
+		}
+		m_cacheable.erase( it++ );
+		if ( rangeStart < regAddr )
+			m_cacheable[rangeStart]	= regAddr;
+		if ( rangeEnd > regEnd )
+			m_cacheable[regEnd]		= rangeEnd;
+	}
+	if ( fCacheable )
+		m_cacheable[regAddr]	= regEnd;
+	else
+		EraseOverlaps( regAddr, numBytes );
+
+	epicsMutexUnlock( m_lock );
+}
+
+bool	GenCpRegCache::IsCacheable(
+	uint64_t		regAddr,
+	size_t			numBytes	)
+{
+	bool			fCacheable	= false;
+	epicsMutexMustLock( m_lock );
+	RangeMap::iterator	it	= m_cacheable.upper_bound( regAddr );
+	if ( it != m_cacheable.begin() )
+	{
+		--it;
+		fCacheable = ( it->first <= regAddr && regAddr + numBytes <= it->second );
+	}
+	epicsMutexUnlock( m_lock );
+	return fCacheable;
+}
+
+void	GenCpRegCache::Update(
+	uint64_t		regAddr,
+	const void	*	pData,
+	size_t			numBytes	)
+{
+	if ( numBytes == 0 )
+		return;
+
+	const uint8_t	*	pBytes	= reinterpret_cast<const uint8_t *>( pData );
+	epicsMutexMustLock( m_lock );
+	bool			fCacheable	= IsCacheable( regAddr, numBytes );
+	if ( fCacheable || m_recentAge > 0.0 )
+	{
+		EraseOverlaps( regAddr, numBytes );
+		m_entries[regAddr].assign( pBytes, pBytes + numBytes );
+		if ( !fCacheable )
+			epicsTimeGetCurrent( &m_updated[regAddr] );
+	}
+	epicsMutexUnlock( m_lock );
+}
+
+bool	GenCpRegCache::Lookup(
+	uint64_t		regAddr,
+	void		*	pData,
+	size_t			numBytes	)
+{
+	bool			fHit	= false;
+	epicsMutexMustLock( m_lock );
+	EntryMap::iterator	it	= m_entries.upper_bound( regAddr );
+	if ( it != m_entries.begin() )
+	{
+		--it;
+		uint64_t	entryEnd	= it->first + it->second.size();
+		if ( it->first <= regAddr && regAddr + numBytes <= entryEnd )
+		{
+			memcpy( pData, &it->second[regAddr - it->first], numBytes );
+			fHit = true;
+		}
+		TimeMap::iterator	itUpdated	= m_updated.find( it->first );
+		if ( fHit && itUpdated != m_updated.end() )
+		{
+			epicsTimeStamp	tNow;
+			epicsTimeGetCurrent( &tNow );
+			fHit	= ( epicsTimeDiffInSeconds( &tNow, &itUpdated->second ) <= m_recentAge );
+		}
+	}
+	// Uncacheable registers always miss, counting those would hide the real hit rate
+	if ( fHit )
+		m_nHits++;
+	else if ( IsCacheable( regAddr, numBytes ) )
+		m_nMisses++;
+	epicsMutexUnlock( m_lock );
+	return fHit;
+}
+
+void	GenCpRegCache::Invalidate(
+	uint64_t		regAddr,
+	size_t			numBytes	)
+{
+	epicsMutexMustLock( m_lock );
+	EraseOverlaps( regAddr, numBytes );
+	epicsMutexUnlock( m_lock );
+}
+
+void	GenCpRegCache::InvalidateAll( )
+{
+	epicsMutexMustLock( m_lock );
+	m_entries.clear();
+	m_updated.clear();
+	epicsMutexUnlock( m_lock );
+}
+
+void	GenCpRegCache::InvalidateRecent( )
+{
+	epicsMutexMustLock( m_lock );
+	for ( TimeMap::iterator it = m_updated.begin(); it != m_updated.end(); ++it )
+		m_entries.erase( it->first );
+	m_updated.clear();
+	epicsMutexUnlock( m_lock );
+}
+
+void	GenCpRegCache::EraseOverlaps(
+	uint64_t		regAddr,
+	size_t			numBytes	)
+{
+	uint64_t		regEnd	= regAddr + numBytes;
+	EntryMap::iterator	it	= m_entries.lower_bound( regAddr );
+	if ( it != m_entries.begin() )
+		--it;
+	while ( it != m_entries.end() && it->first < regEnd )
+	{
+		if ( it->first + it->second.size() > regAddr )
+		{
+			m_updated.erase( it->first );
+			m_entries.erase( it++ );
+		}
+		else
+			++it;
+	}
+}
+
+void	GenCpRegCache::Report(
+	FILE		*	fp,
+	int				details	)
+{
+	epicsMutexMustLock( m_lock );
+	fprintf( fp, "  %s: %zu entries, %zu of them recent reads, %zu cacheable ranges, %lu hits, %lu misses\n",
+			m_pName, m_entries.size(), m_updated.size(), m_cacheable.size(), m_nHits, m_nMisses );
+	if ( details >= 2 )
+	{
+		for ( EntryMap::iterator it = m_entries.begin(); it != m_entries.end(); ++it )
+			fprintf( fp, "    0x%08llX %zu bytes\n", (long long unsigned int) it->first, it->second.size() );
+	}
+	epicsMutexUnlock( m_lock );
+}
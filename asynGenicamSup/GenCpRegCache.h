@@ -0,0 +1,87 @@
+// GenCpRegCache.h
+
+//
+// Register cache for GenCP devices.
+// Holds big endian register images keyed by register address so reads
+// of registers that can't change behind our back are answered w/o
+// a serial transaction.  Only address ranges marked cacheable are kept
+// until invalidated.  W/ a recent age, reads of any other register are
+// also kept, but only answer lookups for that long after they were read.
+//
+
+#ifndef	GENCP_REG_CACHE_H
+#define	GENCP_REG_CACHE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <map>
+#include <vector>
+#include "epicsMutex.h"
+#include "epicsTime.h"
+
+class GenCpRegCache
+{
+public:
+	GenCpRegCache(	const char	*	pName	= "Register cache" );
+	~GenCpRegCache( );
+
+	/// Also keep registers outside the cacheable ranges for recentAge sec
+	/// after they were read, 0 to keep only the cacheable ones
+	void	SetRecentAge(	double			recentAge	);
+
+	/// Allow (or stop) caching of regAddr..regAddr+numBytes
+	void	SetCacheable(	uint64_t		regAddr,
+							size_t			numBytes,
+							bool			fCacheable	);
+
+	/// True if all of regAddr..regAddr+numBytes is cacheable
+	bool	IsCacheable(	uint64_t		regAddr,
+							size_t			numBytes	);
+
+	/// Store numBytes of big endian register data read from or written to regAddr
+	/// Data outside the cacheable ranges is ignored, unless w/ a recent age
+	void	Update(			uint64_t		regAddr,
+							const void	*	pData,
+							size_t			numBytes	);
+
+	/// Copy cached data for regAddr..regAddr+numBytes to pData
+	/// Returns false unless one valid entry covers the whole range
+	/// Only misses on cacheable ranges are counted
+	bool	Lookup(			uint64_t		regAddr,
+							void		*	pData,
+							size_t			numBytes	);
+
+	/// Drop any cached data overlapping regAddr..regAddr+numBytes
+	void	Invalidate(		uint64_t		regAddr,
+							size_t			numBytes	);
+
+	/// Drop all cached data, cacheable ranges are kept
+	void	InvalidateAll( );
+
+	/// Drop the registers kept for the recent age only, e.g. after a write
+	/// that may change any register
+	void	InvalidateRecent( );
+
+	void	Report(			FILE		*	fp,
+							int				details	);
+
+private:
+	/// Erase entries overlapping regAddr..regAddr+numBytes, m_lock must be held
+	void	EraseOverlaps(	uint64_t		regAddr,
+							size_t			numBytes	);
+
+	typedef std::map< uint64_t, std::vector<uint8_t> >	EntryMap;
+	typedef std::map< uint64_t, uint64_t >				RangeMap;
+	typedef std::map< uint64_t, epicsTimeStamp >		TimeMap;
+
+	const char		*	m_pName;
+	epicsMutexId		m_lock;
+	double				m_recentAge;	// sec, 0 to keep cacheable ranges only
+	EntryMap			m_entries;		// Start address to register image
+	TimeMap				m_updated;		// Start address to read time, of entries kept for m_recentAge
+	RangeMap			m_cacheable;	// Start address to end address, non-overlapping
+	unsigned long		m_nHits;
+	unsigned long		m_nMisses;
+};
+
+#endif	/* GENCP_REG_CACHE_H */
@@ -0,0 +1,1171 @@
+// GenCpRegMap.cpp
+
+//
+// Compiled register map for a GenICam camera description file.
+// See GenCpRegMap.h
+//
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include "GenCpFormula.h"
+#include "GenCpRegMap.h"
+#include "GenCpXml.h"
+
+// Max pValue hops from a feature to its register
+#define	GENCP_REGMAP_MAX_HOPS	8
+
+// Perfect hash build: average keys per bucket, and seeds to try per bucket
+#define	GENCP_REGMAP_PHF_LOAD		4
+#define	GENCP_REGMAP_PHF_MAX_SEED	(1 << 20)
+
+typedef std::map<std::string, const GenCpXmlNode *>	GenCpXmlNodeMap;
+
+/// Entry plus its name while compiling
+typedef struct
+{
+	GenCpRegMapEntry	entry;
+	std::string			name;
+}	GenCpRegMapItem;
+
+/// Formula plus the names of the nodes its variables read while compiling
+typedef struct
+{
+	GenCpRegMapFormula			formula;
+	std::vector<uint32_t>		code;
+	std::vector<double>			consts;
+	std::vector<std::string>	varNames;
+	bool						fValid;
+}	GenCpRegMapFormulaItem;
+
+typedef std::map<std::string, int>	GenCpRegMapFormulaIndex;
+
+/// EnumEntry plus the names of it and its Enumeration while compiling
+typedef struct
+{
+	std::string			feature;
+	std::string			name;
+	int64_t				value;
+}	GenCpRegMapEnumItem;
+
+/// Register address and length
+typedef std::pair<uint64_t, uint32_t>	GenCpRegMapRange;
+typedef std::set<GenCpRegMapRange>		GenCpRegMapRangeSet;
+
+/// Invalidated node name and pInvalidator name pairs
+typedef std::vector< std::pair<std::string, std::string> >	GenCpRegMapInvalidators;
+
+uint32_t	GenCpRegMapHash( const char * pName )
+{
+	uint32_t	hash	= 2166136261u;
+	for ( const unsigned char * p = reinterpret_cast<const unsigned char *>( pName ); *p; p++ )
+	{
+		hash ^= *p;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+uint32_t	GenCpRegMapHashSeed( const char * pName, uint32_t seed )
+{
+	uint32_t	hash	= 2166136261u ^ ( seed * 0x9E3779B1u );
+	for ( const unsigned char * p = reinterpret_cast<const unsigned char *>( pName ); *p; p++ )
+	{
+		hash ^= *p;
+		hash *= 16777619u;
+	}
+	// Final avalanche so nearby seeds give unrelated slots
+	hash ^= hash >> 16;
+	hash *= 0x85EBCA6Bu;
+	hash ^= hash >> 13;
+	hash *= 0xC2B2AE35u;
+	hash ^= hash >> 16;
+	return hash;
+}
+
+void	GenCpRegMapFileName(
+	const char		*	pMapDir,
+	const uint8_t	*	pSha1,
+	char			*	pFileName,
+	size_t				sFileName	)
+{
+	char		sha1Hex[2 * GENCP_MFT_ENTRY_SHA1_SIZE + 1];
+	for ( size_t i = 0; i < GENCP_MFT_ENTRY_SHA1_SIZE; i++ )
+		snprintf( &sha1Hex[2 * i], 3, "%02x", pSha1[i] );
+	snprintf( pFileName, sFileName, "%s/%s%s", pMapDir, sha1Hex, GENCP_REGMAP_SUFFIX );
+}
+
+uint64_t	GenCpRegMapDecodeInt(
+	const GenCpRegMapEntry	*	pEntry,
+	const uint8_t			*	pData	)
+{
+	uint64_t		rawValue	= 0;
+	unsigned int	nBits		= pEntry->length * 8;
+	if ( pEntry->length == 0 || pEntry->length > sizeof(rawValue) )
+		return 0;
+	for ( size_t iByte = 0; iByte < pEntry->length; iByte++ )
+	{
+		if ( pEntry->endian == GENCP_REGMAP_ENDIAN_BIG )
+			rawValue	= ( rawValue << 8 ) | pData[iByte];
+		else
+			rawValue	|= static_cast<uint64_t>( pData[iByte] ) << ( 8 * iByte );
+	}
+	if ( pEntry->flags & GENCP_REGMAP_FLAG_MASKED )
+	{
+		rawValue	>>= pEntry->lsb;
+		nBits		= pEntry->msb - pEntry->lsb + 1;
+	}
+	if ( nBits < 64 )
+	{
+		rawValue	&= ( 1ULL << nBits ) - 1;
+		if ( ( pEntry->flags & GENCP_REGMAP_FLAG_SIGNED ) && ( rawValue >> ( nBits - 1 ) ) )
+			rawValue	|= ~( ( 1ULL << nBits ) - 1 );
+	}
+	return rawValue;
+}
+
+double	GenCpRegMapDecode(
+	const GenCpRegMapEntry	*	pEntry,
+	const uint8_t			*	pData	)
+{
+	uint64_t	rawValue	= GenCpRegMapDecodeInt( pEntry, pData );
+	if ( pEntry->type == GENCP_REGMAP_TYPE_FLOAT && !( pEntry->flags & GENCP_REGMAP_FLAG_MASKED ) )
+	{
+		if ( pEntry->length == sizeof(float) )
+		{
+			uint32_t	rawValue32	= static_cast<uint32_t>( rawValue );
+			float		floatValue;
+			memcpy( &floatValue, &rawValue32, sizeof(floatValue) );
+			return floatValue;
+		}
+		double		doubleValue;
+		memcpy( &doubleValue, &rawValue, sizeof(doubleValue) );
+		return doubleValue;
+	}
+	if ( pEntry->flags & GENCP_REGMAP_FLAG_SIGNED )
+		return static_cast<double>( static_cast<int64_t>( rawValue ) );
+	return static_cast<double>( rawValue );
+}
+
+/// Index the named nodes of the register description, looking inside Groups
+/// StructRegs are unnamed, their StructEntry children carry the names
+static void	GenCpRegMapCollectNodes(
+	const GenCpXmlNode					*	pParent,
+	GenCpXmlNodeMap						&	nodes,
+	std::vector<const GenCpXmlNode *>	&	structRegs	)
+{
+	for ( size_t iChild = 0; iChild < pParent->m_children.size(); iChild++ )
+	{
+		const GenCpXmlNode	*	pChild	= pParent->m_children[iChild];
+		const char			*	pName	= pChild->Attr( "Name" );
+		if ( pChild->m_name == "Group" )
+			GenCpRegMapCollectNodes( pChild, nodes, structRegs );
+		else if ( pChild->m_name == "StructReg" )
+			structRegs.push_back( pChild );
+		else if ( pName != NULL )
+			nodes[pName] = pChild;
+	}
+}
+
+static bool	GenCpRegMapIsRegister( const std::string & kind )
+{
+	return	kind == "IntReg"	|| kind == "MaskedIntReg"	|| kind == "FloatReg"
+		||	kind == "StringReg"	|| kind == "Register";
+}
+
+static bool	GenCpRegMapIsFeature( const std::string & kind )
+{
+	return	kind == "Integer"	|| kind == "Float"			|| kind == "Boolean"
+		||	kind == "Enumeration" || kind == "Command"		|| kind == "String";
+}
+
+static bool	GenCpRegMapIsFormula( const std::string & kind )
+{
+	return	kind == "SwissKnife"	|| kind == "IntSwissKnife"
+		||	kind == "Converter"		|| kind == "IntConverter";
+}
+
+static uint8_t	GenCpRegMapAccess( const char * pText, uint8_t dflt )
+{
+	if ( pText == NULL )
+		return dflt;
+	if ( strcmp( pText, "RO" ) == 0 )
+		return GENCP_REGMAP_ACCESS_RO;
+	if ( strcmp( pText, "WO" ) == 0 )
+		return GENCP_REGMAP_ACCESS_WO;
+	if ( strcmp( pText, "RW" ) == 0 )
+		return GENCP_REGMAP_ACCESS_RW;
+	return GENCP_REGMAP_ACCESS_NA;
+}
+
+/// Bit field from Bit or LSB/MSB, numbered from the LSB of the register value
+/// GenICam numbers bits from the MSB for big endian registers
+/// Returns false if the field doesn't fit the register
+static bool	GenCpRegMapBits( const GenCpXmlNode * pNode, GenCpRegMapEntry & entry )
+{
+	const char	*	pBit	= pNode->ChildText( "Bit" );
+	const char	*	pLsb	= pNode->ChildText( "LSB" );
+	const char	*	pMsb	= pNode->ChildText( "MSB" );
+	if ( pBit == NULL && pLsb == NULL && pMsb == NULL )
+		return true;
+
+	unsigned int	nBits	= 8 * entry.length;
+	unsigned int	lsb		= strtoul( pBit ? pBit : ( pLsb ? pLsb : "0" ), NULL, 0 );
+	unsigned int	msb		= pBit ? lsb : ( pMsb ? strtoul( pMsb, NULL, 0 ) : ( entry.endian == GENCP_REGMAP_ENDIAN_BIG ? 0 : nBits - 1 ) );
+	if ( lsb >= nBits || msb >= nBits || nBits > 64 )
+		return false;
+	if ( entry.endian == GENCP_REGMAP_ENDIAN_BIG )
+	{
+		lsb	= nBits - 1 - lsb;
+		msb	= nBits - 1 - msb;
+	}
+	if ( lsb > msb )
+		std::swap( lsb, msb );
+	entry.lsb	= static_cast<uint8_t>( lsb );
+	entry.msb	= static_cast<uint8_t>( msb );
+	entry.flags	|= GENCP_REGMAP_FLAG_MASKED;
+	return true;
+}
+
+/// Fill the register fields of entry from pReg, false if it has no fixed address and length
+static bool	GenCpRegMapResolveRegister( const GenCpXmlNode * pReg, GenCpRegMapEntry & entry )
+{
+	uint64_t		address		= 0;
+	bool			fAddress	= false;
+	for ( size_t iChild = 0; iChild < pReg->m_children.size(); iChild++ )
+	{
+		const std::string &	kind	= pReg->m_children[iChild]->m_name;
+		if ( kind == "Address" )
+		{
+			address	+= strtoull( pReg->m_children[iChild]->m_text.c_str(), NULL, 0 );
+			fAddress = true;
+		}
+		else if ( kind == "pAddress" || kind == "pIndex" || kind == "IntSwissKnife" )
+			return false;
+	}
+	const char	*	pLength		= pReg->ChildText( "Length" );
+	if ( !fAddress || pLength == NULL )
+		return false;
+
+	const char	*	pEndian		= pReg->ChildText( "Endianess" );
+	const char	*	pCache		= pReg->ChildText( "Cachable" );
+	const char	*	pSign		= pReg->ChildText( "Sign" );
+	const char	*	pPolling	= pReg->ChildText( "PollingTime" );
+
+	entry.address		= address;
+	entry.length		= strtoul( pLength, NULL, 0 );
+	entry.access		= GenCpRegMapAccess( pReg->ChildText( "AccessMode" ), GENCP_REGMAP_ACCESS_RO );
+	entry.endian		= ( pEndian && strcmp( pEndian, "BigEndian" ) == 0 ) ? GENCP_REGMAP_ENDIAN_BIG
+																			 : GENCP_REGMAP_ENDIAN_LITTLE;
+	entry.cache			= GENCP_REGMAP_CACHE_WRITE_THROUGH;
+	if ( pCache && strcmp( pCache, "NoCache" ) == 0 )
+		entry.cache		= GENCP_REGMAP_CACHE_NONE;
+	else if ( pCache && strcmp( pCache, "WriteAround" ) == 0 )
+		entry.cache		= GENCP_REGMAP_CACHE_WRITE_AROUND;
+	if ( pSign && strcmp( pSign, "Signed" ) == 0 )
+		entry.flags		|= GENCP_REGMAP_FLAG_SIGNED;
+	entry.pollingTime	= pPolling ? strtoul( pPolling, NULL, 0 ) : 0;
+
+	if ( pReg->m_name == "FloatReg" )
+		entry.type		= GENCP_REGMAP_TYPE_FLOAT;
+	else if ( pReg->m_name == "StringReg" )
+		entry.type		= GENCP_REGMAP_TYPE_STRING;
+	else if ( pReg->m_name == "Register" )
+		entry.type		= GENCP_REGMAP_TYPE_REGISTER;
+	else
+		entry.type		= GENCP_REGMAP_TYPE_INT;
+	if ( pReg->m_name == "MaskedIntReg" && !GenCpRegMapBits( pReg, entry ) )
+		return false;
+	return entry.length > 0;
+}
+
+/// Compile the formula of a SwissKnife or Converter node once, returning its index or -1
+/// Converters are compiled for reading, FormulaFrom w/ FROM bound to pValue
+static int	GenCpRegMapCompileFormula(
+	const std::string				&	name,
+	const GenCpXmlNode				*	pNode,
+	const GenCpXmlNodeMap			&	nodes,
+	std::vector<GenCpRegMapFormulaItem>	&	formulas,
+	GenCpRegMapFormulaIndex			&	formulaIndex	)
+{
+	GenCpRegMapFormulaIndex::iterator	itIndex	= formulaIndex.find( name );
+	if ( itIndex != formulaIndex.end() )
+		return itIndex->second;
+	formulaIndex[name]	= -1;
+
+	bool					fConverter	= pNode->m_name == "Converter" || pNode->m_name == "IntConverter";
+	const char			*	pFormula	= pNode->ChildText( fConverter ? "FormulaFrom" : "Formula" );
+	GenCpFormulaSymbols		symbols;
+	GenCpRegMapFormulaItem	item;
+	std::string				errorMsg;
+	if ( pFormula == NULL )
+		return -1;
+
+	for ( size_t iChild = 0; iChild < pNode->m_children.size(); iChild++ )
+	{
+		const GenCpXmlNode	*	pChild	= pNode->m_children[iChild];
+		const char			*	pName	= pChild->Attr( "Name" );
+		if ( pName == NULL )
+			continue;
+		if ( pChild->m_name == "pVariable" )
+		{
+			// Variables w/ a fixed Value are constants, others are read at run time
+			GenCpXmlNodeMap::const_iterator	itVar	= nodes.find( pChild->m_text );
+			const char	*	pValue	= ( itVar != nodes.end() ) ? itVar->second->ChildText( "Value" ) : NULL;
+			if ( pValue != NULL && itVar->second->Child( "pValue" ) == NULL )
+				symbols.constants[pName]	= strtod( pValue, NULL );
+			else
+			{
+				symbols.variables[pName]	= item.varNames.size();
+				item.varNames.push_back( pChild->m_text );
+			}
+		}
+		else if ( pChild->m_name == "Constant" )
+			symbols.constants[pName]	= strtod( pChild->m_text.c_str(), NULL );
+		else if ( pChild->m_name == "Expression" )
+			symbols.expressions[pName]	= pChild->m_text;
+	}
+	if ( fConverter )
+	{
+		const char	*	pValue	= pNode->ChildText( "pValue" );
+		if ( pValue == NULL )
+			return -1;
+		symbols.variables["FROM"]	= item.varNames.size();
+		item.varNames.push_back( pValue );
+	}
+	if ( item.varNames.size() > 0xFFFF || !GenCpFormulaCompile( pFormula, symbols, item.code, item.consts, errorMsg ) )
+		return -1;
+
+	memset( &item.formula, 0, sizeof(item.formula) );
+	item.formula.fInteger	= ( pNode->m_name == "IntSwissKnife" || pNode->m_name == "IntConverter" );
+	item.fValid				= true;
+	formulas.push_back( item );
+	formulaIndex[name]		= formulas.size() - 1;
+	return formulas.size() - 1;
+}
+
+/// Entry fields for a value computed by formula iFormula of a pFormulaNode
+static void	GenCpRegMapFormulaEntry( const GenCpXmlNode * pFormulaNode, int iFormula, GenCpRegMapEntry & entry )
+{
+	bool	fInteger	= pFormulaNode->m_name == "IntSwissKnife" || pFormulaNode->m_name == "IntConverter";
+	entry.address	= iFormula;
+	entry.length	= 0;
+	entry.type		= fInteger ? GENCP_REGMAP_TYPE_INT : GENCP_REGMAP_TYPE_FLOAT;
+	entry.access	= GENCP_REGMAP_ACCESS_RO;
+	entry.endian	= GENCP_REGMAP_ENDIAN_BIG;
+	entry.cache		= GENCP_REGMAP_CACHE_NONE;
+	entry.flags		= GENCP_REGMAP_FLAG_FORMULA;
+}
+
+/// Drop formulas that read a node w/o an entry, and the entries computed by them,
+/// until every formula variable resolves
+static void	GenCpRegMapPruneFormulas(
+	std::vector<GenCpRegMapItem>			&	items,
+	std::vector<GenCpRegMapFormulaItem>		&	formulas	)
+{
+	for ( bool fChanged = true; fChanged; )
+	{
+		std::set<std::string>	names;
+		for ( size_t iItem = 0; iItem < items.size(); iItem++ )
+			names.insert( items[iItem].name );
+
+		fChanged	= false;
+		for ( size_t iFormula = 0; iFormula < formulas.size(); iFormula++ )
+		{
+			for ( size_t iVar = 0; formulas[iFormula].fValid && iVar < formulas[iFormula].varNames.size(); iVar++ )
+			{
+				if ( names.find( formulas[iFormula].varNames[iVar] ) == names.end() )
+					formulas[iFormula].fValid	= false;
+			}
+		}
+		for ( size_t iItem = 0; iItem < items.size(); )
+		{
+			if (	( items[iItem].entry.flags & GENCP_REGMAP_FLAG_FORMULA )
+				&&	!formulas[items[iItem].entry.address].fValid )
+			{
+				items.erase( items.begin() + iItem );
+				fChanged	= true;
+			}
+			else
+				iItem++;
+		}
+	}
+}
+
+/// Record the pInvalidator links of pNode, which invalidate node name,
+/// and its pSelected links, as a selector invalidates the features it selects
+static void	GenCpRegMapCollectInvalidators(
+	const std::string			&	name,
+	const GenCpXmlNode			*	pNode,
+	GenCpRegMapInvalidators		&	invalidators	)
+{
+	for ( size_t iChild = 0; iChild < pNode->m_children.size(); iChild++ )
+	{
+		if ( pNode->m_children[iChild]->m_name == "pInvalidator" )
+			invalidators.push_back( std::make_pair( name, pNode->m_children[iChild]->m_text ) );
+		else if ( pNode->m_children[iChild]->m_name == "pSelected" )
+			invalidators.push_back( std::make_pair( pNode->m_children[iChild]->m_text, name ) );
+	}
+}
+
+/// Registers the value of entry name is read from, following formula variables
+static void	GenCpRegMapEntryRanges(
+	const std::string							&	name,
+	const std::map<std::string, size_t>			&	itemIndex,
+	const std::vector<GenCpRegMapItem>			&	items,
+	const std::vector<GenCpRegMapFormulaItem>	&	formulas,
+	GenCpRegMapRangeSet							&	ranges,
+	int												depth	)
+{
+	std::map<std::string, size_t>::const_iterator	it	= itemIndex.find( name );
+	if ( it == itemIndex.end() || depth > GENCP_REGMAP_MAX_FORMULA_DEPTH )
+		return;
+	const GenCpRegMapEntry	&	entry	= items[it->second].entry;
+	if ( !( entry.flags & GENCP_REGMAP_FLAG_FORMULA ) )
+	{
+		ranges.insert( GenCpRegMapRange( entry.address, entry.length ) );
+		return;
+	}
+	const GenCpRegMapFormulaItem	&	formula	= formulas[entry.address];
+	for ( size_t iVar = 0; iVar < formula.varNames.size(); iVar++ )
+		GenCpRegMapEntryRanges( formula.varNames[iVar], itemIndex, items, formulas, ranges, depth + 1 );
+}
+
+/// Resolve pInvalidator links to register ranges and close them transitively:
+/// a register made stale by a write also makes stale the registers it invalidates
+static void	GenCpRegMapBuildInvalidations(
+	const std::vector<GenCpRegMapItem>			&	items,
+	const std::vector<GenCpRegMapFormulaItem>	&	formulas,
+	const GenCpRegMapInvalidators				&	invalidators,
+	std::vector<GenCpRegMapInvalidation>		&	table	)
+{
+	std::map<std::string, size_t>							itemIndex;
+	std::map<GenCpRegMapRange, GenCpRegMapRangeSet>			graph;
+	for ( size_t iItem = 0; iItem < items.size(); iItem++ )
+		itemIndex[items[iItem].name]	= iItem;
+
+	for ( size_t iLink = 0; iLink < invalidators.size(); iLink++ )
+	{
+		// Computed values aren't cached, so only registers can be made stale
+		std::map<std::string, size_t>::iterator	itTarget	= itemIndex.find( invalidators[iLink].first );
+		if ( itTarget == itemIndex.end() || ( items[itTarget->second].entry.flags & GENCP_REGMAP_FLAG_FORMULA ) )
+			continue;
+		const GenCpRegMapEntry	&	target	= items[itTarget->second].entry;
+		GenCpRegMapRangeSet			sources;
+		GenCpRegMapEntryRanges( invalidators[iLink].second, itemIndex, items, formulas, sources, 0 );
+		for ( GenCpRegMapRangeSet::iterator itSource = sources.begin(); itSource != sources.end(); ++itSource )
+		{
+			if ( *itSource != GenCpRegMapRange( target.address, target.length ) )
+				graph[*itSource].insert( GenCpRegMapRange( target.address, target.length ) );
+		}
+	}
+
+	// graph and the reached sets are ordered, so the table comes out sorted
+	for ( std::map<GenCpRegMapRange, GenCpRegMapRangeSet>::iterator it = graph.begin(); it != graph.end(); ++it )
+	{
+		GenCpRegMapRangeSet				reached;
+		std::vector<GenCpRegMapRange>	todo( it->second.begin(), it->second.end() );
+		while ( !todo.empty() )
+		{
+			GenCpRegMapRange	range	= todo.back();
+			todo.pop_back();
+			if ( !reached.insert( range ).second )
+				continue;
+			std::map<GenCpRegMapRange, GenCpRegMapRangeSet>::iterator	itNext	= graph.find( range );
+			if ( itNext != graph.end() )
+				todo.insert( todo.end(), itNext->second.begin(), itNext->second.end() );
+		}
+		reached.erase( it->first );
+		for ( GenCpRegMapRangeSet::iterator itReached = reached.begin(); itReached != reached.end(); ++itReached )
+		{
+			GenCpRegMapInvalidation		invalidation;
+			invalidation.address		= it->first.first;
+			invalidation.length			= it->first.second;
+			invalidation.targetAddress	= itReached->first;
+			invalidation.targetLength	= itReached->second;
+			table.push_back( invalidation );
+		}
+	}
+}
+
+/// Record the EnumEntry names and values of Enumeration node name
+static void	GenCpRegMapCollectEnums(
+	const std::string				&	name,
+	const GenCpXmlNode				*	pNode,
+	std::vector<GenCpRegMapEnumItem>	&	enums	)
+{
+	for ( size_t iChild = 0; iChild < pNode->m_children.size(); iChild++ )
+	{
+		const GenCpXmlNode	*	pEnum	= pNode->m_children[iChild];
+		const char			*	pName	= pEnum->Attr( "Name" );
+		const char			*	pValue	= pEnum->ChildText( "Value" );
+		if ( pEnum->m_name != "EnumEntry" || pName == NULL || pValue == NULL )
+			continue;
+		GenCpRegMapEnumItem		item;
+		item.feature	= name;
+		item.name		= pName;
+		item.value		= strtoll( pValue, NULL, 0 );
+		enums.push_back( item );
+	}
+}
+
+static bool	GenCpRegMapEnumLess( const GenCpRegMapEnumEntry & a, const GenCpRegMapEnumEntry & b )
+{
+	return a.entryIndex < b.entryIndex;
+}
+
+static void	GenCpRegMapAddItem( std::vector<GenCpRegMapItem> & items, const std::string & name, const GenCpRegMapEntry & entry )
+{
+	GenCpRegMapItem		item;
+	item.entry			= entry;
+	item.entry.nameHash	= GenCpRegMapHash( name.c_str() );
+	item.name			= name;
+	items.push_back( item );
+}
+
+/// Build a hash and displace perfect hash over the sorted items.
+/// Largest buckets are placed first, each w/ the first seed that puts all
+/// of its names in distinct free slots.
+static GENCP_STATUS	GenCpRegMapBuildPhf(
+	const std::vector<GenCpRegMapItem>	&	items,
+	std::vector<uint32_t>				&	seeds,
+	std::vector<uint32_t>				&	slots,
+	std::string							&	errorMsg	)
+{
+	size_t		nBuckets	= items.size() / GENCP_REGMAP_PHF_LOAD + 1;
+	size_t		nSlots		= items.size() + items.size() / 4 + 1;
+	std::vector< std::vector<uint32_t> >	buckets( nBuckets );
+	for ( size_t iItem = 0; iItem < items.size(); iItem++ )
+		buckets[items[iItem].entry.nameHash % nBuckets].push_back( iItem );
+
+	std::vector< std::pair<size_t, uint32_t> >	order;
+	for ( size_t iBucket = 0; iBucket < nBuckets; iBucket++ )
+		if ( !buckets[iBucket].empty() )
+			order.push_back( std::make_pair( buckets[iBucket].size(), iBucket ) );
+	std::sort( order.rbegin(), order.rend() );
+
+	seeds.assign( nBuckets, 0 );
+	slots.assign( nSlots, GENCP_REGMAP_PHF_EMPTY );
+	std::vector<uint32_t>	bucketSlots;
+	for ( size_t iOrder = 0; iOrder < order.size(); iOrder++ )
+	{
+		const std::vector<uint32_t>	&	bucket	= buckets[order[iOrder].second];
+		uint32_t						seed;
+		for ( seed = 1; seed < GENCP_REGMAP_PHF_MAX_SEED; seed++ )
+		{
+			bucketSlots.clear();
+			size_t		iKey;
+			for ( iKey = 0; iKey < bucket.size(); iKey++ )
+			{
+				uint32_t	slot	= GenCpRegMapHashSeed( items[bucket[iKey]].name.c_str(), seed ) % nSlots;
+				if (	slots[slot] != GENCP_REGMAP_PHF_EMPTY
+					||	std::find( bucketSlots.begin(), bucketSlots.end(), slot ) != bucketSlots.end() )
+					break;
+				bucketSlots.push_back( slot );
+			}
+			if ( iKey == bucket.size() )
+				break;
+		}
+		if ( seed >= GENCP_REGMAP_PHF_MAX_SEED )
+		{
+			errorMsg = "unable to build perfect hash, duplicate name " + items[bucket[0]].name + "?";
+			return GENCP_STATUS_GENERIC_ERROR | GENCP_SC_ERROR;
+		}
+		seeds[order[iOrder].second]	= seed;
+		for ( size_t iKey = 0; iKey < bucket.size(); iKey++ )
+			slots[bucketSlots[iKey]]	= bucket[iKey];
+	}
+	return GENCP_STATUS_SUCCESS;
+}
+
+static bool	GenCpRegMapItemLess( const GenCpRegMapItem & a, const GenCpRegMapItem & b )
+{
+	if ( a.entry.nameHash != b.entry.nameHash )
+		return a.entry.nameHash < b.entry.nameHash;
+	return a.name < b.name;
+}
+
+GENCP_STATUS	GenCpRegMapCompile(
+	const char		*	pXml,
+	size_t				sXml,
+	const uint8_t	*	pSha1,
+	std::vector<uint8_t> &	image,
+	std::string		&	errorMsg	)
+{
+	GenCpXmlNode	*	pRoot	= GenCpXmlParse( pXml, sXml, errorMsg );
+	if ( pRoot == NULL )
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	if ( pRoot->m_name != "RegisterDescription" )
+	{
+		errorMsg = "root element is " + pRoot->m_name + ", not RegisterDescription";
+		delete pRoot;
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
+
+	GenCpXmlNodeMap						nodes;
+	std::vector<const GenCpXmlNode *>	structRegs;
+	std::vector<GenCpRegMapItem>		items;
+	std::vector<GenCpRegMapEnumItem>	enums;
+	GenCpRegMapInvalidators				invalidators;
+	GenCpRegMapEntry					emptyEntry;
+	GenCpRegMapCollectNodes( pRoot, nodes, structRegs );
+	memset( &emptyEntry, 0, sizeof(emptyEntry) );
+	emptyEntry.lsb	= GENCP_REGMAP_NO_BIT;
+	emptyEntry.msb	= GENCP_REGMAP_NO_BIT;
+
+	// One entry per StructEntry bit field, all sharing the StructReg register
+	for ( size_t iStruct = 0; iStruct < structRegs.size(); iStruct++ )
+	{
+		const GenCpXmlNode	*	pNode		= structRegs[iStruct];
+		GenCpRegMapEntry		regEntry	= emptyEntry;
+		if ( !GenCpRegMapResolveRegister( pNode, regEntry ) )
+			continue;
+		for ( size_t iChild = 0; iChild < pNode->m_children.size(); iChild++ )
+		{
+			const GenCpXmlNode	*	pStruct	= pNode->m_children[iChild];
+			const char			*	pName	= pStruct->Attr( "Name" );
+			const char			*	pSign	= pStruct->ChildText( "Sign" );
+			if ( pStruct->m_name != "StructEntry" || pName == NULL )
+				continue;
+			GenCpRegMapEntry		bitEntry	= regEntry;
+			bitEntry.access	= GenCpRegMapAccess( pStruct->ChildText( "AccessMode" ), regEntry.access );
+			if ( pSign && strcmp( pSign, "Signed" ) == 0 )
+				bitEntry.flags	|= GENCP_REGMAP_FLAG_SIGNED;
+			if ( !GenCpRegMapBits( pStruct, bitEntry ) )
+				continue;
+			GenCpRegMapAddItem( items, pName, bitEntry );
+			GenCpRegMapCollectInvalidators( pName, pNode, invalidators );
+			GenCpRegMapCollectInvalidators( pName, pStruct, invalidators );
+		}
+	}
+
+	std::vector<GenCpRegMapFormulaItem>	formulas;
+	GenCpRegMapFormulaIndex				formulaIndex;
+	for ( GenCpXmlNodeMap::iterator it = nodes.begin(); it != nodes.end(); ++it )
+	{
+		const GenCpXmlNode	*	pNode	= it->second;
+		GenCpRegMapEntry		entry	= emptyEntry;
+		GenCpRegMapCollectInvalidators( it->first, pNode, invalidators );
+
+		if ( GenCpRegMapIsRegister( pNode->m_name ) )
+		{
+			if ( GenCpRegMapResolveRegister( pNode, entry ) )
+				GenCpRegMapAddItem( items, it->first, entry );
+		}
+		else if ( GenCpRegMapIsFormula( pNode->m_name ) )
+		{
+			int		iFormula	= GenCpRegMapCompileFormula( it->first, pNode, nodes, formulas, formulaIndex );
+			if ( iFormula < 0 )
+				continue;
+			GenCpRegMapFormulaEntry( pNode, iFormula, entry );
+			GenCpRegMapAddItem( items, it->first, entry );
+		}
+		else if ( GenCpRegMapIsFeature( pNode->m_name ) )
+		{
+			// Follow pValue through any feature aliases to a register
+			const GenCpXmlNode	*	pTarget	= pNode;
+			for ( int iHop = 0; pTarget != NULL && iHop < GENCP_REGMAP_MAX_HOPS; iHop++ )
+			{
+				const char	*	pValue	= pTarget->ChildText( "pValue" );
+				GenCpXmlNodeMap::iterator	itValue	= pValue ? nodes.find( pValue ) : nodes.end();
+				pTarget	= ( itValue != nodes.end() ) ? itValue->second : NULL;
+				if ( pTarget == NULL || !GenCpRegMapIsFeature( pTarget->m_name ) )
+					break;
+			}
+			if ( pTarget != NULL && GenCpRegMapIsFormula( pTarget->m_name ) && pTarget->Attr( "Name" ) != NULL )
+			{
+				int		iFormula	= GenCpRegMapCompileFormula(	pTarget->Attr( "Name" ), pTarget, nodes,
+																	formulas, formulaIndex );
+				if ( iFormula < 0 )
+					continue;
+				GenCpRegMapFormulaEntry( pTarget, iFormula, entry );
+			}
+			else if (	pTarget == NULL
+					||	!GenCpRegMapIsRegister( pTarget->m_name )
+					||	!GenCpRegMapResolveRegister( pTarget, entry ) )
+				continue;
+
+			entry.access	&= GenCpRegMapAccess( pNode->ChildText( "ImposedAccessMode" ), GENCP_REGMAP_ACCESS_RW );
+			if ( pNode->m_name == "Boolean" )
+				entry.type	= GENCP_REGMAP_TYPE_BOOL;
+			else if ( pNode->m_name == "Enumeration" )
+				entry.type	= GENCP_REGMAP_TYPE_ENUM;
+			else if ( pNode->m_name == "Command" )
+				entry.type	= GENCP_REGMAP_TYPE_COMMAND;
+			else if ( pNode->m_name == "String" )
+				entry.type	= GENCP_REGMAP_TYPE_STRING;
+			if ( pNode->Child( "pSelected" ) != NULL )
+				entry.flags	|= GENCP_REGMAP_FLAG_SELECTOR;
+			if ( entry.type == GENCP_REGMAP_TYPE_ENUM )
+				GenCpRegMapCollectEnums( it->first, pNode, enums );
+			// Integer and Float keep the encoding of their register
+			GenCpRegMapAddItem( items, it->first, entry );
+		}
+	}
+	delete pRoot;
+	GenCpRegMapPruneFormulas( items, formulas );
+
+	std::vector<GenCpRegMapInvalidation>	invalidTable;
+	uint32_t								invalidMaxLength	= 0;
+	GenCpRegMapBuildInvalidations( items, formulas, invalidators, invalidTable );
+	for ( size_t iInvalid = 0; iInvalid < invalidTable.size(); iInvalid++ )
+		invalidMaxLength	= std::max( invalidMaxLength, invalidTable[iInvalid].length );
+
+	if ( items.empty() )
+	{
+		errorMsg = "no features w/ a fixed register address";
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
+	std::sort( items.begin(), items.end(), GenCpRegMapItemLess );
+
+	std::vector<uint32_t>	phfSeeds;
+	std::vector<uint32_t>	phfSlots;
+	GENCP_STATUS			status	= GenCpRegMapBuildPhf( items, phfSeeds, phfSlots, errorMsg );
+	if ( status != GENCP_STATUS_SUCCESS )
+		return status;
+
+	// Flatten the formulas still in use into shared tables, variables by entry index
+	std::map<std::string, uint32_t>		entryIndex;
+	std::vector<GenCpRegMapFormula>		formulaTable;
+	std::vector<double>					constTable;
+	std::vector<uint32_t>				varTable;
+	std::vector<uint32_t>				codeTable;
+	std::vector<int>					newFormulaIndex( formulas.size(), -1 );
+	for ( size_t iItem = 0; iItem < items.size(); iItem++ )
+		entryIndex[items[iItem].name]	= iItem;
+	for ( size_t iFormula = 0; iFormula < formulas.size(); iFormula++ )
+	{
+		GenCpRegMapFormulaItem	&	item	= formulas[iFormula];
+		if ( !item.fValid )
+			continue;
+		item.formula.codeIndex	= codeTable.size();
+		item.formula.nCode		= item.code.size();
+		item.formula.constIndex	= constTable.size();
+		item.formula.nConsts	= item.consts.size();
+		item.formula.varIndex	= varTable.size();
+		item.formula.nVars		= item.varNames.size();
+		codeTable.insert( codeTable.end(), item.code.begin(), item.code.end() );
+		constTable.insert( constTable.end(), item.consts.begin(), item.consts.end() );
+		for ( size_t iVar = 0; iVar < item.varNames.size(); iVar++ )
+			varTable.push_back( entryIndex[item.varNames[iVar]] );
+		newFormulaIndex[iFormula]	= formulaTable.size();
+		formulaTable.push_back( item.formula );
+	}
+	for ( size_t iItem = 0; iItem < items.size(); iItem++ )
+	{
+		if ( items[iItem].entry.flags & GENCP_REGMAP_FLAG_FORMULA )
+			items[iItem].entry.address	= newFormulaIndex[items[iItem].entry.address];
+	}
+
+	// Lay out header, entries, formulas, constants, invalidations, enums, hash, variables, code, strings
+	std::string			strings;
+	for ( size_t iItem = 0; iItem < items.size(); iItem++ )
+	{
+		items[iItem].entry.nameOffset	= strings.size();
+		strings	+= items[iItem].name;
+		strings	+= '\0';
+	}
+
+	// EnumEntries of Enumerations pruned w/ their formula are dropped
+	std::vector<GenCpRegMapEnumEntry>	enumTable;
+	for ( size_t iEnum = 0; iEnum < enums.size(); iEnum++ )
+	{
+		std::map<std::string, uint32_t>::iterator	itEntry	= entryIndex.find( enums[iEnum].feature );
+		if ( itEntry == entryIndex.end() )
+			continue;
+		GenCpRegMapEnumEntry	enumEntry;
+		enumEntry.entryIndex	= itEntry->second;
+		enumEntry.nameOffset	= strings.size();
+		enumEntry.value			= enums[iEnum].value;
+		enumTable.push_back( enumEntry );
+		strings	+= enums[iEnum].name;
+		strings	+= '\0';
+	}
+	std::stable_sort( enumTable.begin(), enumTable.end(), GenCpRegMapEnumLess );
+
+	GenCpRegMapHeader	header;
+	memset( &header, 0, sizeof(header) );
+	header.magic		= GENCP_REGMAP_MAGIC;
+	header.version		= GENCP_REGMAP_VERSION;
+	header.headerSize	= sizeof(GenCpRegMapHeader);
+	header.entrySize	= sizeof(GenCpRegMapEntry);
+	memcpy( header.sha1, pSha1, GENCP_MFT_ENTRY_SHA1_SIZE );
+	header.nEntries		= items.size();
+	header.entryOffset	= ( sizeof(GenCpRegMapHeader) + 7 ) & ~7;
+	header.formulaOffset	= header.entryOffset + items.size() * sizeof(GenCpRegMapEntry);
+	header.nFormulas	= formulaTable.size();
+	header.constOffset	= header.formulaOffset + formulaTable.size() * sizeof(GenCpRegMapFormula);
+	header.nConsts		= constTable.size();
+	header.invalidOffset	= header.constOffset + constTable.size() * sizeof(double);
+	header.nInvalid		= invalidTable.size();
+	header.invalidMaxLength	= invalidMaxLength;
+	header.enumOffset	= header.invalidOffset + invalidTable.size() * sizeof(GenCpRegMapInvalidation);
+	header.nEnums		= enumTable.size();
+	header.phfOffset	= header.enumOffset + enumTable.size() * sizeof(GenCpRegMapEnumEntry);
+	header.phfBuckets	= phfSeeds.size();
+	header.phfSlots		= phfSlots.size();
+	header.varOffset	= header.phfOffset + ( phfSeeds.size() + phfSlots.size() ) * sizeof(uint32_t);
+	header.nVars		= varTable.size();
+	header.codeOffset	= header.varOffset + varTable.size() * sizeof(uint32_t);
+	header.nCode		= codeTable.size();
+	header.stringOffset	= header.codeOffset + codeTable.size() * sizeof(uint32_t);
+	header.stringSize	= strings.size();
+	header.fileSize		= header.stringOffset + header.stringSize;
+
+	image.assign( header.fileSize, 0 );
+	memcpy( &image[0], &header, sizeof(header) );
+	for ( size_t iItem = 0; iItem < items.size(); iItem++ )
+		memcpy( &image[header.entryOffset + iItem * sizeof(GenCpRegMapEntry)], &items[iItem].entry, sizeof(GenCpRegMapEntry) );
+	if ( !formulaTable.empty() )
+		memcpy( &image[header.formulaOffset], &formulaTable[0], formulaTable.size() * sizeof(GenCpRegMapFormula) );
+	if ( !constTable.empty() )
+		memcpy( &image[header.constOffset], &constTable[0], constTable.size() * sizeof(double) );
+	if ( !invalidTable.empty() )
+		memcpy( &image[header.invalidOffset], &invalidTable[0], invalidTable.size() * sizeof(GenCpRegMapInvalidation) );
+	if ( !enumTable.empty() )
+		memcpy( &image[header.enumOffset], &enumTable[0], enumTable.size() * sizeof(GenCpRegMapEnumEntry) );
+	if ( !varTable.empty() )
+		memcpy( &image[header.varOffset], &varTable[0], varTable.size() * sizeof(uint32_t) );
+	if ( !codeTable.empty() )
+		memcpy( &image[header.codeOffset], &codeTable[0], codeTable.size() * sizeof(uint32_t) );
+	memcpy( &image[header.phfOffset], &phfSeeds[0], phfSeeds.size() * sizeof(uint32_t) );
+	memcpy( &image[header.phfOffset + phfSeeds.size() * sizeof(uint32_t)], &phfSlots[0], phfSlots.size() * sizeof(uint32_t) );
+	memcpy( &image[header.stringOffset], strings.data(), strings.size() );
+	return GENCP_STATUS_SUCCESS;
+}
+
+GENCP_STATUS	GenCpRegMapWrite(
+	const char		*	pMapDir,
+	const uint8_t	*	pSha1,
+	const std::vector<uint8_t> &	image,
+	std::string		&	errorMsg	)
+{
+	char		fileName[1024];
+	char		tempName[1100];
+	GenCpRegMapFileName( pMapDir, pSha1, fileName, sizeof(fileName) );
+	snprintf( tempName, sizeof(tempName), "%s.tmp%d", fileName, static_cast<int>( getpid() ) );
+
+	// Write a temp file and rename it so a concurrent loader never sees a partial map
+	FILE	*	pFile	= fopen( tempName, "wb" );
+	if ( pFile == NULL )
+	{
+		errorMsg = std::string( "unable to create " ) + tempName + ": " + strerror( errno );
+		return GENCP_STATUS_GENERIC_ERROR | GENCP_SC_ERROR;
+	}
+	size_t		nWritten	= fwrite( &image[0], 1, image.size(), pFile );
+	if ( fclose( pFile ) != 0 || nWritten != image.size() || rename( tempName, fileName ) != 0 )
+	{
+		errorMsg = std::string( "unable to write " ) + fileName + ": " + strerror( errno );
+		unlink( tempName );
+		return GENCP_STATUS_GENERIC_ERROR | GENCP_SC_ERROR;
+	}
+	return GENCP_STATUS_SUCCESS;
+}
+
+GenCpRegMap::GenCpRegMap( )
+	:	m_pMap(			NULL	),
+		m_sMap(			0		),
+		m_pHeader(		NULL	),
+		m_pEntries(		NULL	),
+		m_pStrings(		NULL	),
+		m_pPhfSeeds(	NULL	),
+		m_pPhfSlots(	NULL	),
+		m_pFormulas(	NULL	),
+		m_pConsts(		NULL	),
+		m_pInvalid(		NULL	),
+		m_pVars(		NULL	),
+		m_pCode(		NULL	),
+		m_pEnums(		NULL	),
+		m_fileName(				)
+{
+}
+
+GenCpRegMap::~GenCpRegMap( )
+{
+	Unload();
+}
+
+void	GenCpRegMap::Unload( )
+{
+	if ( m_pMap != NULL )
+		munmap( m_pMap, m_sMap );
+	m_pMap		= NULL;
+	m_sMap		= 0;
+	m_pHeader	= NULL;
+	m_pEntries	= NULL;
+	m_pStrings	= NULL;
+	m_pPhfSeeds	= NULL;
+	m_pPhfSlots	= NULL;
+	m_pFormulas	= NULL;
+	m_pConsts	= NULL;
+	m_pInvalid	= NULL;
+	m_pVars		= NULL;
+	m_pCode		= NULL;
+	m_pEnums	= NULL;
+	m_fileName.clear();
+}
+
+GENCP_STATUS	GenCpRegMap::Load(
+	const char		*	pMapDir,
+	const uint8_t	*	pSha1,
+	std::string		&	errorMsg	)
+{
+	char		fileName[1024];
+	struct stat	fileStat;
+	GenCpRegMapFileName( pMapDir, pSha1, fileName, sizeof(fileName) );
+	Unload();
+
+	int		fd	= open( fileName, O_RDONLY );
+	if ( fd < 0 )
+	{
+		errorMsg = std::string( fileName ) + ": " + strerror( errno );
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
+	if ( fstat( fd, &fileStat ) != 0 || static_cast<size_t>( fileStat.st_size ) < sizeof(GenCpRegMapHeader) )
+	{
+		errorMsg = std::string( fileName ) + ": too short";
+		close( fd );
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
+	size_t		sMap	= fileStat.st_size;
+	void	*	pMap	= mmap( NULL, sMap, PROT_READ, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if ( pMap == MAP_FAILED )
+	{
+		errorMsg = std::string( fileName ) + ": mmap failed, " + strerror( errno );
+		return GENCP_STATUS_GENERIC_ERROR | GENCP_SC_ERROR;
+	}
+
+	const GenCpRegMapHeader	*	pHeader	= reinterpret_cast<const GenCpRegMapHeader *>( pMap );
+	const char				*	pError	= NULL;
+	if (	pHeader->magic != GENCP_REGMAP_MAGIC )
+		pError	= "not a register map";
+	else if ( pHeader->version != GENCP_REGMAP_VERSION
+			||	pHeader->headerSize != sizeof(GenCpRegMapHeader)
+			||	pHeader->entrySize != sizeof(GenCpRegMapEntry) )
+		pError	= "register map version mismatch, recompile it";
+	else if ( memcmp( pHeader->sha1, pSha1, GENCP_MFT_ENTRY_SHA1_SIZE ) != 0 )
+		pError	= "SHA1 mismatch";
+	else if (	pHeader->fileSize != sMap
+			||	pHeader->entryOffset + static_cast<uint64_t>( pHeader->nEntries ) * sizeof(GenCpRegMapEntry) > pHeader->formulaOffset
+			||	pHeader->formulaOffset + static_cast<uint64_t>( pHeader->nFormulas ) * sizeof(GenCpRegMapFormula) > pHeader->constOffset
+			||	pHeader->constOffset + static_cast<uint64_t>( pHeader->nConsts ) * sizeof(double) > pHeader->invalidOffset
+			||	pHeader->invalidOffset + static_cast<uint64_t>( pHeader->nInvalid ) * sizeof(GenCpRegMapInvalidation) > pHeader->enumOffset
+			||	pHeader->enumOffset + static_cast<uint64_t>( pHeader->nEnums ) * sizeof(GenCpRegMapEnumEntry) > pHeader->phfOffset
+			||	pHeader->phfBuckets == 0
+			||	pHeader->phfSlots < pHeader->nEntries
+			||	pHeader->phfOffset + ( static_cast<uint64_t>( pHeader->phfBuckets ) + pHeader->phfSlots ) * sizeof(uint32_t) > pHeader->varOffset
+			||	pHeader->varOffset + static_cast<uint64_t>( pHeader->nVars ) * sizeof(uint32_t) > pHeader->codeOffset
+			||	pHeader->codeOffset + static_cast<uint64_t>( pHeader->nCode ) * sizeof(uint32_t) > pHeader->stringOffset
+			||	pHeader->entryOffset % 8 != 0
+			||	pHeader->constOffset % 8 != 0
+			||	pHeader->invalidOffset % 8 != 0
+			||	pHeader->enumOffset % 8 != 0
+			||	static_cast<uint64_t>( pHeader->stringOffset ) + pHeader->stringSize > sMap
+			||	pHeader->stringSize == 0
+			||	reinterpret_cast<const char *>( pMap )[pHeader->stringOffset + pHeader->stringSize - 1] != '\0' )
+		pError	= "corrupt register map";
+	if ( pError != NULL )
+	{
+		errorMsg = std::string( fileName ) + ": " + pError;
+		munmap( pMap, sMap );
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
+
+	m_pMap		= pMap;
+	m_sMap		= sMap;
+	m_pHeader	= pHeader;
+	m_pEntries	= reinterpret_cast<const GenCpRegMapEntry *>( reinterpret_cast<const char *>( pMap ) + pHeader->entryOffset );
+	m_pStrings	= reinterpret_cast<const char *>( pMap ) + pHeader->stringOffset;
+	m_pPhfSeeds	= reinterpret_cast<const uint32_t *>( reinterpret_cast<const char *>( pMap ) + pHeader->phfOffset );
+	m_pPhfSlots	= m_pPhfSeeds + pHeader->phfBuckets;
+	m_pFormulas	= reinterpret_cast<const GenCpRegMapFormula *>( reinterpret_cast<const char *>( pMap ) + pHeader->formulaOffset );
+	m_pConsts	= reinterpret_cast<const double *>( reinterpret_cast<const char *>( pMap ) + pHeader->constOffset );
+	m_pInvalid	= reinterpret_cast<const GenCpRegMapInvalidation *>( reinterpret_cast<const char *>( pMap ) + pHeader->invalidOffset );
+	m_pVars		= reinterpret_cast<const uint32_t *>( reinterpret_cast<const char *>( pMap ) + pHeader->varOffset );
+	m_pCode		= reinterpret_cast<const uint32_t *>( reinterpret_cast<const char *>( pMap ) + pHeader->codeOffset );
+	m_pEnums	= reinterpret_cast<const GenCpRegMapEnumEntry *>( reinterpret_cast<const char *>( pMap ) + pHeader->enumOffset );
+	m_fileName	= fileName;
+
+	// Formula slices and references are trusted at run time, so check them once here
+	for ( size_t iFormula = 0; iFormula < pHeader->nFormulas && pError == NULL; iFormula++ )
+	{
+		const GenCpRegMapFormula	*	pFormula	= &m_pFormulas[iFormula];
+		if (	static_cast<uint64_t>( pFormula->codeIndex ) + pFormula->nCode > pHeader->nCode
+			||	static_cast<uint64_t>( pFormula->constIndex ) + pFormula->nConsts > pHeader->nConsts
+			||	static_cast<uint64_t>( pFormula->varIndex ) + pFormula->nVars > pHeader->nVars )
+			pError	= "corrupt formula table";
+		for ( size_t iVar = 0; iVar < pFormula->nVars && pError == NULL; iVar++ )
+		{
+			if ( m_pVars[pFormula->varIndex + iVar] >= pHeader->nEntries )
+				pError	= "corrupt formula variable";
+		}
+	}
+	// Invalidated() relies on the sort order and max length
+	for ( size_t iInvalid = 0; iInvalid < pHeader->nInvalid && pError == NULL; iInvalid++ )
+	{
+		if (	m_pInvalid[iInvalid].length > pHeader->invalidMaxLength
+			||	( iInvalid > 0 && m_pInvalid[iInvalid].address < m_pInvalid[iInvalid - 1].address ) )
+			pError	= "corrupt invalidation table";
+	}
+	// EnumValue() relies on the sort order
+	for ( size_t iEnum = 0; iEnum < pHeader->nEnums && pError == NULL; iEnum++ )
+	{
+		if (	m_pEnums[iEnum].entryIndex >= pHeader->nEntries
+			||	m_pEnums[iEnum].nameOffset >= pHeader->stringSize
+			||	( iEnum > 0 && m_pEnums[iEnum].entryIndex < m_pEnums[iEnum - 1].entryIndex ) )
+			pError	= "corrupt enum table";
+	}
+	// Bit fields are shifted and masked at run time w/o further checks
+	for ( size_t iEntry = 0; iEntry < pHeader->nEntries && pError == NULL; iEntry++ )
+	{
+		const GenCpRegMapEntry	*	pEntry	= &m_pEntries[iEntry];
+		if (	( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA )
+			&&	pEntry->address >= pHeader->nFormulas )
+			pError	= "corrupt formula entry";
+		else if (	( pEntry->flags & GENCP_REGMAP_FLAG_MASKED )
+				&&	( pEntry->lsb > pEntry->msb || pEntry->msb >= static_cast<uint64_t>( pEntry->length ) * 8 ) )
+			pError	= "corrupt bit field entry";
+	}
+	if ( pError != NULL )
+	{
+		errorMsg = std::string( fileName ) + ": " + pError;
+		Unload();
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
+	return GENCP_STATUS_SUCCESS;
+}
+
+const GenCpRegMapFormula	*	GenCpRegMap::Formula( const GenCpRegMapEntry * pEntry ) const
+{
+	if (	m_pHeader == NULL
+		||	!( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA )
+		||	pEntry->address >= m_pHeader->nFormulas )
+		return NULL;
+	return &m_pFormulas[pEntry->address];
+}
+
+static bool	GenCpRegMapInvalidationBefore( const GenCpRegMapInvalidation & invalidation, uint64_t address )
+{
+	return invalidation.address < address;
+}
+
+void	GenCpRegMap::Invalidated(
+	uint64_t			regAddr,
+	size_t				numBytes,
+	std::vector< std::pair<uint64_t, uint32_t> > &	targets	) const
+{
+	if ( m_pHeader == NULL || m_pHeader->nInvalid == 0 || numBytes == 0 )
+		return;
+
+	// Written registers overlapping regAddr start no more than invalidMaxLength bytes before it
+	uint64_t	firstAddr	= ( regAddr > m_pHeader->invalidMaxLength ) ? regAddr - m_pHeader->invalidMaxLength : 0;
+	const GenCpRegMapInvalidation	*	pEnd	= m_pInvalid + m_pHeader->nInvalid;
+	for (	const GenCpRegMapInvalidation * p = std::lower_bound( m_pInvalid, pEnd, firstAddr, GenCpRegMapInvalidationBefore );
+			p != pEnd && p->address < regAddr + numBytes; p++ )
+	{
+		if ( p->address + p->length > regAddr )
+			targets.push_back( std::make_pair( p->targetAddress, p->targetLength ) );
+	}
+}
+
+static bool	GenCpRegMapEnumBefore( const GenCpRegMapEnumEntry & enumEntry, uint32_t entryIndex )
+{
+	return enumEntry.entryIndex < entryIndex;
+}
+
+bool	GenCpRegMap::EnumValue(
+	const GenCpRegMapEntry	*	pEntry,
+	const char				*	pEnumName,
+	int64_t					*	pValue	) const
+{
+	if ( m_pHeader == NULL || pEntry == NULL || pEnumName == NULL || pEntry->type != GENCP_REGMAP_TYPE_ENUM )
+		return false;
+	uint32_t	entryIndex	= pEntry - m_pEntries;
+	const GenCpRegMapEnumEntry	*	pEnd	= m_pEnums + m_pHeader->nEnums;
+	for (	const GenCpRegMapEnumEntry * p = std::lower_bound( m_pEnums, pEnd, entryIndex, GenCpRegMapEnumBefore );
+			p != pEnd && p->entryIndex == entryIndex; p++ )
+	{
+		if ( strcmp( m_pStrings + p->nameOffset, pEnumName ) == 0 )
+		{
+			*pValue	= p->value;
+			return true;
+		}
+	}
+	return false;
+}
+
+const char	*	GenCpRegMap::Name( const GenCpRegMapEntry * pEntry ) const
+{
+	if ( pEntry->nameOffset >= m_pHeader->stringSize )
+		return "";
+	return m_pStrings + pEntry->nameOffset;
+}
+
+const GenCpRegMapEntry	*	GenCpRegMap::Find( const char * pName ) const
+{
+	if ( m_pHeader == NULL || pName == NULL )
+		return NULL;
+	uint32_t	seed	= m_pPhfSeeds[GenCpRegMapHash( pName ) % m_pHeader->phfBuckets];
+	if ( seed == 0 )
+		return NULL;	// Empty bucket
+	uint32_t	iEntry	= m_pPhfSlots[GenCpRegMapHashSeed( pName, seed ) % m_pHeader->phfSlots];
+	if ( iEntry >= m_pHeader->nEntries || strcmp( Name( &m_pEntries[iEntry] ), pName ) != 0 )
+		return NULL;
+	return &m_pEntries[iEntry];
+}
+
+void	GenCpRegMap::Report(
+	FILE		*	fp,
+	int				details	)
+{
+	static const char	*	typeNames[]		= { "Int", "Float", "String", "Bool", "Enum", "Command", "Register" };
+	static const char	*	accessNames[]	= { "NA", "RO", "WO", "RW" };
+	if ( m_pHeader == NULL )
+	{
+		fprintf( fp, "  Register map: not loaded\n" );
+		return;
+	}
+	fprintf( fp, "  Register map: %s, %u entries, %u formulas, %u invalidations, %u enum entries, %u hash buckets, %u slots\n",
+			m_fileName.c_str(), m_pHeader->nEntries, m_pHeader->nFormulas, m_pHeader->nInvalid,
+			m_pHeader->nEnums, m_pHeader->phfBuckets, m_pHeader->phfSlots );
+	if ( details < 2 )
+		return;
+	for ( size_t iEntry = 0; iEntry < m_pHeader->nEntries; iEntry++ )
+	{
+		const GenCpRegMapEntry	*	pEntry	= &m_pEntries[iEntry];
+		fprintf( fp, "    %-40s 0x%08llX %4u %-8s %s %s",
+				Name( pEntry ), (long long unsigned int) pEntry->address, pEntry->length,
+				pEntry->type < sizeof(typeNames) / sizeof(typeNames[0]) ? typeNames[pEntry->type] : "?",
+				accessNames[pEntry->access & GENCP_REGMAP_ACCESS_RW],
+				pEntry->endian == GENCP_REGMAP_ENDIAN_BIG ? "BE" : "LE" );
+		if ( pEntry->flags & GENCP_REGMAP_FLAG_MASKED )
+			fprintf( fp, " bits %u..%u", pEntry->lsb, pEntry->msb );
+		if ( pEntry->flags & GENCP_REGMAP_FLAG_SELECTOR )
+			fprintf( fp, " selector" );
+		if ( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA )
+		{
+			const GenCpRegMapFormula	*	pFormula	= Formula( pEntry );
+			fprintf( fp, " formula w/ %u ops, reads", pFormula->nCode );
+			for ( size_t iVar = 0; iVar < pFormula->nVars; iVar++ )
+				fprintf( fp, " %s", Name( &m_pEntries[FormulaVars( pFormula )[iVar]] ) );
+		}
+		for ( size_t iEnum = 0; iEnum < m_pHeader->nEnums; iEnum++ )
+		{
+			if ( m_pEnums[iEnum].entryIndex == iEntry )
+				fprintf( fp, " %s=%lld", m_pStrings + m_pEnums[iEnum].nameOffset, (long long) m_pEnums[iEnum].value );
+		}
+		fprintf( fp, "\n" );
+	}
+	for ( size_t iInvalid = 0; iInvalid < m_pHeader->nInvalid; iInvalid++ )
+		fprintf( fp, "    Write to 0x%08llX %4u invalidates 0x%08llX %4u\n",
+				(long long unsigned int) m_pInvalid[iInvalid].address, m_pInvalid[iInvalid].length,
+				(long long unsigned int) m_pInvalid[iInvalid].targetAddress, m_pInvalid[iInvalid].targetLength );
+}
@@ -0,0 +1,255 @@
+// GenCpRegMap.h
+
+//
+// Compiled register map for a GenICam camera description file.
+// The XML is compiled once, by GenCpTool or on first boot, into a flat
+// binary table of fixed size entries plus a string table.  The file is
+// named after the manifest SHA1 of the XML, so an IOC only needs to
+// mmap it at start-up and never parses XML on its boot path.
+//
+// Names are looked up through a perfect hash built at compile time:
+// the FNV-1a hash picks a bucket, the bucket's seed picks a unique slot,
+// so a lookup is two hashes and one strcmp w/ no probing.
+//
+// SwissKnife, IntSwissKnife and Converter nodes, and features backed by
+// them, are entries flagged GENCP_REGMAP_FLAG_FORMULA.  Their address is
+// the index of a precompiled formula (see GenCpFormula.h), whose variables
+// are the indices of the entries it reads.
+//
+// pInvalidator links are compiled into a table of register ranges, sorted
+// by the written register, listing every register a write makes stale,
+// directly or through a chain of invalidators.  A selector invalidates the
+// features it selects, as their registers then hold another index's value.
+// So caching can stay on for all registers the XML doesn't mark NoCache.
+//
+// Enumeration features keep their EnumEntry names and values in a table
+// sorted by entry, so tools can write enums by name, not by SFNC number.
+//
+// Map files are a host byte order cache, not an interchange format.
+// They are rebuilt whenever GENCP_REGMAP_VERSION changes.
+//
+
+#ifndef	GENCP_REG_MAP_H
+#define	GENCP_REG_MAP_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "GenCpPacket.h"
+#include "GenCpRegister.h"
+
+#define	GENCP_REGMAP_MAGIC			0x50434D47	// "GMCP" in a little endian dump
+#define	GENCP_REGMAP_VERSION		6
+#define	GENCP_REGMAP_SUFFIX			".gcmap"
+#define	GENCP_REGMAP_NO_BIT			0xFF
+#define	GENCP_REGMAP_PHF_EMPTY		0xFFFFFFFF	// Unused perfect hash slot
+#define	GENCP_REGMAP_MAX_FORMULA_DEPTH	8		// Formulas of formulas
+#define	GENCP_REGMAP_MAX_XML_BYTES	(8 * 1024 * 1024)	// Largest manifest XML size trusted for a compile
+
+/// Entry types, from the GenICam node kind
+#define	GENCP_REGMAP_TYPE_INT		0	// Integer, IntReg, MaskedIntReg, StructEntry
+#define	GENCP_REGMAP_TYPE_FLOAT		1	// Float, FloatReg
+#define	GENCP_REGMAP_TYPE_STRING	2	// String, StringReg
+#define	GENCP_REGMAP_TYPE_BOOL		3	// Boolean
+#define	GENCP_REGMAP_TYPE_ENUM		4	// Enumeration
+#define	GENCP_REGMAP_TYPE_COMMAND	5	// Command
+#define	GENCP_REGMAP_TYPE_REGISTER	6	// Register, raw bytes
+
+/// Access modes
+#define	GENCP_REGMAP_ACCESS_NA		0
+#define	GENCP_REGMAP_ACCESS_RO		1
+#define	GENCP_REGMAP_ACCESS_WO		2
+#define	GENCP_REGMAP_ACCESS_RW		3	// RO | WO
+
+/// Register byte order
+#define	GENCP_REGMAP_ENDIAN_LITTLE	0
+#define	GENCP_REGMAP_ENDIAN_BIG		1
+
+/// Cachable, per the GenICam Cachable element
+#define	GENCP_REGMAP_CACHE_NONE		0	// NoCache
+#define	GENCP_REGMAP_CACHE_WRITE_THROUGH	1	// WriteThrough, written value may be cached
+#define	GENCP_REGMAP_CACHE_WRITE_AROUND		2	// WriteAround, read back after a write
+
+/// Entry flags
+#define	GENCP_REGMAP_FLAG_SIGNED	0x01	// Sign is Signed
+#define	GENCP_REGMAP_FLAG_MASKED	0x02	// lsb/msb select a bit field of the register
+#define	GENCP_REGMAP_FLAG_FORMULA	0x04	// Value is computed, address is the formula index
+#define	GENCP_REGMAP_FLAG_SELECTOR	0x08	// Selector, has pSelected features
+
+/// Map file header
+typedef struct
+{
+	uint32_t		magic;			// GENCP_REGMAP_MAGIC
+	uint32_t		version;		// GENCP_REGMAP_VERSION
+	uint32_t		headerSize;		// sizeof(GenCpRegMapHeader)
+	uint32_t		entrySize;		// sizeof(GenCpRegMapEntry)
+	uint8_t			sha1[GENCP_MFT_ENTRY_SHA1_SIZE];	// Manifest SHA1 of the XML file
+	uint32_t		fileSize;
+	uint32_t		nEntries;
+	uint32_t		entryOffset;	// Entries, sorted by nameHash
+	uint32_t		stringOffset;	// NULL terminated names
+	uint32_t		stringSize;
+	uint32_t		phfOffset;		// Perfect hash: phfBuckets seeds, then phfSlots entry indices
+	uint32_t		phfBuckets;
+	uint32_t		phfSlots;
+	uint32_t		formulaOffset;	// GenCpRegMapFormula table
+	uint32_t		nFormulas;
+	uint32_t		constOffset;	// double formula constants
+	uint32_t		nConsts;
+	uint32_t		invalidOffset;	// GenCpRegMapInvalidation table
+	uint32_t		nInvalid;
+	uint32_t		invalidMaxLength;	// Longest written register in the table
+	uint32_t		varOffset;		// uint32_t entry index per formula variable
+	uint32_t		nVars;
+	uint32_t		codeOffset;		// uint32_t formula ops
+	uint32_t		nCode;
+	uint32_t		enumOffset;		// GenCpRegMapEnumEntry table
+	uint32_t		nEnums;
+}	GenCpRegMapHeader;
+
+/// Map entry, one per feature or register that resolves to a fixed address
+/// Two entries per 64 byte cache line
+typedef struct
+{
+	uint32_t		nameHash;		// GenCpRegMapHash() of the name
+	uint32_t		nameOffset;		// Name offset in the string table
+	uint64_t		address;
+	uint32_t		length;			// Register length in bytes
+	uint8_t			type;			// GENCP_REGMAP_TYPE_*
+	uint8_t			access;			// GENCP_REGMAP_ACCESS_*
+	uint8_t			endian;			// GENCP_REGMAP_ENDIAN_*
+	uint8_t			cache;			// GENCP_REGMAP_CACHE_*
+	uint8_t			flags;			// GENCP_REGMAP_FLAG_*
+	uint8_t			lsb;			// Bit field, bit 0 is the LSB of the register value
+	uint8_t			msb;
+	uint8_t			reserved0;
+	uint32_t		pollingTime;	// ms, 0 if not given in the XML
+}	GenCpRegMapEntry;
+
+/// Formula, code, constants and variables are slices of the shared tables
+typedef struct
+{
+	uint32_t		codeIndex;
+	uint32_t		nCode;
+	uint32_t		constIndex;
+	uint32_t		nConsts;
+	uint32_t		varIndex;
+	uint16_t		nVars;
+	uint8_t			fInteger;		// IntSwissKnife or IntConverter
+	uint8_t			reserved0;
+}	GenCpRegMapFormula;
+
+/// A write to address..address+length invalidates targetAddress..targetAddress+targetLength
+/// Sorted by address, then length, then target
+typedef struct
+{
+	uint64_t		address;
+	uint64_t		targetAddress;
+	uint32_t		length;
+	uint32_t		targetLength;
+}	GenCpRegMapInvalidation;
+
+/// EnumEntry of an Enumeration entry, sorted by entry index then name
+typedef struct
+{
+	uint32_t		entryIndex;		// Index of the Enumeration entry
+	uint32_t		nameOffset;		// EnumEntry name offset in the string table
+	int64_t			value;
+}	GenCpRegMapEnumEntry;
+
+/// 32 bit FNV-1a hash of a feature name
+uint32_t		GenCpRegMapHash( const char * pName );
+
+/// Seeded hash of a feature name, selects the perfect hash slot within a bucket
+uint32_t		GenCpRegMapHashSeed(	const char	*	pName,
+										uint32_t		seed	);
+
+/// Decode the value of a register entry from its raw bytes per its
+/// byte order, bit field and sign.  Returns the value sign extended to 64 bits.
+uint64_t		GenCpRegMapDecodeInt(	const GenCpRegMapEntry	*	pEntry,
+										const uint8_t			*	pData	);
+
+/// As GenCpRegMapDecodeInt(), but as a double, and float registers as floats
+double			GenCpRegMapDecode(		const GenCpRegMapEntry	*	pEntry,
+										const uint8_t			*	pData	);
+
+/// Map file path for the XML w/ manifest SHA1 pSha1: <mapDir>/<sha1 in hex>.gcmap
+void			GenCpRegMapFileName(	const char		*	pMapDir,
+										const uint8_t	*	pSha1,
+										char			*	pFileName,
+										size_t				sFileName	);
+
+/// Compile sXml bytes of uncompressed GenICam XML into a map file image
+GENCP_STATUS	GenCpRegMapCompile(		const char		*	pXml,
+										size_t				sXml,
+										const uint8_t	*	pSha1,
+										std::vector<uint8_t> &	image,
+										std::string		&	errorMsg	);
+
+/// Write a map file image to <mapDir>, replacing any existing file atomically
+GENCP_STATUS	GenCpRegMapWrite(		const char		*	pMapDir,
+										const uint8_t	*	pSha1,
+										const std::vector<uint8_t> &	image,
+										std::string		&	errorMsg	);
+
+/// Read only view of a map file mapped into memory
+class GenCpRegMap
+{
+public:
+	GenCpRegMap( );
+	~GenCpRegMap( );
+
+	/// mmap <mapDir>/<sha1>.gcmap and validate it
+	GENCP_STATUS	Load(		const char		*	pMapDir,
+								const uint8_t	*	pSha1,
+								std::string		&	errorMsg	);
+	void			Unload( );
+
+	bool			IsLoaded( )		const	{ return m_pHeader != NULL;	}
+	const uint8_t *	Sha1( )			const	{ return m_pHeader ? m_pHeader->sha1 : NULL;	}
+	size_t			NumEntries( )	const	{ return m_pHeader ? m_pHeader->nEntries : 0;	}
+	const GenCpRegMapEntry *	Entry(	size_t iEntry	) const	{ return &m_pEntries[iEntry];	}
+	const char	*	Name(		const GenCpRegMapEntry	*	pEntry	) const;
+
+	/// Look up a feature or register by name via the perfect hash, NULL if not in the map
+	const GenCpRegMapEntry *	Find(	const char	*	pName	) const;
+
+	/// Formula of a GENCP_REGMAP_FLAG_FORMULA entry, NULL for other entries
+	const GenCpRegMapFormula *	Formula(	const GenCpRegMapEntry	*	pEntry	) const;
+	const uint32_t	*	FormulaCode(	const GenCpRegMapFormula	*	pFormula	) const	{ return m_pCode + pFormula->codeIndex;		}
+	const double	*	FormulaConsts(	const GenCpRegMapFormula	*	pFormula	) const	{ return m_pConsts + pFormula->constIndex;	}
+	const uint32_t	*	FormulaVars(	const GenCpRegMapFormula	*	pFormula	) const	{ return m_pVars + pFormula->varIndex;		}
+
+	/// Value of EnumEntry pEnumName of an Enumeration entry, false if it has none by that name
+	bool			EnumValue(	const GenCpRegMapEntry	*	pEntry,
+								const char				*	pEnumName,
+								int64_t					*	pValue	) const;
+
+	/// Append the registers made stale by a write to regAddr..regAddr+numBytes to targets,
+	/// as address and length pairs.  The written register itself is not included.
+	void			Invalidated(	uint64_t			regAddr,
+									size_t				numBytes,
+									std::vector< std::pair<uint64_t, uint32_t> > &	targets	) const;
+
+	void			Report(		FILE			*	fp,
+								int					details	);
+
+private:
+	void					*	m_pMap;
+	size_t						m_sMap;
+	const GenCpRegMapHeader	*	m_pHeader;
+	const GenCpRegMapEntry	*	m_pEntries;
+	const char				*	m_pStrings;
+	const uint32_t			*	m_pPhfSeeds;
+	const uint32_t			*	m_pPhfSlots;
+	const GenCpRegMapFormula	*	m_pFormulas;
+	const double			*	m_pConsts;
+	const GenCpRegMapInvalidation	*	m_pInvalid;
+	const uint32_t			*	m_pVars;
+	const uint32_t			*	m_pCode;
+	const GenCpRegMapEnumEntry	*	m_pEnums;
+	std::string					m_fileName;
+};
+
+#endif	/* GENCP_REG_MAP_H */
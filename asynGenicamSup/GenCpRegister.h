@@ -28,6 +28,41 @@
 #define REG_BRM_IMPLEMENTATION_ENDIANESS	0x020c
 #define REG_BRM_RESERVED					0x0210
 
+/// BRM Device Capability bits
+#define GENCP_BRM_CAP_SBRM_SUPPORTED		0x0000000000000200ULL
+
+/// BRM sizes
+#define GENCP_BRM_SIZE						REG_BRM_RESERVED
+#define GENCP_BRM_STRING_SIZE				64
+
+/// Technology Specific Bootstrap Register Map (SBRM)
+/// Offsets relative to base addr from REG_BRM_SBRM_ADDRESS
+/// Transfer lengths are in bytes and cover the whole packet, serial prefix included
+#define REG_SBRM_GENCP_VERSION				0x0000
+#define REG_SBRM_CAPABILITY					0x0004
+#define REG_SBRM_CONFIGURATION				0x000c
+#define REG_SBRM_MAX_CMD_TRANSFER_LENGTH	0x0014
+#define REG_SBRM_MAX_ACK_TRANSFER_LENGTH	0x0018
+#define REG_SBRM_NUM_STREAM_CHANNELS		0x001c
+#define REG_SBRM_SIRM_ADDRESS				0x0020
+#define REG_SBRM_SIRM_LENGTH				0x0028
+#define REG_SBRM_EIRM_ADDRESS				0x002c
+#define REG_SBRM_EIRM_LENGTH				0x0034
+#define REG_SBRM_IIDC2_ADDRESS				0x0038
+#define REG_SBRM_CURRENT_BAUDRATE			0x0040
+#define REG_SBRM_SUPPORTED_BAUDRATES		0x0044
+
+/// SBRM baud rate bits, used by both the supported and current baud rate registers
+#define GENCP_SBRM_BAUD_9600				0x00000001
+#define GENCP_SBRM_BAUD_19200				0x00000002
+#define GENCP_SBRM_BAUD_38400				0x00000004
+#define GENCP_SBRM_BAUD_57600				0x00000008
+#define GENCP_SBRM_BAUD_115200				0x00000010
+#define GENCP_SBRM_BAUD_230400				0x00000020
+#define GENCP_SBRM_BAUD_460800				0x00000040
+#define GENCP_SBRM_BAUD_921600				0x00000080
+#define GENCP_SBRM_BAUD_NUM_RATES			8
+
 /// Manifest Table organization
 /// Offsets relative to base addr from REG_BRM_MANIFEST_TABLE_ADDRESS
 /// Offset	Length	Name
@@ -60,4 +95,27 @@ typedef struct GENCP_ATTR
 	uint8_t			xmlFileRsvd[GENCP_MFT_ENTRY_RSVD_SIZE];
 }	GenCpManifestEntry;
 
+/// Device descriptor decoded from the BRM, host byte order
+typedef struct GenCpDeviceInfo
+{
+	uint32_t		gencpVersion;
+	char			manufacturerName[GENCP_BRM_STRING_SIZE+1];
+	char			modelName[GENCP_BRM_STRING_SIZE+1];
+	char			familyName[GENCP_BRM_STRING_SIZE+1];
+	char			deviceVersion[GENCP_BRM_STRING_SIZE+1];
+	char			manufacturerInfo[GENCP_BRM_STRING_SIZE+1];
+	char			serialNumber[GENCP_BRM_STRING_SIZE+1];
+	char			userDefinedName[GENCP_BRM_STRING_SIZE+1];
+	uint64_t		deviceCapability;
+	uint32_t		maxDeviceResponseTime;	// ms
+	uint64_t		manifestTableAddress;
+	uint64_t		sbrmAddress;
+	uint64_t		deviceConfiguration;
+	uint32_t		heartbeatTimeout;		// ms
+	uint32_t		messageChannelId;
+	uint64_t		timestampIncrement;		// ns per tick
+	uint32_t		protocolEndianess;
+	uint32_t		implementationEndianess;
+}	GenCpDeviceInfo;
+
 #endif	/* GEN_CP_REGISTER_H */
@@ -0,0 +1,67 @@
+// GenCpRtt.cpp
+
+//
+// Round trip time estimator for GenCP commands.
+// See GenCpRtt.h
+//
+
+#include "GenCpRtt.h"
+
+// RFC 6298 gains
+#define	GENCP_RTT_ALPHA			0.125
+#define	GENCP_RTT_BETA			0.25
+
+// Max number of timeout doublings
+#define	GENCP_RTT_MAX_BACKOFF	6
+
+GenCpRttEstimator::GenCpRttEstimator( )
+	:	m_srtt(			0.0	),
+		m_rttVar(		0.0	),
+		m_nSamples(		0	),
+		m_nTimeouts(	0	),
+		m_backoff(		0	)
+{
+}
+
+void	GenCpRttEstimator::Reset( )
+{
+	m_srtt		= 0.0;
+	m_rttVar	= 0.0;
+	m_nSamples	= 0;
+	m_backoff	= 0;
+}
+
+void	GenCpRttEstimator::Sample( double rttSec )
+{
+	if ( rttSec < 0.0 )
+		rttSec = 0.0;
+	if ( m_nSamples == 0 )
+	{
+		m_srtt		= rttSec;
+		m_rttVar	= rttSec / 2;
+	}
+	else
+	{
+		double	err	= rttSec - m_srtt;
+		if ( err < 0.0 )
+			err = -err;
+		m_rttVar	= ( 1.0 - GENCP_RTT_BETA  ) * m_rttVar + GENCP_RTT_BETA  * err;
+		m_srtt		= ( 1.0 - GENCP_RTT_ALPHA ) * m_srtt   + GENCP_RTT_ALPHA * rttSec;
+	}
+	m_nSamples++;
+	m_backoff	= 0;
+}
+
+void	GenCpRttEstimator::Backoff( )
+{
+	m_nTimeouts++;
+	if ( m_backoff < GENCP_RTT_MAX_BACKOFF )
+		m_backoff++;
+}
+
+double	GenCpRttEstimator::Timeout( ) const
+{
+	if ( m_nSamples == 0 )
+		return 0.0;
+	return ( m_srtt + 4 * m_rttVar ) * ( 1 << m_backoff );
+}
@@ -0,0 +1,47 @@
+// GenCpRtt.h
+
+//
+// Round trip time estimator for GenCP commands.
+// Smoothed RTT and RTT variance are tracked as in TCP (RFC 6298)
+// so ack timeouts can follow the device instead of a fixed worst case.
+//
+
+#ifndef	GENCP_RTT_H
+#define	GENCP_RTT_H
+
+/// Command classes w/ separate RTT estimates
+#define	GENCP_RTT_READ			0
+#define	GENCP_RTT_WRITE			1
+#define	GENCP_RTT_NUM_CLASSES	2
+
+class GenCpRttEstimator
+{
+public:
+	GenCpRttEstimator( );
+
+	/// Forget all samples, e.g. after the device or baud rate changed
+	void	Reset( );
+
+	/// Add a round trip sample in seconds, clears any timeout backoff
+	void	Sample(			double		rttSec	);
+
+	/// Double the timeout after a lost ack, up to GENCP_RTT_MAX_BACKOFF times
+	void	Backoff( );
+
+	/// srtt + 4 * rttvar scaled by the current backoff, 0 if no samples yet
+	double	Timeout( ) const;
+
+	double			Srtt( )			const	{ return m_srtt;		}
+	double			RttVar( )		const	{ return m_rttVar;		}
+	unsigned long	NumSamples( )	const	{ return m_nSamples;	}
+	unsigned long	NumTimeouts( )	const	{ return m_nTimeouts;	}
+
+private:
+	double			m_srtt;
+	double			m_rttVar;
+	unsigned long	m_nSamples;
+	unsigned long	m_nTimeouts;
+	unsigned int	m_backoff;		// Timeout multiplier is 1 << m_backoff
+};
+
+#endif	/* GENCP_RTT_H */
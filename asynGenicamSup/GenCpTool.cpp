@@ -1,18 +1,57 @@
 #include <assert.h>
 #include <openssl/sha.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 // #include <zlib.h>
 #include "edtinc.h"
 #include "pciload.h"
 #include "GenCpPacket.h"
 #include "GenCpRegister.h"
+#include "GenCpRegMap.h"
 
 
 // GenCp Request ID, start at 0, increment each request
-static uint16_t		localGenCpRequestId	= 0;
+// Thread local so each --all scan worker keeps its own sequence
+static __thread uint16_t	localGenCpRequestId	= 0;
+
+// Defaults for the --all scan
+#define	GENCP_SCAN_MAX_UNITS		8
+#define	GENCP_SCAN_MAX_CHANNELS		4
+#define	GENCP_SCAN_STRING_SIZE		64
+
+// Timeout for each GenCP acknowledge
+#define	GENCP_TOOL_TIMEOUT_MS		500
+
+// Time for the device to switch baud rates after acking the change
+#define	GENCP_BAUD_SETTLE_US		50000
+
+// Ack timeout for FileOperationExecute, file writes may wait on flash
+#define	GENCP_FILE_TIMEOUT_MS		5000
+
+// FileAccessControl EnumEntry names per the SFNC, their values come from the register map
+#define	GENCP_FILE_OP_OPEN			"Open"
+#define	GENCP_FILE_OP_CLOSE			"Close"
+#define	GENCP_FILE_OP_READ			"Read"
+#define	GENCP_FILE_OP_WRITE			"Write"
+#define	GENCP_FILE_MODE_READ		"Read"
+#define	GENCP_FILE_MODE_WRITE		"Write"
+#define	GENCP_FILE_MODE_READWRITE	"ReadWrite"
+#define	GENCP_FILE_STATUS_SUCCESS	"Success"
+
+// Upload progress is saved to <file>.gcpart at least every this many bytes
+#define	GENCP_FILE_CHECKPOINT_BYTES		65536
+#define	GENCP_FILE_CHECKPOINT_SUFFIX	".gcpart"
+
+// Max baud rate for the --baud upshift, 0 to leave the link as configured
+static unsigned int			localGenCpMaxBaud	= 0;
+
+// Baud rate and SBRM to restore in EdtGenCpClose() after an upshift, 0 if not upshifted
+static __thread int			localGenCpOrigBaud	= 0;
+static __thread uint64_t	localGenCpSbrmAddr	= 0;
 
 void usage( const char * msg )
 {
@@ -26,15 +65,67 @@ void usage( const char * msg )
        "    -u N            - Unit number (default 0)\n"
        "    --unit N        - Unit number (default 0)\n"
        "    --readXml fname - Read XML GeniCam file and write to fname\n"
+       "    --compileXml fname - Use local uncompressed XML fname for the next --compileMap\n"
+       "    --compileMap dir    - Compile the camera XML into a register map file in dir\n"
        "    --U16 Addr      - Read 16 bit unsigned value from address\n"
        "    --U32 Addr      - Read 32 bit unsigned value from address\n"
        "    --U64 Addr      - Read 64 bit unsigned value from address\n"
        "    --C20 Addr      - Read 20 character string from address\n"
        "    --C82 Addr      - Read 82 character string from address, etc for other counts\n"
+       "    --W16 Addr Val  - Write 16 bit unsigned value to address\n"
+       "    --W32 Addr Val  - Write 32 bit unsigned value to address\n"
+       "    --W64 Addr Val  - Write 64 bit unsigned value to address\n"
+       "    --bench N       - Repeat the following --U or --W N times and report latency stats\n"
+       "    --baud N        - Upshift the serial link to the fastest SBRM rate <= N for each operation\n"
+       "    --mapDir dir    - Register map directory for --upload, see --compileMap\n"
+       "    --fileSelector NAME - FileSelector EnumEntry, or value, of the camera file for --upload (default 0)\n"
+       "    --upload fname  - Write fname to the camera file via FileAccessControl, resuming\n"
+       "                      an interrupted upload, and verify it by SHA1\n"
+       "    --all           - Scan all units and channels concurrently and print a camera table\n"
+       "    --units N       - Number of units to scan w/ --all (default 8)\n"
+       "    --channels N    - Number of channels per unit to scan w/ --all (default 4)\n"
+       "    --manifest      - Include the XML manifest entry in the --all table\n"
        "    -v              - Verbose\n"
     );
 }
 
+/// GenCpToolTimeMs() Monotonic clock in ms for timeouts and benchmarks
+static double GenCpToolTimeMs( )
+{
+	struct timespec	ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+/// PdvGenCpReadReply() Read up to nBytesExpected reply bytes, waiting at most nMsTimeout
+/// Returns the number of bytes read
+int PdvGenCpReadReply(
+    EdtDev			*	pPdv,
+	char			*	pBuffer,
+	size_t				nBytesExpected,
+	int					nMsTimeout	)
+{
+	double		tDeadline	= GenCpToolTimeMs( ) + nMsTimeout;
+	int			nRead		= 0;
+	while ( nRead < static_cast<int>( nBytesExpected ) )
+	{
+		int		nMsLeft		= static_cast<int>( tDeadline - GenCpToolTimeMs( ) );
+		int		nToRead		= static_cast<int>( nBytesExpected ) - nRead;
+		if ( nMsLeft <= 0 )
+			break;
+		int		nAvailToRead	= pdv_serial_wait( pPdv, nMsLeft, nToRead );
+		if ( nAvailToRead <= 0 )
+			break;
+		if ( nAvailToRead < nToRead )
+			nToRead = nAvailToRead;
+		int		nNew	= pdv_serial_read( pPdv, pBuffer + nRead, nToRead );
+		if ( nNew <= 0 )
+			break;
+		nRead += nNew;
+	}
+	return nRead;
+}
+
 GENCP_STATUS PdvGenCpReadUint(
     EdtDev			*	pPdv,
 	uint64_t			regAddr,
@@ -58,22 +149,11 @@ GENCP_STATUS PdvGenCpReadUint(
 	}
 
 	status = pdv_serial_write( pPdv, reinterpret_cast<char *>( &readMemPacket ), sizeof(readMemPacket) );
-	int		nMsTimeout		= 500;
-	size_t	nBytesReadMax	= sizeof(ackPacket);
-	int		nAvailToRead	= pdv_serial_wait( pPdv, nMsTimeout, nBytesReadMax );
-
-	int     nRead = 0;
-	if ( nAvailToRead > 0 )
-	{
-		int     nToRead = nAvailToRead;
-		if( nToRead > static_cast<int>( nBytesReadMax ) )
-		{
-			printf( "%s: Clipping nAvailToRead %d to nBytesReadMax %zu\n",
-					functionName, nAvailToRead, nBytesReadMax );
-			nToRead = static_cast<int>(nBytesReadMax);
-		}
-		nRead = pdv_serial_read( pPdv, reinterpret_cast<char *>(&ackPacket), nToRead );
-	}
+	// Wait for the size of the ack we expect, not the largest ack we could hold,
+	// otherwise every short read sits out the full timeout
+	size_t	nBytesReadMax	= sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDAck) + numBytes;
+	int		nRead			= PdvGenCpReadReply( pPdv, reinterpret_cast<char *>(&ackPacket),
+												nBytesReadMax, GENCP_TOOL_TIMEOUT_MS );
 
 	if ( nRead <= 0 )
 	{
@@ -123,6 +203,60 @@ GENCP_STATUS PdvGenCpReadUint(
 	return GENCP_STATUS_SUCCESS;
 }
 
+GENCP_STATUS PdvGenCpWriteUint(
+    EdtDev			*	pPdv,
+	uint64_t			regAddr,
+	size_t				numBytes,
+	uint64_t			value	)
+{
+	const char		*	functionName = "PdvGenCpWriteUint";
+	GENCP_STATUS		status;
+	GenCpWriteMemPacket	writeMemPacket;
+	GenCpWriteMemAck	ackPacket;
+	size_t				nBytesSend	= 0;
+
+	switch ( numBytes )
+	{
+	case 2:
+		status = GenCpInitWriteMemPacket(	&writeMemPacket, localGenCpRequestId++, regAddr,
+											static_cast<uint16_t>( value ), &nBytesSend );
+		break;
+	case 4:
+		status = GenCpInitWriteMemPacket(	&writeMemPacket, localGenCpRequestId++, regAddr,
+											static_cast<uint32_t>( value ), &nBytesSend );
+		break;
+	case 8:
+		status = GenCpInitWriteMemPacket(	&writeMemPacket, localGenCpRequestId++, regAddr,
+											static_cast<uint64_t>( value ), &nBytesSend );
+		break;
+	default:
+		status = GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+		break;
+	}
+	if ( status != GENCP_STATUS_SUCCESS )
+	{
+		fprintf( stderr, "%s: GenCP Error: 0x%04X\n", functionName, status );
+		return status;
+	}
+
+	status = pdv_serial_write( pPdv, reinterpret_cast<char *>( &writeMemPacket ), nBytesSend );
+	int		nRead	= PdvGenCpReadReply( pPdv, reinterpret_cast<char *>(&ackPacket),
+										sizeof(ackPacket), GENCP_TOOL_TIMEOUT_MS );
+	if ( nRead <= 0 )
+	{
+		fprintf( stderr, "%s Error: Timeout with no reply!\n", functionName );
+		return GENCP_STATUS_MSG_TIMEOUT | GENCP_SC_ERROR;
+	}
+
+	status = GenCpValidateWriteMemAck( &ackPacket, localGenCpRequestId-1 );
+	if ( status != GENCP_STATUS_SUCCESS )
+	{
+		fprintf( stderr, "GenCP WriteMem Validate Error: %d (0x%X)\n", status, status );
+		return status;
+	}
+	return GENCP_STATUS_SUCCESS;
+}
+
 GENCP_STATUS PdvGenCpReadString(
     EdtDev			*	pPdv,
 	uint64_t			regAddr,
@@ -146,22 +280,11 @@ GENCP_STATUS PdvGenCpReadString(
 	}
 
 	status = pdv_serial_write( pPdv, reinterpret_cast<char *>( &readMemPacket ), sizeof(readMemPacket) );
-	int		nMsTimeout		= 500;
-	size_t	nBytesReadMax	= sizeof(ackPacket);
-	int		nAvailToRead	= pdv_serial_wait( pPdv, nMsTimeout, nBytesReadMax );
-
-	int     nRead = 0;
-	if ( nAvailToRead > 0 )
-	{
-		int     nToRead = nAvailToRead;
-		if( nToRead > static_cast<int>( nBytesReadMax ) )
-		{
-			printf( "%s: Clipping nAvailToRead %d to nBytesReadMax %zu\n",
-					functionName, nAvailToRead, nBytesReadMax );
-			nToRead = static_cast<int>(nBytesReadMax);
-		}
-		nRead = pdv_serial_read( pPdv, reinterpret_cast<char *>(&ackPacket), nToRead );
-	}
+	// Wait for the size of the ack we expect, not the largest ack we could hold,
+	// otherwise every short read sits out the full timeout
+	size_t	nBytesReadMax	= sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDAck) + numBytes;
+	int		nRead			= PdvGenCpReadReply( pPdv, reinterpret_cast<char *>(&ackPacket),
+												nBytesReadMax, GENCP_TOOL_TIMEOUT_MS );
 
 	if ( nRead <= 0 )
 	{
@@ -180,18 +303,42 @@ GENCP_STATUS PdvGenCpReadString(
 	return GENCP_STATUS_SUCCESS;
 }
 
-GENCP_STATUS PdvGenCpReadXmlFile(
+/// PdvGenCpReadMaxPayload() Read the SBRM max transfer lengths and return the
+/// ReadMem and WriteMem payload sizes to use w/ this device
+GENCP_STATUS PdvGenCpReadMaxPayload(
     EdtDev			*	pPdv,
-	unsigned int		iFileEntry,
-	unsigned char	*	pBuffer,
-	size_t				sBuffer,
-	const char		*	pFileName )
+	size_t			*	pMaxReadMemBytes,
+	size_t			*	pMaxWriteMemBytes	)
 {
-	const char		*	functionName = "PdvGenCpReadXmlFile";
 	GENCP_STATUS		status;
+	uint64_t			sbrmAddress;
+	uint64_t			maxCmdLength;
+	uint64_t			maxAckLength;
+
+	*pMaxReadMemBytes	= GENCP_READMEM_MAX_BYTES;
+	*pMaxWriteMemBytes	= GENCP_READMEM_MAX_BYTES;
+
+	status = PdvGenCpReadUint( pPdv, REG_BRM_SBRM_ADDRESS, 8, &sbrmAddress );
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpReadUint( pPdv, sbrmAddress + REG_SBRM_MAX_CMD_TRANSFER_LENGTH, 4, &maxCmdLength );
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpReadUint( pPdv, sbrmAddress + REG_SBRM_MAX_ACK_TRANSFER_LENGTH, 4, &maxAckLength );
+	if ( status != GENCP_STATUS_SUCCESS )
+		return status;
 
-	if ( pBuffer != NULL )
-		*pBuffer = 0;
+	*pMaxReadMemBytes	= GenCpMaxReadMemPayload(  static_cast<uint32_t>( maxAckLength ) );
+	*pMaxWriteMemBytes	= GenCpMaxWriteMemPayload( static_cast<uint32_t>( maxCmdLength ) );
+	return GENCP_STATUS_SUCCESS;
+}
+
+/// PdvGenCpReadManifestEntry() Read XML manifest table entry iFileEntry, fields are left big endian
+GENCP_STATUS PdvGenCpReadManifestEntry(
+    EdtDev				*	pPdv,
+	unsigned int			iFileEntry,
+	GenCpManifestEntry	*	pEntry )
+{
+	const char		*	functionName = "PdvGenCpReadManifestEntry";
+	GENCP_STATUS		status;
 
 	uint64_t			addrManifestTable;
 	status = PdvGenCpReadUint( pPdv, REG_BRM_MANIFEST_TABLE_ADDRESS, 8, &addrManifestTable );
@@ -201,37 +348,50 @@ GENCP_STATUS PdvGenCpReadXmlFile(
 		return status;
 	}
 
-	GenCpManifestEntry	xmlFileEntry;
 	uint64_t addrFileEntry = addrManifestTable + sizeof(uint64_t) + iFileEntry * sizeof(GenCpManifestEntry);
 	status = PdvGenCpReadString( pPdv,					addrFileEntry,		sizeof(GenCpManifestEntry),
-								reinterpret_cast<char *>(&xmlFileEntry),	sizeof(GenCpManifestEntry) );
+								reinterpret_cast<char *>(pEntry),			sizeof(GenCpManifestEntry) );
 	if ( status != GENCP_STATUS_SUCCESS )
 	{
 		fprintf( stderr, "%s: GenCP Error reading manifest table entry: %0x04X\n", functionName, status );
 		return status;
 	}
-	uint32_t		xmlFileVersion	= GenCpBigEndianToCpu( xmlFileEntry.xmlFileVersion );
-	uint32_t		xmlFileSchema	= GenCpBigEndianToCpu( xmlFileEntry.xmlFileSchema );
-	uint64_t		xmlFileStart	= GenCpBigEndianToCpu( xmlFileEntry.xmlFileStart );
-	uint64_t		xmlFileSize		= GenCpBigEndianToCpu( xmlFileEntry.xmlFileSize );
+	return GENCP_STATUS_SUCCESS;
+}
 
-	unsigned char	*	pReadBuffer	= pBuffer;
-	size_t				sReadBuffer	= sBuffer;
+/// PdvGenCpReadXmlData() Read the XML file described by a manifest entry into pBuffer
+GENCP_STATUS PdvGenCpReadXmlData(
+    EdtDev					*	pPdv,
+	const GenCpManifestEntry *	pEntry,
+	unsigned char			*	pReadBuffer,
+	size_t						sReadBuffer )
+{
+	const char		*	functionName = "PdvGenCpReadXmlData";
+	GENCP_STATUS		status	= GENCP_STATUS_SUCCESS;
+	uint32_t			xmlFileVersion	= GenCpBigEndianToCpu( pEntry->xmlFileVersion );
+	uint64_t			xmlFileStart	= GenCpBigEndianToCpu( pEntry->xmlFileStart );
+	uint64_t			xmlFileSize		= GenCpBigEndianToCpu( pEntry->xmlFileSize );
 
 	if ( xmlFileSize > sReadBuffer )
 	{
 		fprintf( stderr, "%s GenCP Error: XML File size %zu > buffer size %zu.\n", functionName, xmlFileSize, sReadBuffer );
-		return status;
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
 	}
 
+	// Use the largest packets the device supports
+	size_t		maxReadMemBytes;
+	size_t		maxWriteMemBytes;
+	if ( PdvGenCpReadMaxPayload( pPdv, &maxReadMemBytes, &maxWriteMemBytes ) != GENCP_STATUS_SUCCESS )
+		fprintf( stderr, "%s: Unable to read SBRM, using %zu byte packets\n", functionName, maxReadMemBytes );
+
 	// Read the file
 	size_t		nBytesRead	= 0;
 	while ( nBytesRead < xmlFileSize )
 	{
 		size_t		nBytesReq	= xmlFileSize - nBytesRead;
 		char	*	nextAddr	= reinterpret_cast<char *>( pReadBuffer + nBytesRead );
-		if( nBytesReq > GENCP_READMEM_MAX_BYTES )
-			nBytesReq = GENCP_READMEM_MAX_BYTES;
+		if( nBytesReq > maxReadMemBytes )
+			nBytesReq = maxReadMemBytes;
 		status = PdvGenCpReadString( pPdv, xmlFileStart + nBytesRead, nBytesReq,
 									nextAddr, sReadBuffer - nBytesRead );
 		if ( status != GENCP_STATUS_SUCCESS )
@@ -241,6 +401,33 @@ GENCP_STATUS PdvGenCpReadXmlFile(
 		}
 		nBytesRead	+= nBytesReq;
 	}
+	return GENCP_STATUS_SUCCESS;
+}
+
+GENCP_STATUS PdvGenCpReadXmlFile(
+    EdtDev			*	pPdv,
+	unsigned int		iFileEntry,
+	unsigned char	*	pBuffer,
+	size_t				sBuffer,
+	const char		*	pFileName )
+{
+	const char		*	functionName = "PdvGenCpReadXmlFile";
+	GENCP_STATUS		status;
+
+	if ( pBuffer != NULL )
+		*pBuffer = 0;
+
+	GenCpManifestEntry	xmlFileEntry;
+	status = PdvGenCpReadManifestEntry( pPdv, iFileEntry, &xmlFileEntry );
+	if ( status != GENCP_STATUS_SUCCESS )
+		return status;
+	uint32_t		xmlFileSchema	= GenCpBigEndianToCpu( xmlFileEntry.xmlFileSchema );
+	uint64_t		xmlFileSize		= GenCpBigEndianToCpu( xmlFileEntry.xmlFileSize );
+
+	unsigned char	*	pReadBuffer	= pBuffer;
+	status = PdvGenCpReadXmlData( pPdv, &xmlFileEntry, pReadBuffer, sBuffer );
+	if ( status != GENCP_STATUS_SUCCESS )
+		return status;
 
 	char		tempFileName[100];
 	strncpy( tempFileName, pFileName, 100 );
@@ -255,7 +442,7 @@ GENCP_STATUS PdvGenCpReadXmlFile(
 		fprintf( stderr, "%s: GenCP unable to create temp file: %s\n", functionName, tempFileName );
 		return status;
 	}
-	(void) fwrite( pReadBuffer, sizeof(char), nBytesRead, outFile );
+	(void) fwrite( pReadBuffer, sizeof(char), xmlFileSize, outFile );
 	(void) fclose( outFile );
 	printf( "Genicam file written to %s\n", tempFileName );
 
@@ -281,6 +468,140 @@ GENCP_STATUS PdvGenCpReadXmlFile(
 	return GENCP_STATUS_SUCCESS;
 }
 
+/// PdvGenCpSetBaud() Ask the device to switch to sbrmBaudBit, then follow it on the host side
+/// and verify the link w/ a read
+GENCP_STATUS PdvGenCpSetBaud(
+    EdtDev			*	pPdv,
+	uint64_t			sbrmAddress,
+	unsigned int		iBit	)
+{
+	GENCP_STATUS		status;
+	uint64_t			gencpVersion;
+
+	// The device acks the change at the old rate, then switches
+	status = PdvGenCpWriteUint( pPdv, sbrmAddress + REG_SBRM_CURRENT_BAUDRATE, 4, 1 << iBit );
+	if ( status != GENCP_STATUS_SUCCESS )
+		return status;
+	usleep( GENCP_BAUD_SETTLE_US );
+	if ( pdv_set_baud( pPdv, GenCpSbrmBaudRate( iBit ) ) != 0 )
+		return GENCP_STATUS_WRONG_CONFIG | GENCP_SC_ERROR;
+	char		flushBuf[1000];
+	(void) pdv_serial_read( pPdv, flushBuf, 1000 );
+	return PdvGenCpReadUint( pPdv, REG_BRM_GENCP_VERSION, 4, &gencpVersion );
+}
+
+/// PdvGenCpNegotiateBaud() Switch the link to the fastest rate supported by both
+/// the device SBRM and maxBaud, falling back one rate at a time on errors
+GENCP_STATUS PdvGenCpNegotiateBaud(
+    EdtDev			*	pPdv,
+	unsigned int		maxBaud	)
+{
+	const char		*	functionName = "PdvGenCpNegotiateBaud";
+	GENCP_STATUS		status;
+	uint64_t			sbrmAddress;
+	uint64_t			supported;
+	uint64_t			capability;
+	int					hostBaud	= pdv_get_baud( pPdv );
+
+	// The baud rate registers are in the SBRM, which the device may not have
+	status = PdvGenCpReadUint( pPdv, REG_BRM_DEVICE_CAPABILITY, 8, &capability );
+	if ( status == GENCP_STATUS_SUCCESS && !( capability & GENCP_BRM_CAP_SBRM_SUPPORTED ) )
+	{
+		fprintf( stderr, "%s: Device has no SBRM, staying at %d baud\n", functionName, hostBaud );
+		return GENCP_STATUS_NOT_IMPL | GENCP_SC_ERROR;
+	}
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpReadUint( pPdv, REG_BRM_SBRM_ADDRESS, 8, &sbrmAddress );
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpReadUint( pPdv, sbrmAddress + REG_SBRM_SUPPORTED_BAUDRATES, 4, &supported );
+	if ( status != GENCP_STATUS_SUCCESS )
+	{
+		fprintf( stderr, "%s: Unable to read SBRM baud rates, staying at %d baud\n", functionName, hostBaud );
+		return status;
+	}
+
+	unsigned int	iHostBit	= GENCP_SBRM_BAUD_NUM_RATES;
+	for ( unsigned int iBit = 0; iBit < GENCP_SBRM_BAUD_NUM_RATES; iBit++ )
+		if ( static_cast<int>( GenCpSbrmBaudRate( iBit ) ) == hostBaud )
+			iHostBit = iBit;
+
+	for ( int iBit = GENCP_SBRM_BAUD_NUM_RATES - 1; iBit >= 0; iBit-- )
+	{
+		int		baud	= GenCpSbrmBaudRate( iBit );
+		if ( !( supported & ( 1 << iBit ) ) || baud > static_cast<int>( maxBaud ) )
+			continue;
+		if ( baud <= hostBaud )
+			break;
+		status = PdvGenCpSetBaud( pPdv, sbrmAddress, iBit );
+		if ( status == GENCP_STATUS_SUCCESS )
+		{
+			localGenCpOrigBaud	= hostBaud;
+			localGenCpSbrmAddr	= sbrmAddress;
+			printf( "Serial link upshifted from %d to %d baud\n", hostBaud, baud );
+			return GENCP_STATUS_SUCCESS;
+		}
+
+		// Put both ends back on the rate we know works and try the next one down
+		fprintf( stderr, "%s: Verify at %d baud failed, falling back\n", functionName, baud );
+		if ( iHostBit < GENCP_SBRM_BAUD_NUM_RATES )
+			(void) PdvGenCpWriteUint( pPdv, sbrmAddress + REG_SBRM_CURRENT_BAUDRATE, 4, 1 << iHostBit );
+		usleep( GENCP_BAUD_SETTLE_US );
+		(void) pdv_set_baud( pPdv, hostBaud );
+		char		flushBuf[1000];
+		(void) pdv_serial_read( pPdv, flushBuf, 1000 );
+	}
+	return GENCP_STATUS_SUCCESS;
+}
+
+/// Open a serial handle to an EDT channel and flush any stale input
+/// Upshifts the link if --baud was given
+/// Returns NULL if the unit/channel can't be opened
+EdtDev * EdtGenCpOpen(
+	unsigned int		iUnit,
+	unsigned int		iChannel,
+	bool				fQuiet	)
+{
+	EdtDev			*	pPdv;
+
+	pPdv = pdv_open_channel( EDT_INTERFACE, iUnit, iChannel );
+	if ( pPdv == NULL )
+	{
+		if ( !fQuiet )
+			pdv_perror( (char *) EDT_INTERFACE );
+		return NULL;
+	}
+	pdv_serial_read_enable( pPdv );
+    // Flush the read buffer
+	char		flushBuf[1000];
+	(void) pdv_serial_read( pPdv, flushBuf, 1000 );
+
+	localGenCpOrigBaud	= 0;
+	if ( localGenCpMaxBaud > 0 )
+		(void) PdvGenCpNegotiateBaud( pPdv, localGenCpMaxBaud );
+	return pPdv;
+}
+
+/// Close a handle from EdtGenCpOpen(), returning the link to its configured baud rate
+/// so the next open finds the device where the EDT config expects it
+void EdtGenCpClose(
+    EdtDev			*	pPdv	)
+{
+	if ( localGenCpOrigBaud > 0 )
+	{
+		for ( unsigned int iBit = 0; iBit < GENCP_SBRM_BAUD_NUM_RATES; iBit++ )
+		{
+			if ( static_cast<int>( GenCpSbrmBaudRate( iBit ) ) != localGenCpOrigBaud )
+				continue;
+			(void) PdvGenCpWriteUint( pPdv, localGenCpSbrmAddr + REG_SBRM_CURRENT_BAUDRATE, 4, 1 << iBit );
+			usleep( GENCP_BAUD_SETTLE_US );
+			break;
+		}
+		(void) pdv_set_baud( pPdv, localGenCpOrigBaud );
+		localGenCpOrigBaud	= 0;
+	}
+	pdv_close( pPdv );
+}
+
 
 GENCP_STATUS EdtGenCpReadUint(
 	unsigned int		iUnit,
@@ -296,22 +617,15 @@ GENCP_STATUS EdtGenCpReadUint(
 	if ( pnResult != NULL )
 		*pnResult = result;
 
-    /* open a handle to the device     */
-    pPdv = pdv_open_channel(EDT_INTERFACE, iUnit, iChannel);
-    if ( pPdv == NULL )
-    {
-        pdv_perror( (char *) EDT_INTERFACE );
-        return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
-    }
-	pdv_serial_read_enable( pPdv );
-    // Flush the read buffer
-	char		flushBuf[1000];
-	(void) pdv_serial_read( pPdv, flushBuf, 1000 );
+	/* open a handle to the device     */
+	pPdv = EdtGenCpOpen( iUnit, iChannel, false );
+	if ( pPdv == NULL )
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
 
 
 	status = PdvGenCpReadUint( pPdv, regAddr, numBytes, &result );
 
-	pdv_close( pPdv );
+	EdtGenCpClose( pPdv );
 
 	if ( status != GENCP_STATUS_SUCCESS )
 	{
@@ -328,6 +642,33 @@ GENCP_STATUS EdtGenCpReadUint(
 }
 
 
+GENCP_STATUS EdtGenCpWriteUint(
+	unsigned int		iUnit,
+	unsigned int		iChannel,
+	uint64_t			regAddr,
+	size_t				numBytes,
+	uint64_t			value	)
+{
+	GENCP_STATUS		status;
+    EdtDev			*	pPdv;
+
+	/* open a handle to the device     */
+	pPdv = EdtGenCpOpen( iUnit, iChannel, false );
+	if ( pPdv == NULL )
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+
+	status = PdvGenCpWriteUint( pPdv, regAddr, numBytes, value );
+
+	EdtGenCpClose( pPdv );
+
+	if ( status != GENCP_STATUS_SUCCESS )
+		fprintf( stderr, "Error writing %zu bytes to regAddr 0x%08lX\n", numBytes, regAddr );
+	else
+		printf( "regAddr 0x%08lX written with %lu = 0x%lx\n", regAddr, value, value );
+	return status;
+}
+
+
 GENCP_STATUS EdtGenCpReadString(
 	unsigned int		iUnit,
 	unsigned int		iChannel,
@@ -342,21 +683,14 @@ GENCP_STATUS EdtGenCpReadString(
 	if ( pBuffer != NULL )
 		*pBuffer = 0;
 
-    /* open a handle to the device     */
-    pPdv = pdv_open_channel(EDT_INTERFACE, iUnit, iChannel);
-    if ( pPdv == NULL )
-    {
-        pdv_perror( (char *) EDT_INTERFACE );
-        return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
-    }
-	pdv_serial_read_enable( pPdv );
-    // Flush the read buffer
-	char		flushBuf[1000];
-	(void) pdv_serial_read( pPdv, flushBuf, 1000 );
+	/* open a handle to the device     */
+	pPdv = EdtGenCpOpen( iUnit, iChannel, false );
+	if ( pPdv == NULL )
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
 
 	status = PdvGenCpReadString( pPdv, regAddr, numBytes, pBuffer, sBuffer );
 
-	pdv_close( pPdv );
+	EdtGenCpClose( pPdv );
 
 	if ( status != GENCP_STATUS_SUCCESS )
 	{
@@ -386,21 +720,14 @@ GENCP_STATUS EdtGenCpReadXmlFile(
 	if ( pBuffer != NULL )
 		*pBuffer = 0;
 
-    /* open a handle to the device     */
-    pPdv = pdv_open_channel((char *) EDT_INTERFACE, iUnit, iChannel);
-    if ( pPdv == NULL )
-    {
-        pdv_perror( (char *) EDT_INTERFACE );
-        return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
-    }
-	pdv_serial_read_enable( pPdv );
-    // Flush the read buffer
-	char		flushBuf[1000];
-	(void) pdv_serial_read( pPdv, flushBuf, 1000 );
+	/* open a handle to the device     */
+	pPdv = EdtGenCpOpen( iUnit, iChannel, false );
+	if ( pPdv == NULL )
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
 
 	status = PdvGenCpReadXmlFile( pPdv, iFileEntry, pBuffer, sBuffer, pFileName );
 
-	pdv_close( pPdv );
+	EdtGenCpClose( pPdv );
 
 	if ( status != GENCP_STATUS_SUCCESS )
 	{
@@ -411,58 +738,926 @@ GENCP_STATUS EdtGenCpReadXmlFile(
 }
 
 
-int main( int argc, char **argv )
+/// EdtGenCpCompileMap() Compile the camera's XML file into a register map file in pMapDir.
+/// The map is keyed by the camera's manifest SHA1.  If pXmlFileName is given, the XML is
+/// read from that file instead of the camera, e.g. after unzipping a compressed XML.
+GENCP_STATUS EdtGenCpCompileMap(
+	unsigned int		iUnit,
+	unsigned int		iChannel,
+	unsigned int		iFileEntry,
+	const char		*	pXmlFileName,
+	const char		*	pMapDir	)
 {
-	int				status;
-    unsigned int	channel = 0;
-    unsigned int	unit 	= 0;
-	unsigned int	iFile	= 0;
-    bool	     	verbose = FALSE;
+	const char		*	functionName = "EdtGenCpCompileMap";
+	GENCP_STATUS		status;
+    EdtDev			*	pPdv;
 
-    for ( int iArg = 1; iArg < argc; iArg++ )
-    {
-		if	(	strcmp( argv[iArg], "-c" ) == 0
-			||	strcmp( argv[iArg], "--channel" ) == 0 )
+	/* open a handle to the device     */
+	pPdv = EdtGenCpOpen( iUnit, iChannel, false );
+	if ( pPdv == NULL )
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+
+	GenCpManifestEntry	xmlFileEntry;
+	status = PdvGenCpReadManifestEntry( pPdv, iFileEntry, &xmlFileEntry );
+	if ( status != GENCP_STATUS_SUCCESS )
+	{
+		EdtGenCpClose( pPdv );
+		return status;
+	}
+	uint32_t		xmlFileSchema	= GenCpBigEndianToCpu( xmlFileEntry.xmlFileSchema );
+	uint64_t		xmlFileSize		= GenCpBigEndianToCpu( xmlFileEntry.xmlFileSize );
+
+	std::vector<char>	xml;
+	if ( pXmlFileName != NULL )
+	{
+		EdtGenCpClose( pPdv );
+		FILE	*	inFile	= fopen( pXmlFileName, "rb" );
+		if ( inFile == NULL )
 		{
-			if ( ++iArg >= argc )
-			{
-				usage( "Error: Missing channel number.\n" );
-				exit( -1 );
-			}
-			channel = atoi( argv[iArg] );
+			fprintf( stderr, "%s: Unable to open %s\n", functionName, pXmlFileName );
+			return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
 		}
-		else if (	strcmp( argv[iArg], "-u" ) == 0
-				||	strcmp( argv[iArg], "--unit" ) == 0 )
-        {
-			if ( ++iArg >= argc )
-			{
-				usage( "Error: Missing unit number.\n" );
-				exit( -1 );
-			}
-			unit = atoi( argv[iArg] );
+		char		buffer[4096];
+		size_t		nRead;
+		while ( ( nRead = fread( buffer, 1, sizeof(buffer), inFile ) ) > 0 )
+			xml.insert( xml.end(), buffer, buffer + nRead );
+		(void) fclose( inFile );
+	}
+	else
+	{
+		if ( GENCP_MFT_ENTRY_SCHEMA_TYPE(xmlFileSchema) == GENCP_MFT_ENTRY_SCHEMA_TYPE_ZIP )
+		{
+			EdtGenCpClose( pPdv );
+			fprintf( stderr,	"%s: Camera XML is zipped.  Read it w/ --readXml, unzip it, "
+								"and pass the XML file w/ --compileXml\n", functionName );
+			return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
 		}
-		else if (	strncmp( argv[iArg], "--C", 3 ) == 0 )
+		if ( xmlFileSize == 0 || xmlFileSize > GENCP_REGMAP_MAX_XML_BYTES )
 		{
-			char			buffer[1001];
-			unsigned int	numBytes	= atoi( &argv[iArg][3] );
-			if ( numBytes == 0 || numBytes > 1000 )
-			{
-				fprintf( stderr, "Invalid number of bytes for --C option: %s\n", argv[iArg] );
-				exit( 1 );
-			}
-			iArg++;
-			if ( iArg >= argc )
-			{
-				usage( "Error: Missing address.\n" );
-				exit( -1 );
-			}
-
-			uint64_t		regAddr		= strtoull( argv[iArg], NULL, 0 );
-			status = EdtGenCpReadString( unit, channel, regAddr, numBytes, buffer, 1000 );
+			EdtGenCpClose( pPdv );
+			fprintf( stderr, "%s GenCP Error: XML file size %llu not in 1..%u bytes.\n", functionName,
+					(long long unsigned int) xmlFileSize, GENCP_REGMAP_MAX_XML_BYTES );
+			return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
 		}
-		else if (	strncmp( argv[iArg], "--U", 3 ) == 0 )
+		xml.resize( xmlFileSize );
+		status = PdvGenCpReadXmlData(	pPdv, &xmlFileEntry,
+										reinterpret_cast<unsigned char *>( &xml[0] ), xml.size() );
+		EdtGenCpClose( pPdv );
+		if ( status != GENCP_STATUS_SUCCESS )
+			return status;
+
+		uint8_t		xmlFileSHA1[GENCP_MFT_ENTRY_SHA1_SIZE];
+		SHA1( reinterpret_cast<unsigned char *>( &xml[0] ), xml.size(), xmlFileSHA1 );
+		if ( memcmp( xmlFileSHA1, xmlFileEntry.xmlFileSHA1, GENCP_MFT_ENTRY_SHA1_SIZE ) != 0 )
 		{
-       		//   --U32 Addr  Read 32 bit unsigned value from address\n"
+			fprintf( stderr, "%s GenCP Error: SHA1 hash does not match!\n", functionName );
+			return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+		}
+	}
+
+	std::vector<uint8_t>	image;
+	std::string				errorMsg;
+	status = GenCpRegMapCompile( xml.empty() ? "" : &xml[0], xml.size(), xmlFileEntry.xmlFileSHA1, image, errorMsg );
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = GenCpRegMapWrite( pMapDir, xmlFileEntry.xmlFileSHA1, image, errorMsg );
+	if ( status != GENCP_STATUS_SUCCESS )
+	{
+		fprintf( stderr, "%s: %s\n", functionName, errorMsg.c_str() );
+		return status;
+	}
+
+	char		mapFileName[1024];
+	GenCpRegMapFileName( pMapDir, xmlFileEntry.xmlFileSHA1, mapFileName, sizeof(mapFileName) );
+	const GenCpRegMapHeader	*	pHeader	= reinterpret_cast<const GenCpRegMapHeader *>( &image[0] );
+	printf( "Register map w/ %u entries written to %s\n", pHeader->nEntries, mapFileName );
+	return GENCP_STATUS_SUCCESS;
+}
+
+
+/// FileAccessControl features of a camera, resolved through its register map
+/// Enum values are looked up by EnumEntry name, as cameras needn't use the SFNC numbering
+typedef struct
+{
+    EdtDev					*	pPdv;
+	const GenCpRegMap		*	pMap;
+	const GenCpRegMapEntry	*	pBuffer;		// FileAccessBuffer
+	size_t						maxReadMemBytes;
+	size_t						maxWriteMemBytes;
+	const char				*	pOpSelected;	// FileOperationSelector last written, NULL if not yet
+	int64_t						lengthSet;		// FileAccessLength last written, -1 if not yet
+}	GenCpFileAccess;
+
+/// PdvGenCpWriteBytes() Write numBytes of raw register data to regAddr in one WriteMem,
+/// waiting out pending acks for up to nMsTimeout in all, e.g. while a file op runs
+static GENCP_STATUS PdvGenCpWriteBytes(
+    EdtDev			*	pPdv,
+	uint64_t			regAddr,
+	const void		*	pData,
+	size_t				numBytes,
+	int					nMsTimeout	)
+{
+	const char		*	functionName = "PdvGenCpWriteBytes";
+	GENCP_STATUS		status;
+	GenCpWriteMemPacket	writeMemPacket;
+	GenCpWriteMemAck	ackPacket;
+	size_t				nBytesSend	= 0;
+	uint16_t			requestId	= localGenCpRequestId++;
+
+	status = GenCpInitWriteMemPacket(	&writeMemPacket, requestId, regAddr, numBytes,
+										reinterpret_cast<const char *>( pData ), &nBytesSend );
+	if ( status != GENCP_STATUS_SUCCESS )
+	{
+		fprintf( stderr, "%s: GenCP Error: 0x%04X\n", functionName, status );
+		return status;
+	}
+
+	if ( pdv_serial_write( pPdv, reinterpret_cast<char *>( &writeMemPacket ), nBytesSend ) != 0 )
+	{
+		fprintf( stderr, "%s Error: Serial write of %zu bytes failed!\n", functionName, nBytesSend );
+		return GENCP_STATUS_GENERIC_ERROR | GENCP_SC_ERROR;
+	}
+	double		tGiveUp		= GenCpToolTimeMs( ) + nMsTimeout;
+	int			nMsWait		= GENCP_TOOL_TIMEOUT_MS;
+	for ( ;; )
+	{
+		int		nRead	= PdvGenCpReadReply( pPdv, reinterpret_cast<char *>(&ackPacket), sizeof(ackPacket), nMsWait );
+		if ( nRead <= 0 )
+		{
+			fprintf( stderr, "%s Error: Timeout with no reply!\n", functionName );
+			return GENCP_STATUS_MSG_TIMEOUT | GENCP_SC_ERROR;
+		}
+		if ( GenCpBigEndianToCpu( ackPacket.ccd.ccdCommandId ) != GENCP_ID_PENDING_ACK )
+			break;
+
+		// The device needs longer, the ack follows the pending ack
+		uint16_t	msPending	= 0;
+		status = GenCpProcessPendingAck( reinterpret_cast<GenCpPendingAck *>( &ackPacket ), requestId, &msPending );
+		if ( status != GENCP_STATUS_SUCCESS )
+			return status;
+		if ( GenCpToolTimeMs( ) + msPending > tGiveUp )
+		{
+			fprintf( stderr, "%s Error: Device asks for %u ms more, giving up\n", functionName, msPending );
+			return GENCP_STATUS_MSG_TIMEOUT | GENCP_SC_ERROR;
+		}
+		nMsWait	= msPending + GENCP_TOOL_TIMEOUT_MS;
+	}
+
+	status = GenCpValidateWriteMemAck( &ackPacket, requestId );
+	if ( status != GENCP_STATUS_SUCCESS )
+	{
+		fprintf( stderr, "GenCP WriteMem Validate Error: %d (0x%X)\n", status, status );
+		return status;
+	}
+	return GENCP_STATUS_SUCCESS;
+}
+
+/// PdvGenCpFindFeature() Look up a register backed integer feature in the map
+static const GenCpRegMapEntry * PdvGenCpFindFeature(
+	const GenCpRegMap	*	pMap,
+	const char			*	pName	)
+{
+	const GenCpRegMapEntry	*	pEntry	= pMap->Find( pName );
+	if (	pEntry == NULL || ( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA )
+		||	pEntry->length == 0 || pEntry->length > sizeof(uint64_t) )
+	{
+		fprintf( stderr, "Camera has no register for %s, FileAccessControl not supported\n", pName );
+		return NULL;
+	}
+	return pEntry;
+}
+
+/// PdvGenCpReadFeature() Read an integer feature, w/ its byte order and bit field applied
+static GENCP_STATUS PdvGenCpReadFeature(
+	GenCpFileAccess		*	pAccess,
+	const char			*	pName,
+	uint64_t			*	pValue	)
+{
+	const GenCpRegMapEntry	*	pEntry	= PdvGenCpFindFeature( pAccess->pMap, pName );
+	uint8_t						regData[sizeof(uint64_t)];
+	if ( pEntry == NULL )
+		return GENCP_STATUS_INVALID_ADDR | GENCP_SC_ERROR;
+	GENCP_STATUS	status	= PdvGenCpReadString(	pAccess->pPdv, pEntry->address, pEntry->length,
+													reinterpret_cast<char *>( regData ), sizeof(regData) );
+	if ( status == GENCP_STATUS_SUCCESS )
+		*pValue	= GenCpRegMapDecodeInt( pEntry, regData );
+	return status;
+}
+
+/// PdvGenCpWriteFeature() Write an integer feature, read-modify-write for bit fields
+static GENCP_STATUS PdvGenCpWriteFeature(
+	GenCpFileAccess		*	pAccess,
+	const char			*	pName,
+	uint64_t				value,
+	int						nMsTimeout	)
+{
+	const GenCpRegMapEntry	*	pEntry	= PdvGenCpFindFeature( pAccess->pMap, pName );
+	uint8_t						regData[sizeof(uint64_t)];
+	GENCP_STATUS				status;
+	if ( pEntry == NULL )
+		return GENCP_STATUS_INVALID_ADDR | GENCP_SC_ERROR;
+
+	uint64_t	rawValue	= value;
+	if ( pEntry->flags & GENCP_REGMAP_FLAG_MASKED )
+	{
+		status = PdvGenCpReadString(	pAccess->pPdv, pEntry->address, pEntry->length,
+										reinterpret_cast<char *>( regData ), sizeof(regData) );
+		if ( status != GENCP_STATUS_SUCCESS )
+			return status;
+		unsigned int	nBits	= pEntry->msb - pEntry->lsb + 1;
+		uint64_t		mask	= ( ( nBits < 64 ) ? ( 1ULL << nBits ) - 1 : ~0ULL ) << pEntry->lsb;
+		rawValue	= 0;
+		for ( size_t iByte = 0; iByte < pEntry->length; iByte++ )
+		{
+			if ( pEntry->endian == GENCP_REGMAP_ENDIAN_BIG )
+				rawValue	= ( rawValue << 8 ) | regData[iByte];
+			else
+				rawValue	|= static_cast<uint64_t>( regData[iByte] ) << ( 8 * iByte );
+		}
+		rawValue	= ( rawValue & ~mask ) | ( ( value << pEntry->lsb ) & mask );
+	}
+	for ( size_t iByte = 0; iByte < pEntry->length; iByte++ )
+	{
+		size_t		iShift	= ( pEntry->endian == GENCP_REGMAP_ENDIAN_BIG ) ? pEntry->length - 1 - iByte : iByte;
+		regData[iByte]	= static_cast<uint8_t>( rawValue >> ( 8 * iShift ) );
+	}
+	return PdvGenCpWriteBytes( pAccess->pPdv, pEntry->address, regData, pEntry->length, nMsTimeout );
+}
+
+/// PdvGenCpEnumValue() Value of EnumEntry pEnumName of enum feature pName
+/// A numeric pEnumName is taken as the value if the enum has no entry by that name
+static GENCP_STATUS PdvGenCpEnumValue(
+	GenCpFileAccess		*	pAccess,
+	const char			*	pName,
+	const char			*	pEnumName,
+	uint64_t			*	pValue	)
+{
+	const GenCpRegMapEntry	*	pEntry	= PdvGenCpFindFeature( pAccess->pMap, pName );
+	int64_t						value;
+	char					*	pEnd;
+	if ( pEntry == NULL )
+		return GENCP_STATUS_INVALID_ADDR | GENCP_SC_ERROR;
+	if ( pAccess->pMap->EnumValue( pEntry, pEnumName, &value ) )
+	{
+		*pValue	= static_cast<uint64_t>( value );
+		return GENCP_STATUS_SUCCESS;
+	}
+	value	= strtoll( pEnumName, &pEnd, 0 );
+	if ( pEnd != pEnumName && *pEnd == '\0' )
+	{
+		*pValue	= static_cast<uint64_t>( value );
+		return GENCP_STATUS_SUCCESS;
+	}
+	fprintf( stderr, "Camera's %s has no EnumEntry %s\n", pName, pEnumName );
+	return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+}
+
+/// PdvGenCpWriteEnum() Write enum feature pName by EnumEntry name
+static GENCP_STATUS PdvGenCpWriteEnum(
+	GenCpFileAccess		*	pAccess,
+	const char			*	pName,
+	const char			*	pEnumName,
+	int						nMsTimeout	)
+{
+	uint64_t		value;
+	GENCP_STATUS	status	= PdvGenCpEnumValue( pAccess, pName, pEnumName, &value );
+	if ( status != GENCP_STATUS_SUCCESS )
+		return status;
+	return PdvGenCpWriteFeature( pAccess, pName, value, nMsTimeout );
+}
+
+/// PdvGenCpFileOperation() Run a file operation, checking FileOperationStatus
+/// Returns FileOperationResult, e.g. the bytes read or written, in pResult
+static GENCP_STATUS PdvGenCpFileOperation(
+	GenCpFileAccess		*	pAccess,
+	const char			*	pOperation,
+	uint64_t			*	pResult	)
+{
+	const char		*	functionName = "PdvGenCpFileOperation";
+	GENCP_STATUS		status	= GENCP_STATUS_SUCCESS;
+	uint64_t			opStatus;
+	uint64_t			opSuccess;
+
+	if ( pAccess->pOpSelected == NULL || strcmp( pAccess->pOpSelected, pOperation ) != 0 )
+	{
+		status = PdvGenCpWriteEnum( pAccess, "FileOperationSelector", pOperation, GENCP_TOOL_TIMEOUT_MS );
+		if ( status != GENCP_STATUS_SUCCESS )
+			return status;
+		pAccess->pOpSelected	= pOperation;
+	}
+	status = PdvGenCpWriteFeature( pAccess, "FileOperationExecute", 1, GENCP_FILE_TIMEOUT_MS );
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpReadFeature( pAccess, "FileOperationStatus", &opStatus );
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpEnumValue( pAccess, "FileOperationStatus", GENCP_FILE_STATUS_SUCCESS, &opSuccess );
+	if ( status != GENCP_STATUS_SUCCESS )
+		return status;
+	if ( opStatus != opSuccess )
+	{
+		fprintf( stderr, "%s: File operation %s failed, status %llu\n", functionName, pOperation,
+				(long long unsigned int) opStatus );
+		return GENCP_STATUS_GENERIC_ERROR | GENCP_SC_ERROR;
+	}
+	return PdvGenCpReadFeature( pAccess, "FileOperationResult", pResult );
+}
+
+/// PdvGenCpFileTransfer() Write or read one FileAccessBuffer of file data at offset,
+/// the buffer in max size WriteMem or ReadMem packets.  Returns the bytes moved.
+static GENCP_STATUS PdvGenCpFileTransfer(
+	GenCpFileAccess		*	pAccess,
+	bool					fWrite,
+	uint64_t				offset,
+	uint8_t				*	pData,
+	size_t					numBytes,
+	size_t				*	pnMoved	)
+{
+	GENCP_STATUS		status	= GENCP_STATUS_SUCCESS;
+	uint64_t			result	= 0;
+	size_t				maxPacket	= fWrite ? pAccess->maxWriteMemBytes : pAccess->maxReadMemBytes;
+
+	*pnMoved	= 0;
+	for ( size_t iByte = 0; fWrite && iByte < numBytes && status == GENCP_STATUS_SUCCESS; iByte += maxPacket )
+	{
+		size_t		nPacket	= ( numBytes - iByte < maxPacket ) ? numBytes - iByte : maxPacket;
+		status = PdvGenCpWriteBytes( pAccess->pPdv, pAccess->pBuffer->address + iByte, pData + iByte, nPacket,
+									GENCP_TOOL_TIMEOUT_MS );
+	}
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpWriteFeature( pAccess, "FileAccessOffset", offset, GENCP_TOOL_TIMEOUT_MS );
+	if ( status == GENCP_STATUS_SUCCESS && pAccess->lengthSet != static_cast<int64_t>( numBytes ) )
+	{
+		// Only the last transfer is short, so this is mostly written once
+		status = PdvGenCpWriteFeature( pAccess, "FileAccessLength", numBytes, GENCP_TOOL_TIMEOUT_MS );
+		pAccess->lengthSet	= ( status == GENCP_STATUS_SUCCESS ) ? static_cast<int64_t>( numBytes ) : -1;
+	}
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpFileOperation( pAccess, fWrite ? GENCP_FILE_OP_WRITE : GENCP_FILE_OP_READ, &result );
+	if ( status != GENCP_STATUS_SUCCESS )
+		return status;
+	if ( result > numBytes )
+		result	= numBytes;
+
+	for ( size_t iByte = 0; !fWrite && iByte < result && status == GENCP_STATUS_SUCCESS; iByte += maxPacket )
+	{
+		size_t		nPacket	= ( result - iByte < maxPacket ) ? result - iByte : maxPacket;
+		status = PdvGenCpReadString( pAccess->pPdv, pAccess->pBuffer->address + iByte, nPacket,
+									reinterpret_cast<char *>( pData + iByte ), nPacket );
+	}
+	*pnMoved	= result;
+	return status;
+}
+
+/// PdvGenCpFileOpen() Select a file and open it in the given FileOpenMode
+static GENCP_STATUS PdvGenCpFileOpen(
+	GenCpFileAccess		*	pAccess,
+	unsigned int			fileSelector,
+	const char			*	pOpenMode	)
+{
+	uint64_t			result;
+	GENCP_STATUS		status;
+	status = PdvGenCpWriteFeature( pAccess, "FileSelector", fileSelector, GENCP_TOOL_TIMEOUT_MS );
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpWriteEnum( pAccess, "FileOpenMode", pOpenMode, GENCP_TOOL_TIMEOUT_MS );
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpFileOperation( pAccess, GENCP_FILE_OP_OPEN, &result );
+	return status;
+}
+
+/// GenCpToolReadCheckpoint() Offset a previous upload of the file w/ hash pSha1 got to, 0 if none
+static uint64_t GenCpToolReadCheckpoint(
+	const char			*	pCheckpointName,
+	const uint8_t		*	pSha1,
+	unsigned int			fileSelector	)
+{
+	char				sha1Hex[2 * SHA_DIGEST_LENGTH + 1];
+	char				savedHex[2 * SHA_DIGEST_LENGTH + 1];
+	unsigned int		savedSelector;
+	unsigned long long	savedOffset;
+	FILE			*	pFile	= fopen( pCheckpointName, "r" );
+	if ( pFile == NULL )
+		return 0;
+	int		nScan	= fscanf( pFile, "%40s %u %llu", savedHex, &savedSelector, &savedOffset );
+	(void) fclose( pFile );
+
+	for ( size_t i = 0; i < SHA_DIGEST_LENGTH; i++ )
+		snprintf( &sha1Hex[2 * i], 3, "%02x", pSha1[i] );
+	if ( nScan != 3 || strcmp( sha1Hex, savedHex ) != 0 || savedSelector != fileSelector )
+		return 0;
+	return savedOffset;
+}
+
+/// GenCpToolWriteCheckpoint() Save the offset uploaded so far, replacing the file atomically
+static void GenCpToolWriteCheckpoint(
+	const char			*	pCheckpointName,
+	const uint8_t		*	pSha1,
+	unsigned int			fileSelector,
+	uint64_t				offset	)
+{
+	std::string		tempName	= std::string( pCheckpointName ) + ".tmp";
+	FILE		*	pFile		= fopen( tempName.c_str(), "w" );
+	if ( pFile == NULL )
+		return;
+	for ( size_t i = 0; i < SHA_DIGEST_LENGTH; i++ )
+		fprintf( pFile, "%02x", pSha1[i] );
+	fprintf( pFile, " %u %llu\n", fileSelector, (long long unsigned int) offset );
+	if ( fclose( pFile ) == 0 )
+		(void) rename( tempName.c_str(), pCheckpointName );
+}
+
+/// EdtGenCpUploadFile() Write a local file to the camera file pFileSelector via FileAccessControl,
+/// resuming from the checkpoint of an interrupted upload of the same file, then read it back
+/// and check its SHA1.  The feature addresses and enum values come from the camera's map in pMapDir.
+GENCP_STATUS EdtGenCpUploadFile(
+	unsigned int		iUnit,
+	unsigned int		iChannel,
+	unsigned int		iFileEntry,
+	const char		*	pMapDir,
+	const char		*	pFileSelector,
+	const char		*	pFileName	)
+{
+	const char		*	functionName = "EdtGenCpUploadFile";
+	GENCP_STATUS		status;
+    EdtDev			*	pPdv;
+	uint64_t			fileSelector	= 0;
+
+	std::vector<uint8_t>	data;
+	FILE	*	inFile	= fopen( pFileName, "rb" );
+	if ( inFile == NULL )
+	{
+		fprintf( stderr, "%s: Unable to open %s\n", functionName, pFileName );
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
+	uint8_t		buffer[4096];
+	size_t		nRead;
+	while ( ( nRead = fread( buffer, 1, sizeof(buffer), inFile ) ) > 0 )
+		data.insert( data.end(), buffer, buffer + nRead );
+	(void) fclose( inFile );
+	uint8_t		fileSHA1[SHA_DIGEST_LENGTH];
+	SHA1( data.empty() ? buffer : &data[0], data.size(), fileSHA1 );
+
+	/* open a handle to the device     */
+	pPdv = EdtGenCpOpen( iUnit, iChannel, false );
+	if ( pPdv == NULL )
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+
+	GenCpManifestEntry	xmlFileEntry;
+	GenCpRegMap			regMap;
+	std::string			errorMsg;
+	status = PdvGenCpReadManifestEntry( pPdv, iFileEntry, &xmlFileEntry );
+	if ( status == GENCP_STATUS_SUCCESS )
+	{
+		status = regMap.Load( pMapDir, xmlFileEntry.xmlFileSHA1, errorMsg );
+		if ( status != GENCP_STATUS_SUCCESS )
+			fprintf( stderr, "%s: %s, compile it w/ --compileMap first\n", functionName, errorMsg.c_str() );
+	}
+
+	GenCpFileAccess		access;
+	access.pPdv			= pPdv;
+	access.pMap			= &regMap;
+	access.pBuffer		= NULL;
+	access.pOpSelected	= NULL;
+	access.lengthSet	= -1;
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpReadMaxPayload( pPdv, &access.maxReadMemBytes, &access.maxWriteMemBytes );
+	if ( status == GENCP_STATUS_SUCCESS )
+	{
+		access.pBuffer	= regMap.Find( "FileAccessBuffer" );
+		if ( access.pBuffer == NULL || access.pBuffer->length == 0 )
+		{
+			fprintf( stderr, "%s: Camera has no FileAccessBuffer, FileAccessControl not supported\n", functionName );
+			status = GENCP_STATUS_INVALID_ADDR | GENCP_SC_ERROR;
+		}
+	}
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpEnumValue( &access, "FileSelector", pFileSelector, &fileSelector );
+	if ( status != GENCP_STATUS_SUCCESS )
+	{
+		EdtGenCpClose( pPdv );
+		return status;
+	}
+
+	// Resume where an interrupted upload of the same file stopped, keeping what it wrote
+	std::string		checkpointName	= std::string( pFileName ) + GENCP_FILE_CHECKPOINT_SUFFIX;
+	uint64_t		offset			= GenCpToolReadCheckpoint( checkpointName.c_str(), fileSHA1, fileSelector );
+	if ( offset > data.size() )
+		offset	= 0;
+	if ( offset > 0 )
+	{
+		status = PdvGenCpFileOpen( &access, fileSelector, GENCP_FILE_MODE_READWRITE );
+		if ( status == GENCP_STATUS_SUCCESS )
+			printf( "Resuming upload of %s at %llu of %zu bytes\n", pFileName, (long long unsigned int) offset, data.size() );
+		else
+		{
+			fprintf( stderr, "%s: Unable to reopen file %s to resume, starting over\n", functionName, pFileSelector );
+			offset	= 0;
+		}
+	}
+	if ( offset == 0 )
+		status = PdvGenCpFileOpen( &access, fileSelector, GENCP_FILE_MODE_WRITE );
+
+	size_t		sChunk		= access.pBuffer->length;
+	uint64_t	checkpoint	= offset;
+	double		tStart		= GenCpToolTimeMs( );
+	uint64_t	offsetStart	= offset;
+	while ( status == GENCP_STATUS_SUCCESS && offset < data.size() )
+	{
+		size_t		nChunk	= ( data.size() - offset < sChunk ) ? data.size() - offset : sChunk;
+		size_t		nMoved;
+		status = PdvGenCpFileTransfer( &access, true, offset, &data[offset], nChunk, &nMoved );
+		if ( status == GENCP_STATUS_SUCCESS && nMoved == 0 )
+		{
+			fprintf( stderr, "%s: Camera wrote nothing at %llu, file full?\n", functionName, (long long unsigned int) offset );
+			status = GENCP_STATUS_GENERIC_ERROR | GENCP_SC_ERROR;
+		}
+		if ( status != GENCP_STATUS_SUCCESS )
+			break;
+		offset	+= nMoved;
+		if ( offset - checkpoint >= GENCP_FILE_CHECKPOINT_BYTES || offset == data.size() )
+		{
+			GenCpToolWriteCheckpoint( checkpointName.c_str(), fileSHA1, fileSelector, offset );
+			checkpoint	= offset;
+			double	tElapsed	= ( GenCpToolTimeMs( ) - tStart ) * 1e-3;
+			printf( "\r%llu of %zu bytes, %.1f kB/s", (long long unsigned int) offset, data.size(),
+					tElapsed > 0 ? ( offset - offsetStart ) / tElapsed * 1e-3 : 0.0 );
+			fflush( stdout );
+		}
+	}
+	if ( offset > offsetStart )
+		putchar( '\n' );
+	uint64_t	result;
+	if ( status != GENCP_STATUS_SUCCESS )
+	{
+		fprintf( stderr, "%s: Upload stopped at %llu of %zu bytes, run again to resume\n", functionName,
+				(long long unsigned int) offset, data.size() );
+		(void) PdvGenCpFileOperation( &access, GENCP_FILE_OP_CLOSE, &result );
+		EdtGenCpClose( pPdv );
+		return status;
+	}
+	status = PdvGenCpFileOperation( &access, GENCP_FILE_OP_CLOSE, &result );
+
+	// Verify by hashing the file as read back, w/o holding a second copy
+	SHA_CTX		sha1Ctx;
+	uint8_t		readSHA1[SHA_DIGEST_LENGTH];
+	uint64_t	nVerified	= 0;
+	std::vector<uint8_t>	chunk( sChunk );
+	SHA1_Init( &sha1Ctx );
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpFileOpen( &access, fileSelector, GENCP_FILE_MODE_READ );
+	while ( status == GENCP_STATUS_SUCCESS && nVerified < data.size() )
+	{
+		size_t		nChunk	= ( data.size() - nVerified < sChunk ) ? data.size() - nVerified : sChunk;
+		size_t		nMoved;
+		status = PdvGenCpFileTransfer( &access, false, nVerified, &chunk[0], nChunk, &nMoved );
+		if ( status == GENCP_STATUS_SUCCESS && nMoved == 0 )
+			break;
+		SHA1_Update( &sha1Ctx, &chunk[0], nMoved );
+		nVerified	+= nMoved;
+	}
+	SHA1_Final( readSHA1, &sha1Ctx );
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpFileOperation( &access, GENCP_FILE_OP_CLOSE, &result );
+	EdtGenCpClose( pPdv );
+	if ( status != GENCP_STATUS_SUCCESS )
+	{
+		fprintf( stderr, "%s: Readback of file %s failed after %llu bytes\n", functionName, pFileSelector,
+				(long long unsigned int) nVerified );
+		return status;
+	}
+
+	// Either way the next upload starts over
+	(void) remove( checkpointName.c_str() );
+	if ( nVerified != data.size() || memcmp( readSHA1, fileSHA1, SHA_DIGEST_LENGTH ) != 0 )
+	{
+		fprintf( stderr, "%s GenCP Error: File %s read back %llu of %zu bytes, SHA1 does not match!\n",
+				functionName, pFileSelector, (long long unsigned int) nVerified, data.size() );
+		return GENCP_STATUS_GENERIC_ERROR | GENCP_SC_ERROR;
+	}
+	printf( "%s uploaded to file %s, %zu bytes match SHA1: ", pFileName, pFileSelector, data.size() );
+	for ( size_t i = 0; i < SHA_DIGEST_LENGTH; i++ )
+		printf( "%02x", fileSHA1[i] );
+	putchar( '\n' );
+	return GENCP_STATUS_SUCCESS;
+}
+
+
+static int GenCpCompareDouble( const void * pA, const void * pB )
+{
+	double	a	= *reinterpret_cast<const double *>( pA );
+	double	b	= *reinterpret_cast<const double *>( pB );
+	return ( a < b ) ? -1 : ( a > b ) ? 1 : 0;
+}
+
+/// EdtGenCpBench() Issue nIter back to back ReadMem or WriteMem transactions on one open handle
+/// and report round trip statistics, throughput, and the wire vs device time split
+GENCP_STATUS EdtGenCpBench(
+	unsigned int		iUnit,
+	unsigned int		iChannel,
+	uint64_t			regAddr,
+	size_t				numBytes,
+	bool				fWrite,
+	uint64_t			value,
+	unsigned int		nIter	)
+{
+	const char		*	functionName = "EdtGenCpBench";
+	GENCP_STATUS		status;
+    EdtDev			*	pPdv;
+
+	if ( nIter == 0 )
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+
+	double			*	pRtt	= reinterpret_cast<double *>( calloc( nIter, sizeof(double) ) );
+	if ( pRtt == NULL )
+	{
+		fprintf( stderr, "%s: Unable to allocate %u samples\n", functionName, nIter );
+		return GENCP_STATUS_GENERIC_ERROR | GENCP_SC_ERROR;
+	}
+
+	/* open a handle to the device     */
+	pPdv = EdtGenCpOpen( iUnit, iChannel, false );
+	if ( pPdv == NULL )
+	{
+		free( pRtt );
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
+	int				baud	= pdv_get_baud( pPdv );
+
+	unsigned int	nOk		= 0;
+	unsigned int	nErrors	= 0;
+	double			tStart	= GenCpToolTimeMs( );
+	for ( unsigned int iIter = 0; iIter < nIter; iIter++ )
+	{
+		uint64_t	result;
+		double		t0	= GenCpToolTimeMs( );
+		if ( fWrite )
+			status = PdvGenCpWriteUint( pPdv, regAddr, numBytes, value );
+		else
+			status = PdvGenCpReadUint( pPdv, regAddr, numBytes, &result );
+		double		t1	= GenCpToolTimeMs( );
+		if ( status != GENCP_STATUS_SUCCESS )
+		{
+			// Drop anything left over from the failed transaction before the next one
+			char		flushBuf[1000];
+			(void) pdv_serial_read( pPdv, flushBuf, 1000 );
+			nErrors++;
+			continue;
+		}
+		pRtt[nOk++] = t1 - t0;
+	}
+	double			tTotal	= GenCpToolTimeMs( ) - tStart;
+
+	EdtGenCpClose( pPdv );
+
+	if ( nOk == 0 )
+	{
+		fprintf( stderr, "%s: All %u transactions failed\n", functionName, nIter );
+		free( pRtt );
+		return GENCP_STATUS_MSG_TIMEOUT | GENCP_SC_ERROR;
+	}
+
+	qsort( pRtt, nOk, sizeof(double), GenCpCompareDouble );
+	double		rttSum	= 0.0;
+	for ( unsigned int i = 0; i < nOk; i++ )
+		rttSum += pRtt[i];
+	double		rttMedian	= pRtt[nOk / 2];
+	double		rttP99		= pRtt[ ( nOk * 99 ) / 100 < nOk ? ( nOk * 99 ) / 100 : nOk - 1 ];
+
+	// Bytes on the wire per transaction, command plus acknowledge
+	size_t		nWireBytes;
+	if ( fWrite )
+		nWireBytes	= sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDRequest) + sizeof(uint64_t) + numBytes
+					+ sizeof(GenCpWriteMemAck);
+	else
+		nWireBytes	= sizeof(GenCpReadMemPacket)
+					+ sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDAck) + numBytes;
+	// 8N1 framing, 10 bits per byte
+	double		wireMs		= ( baud > 0 ) ? ( nWireBytes * 10.0 * 1e3 ) / baud : 0.0;
+	double		deviceMs	= rttMedian - wireMs;
+
+	printf( "%s %u x %zu bytes @ 0x%llX on unit %u channel %u, %d baud\n",
+			fWrite ? "WriteMem" : "ReadMem", nIter, numBytes,
+			(long long unsigned int) regAddr, iUnit, iChannel, baud );
+	printf( "  RTT ms:     min %.3f, median %.3f, mean %.3f, p99 %.3f, max %.3f\n",
+			pRtt[0], rttMedian, rttSum / nOk, rttP99, pRtt[nOk - 1] );
+	printf( "  Throughput: %.1f transactions/s, %.1f payload bytes/s, %.1f wire bytes/s\n",
+			nOk * 1e3 / tTotal, nOk * numBytes * 1e3 / tTotal, nOk * nWireBytes * 1e3 / tTotal );
+	printf( "  Median RTT: %.3f ms serial transfer (%zu bytes), %.3f ms device processing\n",
+			wireMs, nWireBytes, deviceMs > 0.0 ? deviceMs : 0.0 );
+	printf( "  Errors:     %u of %u\n", nErrors, nIter );
+
+	free( pRtt );
+	return GENCP_STATUS_SUCCESS;
+}
+
+/// Per camera results for the --all scan
+typedef struct
+{
+	unsigned int		iUnit;
+	unsigned int		iChannel;
+	bool				fManifest;
+	bool				fPresent;
+	GENCP_STATUS		status;
+	char				manufacturer[GENCP_SCAN_STRING_SIZE+1];
+	char				model[GENCP_SCAN_STRING_SIZE+1];
+	char				serialNumber[GENCP_SCAN_STRING_SIZE+1];
+	char				deviceVersion[GENCP_SCAN_STRING_SIZE+1];
+	uint64_t			nManifestEntries;
+	GenCpManifestEntry	xmlFileEntry;
+}	GenCpScanInfo;
+
+/// PdvGenCpReadBrmString() Read one of the 64 byte BRM string registers and terminate it
+static GENCP_STATUS PdvGenCpReadBrmString(
+    EdtDev			*	pPdv,
+	uint64_t			regAddr,
+	char			*	pBuffer )
+{
+	GENCP_STATUS	status;
+	status = PdvGenCpReadString( pPdv, regAddr, GENCP_SCAN_STRING_SIZE, pBuffer, GENCP_SCAN_STRING_SIZE );
+	pBuffer[GENCP_SCAN_STRING_SIZE] = 0;
+	return status;
+}
+
+/// EdtGenCpScanWorker() Thread function for one serial link of the --all scan
+/// Reads the BRM identity block and optionally the first manifest table entry
+static void * EdtGenCpScanWorker( void * pArg )
+{
+	GenCpScanInfo	*	pInfo	= reinterpret_cast<GenCpScanInfo *>( pArg );
+	GENCP_STATUS		status;
+	EdtDev			*	pPdv;
+
+	pInfo->fPresent	= false;
+	pInfo->status	= GENCP_STATUS_SUCCESS;
+	pPdv = EdtGenCpOpen( pInfo->iUnit, pInfo->iChannel, true );
+	if ( pPdv == NULL )
+		return NULL;
+	pInfo->fPresent	= true;
+
+	status = PdvGenCpReadBrmString( pPdv, REG_BRM_MANUFACTURER_NAME,	pInfo->manufacturer );
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpReadBrmString( pPdv, REG_BRM_MODEL_NAME,		pInfo->model );
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpReadBrmString( pPdv, REG_BRM_SERIAL_NUMBER,	pInfo->serialNumber );
+	if ( status == GENCP_STATUS_SUCCESS )
+		status = PdvGenCpReadBrmString( pPdv, REG_BRM_DEVICE_VERSION,	pInfo->deviceVersion );
+
+	if ( status == GENCP_STATUS_SUCCESS && pInfo->fManifest )
+	{
+		uint64_t			addrManifestTable;
+		status = PdvGenCpReadUint( pPdv, REG_BRM_MANIFEST_TABLE_ADDRESS, 8, &addrManifestTable );
+		if ( status == GENCP_STATUS_SUCCESS )
+			status = PdvGenCpReadUint( pPdv, addrManifestTable, 8, &pInfo->nManifestEntries );
+		if ( status == GENCP_STATUS_SUCCESS && pInfo->nManifestEntries > 0 )
+			status = PdvGenCpReadString( pPdv, addrManifestTable + sizeof(uint64_t), sizeof(GenCpManifestEntry),
+										reinterpret_cast<char *>(&pInfo->xmlFileEntry), sizeof(GenCpManifestEntry) );
+	}
+
+	EdtGenCpClose( pPdv );
+	pInfo->status	= status;
+	return NULL;
+}
+
+/// EdtGenCpScanAll() Scan every unit/channel concurrently, one worker thread per serial link,
+/// and print one consolidated camera table
+GENCP_STATUS EdtGenCpScanAll(
+	unsigned int		nUnits,
+	unsigned int		nChannels,
+	bool				fManifest )
+{
+	const char		*	functionName = "EdtGenCpScanAll";
+	unsigned int		nLinks	= nUnits * nChannels;
+	GenCpScanInfo	*	pInfo	= reinterpret_cast<GenCpScanInfo *>( calloc( nLinks, sizeof(GenCpScanInfo) ) );
+	pthread_t		*	pThread	= reinterpret_cast<pthread_t *>( calloc( nLinks, sizeof(pthread_t) ) );
+	bool			*	pJoin	= reinterpret_cast<bool *>( calloc( nLinks, sizeof(bool) ) );
+	if ( pInfo == NULL || pThread == NULL || pJoin == NULL )
+	{
+		fprintf( stderr, "%s: Unable to allocate %u scan workers\n", functionName, nLinks );
+		free( pInfo );
+		free( pThread );
+		free( pJoin );
+		return GENCP_STATUS_GENERIC_ERROR | GENCP_SC_ERROR;
+	}
+
+	for ( unsigned int iLink = 0; iLink < nLinks; iLink++ )
+	{
+		pInfo[iLink].iUnit		= iLink / nChannels;
+		pInfo[iLink].iChannel	= iLink % nChannels;
+		pInfo[iLink].fManifest	= fManifest;
+		if ( pthread_create( &pThread[iLink], NULL, EdtGenCpScanWorker, &pInfo[iLink] ) == 0 )
+			pJoin[iLink] = true;
+		else
+		{
+			// Fall back to scanning this link from the main thread
+			fprintf( stderr, "%s: Unable to start worker for unit %u channel %u\n", functionName,
+					pInfo[iLink].iUnit, pInfo[iLink].iChannel );
+			(void) EdtGenCpScanWorker( &pInfo[iLink] );
+		}
+	}
+	for ( unsigned int iLink = 0; iLink < nLinks; iLink++ )
+	{
+		if ( pJoin[iLink] )
+			pthread_join( pThread[iLink], NULL );
+	}
+
+	printf( "%-4s %-4s %-20s %-24s %-20s %-20s", "Unit", "Chan", "Manufacturer", "Model", "Serial", "Version" );
+	if ( fManifest )
+		printf( " %-9s %-4s %-40s", "XmlVers", "Zip", "XmlSHA1" );
+	putchar( '\n' );
+
+	unsigned int	nCameras	= 0;
+	for ( unsigned int iLink = 0; iLink < nLinks; iLink++ )
+	{
+		GenCpScanInfo	*	pCam	= &pInfo[iLink];
+		if ( !pCam->fPresent )
+			continue;
+		if ( pCam->status != GENCP_STATUS_SUCCESS )
+		{
+			printf( "%-4u %-4u GenCP Error 0x%04X\n", pCam->iUnit, pCam->iChannel, pCam->status );
+			continue;
+		}
+		nCameras++;
+		printf( "%-4u %-4u %-20.20s %-24.24s %-20.20s %-20.20s", pCam->iUnit, pCam->iChannel,
+				pCam->manufacturer, pCam->model, pCam->serialNumber, pCam->deviceVersion );
+		if ( fManifest && pCam->nManifestEntries > 0 )
+		{
+			uint32_t	xmlFileVersion	= GenCpBigEndianToCpu( pCam->xmlFileEntry.xmlFileVersion );
+			uint32_t	xmlFileSchema	= GenCpBigEndianToCpu( pCam->xmlFileEntry.xmlFileSchema );
+			printf( " %3u.%u.%-3u %-4s ",
+					GENCP_MFT_ENTRY_FILE_MAJOR_VERSION(xmlFileVersion),
+					GENCP_MFT_ENTRY_FILE_MINOR_VERSION(xmlFileVersion),
+					GENCP_MFT_ENTRY_FILE_SUB_VERSION(xmlFileVersion),
+					GENCP_MFT_ENTRY_SCHEMA_TYPE(xmlFileSchema) == GENCP_MFT_ENTRY_SCHEMA_TYPE_ZIP ? "yes" : "no" );
+			for ( size_t i = 0; i < GENCP_MFT_ENTRY_SHA1_SIZE; i++ )
+				printf( "%02x", pCam->xmlFileEntry.xmlFileSHA1[i] );
+		}
+		putchar( '\n' );
+	}
+	printf( "%u cameras found on %u units x %u channels\n", nCameras, nUnits, nChannels );
+
+	free( pInfo );
+	free( pThread );
+	free( pJoin );
+	return GENCP_STATUS_SUCCESS;
+}
+
+
+int main( int argc, char **argv )
+{
+	int				status;
+    unsigned int	channel = 0;
+    unsigned int	unit 	= 0;
+	unsigned int	iFile	= 0;
+    bool	     	verbose = FALSE;
+	bool			scanAll		= false;
+	bool			scanManifest= false;
+	unsigned int	scanUnits	= GENCP_SCAN_MAX_UNITS;
+	unsigned int	scanChannels= GENCP_SCAN_MAX_CHANNELS;
+	unsigned int	benchCount	= 0;
+	const char	*	xmlFileName	= NULL;
+	const char	*	mapDir		= NULL;
+	const char	*	fileSelector= "0";
+
+    for ( int iArg = 1; iArg < argc; iArg++ )
+    {
+		if	(	strcmp( argv[iArg], "-c" ) == 0
+			||	strcmp( argv[iArg], "--channel" ) == 0 )
+		{
+			if ( ++iArg >= argc )
+			{
+				usage( "Error: Missing channel number.\n" );
+				exit( -1 );
+			}
+			channel = atoi( argv[iArg] );
+		}
+		else if (	strcmp( argv[iArg], "-u" ) == 0
+				||	strcmp( argv[iArg], "--unit" ) == 0 )
+        {
+			if ( ++iArg >= argc )
+			{
+				usage( "Error: Missing unit number.\n" );
+				exit( -1 );
+			}
+			unit = atoi( argv[iArg] );
+		}
+		else if (	strncmp( argv[iArg], "--C", 3 ) == 0 )
+		{
+			char			buffer[1001];
+			unsigned int	numBytes	= atoi( &argv[iArg][3] );
+			if ( numBytes == 0 || numBytes > 1000 )
+			{
+				fprintf( stderr, "Invalid number of bytes for --C option: %s\n", argv[iArg] );
+				exit( 1 );
+			}
+			iArg++;
+			if ( iArg >= argc )
+			{
+				usage( "Error: Missing address.\n" );
+				exit( -1 );
+			}
+
+			uint64_t		regAddr		= strtoull( argv[iArg], NULL, 0 );
+			status = EdtGenCpReadString( unit, channel, regAddr, numBytes, buffer, 1000 );
+		}
+		else if (	strncmp( argv[iArg], "--U", 3 ) == 0 )
+		{
+       		//   --U32 Addr  Read 32 bit unsigned value from address\n"
 			uint64_t		result64;
 			unsigned int	numBits		= atoi( &argv[iArg][3] );
 			unsigned int	numBytes	= numBits / 8;
@@ -484,7 +1679,51 @@ int main( int argc, char **argv )
 			//	fprintf( stderr, "Invalid reg addr for --U option: %s\n", argv[iArg] );
 			//	exit( 1 );
 			//}
-			status = EdtGenCpReadUint( unit, channel, regAddr, numBytes, &result64 );
+			if ( benchCount > 0 )
+				status = EdtGenCpBench( unit, channel, regAddr, numBytes, false, 0, benchCount );
+			else
+				status = EdtGenCpReadUint( unit, channel, regAddr, numBytes, &result64 );
+		}
+		else if (	strncmp( argv[iArg], "--W", 3 ) == 0 )
+		{
+       		//   --W32 Addr Value  Write 32 bit unsigned value to address\n"
+			unsigned int	numBits		= atoi( &argv[iArg][3] );
+			unsigned int	numBytes	= numBits / 8;
+			if ( numBytes != 2 && numBytes != 4 && numBytes != 8 )
+			{
+				fprintf( stderr, "Invalid number of bits for --W option: %s\n", argv[iArg] );
+				exit( 1 );
+			}
+			if ( iArg + 2 >= argc )
+			{
+				usage( "Error: Missing address or value.\n" );
+				exit( -1 );
+			}
+
+			uint64_t		regAddr		= strtoull( argv[++iArg], NULL, 0 );
+			uint64_t		value		= strtoull( argv[++iArg], NULL, 0 );
+			if ( benchCount > 0 )
+				status = EdtGenCpBench( unit, channel, regAddr, numBytes, true, value, benchCount );
+			else
+				status = EdtGenCpWriteUint( unit, channel, regAddr, numBytes, value );
+		}
+		else if ( strcmp( argv[iArg], "--baud" ) == 0 )
+		{
+			if ( ++iArg >= argc )
+			{
+				usage( "Error: Missing baud rate.\n" );
+				exit( -1 );
+			}
+			localGenCpMaxBaud = atoi( argv[iArg] );
+		}
+		else if ( strcmp( argv[iArg], "--bench" ) == 0 )
+		{
+			if ( ++iArg >= argc )
+			{
+				usage( "Error: Missing benchmark count.\n" );
+				exit( -1 );
+			}
+			benchCount = atoi( argv[iArg] );
 		}
 		else if ( strcmp( argv[iArg], "--readXml" ) == 0 )
         {
@@ -498,6 +1737,82 @@ int main( int argc, char **argv )
 			unsigned char	xmlFileBuffer[100000];
 			status = EdtGenCpReadXmlFile( unit, channel, iFile, xmlFileBuffer, 100000, argv[iArg] );
 		}
+		else if ( strcmp( argv[iArg], "--compileXml" ) == 0 )
+		{
+			if ( ++iArg >= argc )
+			{
+				usage( "Error: Missing XML fileName.\n" );
+				exit( -1 );
+			}
+			xmlFileName = argv[iArg];
+		}
+		else if ( strcmp( argv[iArg], "--compileMap" ) == 0 )
+		{
+			if ( ++iArg >= argc )
+			{
+				usage( "Error: Missing map directory.\n" );
+				exit( -1 );
+			}
+			status = EdtGenCpCompileMap( unit, channel, iFile, xmlFileName, argv[iArg] );
+		}
+		else if ( strcmp( argv[iArg], "--mapDir" ) == 0 )
+		{
+			if ( ++iArg >= argc )
+			{
+				usage( "Error: Missing map directory.\n" );
+				exit( -1 );
+			}
+			mapDir = argv[iArg];
+		}
+		else if ( strcmp( argv[iArg], "--fileSelector" ) == 0 )
+		{
+			if ( ++iArg >= argc )
+			{
+				usage( "Error: Missing FileSelector value.\n" );
+				exit( -1 );
+			}
+			fileSelector = argv[iArg];
+		}
+		else if ( strcmp( argv[iArg], "--upload" ) == 0 )
+		{
+			if ( ++iArg >= argc )
+			{
+				usage( "Error: Missing fileName.\n" );
+				exit( -1 );
+			}
+			if ( mapDir == NULL )
+			{
+				usage( "Error: --upload needs --mapDir first.\n" );
+				exit( -1 );
+			}
+			status = EdtGenCpUploadFile( unit, channel, iFile, mapDir, fileSelector, argv[iArg] );
+		}
+		else if ( strcmp( argv[iArg], "--all" ) == 0 )
+		{
+			scanAll = true;
+		}
+		else if ( strcmp( argv[iArg], "--manifest" ) == 0 )
+		{
+			scanManifest = true;
+		}
+		else if ( strcmp( argv[iArg], "--units" ) == 0 )
+		{
+			if ( ++iArg >= argc )
+			{
+				usage( "Error: Missing number of units.\n" );
+				exit( -1 );
+			}
+			scanUnits = atoi( argv[iArg] );
+		}
+		else if ( strcmp( argv[iArg], "--channels" ) == 0 )
+		{
+			if ( ++iArg >= argc )
+			{
+				usage( "Error: Missing number of channels.\n" );
+				exit( -1 );
+			}
+			scanChannels = atoi( argv[iArg] );
+		}
 		else if (	strcmp( argv[iArg], "-v" ) == 0
 				||	strcmp( argv[iArg], "--verbose" ) == 0 )
         {
@@ -517,5 +1832,15 @@ int main( int argc, char **argv )
 		}
     }
 
+	if ( scanAll )
+	{
+		if ( scanUnits == 0 || scanChannels == 0 )
+		{
+			usage( "Error: --units and --channels must be > 0.\n" );
+			exit( -1 );
+		}
+		status = EdtGenCpScanAll( scanUnits, scanChannels, scanManifest );
+	}
+
     return (0);
 }
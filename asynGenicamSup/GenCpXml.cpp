@@ -0,0 +1,379 @@
+// GenCpXml.cpp
+
+//
+// Minimal XML DOM parser for GenICam camera description files.
+// See GenCpXml.h
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "GenCpXml.h"
+
+GenCpXmlNode::GenCpXmlNode( )
+	:	m_name(		),
+		m_attrs(	),
+		m_text(		),
+		m_children(	)
+{
+}
+
+GenCpXmlNode::~GenCpXmlNode( )
+{
+	for ( size_t iChild = 0; iChild < m_children.size(); iChild++ )
+		delete m_children[iChild];
+}
+
+const char	*	GenCpXmlNode::Attr( const char * pName ) const
+{
+	for ( size_t iAttr = 0; iAttr < m_attrs.size(); iAttr++ )
+	{
+		if ( m_attrs[iAttr].first == pName )
+			return m_attrs[iAttr].second.c_str();
+	}
+	return NULL;
+}
+
+const GenCpXmlNode	*	GenCpXmlNode::Child( const char * pName ) const
+{
+	for ( size_t iChild = 0; iChild < m_children.size(); iChild++ )
+	{
+		if ( m_children[iChild]->m_name == pName )
+			return m_children[iChild];
+	}
+	return NULL;
+}
+
+const char	*	GenCpXmlNode::ChildText( const char * pName ) const
+{
+	const GenCpXmlNode	*	pChild	= Child( pName );
+	return pChild ? pChild->m_text.c_str() : NULL;
+}
+
+/// Cursor over the XML text
+class GenCpXmlParser
+{
+public:
+	GenCpXmlParser( const char * pXml, size_t sXml )
+		:	m_p( pXml ), m_pEnd( pXml + sXml ), m_pStart( pXml ), m_error( )
+	{
+	}
+
+	GenCpXmlNode	*	ParseDocument( );
+	const std::string &	Error( ) const	{ return m_error; }
+
+private:
+	bool	Fail( const char * pMsg );
+	bool	StartsWith( const char * pString ) const;
+	bool	SkipPast( const char * pString );
+	void	SkipSpace( );
+	bool	ParseName( std::string & name );
+	bool	ParseElement( GenCpXmlNode * pNode, int depth );
+	bool	AppendDecoded( std::string & out, const char * pBegin, const char * pEnd );
+
+	const char	*	m_p;
+	const char	*	m_pEnd;
+	const char	*	m_pStart;
+	std::string		m_error;
+};
+
+// Deep enough for any GenICam file, shallow enough for the stack
+#define	GENCP_XML_MAX_DEPTH	64
+
+static bool	IsNameChar( char c )
+{
+	return ( c >= 'a' && c <= 'z' ) || ( c >= 'A' && c <= 'Z' ) || ( c >= '0' && c <= '9' )
+		|| c == '_' || c == '-' || c == '.' || c == ':' || ( c & 0x80 );
+}
+
+static bool	IsSpace( char c )
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static void	Trim( std::string & s )
+{
+	size_t	iStart	= 0;
+	size_t	iEnd	= s.size();
+	while ( iStart < iEnd && IsSpace( s[iStart] ) )
+		iStart++;
+	while ( iEnd > iStart && IsSpace( s[iEnd - 1] ) )
+		iEnd--;
+	s = s.substr( iStart, iEnd - iStart );
+}
+
+bool	GenCpXmlParser::Fail( const char * pMsg )
+{
+	if ( m_error.empty() )
+	{
+		// Report the line number of the error
+		unsigned int	line	= 1;
+		for ( const char * p = m_pStart; p < m_p && p < m_pEnd; p++ )
+			if ( *p == '\n' )
+				line++;
+		char	buffer[200];
+		snprintf( buffer, sizeof(buffer), "line %u: %s", line, pMsg );
+		m_error = buffer;
+	}
+	return false;
+}
+
+bool	GenCpXmlParser::StartsWith( const char * pString ) const
+{
+	size_t	len	= strlen( pString );
+	return static_cast<size_t>( m_pEnd - m_p ) >= len && memcmp( m_p, pString, len ) == 0;
+}
+
+bool	GenCpXmlParser::SkipPast( const char * pString )
+{
+	size_t	len	= strlen( pString );
+	while ( m_p < m_pEnd )
+	{
+		if ( StartsWith( pString ) )
+		{
+			m_p += len;
+			return true;
+		}
+		m_p++;
+	}
+	return Fail( "unterminated markup" );
+}
+
+void	GenCpXmlParser::SkipSpace( )
+{
+	while ( m_p < m_pEnd && IsSpace( *m_p ) )
+		m_p++;
+}
+
+bool	GenCpXmlParser::ParseName( std::string & name )
+{
+	const char	*	pBegin	= m_p;
+	while ( m_p < m_pEnd && IsNameChar( *m_p ) )
+		m_p++;
+	if ( m_p == pBegin )
+		return Fail( "expected a name" );
+	name.assign( pBegin, m_p - pBegin );
+	return true;
+}
+
+/// Append pBegin..pEnd to out w/ entities decoded, false on a reference to no character
+bool	GenCpXmlParser::AppendDecoded( std::string & out, const char * pBegin, const char * pEnd )
+{
+	for ( const char * p = pBegin; p < pEnd; p++ )
+	{
+		if ( *p != '&' )
+		{
+			out += *p;
+			continue;
+		}
+		const char	*	pSemi	= static_cast<const char *>( memchr( p, ';', pEnd - p ) );
+		if ( pSemi == NULL )
+		{
+			out += *p;
+			continue;
+		}
+		std::string		entity( p + 1, pSemi - p - 1 );
+		if		( entity == "lt"	)	out += '<';
+		else if ( entity == "gt"	)	out += '>';
+		else if ( entity == "amp"	)	out += '&';
+		else if ( entity == "quot"	)	out += '"';
+		else if ( entity == "apos"	)	out += '\'';
+		else if ( entity.size() > 1 && entity[0] == '#' )
+		{
+			unsigned long	code	= ( entity[1] == 'x' ) ? strtoul( entity.c_str() + 2, NULL, 16 )
+														   : strtoul( entity.c_str() + 1, NULL, 10 );
+			// Surrogates are utf-16 halves, not characters, and utf-8 stops at 0x10FFFF
+			if ( code == 0 || ( code >= 0xD800 && code <= 0xDFFF ) || code > 0x10FFFF )
+				return Fail( "invalid character reference" );
+			// Names and formulas are ascii, anything else only needs to survive as utf-8
+			if ( code < 0x80 )
+				out += static_cast<char>( code );
+			else if ( code < 0x800 )
+			{
+				out += static_cast<char>( 0xC0 | ( code >> 6 ) );
+				out += static_cast<char>( 0x80 | ( code & 0x3F ) );
+			}
+			else if ( code < 0x10000 )
+			{
+				out += static_cast<char>( 0xE0 | ( code >> 12 ) );
+				out += static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+				out += static_cast<char>( 0x80 | ( code & 0x3F ) );
+			}
+			else
+			{
+				out += static_cast<char>( 0xF0 | ( code >> 18 ) );
+				out += static_cast<char>( 0x80 | ( ( code >> 12 ) & 0x3F ) );
+				out += static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+				out += static_cast<char>( 0x80 | ( code & 0x3F ) );
+			}
+		}
+		else
+		{
+			out.append( p, pSemi - p + 1 );
+		}
+		p = pSemi;
+	}
+	return true;
+}
+
+/// Parse the element whose '<' is at m_p into pNode
+bool	GenCpXmlParser::ParseElement( GenCpXmlNode * pNode, int depth )
+{
+	if ( depth > GENCP_XML_MAX_DEPTH )
+		return Fail( "elements nested too deep" );
+	m_p++;
+	if ( !ParseName( pNode->m_name ) )
+		return false;
+
+	// Attributes
+	for ( ;; )
+	{
+		SkipSpace();
+		if ( m_p >= m_pEnd )
+			return Fail( "unterminated start tag" );
+		if ( StartsWith( "/>" ) )
+		{
+			m_p += 2;
+			return true;
+		}
+		if ( *m_p == '>' )
+		{
+			m_p++;
+			break;
+		}
+		std::string		attrName;
+		if ( !ParseName( attrName ) )
+			return false;
+		SkipSpace();
+		if ( m_p >= m_pEnd || *m_p != '=' )
+			return Fail( "expected '=' after attribute name" );
+		m_p++;
+		SkipSpace();
+		if ( m_p >= m_pEnd || ( *m_p != '"' && *m_p != '\'' ) )
+			return Fail( "expected quoted attribute value" );
+		char			quote	= *m_p++;
+		const char	*	pValue	= m_p;
+		while ( m_p < m_pEnd && *m_p != quote )
+			m_p++;
+		if ( m_p >= m_pEnd )
+			return Fail( "unterminated attribute value" );
+		std::string		attrValue;
+		if ( !AppendDecoded( attrValue, pValue, m_p ) )
+			return false;
+		m_p++;
+		pNode->m_attrs.push_back( std::make_pair( attrName, attrValue ) );
+	}
+
+	// Content
+	while ( m_p < m_pEnd )
+	{
+		if ( *m_p != '<' )
+		{
+			const char	*	pText	= m_p;
+			while ( m_p < m_pEnd && *m_p != '<' )
+				m_p++;
+			if ( !AppendDecoded( pNode->m_text, pText, m_p ) )
+				return false;
+		}
+		else if ( StartsWith( "</" ) )
+		{
+			m_p += 2;
+			std::string		endName;
+			if ( !ParseName( endName ) )
+				return false;
+			if ( endName != pNode->m_name )
+				return Fail( "mismatched end tag" );
+			SkipSpace();
+			if ( m_p >= m_pEnd || *m_p != '>' )
+				return Fail( "unterminated end tag" );
+			m_p++;
+			Trim( pNode->m_text );
+			return true;
+		}
+		else if ( StartsWith( "<!--" ) )
+		{
+			if ( !SkipPast( "-->" ) )
+				return false;
+		}
+		else if ( StartsWith( "<![CDATA[" ) )
+		{
+			m_p += 9;
+			const char	*	pText	= m_p;
+			if ( !SkipPast( "]]>" ) )
+				return false;
+			pNode->m_text.append( pText, m_p - 3 - pText );
+		}
+		else if ( StartsWith( "<?" ) )
+		{
+			if ( !SkipPast( "?>" ) )
+				return false;
+		}
+		else
+		{
+			GenCpXmlNode	*	pChild	= new GenCpXmlNode();
+			pNode->m_children.push_back( pChild );
+			if ( !ParseElement( pChild, depth + 1 ) )
+				return false;
+		}
+	}
+	return Fail( "missing end tag" );
+}
+
+GenCpXmlNode	*	GenCpXmlParser::ParseDocument( )
+{
+	// Skip a utf-8 byte order mark
+	if ( StartsWith( "\xEF\xBB\xBF" ) )
+		m_p += 3;
+
+	// Prolog: declaration, comments, DOCTYPE
+	for ( ;; )
+	{
+		SkipSpace();
+		if ( m_p >= m_pEnd )
+		{
+			Fail( "no root element" );
+			return NULL;
+		}
+		if ( StartsWith( "<?" ) )
+		{
+			if ( !SkipPast( "?>" ) )
+				return NULL;
+		}
+		else if ( StartsWith( "<!--" ) )
+		{
+			if ( !SkipPast( "-->" ) )
+				return NULL;
+		}
+		else if ( StartsWith( "<!" ) )
+		{
+			if ( !SkipPast( ">" ) )
+				return NULL;
+		}
+		else if ( *m_p == '<' )
+			break;
+		else
+		{
+			Fail( "text before root element" );
+			return NULL;
+		}
+	}
+
+	GenCpXmlNode	*	pRoot	= new GenCpXmlNode();
+	if ( !ParseElement( pRoot, 0 ) )
+	{
+		delete pRoot;
+		return NULL;
+	}
+	return pRoot;
+}
+
+GenCpXmlNode	*	GenCpXmlParse(
+	const char		*	pXml,
+	size_t				sXml,
+	std::string		&	errorMsg	)
+{
+	GenCpXmlParser		parser( pXml, sXml );
+	GenCpXmlNode	*	pRoot	= parser.ParseDocument();
+	errorMsg	= parser.Error();
+	return pRoot;
+}
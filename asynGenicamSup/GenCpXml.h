@@ -0,0 +1,44 @@
+// GenCpXml.h
+
+//
+// Minimal XML DOM parser for GenICam camera description files.
+// Handles elements, attributes, text, comments, CDATA, processing
+// instructions, DOCTYPE and the predefined and numeric entities.
+// No namespaces or DTD validation, GenICam files don't need them.
+//
+
+#ifndef	GENCP_XML_H
+#define	GENCP_XML_H
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+class GenCpXmlNode
+{
+public:
+	GenCpXmlNode( );
+	~GenCpXmlNode( );
+
+	/// Value of attribute pName, NULL if not present
+	const char			*	Attr(		const char	*	pName	) const;
+
+	/// First child element named pName, NULL if none
+	const GenCpXmlNode	*	Child(		const char	*	pName	) const;
+
+	/// Trimmed text of the first child element named pName, NULL if none
+	const char			*	ChildText(	const char	*	pName	) const;
+
+	std::string											m_name;
+	std::vector< std::pair<std::string, std::string> >	m_attrs;
+	std::string											m_text;		// Text content, trimmed
+	std::vector<GenCpXmlNode *>							m_children;
+};
+
+/// Parse sXml bytes of XML, returns the root element or NULL w/ errorMsg set
+/// Caller must delete the returned node
+GenCpXmlNode	*	GenCpXmlParse(	const char	*	pXml,
+									size_t			sXml,
+									std::string	&	errorMsg	);
+
+#endif	/* GENCP_XML_H */
@@ -14,20 +14,40 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
+#include <math.h>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <set>
 
 #include "cantProceed.h"
 #include "epicsStdio.h"
 #include "epicsString.h"
+#include "epicsEvent.h"
+#include "epicsMutex.h"
 #include "epicsThread.h"
+#include "epicsTime.h"
 #include "epicsExport.h"
 #include "iocsh.h"
+#include "initHooks.h"
 
 #include "asynDriver.h"
 #include "asynOctet.h"
+#include "asynDrvUser.h"
+#include "asynInt8Array.h"
+#include "asynInt16Array.h"
+#include "asynInt32Array.h"
+#include "asynOption.h"
 #include "asynShellCommands.h"
 #include "asynGenicam.h"
 #include "GenTL.h"
 #include "GenCpPacket.h"
+#include "GenCpRegister.h"
+#include "GenCpRegCache.h"
+#include "GenCpRegMap.h"
+#include "GenCpCommand.h"
+#include "GenCpFormula.h"
+#include "GenCpRtt.h"
 
 //#ifndef FALSE
 //#define	FALSE 0
@@ -45,6 +65,267 @@
 
 int		DEBUG_GENICAM	= 0;
 
+// Don't retry a failed connect time bootstrap more often than this
+#define	GENCP_BOOTSTRAP_RETRY_SEC	10.0
+
+// Consecutive errors after a baud rate upshift before falling back to a lower rate
+#define	GENCP_BAUD_FALLBACK_ERRORS	3
+
+// Time for the device to switch baud rates after acking the change
+#define	GENCP_BAUD_SETTLE_SEC		0.05
+
+// Floor for adaptive ack timeouts, covers host scheduling and serial driver latency
+#define	GENCP_RTO_MIN_SEC			0.02
+
+// Max unused bytes between two formula input registers read in one ReadMem
+#define	GENCP_FORMULA_MAX_GAP		16
+
+// Longest the scan thread sleeps w/o a due group, so new groups start promptly
+#define	GENCP_SCAN_IDLE_SEC			1.0
+
+// ReadMem transactions per queued scan request, other requests are served in between
+#define	GENCP_SCAN_READS_PER_REQUEST	1
+
+// Default max link utilization planned for scan groups, percent
+#define	GENCP_LINK_BUDGET_PERCENT	80.0
+
+// Device latency per transaction assumed until round trips are measured
+#define	GENCP_LINK_LATENCY_SEC		0.005
+
+// Window over which the measured link utilization is averaged
+#define	GENCP_LINK_UTIL_WINDOW_SEC	10.0
+
+// Factor by which the scan interval of an unchanged register grows in adaptive groups
+#define	GENCP_SCAN_BACKOFF			2
+
+// drvInfo prefix of register ranges for the array interfaces, e.g. "GC:0x20000 8192 LE"
+// Without it, only names of the loaded register map are taken, the rest go to the lower driver
+#define	GENCP_ARRAY_DRVINFO_PREFIX	"GC:"
+
+// Polling interval of W commands, doubling from min to max while the condition isn't met
+#define	GENCP_WAIT_MIN_POLL_SEC		0.001
+#define	GENCP_WAIT_MAX_POLL_SEC		0.05
+
+// Consecutive ack timeouts that open the breaker, failing requests at once until a probe is answered
+// 0, the breaker is off unless enabled w/ asynGenicamSetBreaker
+#define	GENCP_BREAKER_TIMEOUTS		0
+
+// Time from opening the breaker to the first probe, doubling after each failed probe up to the max
+#define	GENCP_BREAKER_MIN_PROBE_SEC	0.5
+#define	GENCP_BREAKER_MAX_PROBE_SEC	30.0
+
+// Combined writes that failed, kept until their addresses are accessed again
+#define	GENCP_LOST_WRITES_MAX		64
+
+// GenCpReadRegs resume address once all registers are read
+#define	GENCP_READ_REGS_DONE		0xFFFFFFFFFFFFFFFFULL
+
+/// Raw register bytes by address, inputs of a formula evaluation
+typedef std::map<uint64_t, std::vector<uint8_t> >	GenCpRegData;
+
+/// Register range moved whole by the asynInt8/16/32Array interfaces
+typedef struct
+{
+	std::string			drvInfo;		// As given, e.g. "0x20000 8192" or "LUTValueAll LE"
+	std::string			reg;			// Address or feature name
+	bool				fResolved;		// address and length are valid
+	uint64_t			address;
+	size_t				length;			// Bytes, as given for an address, else the feature's
+	bool				fLittleEndian;	// Elements are little endian
+}	GenCpArrayRange;
+
+/// Combined write answered OK that the camera never took
+typedef struct
+{
+	uint64_t			address;
+	size_t				length;
+	std::string			error;			// errorMessage of the failed WriteMem
+}	GenCpLostWrite;
+
+/// Register write of a preset
+typedef struct
+{
+	uint64_t				address;
+	std::vector<uint8_t>	bytes;			// As sent, the register's byte order
+	std::vector<uint8_t>	mask;			// Bits the preset sets, all of them unless a bit field
+	bool					fReadable;		// Compared w/ the register, else always written
+	bool					fSelector;		// Written by itself, in file order
+}	GenCpPresetWrite;
+
+/// Named register values from asynGenicamLoadPresets
+typedef struct
+{
+	std::string						file;		// Loaded from
+	std::vector<std::string>		lines;		// As loaded, e.g. "U32 0x1234 =5" or "N Gain =2"
+	bool							fCompiled;	// writes is valid for the loaded map and selectors
+	std::vector<GenCpPresetWrite>	writes;		// Address order between selector writes
+}	GenCpPreset;
+
+/// Register or feature polled by a scan group
+typedef struct
+{
+	std::string			command;		// As configured, e.g. "U32 0x1234" or "N Gain"
+	std::string			name;			// Feature name for N commands
+	bool				fFeature;		// Resolve name in the register map at each scan
+	GenCpRegMapEntry	entry;			// Register of U, F and C commands
+	unsigned int		responseType;	// GENCP_TY_RESP_* of the equivalent read
+	unsigned int		responseCount;
+	double				deadband;		// Publish numeric values only on a larger change
+	bool				fPublished;		// lastValue and lastText are valid
+	double				lastValue;
+	std::string			lastText;
+	unsigned int		interval;		// Read every interval group scans
+	unsigned int		countdown;		// Group scans to skip before the next read
+	bool				fDue;			// Read by the current scan
+}	GenCpScanReg;
+
+/// Registers read together every period by the scan thread
+typedef struct
+{
+	std::string					name;
+	double						period;		// sec
+	double						maxPeriod;	// Adaptive groups read unchanged registers down to this, sec
+	asynQueuePriority			priority;	// Queue priority of the group's reads
+	bool						fDisabled;	// Refused by the link budget
+	double						cost;		// Estimated link time per scan, sec
+	epicsTimeStamp				tNext;		// Next scan due
+	std::vector<GenCpScanReg>	regs;
+	bool						fFailing;	// Last scan failed
+	unsigned long				nScans;
+	unsigned long				nOverruns;	// Scans skipped because the link was busy
+	unsigned long				nStarved;	// Reads requeued at a higher priority after a long wait
+	unsigned long				nDropped;	// Scans not done before the next was due
+	unsigned long				nSkipped;	// Register reads skipped by adaptive backoff
+	unsigned long				nErrors;
+	unsigned long				nPublished;
+}	GenCpScanGroup;
+
+/// asynOctet I/O Intr client
+typedef struct
+{
+	asynUser				*	pasynUser;
+	interruptCallbackOctet		callback;
+	void					*	userPvt;
+	bool						fLower;			// Also registered w/ the lower driver
+	void					*	lowerRegistrarPvt;
+}	GenCpOctetInterrupt;
+
+/// Response for a computed feature, R<name>=value
+static void	GenCpFormatFormula(
+	char					*	pBuffer,
+	size_t						sBuffer,
+	const GenCpRegMapEntry	*	pEntry,
+	const char				*	pName,
+	double						value	)
+{
+	if ( pEntry->type == GENCP_REGMAP_TYPE_FLOAT )
+		snprintf( pBuffer, sBuffer, "R%s=%f\n", pName, value );
+	else
+		snprintf( pBuffer, sBuffer, "R%s=%lld\n", pName, static_cast<long long int>( value ) );
+}
+
+/// Parse a scan group read command, the read command of the ascii protocol w/o the '?'
+static bool	GenCpParseScanReg(
+	const char			*	pCommand,
+	GenCpScanReg		&	reg	)
+{
+	char					kind;
+	char					name[128];
+	unsigned int			count;
+	long long int			regAddr;
+
+	memset( &reg.entry, 0, sizeof(reg.entry) );
+	reg.command			= pCommand;
+	reg.fFeature		= false;
+	reg.fPublished		= false;
+	reg.lastValue		= 0.0;
+	reg.interval		= 1;
+	reg.countdown		= 0;
+	reg.fDue			= false;
+	reg.entry.access	= GENCP_REGMAP_ACCESS_RO;
+	reg.entry.endian	= GENCP_REGMAP_ENDIAN_BIG;
+	reg.entry.lsb		= GENCP_REGMAP_NO_BIT;
+	reg.entry.msb		= GENCP_REGMAP_NO_BIT;
+
+	if ( sscanf( pCommand, " N %127[^ \t?]", name ) == 1 )
+	{
+		// Type and address come from the register map at scan time
+		reg.name			= name;
+		reg.fFeature		= true;
+		reg.responseType	= GENCP_TY_RESP_UINT;
+		reg.responseCount	= 0;
+		return true;
+	}
+	if ( sscanf( pCommand, " %c%u %Li", &kind, &count, &regAddr ) != 3 )
+		return false;
+
+	reg.entry.address	= regAddr;
+	reg.responseCount	= count;
+	switch ( kind )
+	{
+	case 'U':
+		reg.entry.type		= GENCP_REGMAP_TYPE_INT;
+		reg.entry.length	= count / 8;
+		reg.responseType	= GENCP_TY_RESP_UINT;
+		return GenCpValidUintBits( count );
+	case 'F':
+		reg.entry.type		= GENCP_REGMAP_TYPE_FLOAT;
+		reg.entry.length	= count / 8;
+		reg.responseType	= ( count == 32 ) ? GENCP_TY_RESP_FLOAT : GENCP_TY_RESP_DOUBLE;
+		return count == 32 || count == 64;
+	case 'C':
+		reg.entry.type		= GENCP_REGMAP_TYPE_STRING;
+		reg.entry.length	= count;
+		reg.responseType	= GENCP_TY_RESP_STRING;
+		return count > 0;
+	default:
+		return false;
+	}
+}
+
+/// Read a scan register again next scan if it changed, else back off
+/// geometrically up to the group's maxPeriod
+static void	GenCpScanBackoff(
+	const GenCpScanGroup	&	group,
+	GenCpScanReg			&	reg,
+	bool						fChanged	)
+{
+	unsigned int	maxInterval	= 1;
+	if ( group.maxPeriod > group.period )
+		maxInterval	= static_cast<unsigned int>( group.maxPeriod / group.period );
+	if ( fChanged )
+		reg.interval	= 1;
+	else
+		reg.interval	= std::min( reg.interval * GENCP_SCAN_BACKOFF, maxInterval );
+	reg.countdown	= reg.interval - 1;
+}
+
+/// Read only BRM registers, constant while the device is connected
+/// Writable ones, e.g. the user defined name, can be changed by other tools
+/// between connects so are always read.  These are loaded into the register cache by the connect time bulk BRM read
+static const struct
+{
+	uint64_t		regAddr;
+	size_t			numBytes;
+}	brmCacheable[] =
+{
+	{ REG_BRM_GENCP_VERSION,				4						},
+	{ REG_BRM_MANUFACTURER_NAME,			GENCP_BRM_STRING_SIZE	},
+	{ REG_BRM_MODEL_NAME,					GENCP_BRM_STRING_SIZE	},
+	{ REG_BRM_FAMILY_NAME,					GENCP_BRM_STRING_SIZE	},
+	{ REG_BRM_DEVICE_VERSION,				GENCP_BRM_STRING_SIZE	},
+	{ REG_BRM_MANUFACTURER_INFO,			GENCP_BRM_STRING_SIZE	},
+	{ REG_BRM_SERIAL_NUMBER,				GENCP_BRM_STRING_SIZE	},
+	{ REG_BRM_DEVICE_CAPABILITY,			8						},
+	{ REG_BRM_MAX_DEVICE_RESPONSE_TIME,		4						},
+	{ REG_BRM_MANIFEST_TABLE_ADDRESS,		8						},
+	{ REG_BRM_SBRM_ADDRESS,					8						},
+	{ REG_BRM_MESSAGE_CHANNEL_ID,			4						},
+	{ REG_BRM_TIMESTAMP_INCREMENT,			8						},
+	{ REG_BRM_PROTOCOL_ENDIANESS,			4						},
+	{ REG_BRM_IMPLEMENTATION_ENDIANESS,		4						},
+};
+
 class asynGenicam
 {
 //	Public member functions
@@ -64,23 +345,529 @@ public:
 								size_t				*	pnRead,
 								int					*	eomReason );
 
+	/// Connect time negotiation w/ the device, reads the SBRM transfer lengths
+	/// Caller must own the port
+	asynStatus	GenCpConnect(	asynUser			*	pasynUser	);
+
+	/// Send one command packet on the underlying port and read back its ack
+	/// Caller must own the port
+	asynStatus	GenCpTransaction(	asynUser		*	pasynUser,
+									const void		*	pCmd,
+									size_t				sCmd,
+									void			*	pAck,
+									size_t				sAckMax,
+									size_t			*	pnAckRead	);
+
+	/// Read numBytes from regAddr in a single ReadMem transaction
+	/// Caller must own the port
+	asynStatus	GenCpReadMem(	asynUser			*	pasynUser,
+								uint64_t				regAddr,
+								void				*	pBuffer,
+								size_t					numBytes	);
+
+	/// Write numBytes of big endian data to regAddr in a single WriteMem transaction
+	/// Caller must own the port
+	asynStatus	GenCpWriteMem(	asynUser			*	pasynUser,
+								uint64_t				regAddr,
+								const void			*	pBuffer,
+								size_t					numBytes	);
+
+	/// Upshift the link to the fastest baud rate supported by both the device and m_maxBaud,
+	/// or m_fallbackBaud after a fallback on this connection
+	/// Caller must own the port
+	asynStatus	GenCpNegotiateBaud(	asynUser		*	pasynUser,
+									uint64_t			sbrmAddress	);
+
+	/// Read one ack for requestId, prefix and CCD first so short error acks don't wait,
+	/// waiting out any pending acks.  Updates the RTT estimate for rttClass.
+	/// Caller must own the port
+	asynStatus	GenCpReadAck(	asynUser			*	pasynUser,
+								uint16_t				requestId,
+								unsigned int			rttClass,
+								size_t					sCmd,
+								const epicsTimeStamp *	ptSent,
+								void				*	pAck,
+								size_t					sAckMax,
+								size_t				*	pnAckRead	);
+
+	/// Ack timeout for a request from the RTT estimate and max device response time,
+	/// never more than userTimeout
+	double		RequestTimeout(	unsigned int			rttClass,
+								size_t					nBytes,
+								double					userTimeout	);
+
+	/// Serial transfer time for nBytes at the current baud rate, 0 if unknown
+	double		WireTime(		size_t					nBytes	);
+
+	/// Read numBytes from regAddr in as few max size ReadMem transactions as possible
+	/// Caller must own the port
+	asynStatus	GenCpReadMemBlock(	asynUser		*	pasynUser,
+									uint64_t			regAddr,
+									void			*	pBuffer,
+									size_t				numBytes	);
+
+	/// Write numBytes to regAddr in as few max size WriteMem transactions as possible
+	/// Caller must own the port
+	asynStatus	GenCpWriteMemBlock(	asynUser		*	pasynUser,
+									uint64_t			regAddr,
+									const void		*	pBuffer,
+									size_t				numBytes	);
+
+	/// asynDrvUser: drvInfo names the register range of an array record,
+	/// an address or feature name, optionally followed by LE or BE
+	asynStatus	DrvUserCreate(	asynUser			*	pasynUser,
+								const char			*	drvInfo,
+								const char			**	pptypeName,
+								size_t				*	psize	);
+	asynStatus	DrvUserGetType(	asynUser			*	pasynUser,
+								const char			**	pptypeName,
+								size_t				*	psize	);
+	asynStatus	DrvUserDestroy(	asynUser			*	pasynUser	);
+
+	/// asynInt8/16/32Array: read or write nElements of the range selected
+	/// by pasynUser->reason.  Caller must own the port
+	template <typename T>
+	asynStatus	ArrayRead(		asynUser			*	pasynUser,
+								T					*	pValue,
+								size_t					nElements,
+								size_t				*	pnIn	);
+	template <typename T>
+	asynStatus	ArrayWrite(		asynUser			*	pasynUser,
+								const T				*	pValue,
+								size_t					nElements	);
+
+	/// Bulk read the BRM, decode it to m_deviceInfo and load the register cache
+	/// Caller must own the port
+	asynStatus	GenCpReadBrm(	asynUser			*	pasynUser	);
+
+	/// Load the register map for the device XML from m_regMapDir,
+	/// compiling it from the device XML first if needed and allowed
+	/// Caller must own the port
+	asynStatus	GenCpLoadRegMap(	asynUser		*	pasynUser	);
+
+	/// Mark the registers of the loaded map cacheable if m_fRegMapCache,
+	/// except NoCache and polled ones, replacing any set for a previous map
+	void		GenCpSetMapCacheable( );
+
+	/// Collect the selector registers of the loaded map and m_cfgSelectors
+	void		GenCpSetSelectors( );
+
+	/// Resolve the registers of m_cfgNoAck into m_noAckRegs
+	void		GenCpSetNoAck( );
+
+	/// Have the presets compiled again, against the loaded map and selectors, at their next use
+	void		GenCpSetPresets( );
+
+	/// Have the array ranges resolved again, against the loaded map, at their next use
+	void		GenCpSetArrays( );
+
+	/// Load the presets of a file, [name] sections of U or N write commands,
+	/// replacing loaded presets of the same name
+	int			LoadPresets(	const char			*	pFileName	);
+
+	/// Write the registers of a preset that differ from their current value,
+	/// contiguous ones in one WriteMem.  Caller must own the port
+	asynStatus	ApplyPreset(	asynUser			*	pasynUser,
+								const char			*	pName	);
+
+	/// Resolve a register given as an address or a feature name of the map
+	bool		GenCpResolveReg(	const char		*	pReg,
+									uint64_t		*	pRegAddr	);
+
+	/// Called w/ the status of each read of a response, reports a failure
+	/// of the ack that followed writes sent w/o ack, and fails an acked
+	/// request w/ the first error a device returned for those writes
+	asynStatus	BarrierDone(	asynUser			*	pasynUser,
+								asynStatus				status	);
+
+	/// Search the host baud rates <= m_maxBaud for one the device answers on
+	/// Caller must own the port
+	asynStatus	GenCpHuntBaud(	asynUser			*	pasynUser	);
+
+	/// Get or set the baud rate of the underlying asyn serial port via asynOption
+	int			GetHostBaud(	asynUser			*	pasynUser	);
+	asynStatus	SetHostBaud(	asynUser			*	pasynUser,
+								int						baud	);
+
+	/// Add a scan group read every period sec by the port's scan thread,
+	/// queueing its reads at priority 0 low, 1 medium or 2 high
+	/// If maxPeriod > period, registers that don't change are read less
+	/// and less often, down to every maxPeriod sec
+	int			AddScanGroup(	const char			*	pGroup,
+								double					period,
+								int						priority,
+								double					maxPeriod	);
+
+	/// Add a read command w/o the '?', e.g. "U32 0x1234" or "N Gain", to a scan group
+	/// Numeric values are published when they change by more than deadband
+	int			AddScanReg(		const char			*	pGroup,
+								const char			*	pCommand,
+								double					deadband	);
+
+	/// Body of the scan thread, never returns
+	void		ScanThread( );
+
+	/// Estimate the link time of every scan group from packet sizes, baud
+	/// rate and measured device latency, and warn if they add up to more
+	/// than m_linkBudget.  If fEnforce and m_fLinkBudgetEnforce, groups
+	/// past the budget, in configuration order, are no longer scanned.
+	void		PlanLinkBudget(	bool					fEnforce	);
+
+	/// Set the max planned link utilization, 0..1, under m_scanLock as
+	/// PlanLinkBudget reads it
+	void		SetLinkBudget(	double					budget,
+								bool					fEnforce	);
+
+	/// Fraction of time the link was busy w/ transactions, recently
+	double		LinkUtilization( );
+
+	/// Queued scan request callbacks, on the port thread and the queue timeout
+	void		ScanProcess(	asynUser			*	pasynUser	);
+	void		ScanTimeout(	asynUser			*	pasynUser	);
+
+	/// asynOctet I/O Intr clients get the responses of scan group reads,
+	/// and anything the lower driver publishes
+	asynStatus	RegisterInterruptUser(	asynUser		*	pasynUser,
+										interruptCallbackOctet	callback,
+										void			*	userPvt,
+										void			**	registrarPvt	);
+	asynStatus	CancelInterruptUser(	asynUser		*	pasynUser,
+										void			*	registrarPvt	);
+
+	/// Flush input after an error, fall back to a lower baud rate after
+	/// repeated errors and redo connect time negotiation when needed
+	/// Returns asynDisconnected w/o any I/O while the breaker is open
+	/// Caller must own the port
+	asynStatus	GenCpCheckLink(	asynUser			*	pasynUser	);
+
+	/// Open the breaker after timeouts consecutive ack timeouts, 0 to never
+	/// open it, w/ probes at most maxProbe sec apart.  Caller must own the port
+	void		SetBreaker(		unsigned int			timeouts,
+								double					maxProbe	);
+
+	/// Combine writes to contiguous registers into one WriteMem, 0 to disable
+	/// Pending writes are sent before any other request.  Caller must own the port
+	int			SetWriteCombine(	int					enable	);
+
+	/// Queued request callback that sends the combined writes
+	void		FlushProcess(	asynUser			*	pasynUser	);
+
+	/// Keep the value of any register read from the device for maxAge sec
+	/// in the register cache, so values may be up to maxAge old, 0 to disable.
+	/// Caller must own the port
+	void		SetRecentReads(	double					maxAge	);
+
+	/// Find the asynGenicam instance for a port
+	static asynGenicam	*	Find(	const char		*	portName	);
+
+	void		Report(			FILE				*	fp,
+								int						details	);
+
 //	Public member data
 public:
     asynInterface		m_octet;
     asynOctet     	*	m_pasynOctetDrv;
     void        	*	m_drvPvt;
+    asynInterface		m_drvUser;
+    asynInterface		m_int8Array;
+    asynInterface		m_int16Array;
+    asynInterface		m_int32Array;
+    asynDrvUser     *	m_pasynDrvUserPrev;		// Lower driver's asynDrvUser, if any
+    void        	*	m_drvUserPrevPvt;
 
 	// TODO: std::string m_portName
     char          	*	m_portName;
     int           		m_addr;
 	bool				m_fInputFlushNeeded;
+	bool				m_fBootstrapNeeded;
+	epicsTimeStamp		m_tBootstrapLast;
+	asynUser		*	m_pasynUserSelf;
+	int					m_maxBaud;				// Max baud rate for upshift, 0 to leave as configured
+	int					m_origBaud;				// Host baud rate before any upshift
+	int					m_curBaud;				// Current negotiated baud rate, 0 if not upshifted
+	int					m_fallbackBaud;			// Max baud rate after a fallback on this connection, 0 if none
+	unsigned int		m_nConsecutiveErrors;
+	bool				m_fAdaptiveTimeout;
+	double				m_minTimeout;			// Floor for adaptive ack timeouts in sec
+	std::string			m_regMapDir;			// Register map directory, empty for no map
+	bool				m_fRegMapCompile;		// Compile a missing map from the device XML
+	bool				m_fRegMapCache;			// Cache registers the map allows
+	bool				m_fCacheRefresh;		// Re-read registers a write invalidates
+	std::vector<std::string>	m_cfgSelectors;	// Selectors from asynGenicamAddSelector, address or name
+	std::vector< std::pair<std::string, unsigned int> >	m_cfgNoAck;	// From asynGenicamAddNoAckReg, w/ sync interval
+	double				m_linkBudget;			// Max planned link utilization, 0..1, guarded by m_scanLock
+	bool				m_fLinkBudgetEnforce;	// Stop scan groups past m_linkBudget, guarded by m_scanLock
+	epicsTimeStamp		m_tRequestSent;			// Send time of the pending request
+	size_t				m_sRequestSent;			// Size of the pending request packet
+	asynGenicam		*	m_pNext;
+	static asynGenicam	*	ms_pFirst;
+
+//	Private member functions
+private:
+	/// Format the register data in m_GenCpReadData as an ascii response
+	GENCP_STATUS	GenCpFormatReadData(	char	*	pBuffer,
+											size_t		sBuffer	);
+
+	/// Format nBytes of register data read from regAddr as the ascii response
+	/// to a read w/ responseType and responseCount, or per pFeature if not NULL
+	GENCP_STATUS	GenCpFormatRegData(		char	*	pBuffer,
+											size_t		sBuffer,
+											unsigned int	responseType,
+											unsigned int	responseCount,
+											unsigned long long	regAddr,
+											const uint8_t	*	pData,
+											size_t		nBytes,
+											const GenCpRegMapEntry	*	pFeature	);
+
+	/// Format register data per the byte order, bit field and sign of pFeature
+	GENCP_STATUS	GenCpFormatFeatureData(	char	*	pBuffer,
+											size_t		sBuffer,
+											const GenCpRegMapEntry	*	pFeature,
+											unsigned long long	regAddr,
+											const uint8_t	*	pData,
+											size_t		nBytes	);
+
+	/// Fill regData w/ the registers it lists, from the cache where valid,
+	/// merging the rest into as few ReadMem transactions as possible.
+	/// Registers read are stored in the cache.  Caller must own the port
+	/// If pResumeAddr is given, start at that address and stop after
+	/// maxReads transactions, leaving where to resume or GENCP_READ_REGS_DONE
+	asynStatus		GenCpReadRegs(		asynUser		*	pasynUser,
+										GenCpRegData	&	regData,
+										uint64_t		*	pResumeAddr	= NULL,
+										size_t				maxReads	= 0	);
+
+	/// Send the combined writes, if any.  If the camera rejects them, retry each
+	/// write alone, and log and add to m_lostWrites the ones that still fail.
+	/// Caller must own the port
+	asynStatus		GenCpFlushWrites(	asynUser		*	pasynUser	);
+
+	/// Fail the access w/ the error of a lost combined write to any of its
+	/// bytes, as the write was answered OK already.  Caller must own the port
+	asynStatus		GenCpCheckLostWrites(	asynUser	*	pasynUser,
+											uint64_t		regAddr,
+											size_t			numBytes	);
+
+	/// Add a write to the combined writes if it continues them, else send them
+	/// first and start anew.  Caller must own the port
+	asynStatus		GenCpCombineWrite(	asynUser		*	pasynUser,
+										uint64_t			regAddr,
+										const uint8_t	*	pData,
+										size_t				numBytes	);
+
+	/// Apply the ops of a read-modify-write, e.g. "&=~0x10 |=0x4", to the
+	/// register, read from the cache if valid.  Caller must own the port
+	asynStatus		GenCpReadModify(	asynUser		*	pasynUser,
+										const char		*	pOps,
+										unsigned int		nBits,
+										uint64_t			regAddr,
+										uint64_t		*	pValue	);
+
+	/// Range of an array request, resolved against the register map if needed,
+	/// w/ nElements limited to the range's length
+	asynStatus		GenCpArrayLookup(	asynUser		*	pasynUser,
+										size_t				elementSize,
+										size_t			*	pnElements,
+										const GenCpArrayRange	**	ppRange	);
+
+	/// Invalidate the cached registers a write to regAddr..regAddr+numBytes
+	/// makes stale, per the map, and queue them for refresh if enabled
+	void			GenCpInvalidateDependents(	uint64_t		regAddr,
+												size_t			numBytes	);
+
+	/// Forget the known value of selectors overlapping regAddr..regAddr+numBytes,
+	/// for writes that don't go through GenCpSelectorUnchanged()
+	void			GenCpForgetSelectors(	uint64_t		regAddr,
+											size_t			numBytes	);
+
+	/// True if a write of numBytes at pData to regAddr would leave a selector
+	/// at the value it is known to have.  Otherwise forgets what the write
+	/// overlaps and, for a selector, remembers the value until the ack.
+	bool			GenCpSelectorUnchanged(	uint64_t		regAddr,
+											const uint8_t	*	pData,
+											size_t			numBytes	);
+
+	/// Read the registers of the scan groups in as few ReadMem transactions
+	/// as possible, each queued as its own request at the groups' priority,
+	/// and append the responses for values that changed to m_scanPublished
+	/// Returns asynTimeout if the reads are not done by tDeadline
+	/// Called by the scan thread on copies of the due groups, w/o m_scanLock
+	/// or the port, so configuration and reports don't wait for the link
+	asynStatus		GenCpScan(			std::vector<GenCpScanGroup *> &	groups,
+										const epicsTimeStamp		&	tDeadline	);
+
+	/// Link time of one scan of a group, all registers read from the device
+	double			GenCpScanCost(		GenCpScanGroup	&	group	);
+
+	/// Add the time since the request was sent to the link busy time
+	void			LinkBusy(			const epicsTimeStamp	*	ptSent	);
+
+	/// List the registers to read for a scan group in regData, all of them
+	/// or, if fAdaptive, those due per their backoff
+	void			GenCpScanPlan(		GenCpScanGroup	&	group,
+										GenCpRegData	&	regData,
+										bool				fAdaptive	);
+
+	/// Add the registers a scan register reads to regData, NULL if none
+	const GenCpRegMapEntry	*	GenCpScanInputs(	GenCpScanReg	&	reg,
+													GenCpRegData	&	regData	);
+
+	/// Read scan registers that m_scanWrites changed at the next scan
+	void			GenCpScanResetWritten( );
+	void			GenCpScanResetWritten(	GenCpScanGroup	&	group	);
+
+	/// Append the responses for scan group values that changed to m_scanPublished
+	void			GenCpScanUpdate(	GenCpScanGroup	&	group,
+										GenCpRegData	&	regData	);
+
+	/// Pass responses to all asynOctet I/O Intr clients
+	void			GenCpPublish(		const std::vector<std::string> &	published	);
+
+	/// Compute a formula feature, reading all registers it depends on in
+	/// as few ReadMem transactions as possible.  Caller must own the port
+	asynStatus		GenCpEvalFeature(	asynUser		*	pasynUser,
+										const GenCpRegMapEntry	*	pEntry,
+										double			*	pValue	);
+
+	/// Add the registers an entry reads, directly or via formulas, to regData
+	bool			GenCpFormulaInputs(	const GenCpRegMapEntry	*	pEntry,
+										GenCpRegData	&	regData,
+										int					depth	);
+
+	/// Value of an entry from the register bytes in regData
+	bool			GenCpEvalEntry(		const GenCpRegMapEntry	*	pEntry,
+										const GenCpRegData	&	regData,
+										double			*	pValue,
+										int					depth	);
+
+	/// Resolve an N feature command via the register map and translate it
+	/// to the C, U or F command for the feature's register
+	asynStatus		FeatureToGenicam(	asynUser		*	pasynUser,
+										const char		*	data,
+										const char		**	ppSendBufferRet,
+										size_t			*	psSendBufferRet	);
+
+	/// Do a W command: optionally write a register, then poll it until
+	/// (value & mask) == or != expected, or the timeout, and answer w/ the
+	/// last value read as a U read would.  For a feature name the value is
+	/// the feature's, per its byte order and bit field.  Caller must own the port
+	asynStatus		WaitToGenicam(		asynUser		*	pasynUser,
+										const char		*	data,
+										const char		**	ppSendBufferRet,
+										size_t			*	psSendBufferRet	);
+
+	/// Translate the lines of a preset to register writes, merging writes
+	/// to the same register and sorting them by address between selectors
+	asynStatus		GenCpCompilePreset(	asynUser		*	pasynUser,
+										const char		*	pName,
+										GenCpPreset		&	preset	);
+
+	/// Write a span of changed preset registers.  Caller must own the port
+	asynStatus		GenCpPresetWriteSpan(	asynUser		*	pasynUser,
+											uint64_t			regAddr,
+											const std::vector<uint8_t>	&	span	);
+
+	/// While the breaker is open, fail at once unless a probe is due and
+	/// the device answers it.  Caller must own the port
+	asynStatus		GenCpBreakerCheck(	asynUser		*	pasynUser	);
+
+	/// Forget RTT samples, e.g. after a baud rate change
+	void			ResetRtt( );
+
 //	Private member data
 private:
+	GenCpRegCache		m_regCache;
+	bool				m_fWriteCombine;		// Combine contiguous writes
+	asynUser		*	m_pasynUserFlush;		// Queued request that sends combined writes
+	bool				m_fFlushQueued;			// m_pasynUserFlush is queued
+	uint64_t			m_combineAddr;			// Start of the combined writes
+	std::vector<uint8_t>	m_combineData;		// Combined writes, empty if none
+	std::vector<size_t>	m_combineSizes;			// Bytes of each write in m_combineData
+	unsigned long		m_nWritesCombined;		// Writes answered from m_combineData
+	unsigned long		m_nCombinedSent;		// WriteMem transactions for combined writes
+	unsigned long		m_nCombineErrors;			// Combined WriteMem transactions that failed
+	unsigned long		m_nCombineRetried;		// Writes retried alone after a failed combined write
+	unsigned long		m_nCombineLost;			// Writes answered OK that the camera never took
+	std::vector<GenCpLostWrite>	m_lostWrites;	// Lost writes not yet reported, oldest first
+	std::map<uint64_t, unsigned int>	m_noAckRegs;	// Written w/o ack, acked every N writes
+	unsigned int		m_nUnacked;				// Writes sent w/o ack since the last acked request
+	unsigned int		m_nBarrierUnacked;		// m_nUnacked when the pending acked request was sent
+	unsigned long		m_nNoAckWrites;
+	unsigned long		m_nBarrierFailures;		// Acks failed after writes w/o ack
+	unsigned long		m_nStaleAcks;			// Acks for other requests, e.g. sent despite REQACK=0
+	std::string			m_barrierError;			// First error ack of writes w/o ack, failing the next barrier
+	unsigned long		m_nReadModifyWrites;
+	unsigned long		m_nReadModifyCached;	// Of those, read from the cache
+	std::vector<GenCpArrayRange>	m_arrays;	// Index + 1 is the asynUser reason
+	std::vector<uint8_t>	m_arrayBuffer;		// Raw bytes of the array transfer in progress
+	unsigned long		m_nArrayReads;
+	unsigned long		m_nArrayWrites;
+	unsigned long long	m_nArrayBytes;
+	unsigned long		m_nWaits;
+	unsigned long		m_nWaitPolls;
+	unsigned long		m_nWaitTimeouts;
+	std::map<std::string, GenCpPreset>	m_presets;	// By name
+	unsigned long		m_nPresetApplies;
+	unsigned long		m_nPresetWrites;		// Registers written by presets
+	unsigned long		m_nPresetSkips;			// Registers already at the preset value
+	unsigned long		m_nPresetWriteMems;		// WriteMem transactions for presets
+	unsigned int		m_breakerTimeouts;		// Consecutive ack timeouts that open the breaker, 0 never
+	double				m_breakerMaxProbe;		// Max sec between probes
+	unsigned int		m_nConsecutiveTimeouts;	// Acks w/o a single byte received
+	bool				m_fBreakerOpen;			// Device not answering, requests fail at once
+	epicsTimeStamp		m_tBreakerProbe;		// Next probe due
+	double				m_breakerInterval;		// sec from the last probe to the next
+	unsigned long		m_nBreakerTrips;
+	unsigned long		m_nBreakerRejects;		// Requests failed at once
+	unsigned long		m_nBreakerProbes;
+	double				m_recentReadAge;		// sec, 0 to keep no recent reads in m_regCache
+	GenCpRegMap			m_regMap;
+	GenCpRegMapEntry	m_feature;				// Register map entry of the pending N command
+	bool				m_fFeature;				// m_feature is valid
+	bool				m_fFormulaResponse;		// Response is in m_formulaResponse
+	char				m_formulaResponse[GENCP_RESPONSE_MAX];
+	std::vector< std::pair<uint64_t, uint32_t> >	m_mapCacheable;	// Ranges set by GenCpSetMapCacheable()
+	GenCpRegData		m_refreshRegs;			// Registers to re-read once the pending write is acked
+	std::set<uint64_t>	m_selectors;			// Selector register addresses
+	GenCpRegData		m_selectorState;		// Last value acked for each selector
+	std::vector<uint8_t>	m_selectorPending;	// Value of the pending selector write
+	bool				m_fSelectorPending;		// m_selectorPending is valid
+	unsigned long		m_nSelectorSkips;		// Selector writes answered locally
+	epicsMutexId		m_scanLock;				// Guards m_scanGroups, taken after the port, never held waiting for it
+	epicsEventId		m_scanEvent;			// Wakes the scan thread on config changes
+	epicsThreadId		m_scanThread;
+	asynUser		*	m_pasynUserScan;		// Scan thread I/O
+	std::list<GenCpScanGroup>	m_scanGroups;
+	epicsMutexId		m_interruptLock;		// Guards m_interruptUsers and m_fRepublish
+	std::list<GenCpOctetInterrupt *>	m_interruptUsers;
+	bool				m_fRepublish;			// New client, publish all scanned values again
+	epicsEventId		m_scanDone;				// Signals the scan thread a queued scan request is done
+	std::vector<GenCpScanGroup *>	m_scanGroupsDue;	// Groups the queued scan requests read
+	bool				m_fScanPlanned;			// m_scanRegData lists the registers of m_scanGroupsDue
+	GenCpRegData		m_scanRegData;			// Registers of m_scanGroupsDue
+	unsigned long		m_nScanMerged;			// Register reads saved by merging groups due together
+	double				m_linkPlanned;			// Link utilization planned for scan groups, 0..1
+	epicsTimeStamp		m_tLinkWindow;			// Start of the link utilization window
+	double				m_linkBusy;				// Link busy time in the window, sec
+	double				m_linkUtil;				// Link utilization of the last full window, 0..1
+	uint64_t			m_scanResume;			// Next address of m_scanRegData to read
+	asynStatus			m_scanStatus;			// Of the last queued scan request
+	std::vector<std::string>	m_scanPublished;	// Responses to publish after the scan
+	std::vector< std::pair<uint64_t, uint32_t> >	m_scanWrites;	// Written since the last scan, guarded by the port
+	GenCpDeviceInfo		m_deviceInfo;
+	bool				m_fDeviceInfoValid;
+	bool				m_fResponseLocal;		// Response data is already in m_GenCpReadData
+	GenCpRttEstimator	m_rtt[GENCP_RTT_NUM_CLASSES];
+	size_t				m_maxReadMemBytes;		// Negotiated max ReadMem payload
+	size_t				m_maxWriteMemBytes;		// Negotiated max WriteMem payload
 	unsigned long long	m_GenCpRegAddr;
 	epicsUInt16			m_GenCpRequestId;
+	epicsUInt16			m_GenCpPendingRequestId;
 	unsigned int		m_GenCpResponseType;
 	unsigned int		m_GenCpResponseCount;
 	unsigned int		m_GenCpResponseSize;
+	size_t				m_GenCpReadBytes;		// Register bytes for the pending read or write
+	uint8_t				m_GenCpReadData[GENCP_PACKET_MAX_BYTES];
 	GenCpReadMemPacket	m_genCpReadMemPacket;
 	GenCpWriteMemPacket	m_genCpWriteMemPacket;
 	GenCpReadMemAck		m_genCpReadMemAck;
@@ -147,12 +934,86 @@ static asynStatus getOutputEos(
 	int					eossize,
 	int				*	eoslen );
 
+static void genicamExceptionCallback(
+	asynUser		*	pasynUser,
+	asynException		exception );
+
 static asynOctet genicamOctetInterface =
 {
     writeOctet, readOctet, flushIt,
     registerInterruptUser, cancelInterruptUser,
     setInputEos, getInputEos, setOutputEos, getOutputEos
 };
+
+/* asynDrvUser methods */
+static asynStatus drvUserCreate(
+	void			*	drvPvt,
+	asynUser		*	pasynUser,
+	const char		*	drvInfo,
+	const char		**	pptypeName,
+	size_t			*	psize );
+
+static asynStatus drvUserGetType(
+	void			*	drvPvt,
+	asynUser		*	pasynUser,
+	const char		**	pptypeName,
+	size_t			*	psize );
+
+static asynStatus drvUserDestroy(
+	void			*	drvPvt,
+	asynUser		*	pasynUser );
+
+static asynDrvUser genicamDrvUserInterface =
+{
+    drvUserCreate, drvUserGetType, drvUserDestroy
+};
+
+/* asynInt8Array, asynInt16Array and asynInt32Array methods */
+template <typename T>
+static asynStatus writeArray(
+	void			*	drvPvt,
+	asynUser		*	pasynUser,
+	T				*	value,
+	size_t				nElements );
+
+template <typename T>
+static asynStatus readArray(
+	void			*	drvPvt,
+	asynUser		*	pasynUser,
+	T				*	value,
+	size_t				nElements,
+	size_t			*	pnIn );
+
+template <typename Callback>
+static asynStatus registerArrayInterruptUser(
+	void			*	drvPvt,
+	asynUser		*	pasynUser,
+	Callback			callback,
+	void			*	userPvt,
+	void			**	registrarPvt );
+
+static asynStatus cancelArrayInterruptUser(
+	void			*	drvPvt,
+	asynUser		*	pasynUser,
+	void			*	registrarPvt );
+
+static asynInt8Array genicamInt8ArrayInterface =
+{
+    writeArray<epicsInt8>, readArray<epicsInt8>,
+    registerArrayInterruptUser<interruptCallbackInt8Array>, cancelArrayInterruptUser
+};
+
+static asynInt16Array genicamInt16ArrayInterface =
+{
+    writeArray<epicsInt16>, readArray<epicsInt16>,
+    registerArrayInterruptUser<interruptCallbackInt16Array>, cancelArrayInterruptUser
+};
+
+static asynInt32Array genicamInt32ArrayInterface =
+{
+    writeArray<epicsInt32>, readArray<epicsInt32>,
+    registerArrayInterruptUser<interruptCallbackInt32Array>, cancelArrayInterruptUser
+};
  
 extern "C" epicsShareFunc int
 asynGenicamConfig( const char *	portName, int addr )
@@ -160,6 +1021,12 @@ asynGenicamConfig( const char *	portName, int addr )
     asynStatus			status;
     asynInterface	*	pasynOctet;
 
+	if ( asynGenicam::Find( portName ) != NULL )
+	{
+        printf( "%s asynGenicamConfig: port already configured.\n", portName );
+        return -1;
+	}
+
 	asynGenicam	*	pInterposeGenicam	= new asynGenicam( portName, addr );
     status = pasynManager->interposeInterface(portName, addr, &pInterposeGenicam->m_octet, &pasynOctet );
     if ( status != asynSuccess || pasynOctet == NULL )
@@ -170,82 +1037,462 @@ asynGenicamConfig( const char *	portName, int addr )
     }
     pInterposeGenicam->m_pasynOctetDrv	= (asynOctet *)pasynOctet->pinterface;
     pInterposeGenicam->m_drvPvt			= pasynOctet->drvPvt;
-    return 0;
-}
- 
-/* asynOctet methods */
-static asynStatus writeOctet(
-	void				*	ppvt,
-	asynUser 			*	pasynUser,
-    const char			*	data,
-	size_t					maxChars,
-	size_t				*	pnWritten )
-{
-	asynGenicam *	pInterposeGenicam	= reinterpret_cast<asynGenicam *>( ppvt );
-	asynStatus				status			= asynSuccess;
-    static const char	*	functionName	= "asynGenicam  writeOctet";
 
-	if ( DEBUG_GENICAM >= 3 )
-		printf( "%s: %s Write %zu: %s\n", functionName, pInterposeGenicam->m_portName, strlen(data), data );
-	asynPrint(	pasynUser, ASYN_TRACE_FLOW,
-				"%s: %s maxChars %zu: %s\n", functionName, pInterposeGenicam->m_portName, maxChars, data );
+	// Array records address register ranges via drvUser, passing on what isn't ours
+    asynInterface	*	pasynPrev	= NULL;
+    if ( pasynManager->interposeInterface( portName, addr, &pInterposeGenicam->m_drvUser, &pasynPrev ) == asynSuccess )
+	{
+		if ( pasynPrev != NULL )
+		{
+			pInterposeGenicam->m_pasynDrvUserPrev	= (asynDrvUser *)pasynPrev->pinterface;
+			pInterposeGenicam->m_drvUserPrevPvt		= pasynPrev->drvPvt;
+		}
+		if (	pasynManager->interposeInterface( portName, addr, &pInterposeGenicam->m_int8Array, &pasynPrev ) != asynSuccess
+			||	pasynManager->interposeInterface( portName, addr, &pInterposeGenicam->m_int16Array, &pasynPrev ) != asynSuccess
+			||	pasynManager->interposeInterface( portName, addr, &pInterposeGenicam->m_int32Array, &pasynPrev ) != asynSuccess )
+			printf( "%s asynGenicamConfig: array interfaces not available.\n", portName );
+	}
+	else
+		printf( "%s asynGenicamConfig: drvUser interface not available, no array records.\n", portName );
 
-	if ( pnWritten )
-		*pnWritten = 0;
+	// Private asynUser for connect time I/O and connection exceptions
+	asynUser	*	pasynUser	= pasynManager->createAsynUser( 0, 0 );
+	pasynUser->userPvt	= pInterposeGenicam;
+	pasynUser->timeout	= 1.0;
+	status = pasynManager->connectDevice( pasynUser, portName, addr );
+	if ( status != asynSuccess )
+	{
+		printf( "%s asynGenicamConfig connectDevice failed: %s\n", portName, pasynUser->errorMessage );
+		pasynManager->freeAsynUser( pasynUser );
+		return 0;
+	}
+	pInterposeGenicam->m_pasynUserSelf	= pasynUser;
+	pasynManager->exceptionCallbackAdd( pasynUser, genicamExceptionCallback );
+	pInterposeGenicam->m_pNext			= asynGenicam::ms_pFirst;
+	asynGenicam::ms_pFirst				= pInterposeGenicam;
 
-	if ( maxChars == 0 )
-		return asynSuccess;
+	// Negotiate now if the port is already connected, otherwise on the first write
+	int		isConnected	= 0;
+	pasynManager->isConnected( pasynUser, &isConnected );
+	if ( isConnected && pasynManager->lockPort( pasynUser ) == asynSuccess )
+	{
+		pInterposeGenicam->GenCpConnect( pasynUser );
+		pasynManager->unlockPort( pasynUser );
+	}
+    return 0;
+}
 
-	// See if we need to flush input from prior error
-	if ( pInterposeGenicam->m_fInputFlushNeeded )
+extern "C" epicsShareFunc int
+asynGenicamSetMaxBaud( const char *	portName, int maxBaud )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
 	{
-		size_t	nRead	= 0;
-		int		eomReason;
-		char	flushBuffer[256];
-		pInterposeGenicam->m_pasynOctetDrv->read( pInterposeGenicam->m_drvPvt,
-				pasynUser, flushBuffer, 256, &nRead, &eomReason );
-		pInterposeGenicam->m_fInputFlushNeeded = false;
-		if ( DEBUG_GENICAM >= 3 )
-			printf( "%s: %s Flushed %zu bytes from input\n", functionName,
-					pInterposeGenicam->m_portName, nRead );
+        printf( "%s asynGenicamSetMaxBaud: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
 	}
+	pInterposeGenicam->m_maxBaud			= maxBaud;
+	pInterposeGenicam->m_fBootstrapNeeded	= true;
 
-	const char		*	pSendBuffer	= NULL;
-	size_t				sSendBuffer	= 0;
-	status	= pInterposeGenicam->AsciiToGenicam( pasynUser, data, maxChars,
-											&pSendBuffer, &sSendBuffer );
+	asynUser	*	pasynUser	= pInterposeGenicam->m_pasynUserSelf;
+	int				isConnected	= 0;
+	pasynManager->isConnected( pasynUser, &isConnected );
+	if ( isConnected && pasynManager->lockPort( pasynUser ) == asynSuccess )
+	{
+		pInterposeGenicam->GenCpConnect( pasynUser );
+		pasynManager->unlockPort( pasynUser );
+	}
+	return 0;
+}
 
-	size_t		nSent	= 0;
-	if ( pSendBuffer && sSendBuffer )
+extern "C" epicsShareFunc int
+asynGenicamSetRegMap( const char *	portName, const char * mapDir, int compile )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
 	{
-		status = pInterposeGenicam->m_pasynOctetDrv->write(
-					pInterposeGenicam->m_drvPvt,
-					pasynUser, pSendBuffer, sSendBuffer, &nSent );
+        printf( "%s asynGenicamSetRegMap: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
+	}
+	pInterposeGenicam->m_regMapDir		= ( mapDir != NULL ) ? mapDir : "";
+	pInterposeGenicam->m_fRegMapCompile	= ( compile != 0 );
 
-		if ( status == 0 )
-		{
-			*pnWritten = strlen( data );
+	asynUser	*	pasynUser	= pInterposeGenicam->m_pasynUserSelf;
+	int				isConnected	= 0;
+	pasynManager->isConnected( pasynUser, &isConnected );
+	if ( isConnected && !pInterposeGenicam->m_regMapDir.empty() && pasynManager->lockPort( pasynUser ) == asynSuccess )
+	{
+		pInterposeGenicam->GenCpLoadRegMap( pasynUser );
+		pInterposeGenicam->GenCpSetMapCacheable();
+		pInterposeGenicam->GenCpSetSelectors();
+		pInterposeGenicam->GenCpSetNoAck();
+		pInterposeGenicam->GenCpSetPresets();
+		pasynManager->unlockPort( pasynUser );
+	}
+	return 0;
+}
 
-			asynPrint(	pasynUser,	ASYN_TRACE_FLOW,
-						"%s: sent %zu pkt to %s for: %s\n",
-						functionName, sSendBuffer, pInterposeGenicam->m_portName, data	);
-			asynPrintIO(	pasynUser, ASYN_TRACEIO_DRIVER, data, *pnWritten,
-							"%s: %s wrote %zu: ", functionName, pInterposeGenicam->m_portName, sSendBuffer );
-		}
-		else
-		{
-			epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
-							"%s: %s write error: %s\n",
-							functionName, pInterposeGenicam->m_portName, strerror(errno)	);
-			status = asynError;
-			pInterposeGenicam->m_fInputFlushNeeded = true;
-		}
+extern "C" epicsShareFunc int
+asynGenicamSetRegCache( const char *	portName, int enable, int refresh )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
+	{
+        printf( "%s asynGenicamSetRegCache: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
 	}
 
-    return status;
+	asynUser	*	pasynUser	= pInterposeGenicam->m_pasynUserSelf;
+	if ( pasynManager->lockPort( pasynUser ) != asynSuccess )
+	{
+        printf( "%s asynGenicamSetRegCache: unable to lock port.\n", portName );
+        return -1;
+	}
+	pInterposeGenicam->m_fRegMapCache	= ( enable != 0 );
+	pInterposeGenicam->m_fCacheRefresh	= ( refresh != 0 );
+	pInterposeGenicam->GenCpSetMapCacheable();
+	pasynManager->unlockPort( pasynUser );
+	return 0;
 }
 
-static asynStatus readOctet(
+extern "C" epicsShareFunc int
+asynGenicamAddNoAckReg( const char *	portName, const char * reg, int syncEvery )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
+	{
+        printf( "%s asynGenicamAddNoAckReg: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
+	}
+	if ( reg == NULL || reg[0] == '\0' || syncEvery < 2 )
+	{
+        printf( "%s asynGenicamAddNoAckReg: register address or feature name and syncEvery >= 2 required.\n", portName );
+        return -1;
+	}
+
+	asynUser	*	pasynUser	= pInterposeGenicam->m_pasynUserSelf;
+	if ( pasynManager->lockPort( pasynUser ) != asynSuccess )
+	{
+        printf( "%s asynGenicamAddNoAckReg: unable to lock port.\n", portName );
+        return -1;
+	}
+	pInterposeGenicam->m_cfgNoAck.push_back( std::make_pair( std::string( reg ), static_cast<unsigned int>( syncEvery ) ) );
+	pInterposeGenicam->GenCpSetNoAck();
+	pasynManager->unlockPort( pasynUser );
+	return 0;
+}
+
+extern "C" epicsShareFunc int
+asynGenicamSetWriteCombine( const char *	portName, int enable )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
+	{
+        printf( "%s asynGenicamSetWriteCombine: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
+	}
+
+	asynUser	*	pasynUser	= pInterposeGenicam->m_pasynUserSelf;
+	if ( pasynManager->lockPort( pasynUser ) != asynSuccess )
+	{
+        printf( "%s asynGenicamSetWriteCombine: unable to lock port.\n", portName );
+        return -1;
+	}
+	int		status	= pInterposeGenicam->SetWriteCombine( enable );
+	pasynManager->unlockPort( pasynUser );
+	return status;
+}
+
+extern "C" epicsShareFunc int
+asynGenicamSetRecentReads( const char *	portName, double maxAgeMs )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
+	{
+        printf( "%s asynGenicamSetRecentReads: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
+	}
+
+	asynUser	*	pasynUser	= pInterposeGenicam->m_pasynUserSelf;
+	if ( pasynManager->lockPort( pasynUser ) != asynSuccess )
+	{
+        printf( "%s asynGenicamSetRecentReads: unable to lock port.\n", portName );
+        return -1;
+	}
+	pInterposeGenicam->SetRecentReads( maxAgeMs * 1e-3 );
+	pasynManager->unlockPort( pasynUser );
+	return 0;
+}
+
+extern "C" epicsShareFunc int
+asynGenicamAddSelector( const char *	portName, const char * selector )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
+	{
+        printf( "%s asynGenicamAddSelector: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
+	}
+	if ( selector == NULL || selector[0] == '\0' )
+	{
+        printf( "%s asynGenicamAddSelector: selector register address or feature name required.\n", portName );
+        return -1;
+	}
+
+	asynUser	*	pasynUser	= pInterposeGenicam->m_pasynUserSelf;
+	if ( pasynManager->lockPort( pasynUser ) != asynSuccess )
+	{
+        printf( "%s asynGenicamAddSelector: unable to lock port.\n", portName );
+        return -1;
+	}
+	pInterposeGenicam->m_cfgSelectors.push_back( selector );
+	pInterposeGenicam->GenCpSetSelectors();
+	pInterposeGenicam->GenCpSetPresets();
+	pasynManager->unlockPort( pasynUser );
+	return 0;
+}
+
+extern "C" epicsShareFunc int
+asynGenicamAddScanGroup( const char *	portName, const char * group, double period, int priority, double maxPeriod )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
+	{
+        printf( "%s asynGenicamAddScanGroup: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
+	}
+	return pInterposeGenicam->AddScanGroup( group, period, priority, maxPeriod );
+}
+
+extern "C" epicsShareFunc int
+asynGenicamAddScanReg( const char *	portName, const char * group, const char * command, double deadband )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
+	{
+        printf( "%s asynGenicamAddScanReg: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
+	}
+	return pInterposeGenicam->AddScanReg( group, command, deadband );
+}
+
+extern "C" epicsShareFunc int
+asynGenicamSetLinkBudget( const char *	portName, double maxPercent, int enforce )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
+	{
+        printf( "%s asynGenicamSetLinkBudget: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
+	}
+	pInterposeGenicam->SetLinkBudget( ( maxPercent > 0 ) ? maxPercent / 100 : GENCP_LINK_BUDGET_PERCENT / 100, enforce != 0 );
+	return 0;
+}
+
+extern "C" epicsShareFunc int
+asynGenicamSetBreaker( const char *	portName, int timeouts, double maxProbeSec )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
+	{
+        printf( "%s asynGenicamSetBreaker: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
+	}
+	if ( timeouts < 0 )
+	{
+        printf( "%s asynGenicamSetBreaker: timeouts must be >= 0.\n", portName );
+        return -1;
+	}
+
+	asynUser	*	pasynUser	= pInterposeGenicam->m_pasynUserSelf;
+	if ( pasynManager->lockPort( pasynUser ) != asynSuccess )
+	{
+        printf( "%s asynGenicamSetBreaker: unable to lock port.\n", portName );
+        return -1;
+	}
+	pInterposeGenicam->SetBreaker( static_cast<unsigned int>( timeouts ), maxProbeSec );
+	pasynManager->unlockPort( pasynUser );
+	return 0;
+}
+
+extern "C" epicsShareFunc int
+asynGenicamLoadPresets( const char *	portName, const char * fileName )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
+	{
+        printf( "%s asynGenicamLoadPresets: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
+	}
+	return pInterposeGenicam->LoadPresets( fileName );
+}
+
+extern "C" epicsShareFunc int
+asynGenicamApplyPreset( const char *	portName, const char * preset )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
+	{
+        printf( "%s asynGenicamApplyPreset: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
+	}
+	if ( preset == NULL || preset[0] == '\0' )
+	{
+        printf( "%s asynGenicamApplyPreset: preset name required.\n", portName );
+        return -1;
+	}
+
+	asynUser	*	pasynUser	= pInterposeGenicam->m_pasynUserSelf;
+	int				isConnected	= 0;
+	pasynManager->isConnected( pasynUser, &isConnected );
+	if ( !isConnected )
+	{
+        printf( "%s asynGenicamApplyPreset: port not connected.\n", portName );
+        return -1;
+	}
+	if ( pasynManager->lockPort( pasynUser ) != asynSuccess )
+	{
+        printf( "%s asynGenicamApplyPreset: unable to lock port.\n", portName );
+        return -1;
+	}
+	asynStatus	status	= pInterposeGenicam->ApplyPreset( pasynUser, preset );
+	pasynManager->unlockPort( pasynUser );
+	if ( status != asynSuccess )
+	{
+        printf( "%s asynGenicamApplyPreset: %s", portName, pasynUser->errorMessage );
+        return -1;
+	}
+	return 0;
+}
+
+extern "C" epicsShareFunc int
+asynGenicamReport( const char *	portName, int details )
+{
+	bool	fFound	= false;
+	for ( asynGenicam * pGenicam = asynGenicam::ms_pFirst; pGenicam != NULL; pGenicam = pGenicam->m_pNext )
+	{
+		if ( portName != NULL && portName[0] != '\0' && strcmp( pGenicam->m_portName, portName ) != 0 )
+			continue;
+		pGenicam->Report( stdout, details );
+		fFound = true;
+	}
+	if ( !fFound && portName != NULL && portName[0] != '\0' )
+	{
+        printf( "%s asynGenicamReport: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
+	}
+	return 0;
+}
+
+extern "C" epicsShareFunc int
+asynGenicamSetAdaptiveTimeout( const char *	portName, int enable, double minTimeoutMs )
+{
+	asynGenicam	*	pInterposeGenicam	= asynGenicam::Find( portName );
+	if ( pInterposeGenicam == NULL || pInterposeGenicam->m_pasynUserSelf == NULL )
+	{
+        printf( "%s asynGenicamSetAdaptiveTimeout: port not configured via asynGenicamConfig.\n", portName );
+        return -1;
+	}
+
+	// Ack timeouts are figured on the port thread, so change them only w/ the port
+	asynUser	*	pasynUser	= pInterposeGenicam->m_pasynUserSelf;
+	if ( pasynManager->lockPort( pasynUser ) != asynSuccess )
+	{
+        printf( "%s asynGenicamSetAdaptiveTimeout: unable to lock port.\n", portName );
+        return -1;
+	}
+	pInterposeGenicam->m_fAdaptiveTimeout	= ( enable != 0 );
+	pInterposeGenicam->m_minTimeout			= ( minTimeoutMs > 0 ) ? minTimeoutMs * 1e-3 : GENCP_RTO_MIN_SEC;
+	pasynManager->unlockPort( pasynUser );
+	return 0;
+}
+
+/// Ask for a fresh bootstrap after any (re)connect of the underlying port
+static void genicamExceptionCallback( asynUser * pasynUser, asynException exception )
+{
+	asynGenicam *	pInterposeGenicam	= reinterpret_cast<asynGenicam *>( pasynUser->userPvt );
+	if ( exception == asynExceptionConnect )
+	{
+		// A new connection gets the full rate again
+		pInterposeGenicam->m_fBootstrapNeeded	= true;
+		pInterposeGenicam->m_fallbackBaud		= 0;
+	}
+}
+ 
+/* asynOctet methods */
+static asynStatus writeOctet(
+	void				*	ppvt,
+	asynUser 			*	pasynUser,
+    const char			*	data,
+	size_t					maxChars,
+	size_t				*	pnWritten )
+{
+	asynGenicam *	pInterposeGenicam	= reinterpret_cast<asynGenicam *>( ppvt );
+	asynStatus				status			= asynSuccess;
+    static const char	*	functionName	= "asynGenicam  writeOctet";
+
+	if ( DEBUG_GENICAM >= 3 )
+		printf( "%s: %s Write %zu: %s\n", functionName, pInterposeGenicam->m_portName, strlen(data), data );
+	asynPrint(	pasynUser, ASYN_TRACE_FLOW,
+				"%s: %s maxChars %zu: %s\n", functionName, pInterposeGenicam->m_portName, maxChars, data );
+
+	if ( pnWritten )
+		*pnWritten = 0;
+
+	if ( maxChars == 0 )
+		return asynSuccess;
+
+	status	= pInterposeGenicam->GenCpCheckLink( pasynUser );
+	if ( status != asynSuccess )
+		return status;
+
+	const char		*	pSendBuffer	= NULL;
+	size_t				sSendBuffer	= 0;
+	status	= pInterposeGenicam->AsciiToGenicam( pasynUser, data, maxChars,
+											&pSendBuffer, &sSendBuffer );
+
+	size_t		nSent	= 0;
+	if ( pSendBuffer && sSendBuffer )
+	{
+		status = pInterposeGenicam->m_pasynOctetDrv->write(
+					pInterposeGenicam->m_drvPvt,
+					pasynUser, pSendBuffer, sSendBuffer, &nSent );
+
+		if ( status == 0 )
+		{
+			*pnWritten = strlen( data );
+			epicsTimeGetCurrent( &pInterposeGenicam->m_tRequestSent );
+			pInterposeGenicam->m_sRequestSent	= sSendBuffer;
+
+			asynPrint(	pasynUser,	ASYN_TRACE_FLOW,
+						"%s: sent %zu pkt to %s for: %s\n",
+						functionName, sSendBuffer, pInterposeGenicam->m_portName, data	);
+			asynPrintIO(	pasynUser, ASYN_TRACEIO_DRIVER, data, *pnWritten,
+							"%s: %s wrote %zu: ", functionName, pInterposeGenicam->m_portName, sSendBuffer );
+		}
+		else
+		{
+			epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+							"%s: %s write error: %s\n",
+							functionName, pInterposeGenicam->m_portName, strerror(errno)	);
+			status = asynError;
+			pInterposeGenicam->m_fInputFlushNeeded = true;
+		}
+	}
+	else if ( status == asynSuccess )
+	{
+		// Answered locally, e.g. from the register cache
+		if ( pnWritten )
+			*pnWritten = strlen( data );
+		asynPrint(	pasynUser,	ASYN_TRACE_FLOW,
+					"%s: %s answered locally for: %s\n",
+					functionName, pInterposeGenicam->m_portName, data	);
+	}
+
+    return status;
+}
+
+static asynStatus readOctet(
 	void			*	ppvt,
 	asynUser		*	pasynUser,
     char			*	data,
@@ -271,6 +1518,17 @@ static asynStatus readOctet(
 		return asynSuccess;
 
 	status	= pInterposeGenicam->GenicamToAscii( pasynUser, data, nBytesReadMax, pnRead, eomReason );
+	if ( pInterposeGenicam->BarrierDone( pasynUser, status ) != status )
+	{
+		// Failed by an earlier write w/o ack, the response is dropped
+		status	= asynError;
+		if ( pnRead )
+			*pnRead = 0;
+	}
+	if ( status == asynSuccess )
+		pInterposeGenicam->m_nConsecutiveErrors = 0;
+	else
+		pInterposeGenicam->m_nConsecutiveErrors++;
 
 	if ( pnRead && *pnRead > 0 )
 	{
@@ -306,8 +1564,7 @@ static asynStatus registerInterruptUser(
 {
     asynGenicam *pInterposeGenicam = (asynGenicam *)ppvt;
 
-    return pInterposeGenicam->m_pasynOctetDrv->registerInterruptUser(
-        pInterposeGenicam->m_drvPvt, pasynUser, callback, userPvt, registrarPvt );
+    return pInterposeGenicam->RegisterInterruptUser( pasynUser, callback, userPvt, registrarPvt );
 }
 
 static asynStatus cancelInterruptUser(
@@ -317,8 +1574,86 @@ static asynStatus cancelInterruptUser(
 {
     asynGenicam *pInterposeGenicam = (asynGenicam *)drvPvt;
 
-    return pInterposeGenicam->m_pasynOctetDrv->cancelInterruptUser(
-        pInterposeGenicam->m_drvPvt, pasynUser, registrarPvt );
+    return pInterposeGenicam->CancelInterruptUser( pasynUser, registrarPvt );
+}
+
+static asynStatus drvUserCreate(
+	void *drvPvt,
+	asynUser *pasynUser,
+	const char *drvInfo,
+	const char **pptypeName,
+	size_t *psize )
+{
+    asynGenicam *pInterposeGenicam = (asynGenicam *)drvPvt;
+
+    return pInterposeGenicam->DrvUserCreate( pasynUser, drvInfo, pptypeName, psize );
+}
+
+static asynStatus drvUserGetType(
+	void *drvPvt,
+	asynUser *pasynUser,
+	const char **pptypeName,
+	size_t *psize )
+{
+    asynGenicam *pInterposeGenicam = (asynGenicam *)drvPvt;
+
+    return pInterposeGenicam->DrvUserGetType( pasynUser, pptypeName, psize );
+}
+
+static asynStatus drvUserDestroy(
+	void *drvPvt,
+	asynUser *pasynUser )
+{
+    asynGenicam *pInterposeGenicam = (asynGenicam *)drvPvt;
+
+    return pInterposeGenicam->DrvUserDestroy( pasynUser );
+}
+
+template <typename T>
+static asynStatus writeArray(
+	void *drvPvt,
+	asynUser *pasynUser,
+	T *value,
+	size_t nElements )
+{
+    asynGenicam *pInterposeGenicam = (asynGenicam *)drvPvt;
+
+    return pInterposeGenicam->ArrayWrite( pasynUser, value, nElements );
+}
+
+template <typename T>
+static asynStatus readArray(
+	void *drvPvt,
+	asynUser *pasynUser,
+	T *value,
+	size_t nElements,
+	size_t *pnIn )
+{
+    asynGenicam *pInterposeGenicam = (asynGenicam *)drvPvt;
+
+    return pInterposeGenicam->ArrayRead( pasynUser, value, nElements, pnIn );
+}
+
+template <typename Callback>
+static asynStatus registerArrayInterruptUser(
+	void * /*drvPvt*/,
+	asynUser *pasynUser,
+	Callback /*callback*/,
+	void * /*userPvt*/,
+	void ** /*registrarPvt*/ )
+{
+	// Scan groups publish text, there is nothing to publish arrays from
+	epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+					"asynGenicam: I/O Intr not supported for arrays\n" );
+    return asynError;
+}
+
+static asynStatus cancelArrayInterruptUser(
+	void * /*drvPvt*/,
+	asynUser * /*pasynUser*/,
+    void * /*registrarPvt*/ )
+{
+    return asynError;
 }
 
 static asynStatus setInputEos(
@@ -381,14 +1716,128 @@ asynGenicam::asynGenicam( const char *	portName, int addr )
     :	m_octet(							),
     	m_pasynOctetDrv(			NULL	),
     	m_drvPvt(					NULL	),
+    	m_drvUser(							),
+    	m_int8Array(						),
+    	m_int16Array(						),
+    	m_int32Array(						),
+    	m_pasynDrvUserPrev(			NULL	),
+    	m_drvUserPrevPvt(			NULL	),
     	m_portName(					NULL	),
     	m_addr(						addr	),
 		m_fInputFlushNeeded(		false	),			
+		m_fBootstrapNeeded(			true	),
+		m_tBootstrapLast(					),
+		m_pasynUserSelf(			NULL	),
+		m_maxBaud(					0		),
+		m_origBaud(					0		),
+		m_curBaud(					0		),
+		m_fallbackBaud(				0		),
+		m_nConsecutiveErrors(		0		),
+		m_fAdaptiveTimeout(			false	),
+		m_minTimeout(	GENCP_RTO_MIN_SEC	),
+		m_regMapDir(						),
+		m_fRegMapCompile(			false	),
+		m_fRegMapCache(				false	),
+		m_fCacheRefresh(			false	),
+		m_cfgSelectors(						),
+		m_cfgNoAck(							),
+		m_linkBudget(	GENCP_LINK_BUDGET_PERCENT / 100	),
+		m_fLinkBudgetEnforce(		false	),
+		m_tRequestSent(						),
+		m_sRequestSent(				0		),
+		m_pNext(					NULL	),
+		m_regCache(							),
+		m_fWriteCombine(			false	),
+		m_pasynUserFlush(			NULL	),
+		m_fFlushQueued(				false	),
+		m_combineAddr(				0		),
+		m_combineData(						),
+		m_combineSizes(						),
+		m_nWritesCombined(			0		),
+		m_nCombinedSent(			0		),
+		m_nCombineErrors(			0		),
+		m_nCombineRetried(			0		),
+		m_nCombineLost(				0		),
+		m_lostWrites(						),
+		m_noAckRegs(						),
+		m_nUnacked(					0		),
+		m_nBarrierUnacked(			0		),
+		m_nNoAckWrites(				0		),
+		m_nBarrierFailures(			0		),
+		m_nStaleAcks(				0		),
+		m_barrierError(						),
+		m_nReadModifyWrites(		0		),
+		m_nReadModifyCached(		0		),
+		m_arrays(							),
+		m_arrayBuffer(						),
+		m_nArrayReads(				0		),
+		m_nArrayWrites(				0		),
+		m_nArrayBytes(				0		),
+		m_nWaits(					0		),
+		m_nWaitPolls(				0		),
+		m_nWaitTimeouts(			0		),
+		m_presets(							),
+		m_nPresetApplies(			0		),
+		m_nPresetWrites(			0		),
+		m_nPresetSkips(				0		),
+		m_nPresetWriteMems(			0		),
+		m_breakerTimeouts(	GENCP_BREAKER_TIMEOUTS	),
+		m_breakerMaxProbe(	GENCP_BREAKER_MAX_PROBE_SEC	),
+		m_nConsecutiveTimeouts(		0		),
+		m_fBreakerOpen(				false	),
+		m_tBreakerProbe(					),
+		m_breakerInterval(	GENCP_BREAKER_MIN_PROBE_SEC	),
+		m_nBreakerTrips(			0		),
+		m_nBreakerRejects(			0		),
+		m_nBreakerProbes(			0		),
+		m_recentReadAge(			0.0		),
+		m_regMap(							),
+		m_feature(							),
+		m_fFeature(					false	),
+		m_fFormulaResponse(			false	),
+		m_formulaResponse(					),
+		m_mapCacheable(						),
+		m_refreshRegs(						),
+		m_selectors(						),
+		m_selectorState(					),
+		m_selectorPending(					),
+		m_fSelectorPending(			false	),
+		m_nSelectorSkips(			0		),
+		m_scanLock(	epicsMutexMustCreate( )	),
+		m_scanEvent(	epicsEventMustCreate( epicsEventEmpty )	),
+		m_scanThread(				NULL	),
+		m_pasynUserScan(			NULL	),
+		m_scanGroups(						),
+		m_interruptLock(	epicsMutexMustCreate( )	),
+		m_interruptUsers(					),
+		m_fRepublish(				false	),
+		m_scanDone(	epicsEventMustCreate( epicsEventEmpty )	),
+		m_scanGroupsDue(					),
+		m_fScanPlanned(				false	),
+		m_scanRegData(						),
+		m_nScanMerged(				0		),
+		m_linkPlanned(				0.0		),
+		m_tLinkWindow(						),
+		m_linkBusy(					0.0		),
+		m_linkUtil(					0.0		),
+		m_scanResume(				0		),
+		m_scanStatus(		asynSuccess		),
+		m_scanPublished(					),
+		m_scanWrites(						),
+		m_deviceInfo(						),
+		m_fDeviceInfoValid(			false	),
+		m_fResponseLocal(			false	),
+		m_rtt(								),
+		m_maxReadMemBytes(	GENCP_READMEM_MAX_BYTES	),
+		m_maxWriteMemBytes(	GENCP_READMEM_MAX_BYTES	),
 		m_GenCpRegAddr(				0LL		),			
 		m_GenCpRequestId(			0		),
+		m_GenCpPendingRequestId(	0		),
 		m_GenCpResponseType(		0		),
 		m_GenCpResponseCount(		0		),
 		m_GenCpResponseSize(		0		),
+		m_GenCpReadBytes(			0		),
+		m_GenCpReadData(					),
 		m_genCpReadMemPacket(				),
 		m_genCpWriteMemPacket(				),
 		m_GenCpResponsePending(				)
@@ -397,16 +1846,2245 @@ asynGenicam::asynGenicam( const char *	portName, int addr )
     m_octet.interfaceType = asynOctetType;
     m_octet.pinterface = &genicamOctetInterface;
     m_octet.drvPvt = this;
+    m_drvUser.interfaceType = asynDrvUserType;
+    m_drvUser.pinterface = &genicamDrvUserInterface;
+    m_drvUser.drvPvt = this;
+    m_int8Array.interfaceType = asynInt8ArrayType;
+    m_int8Array.pinterface = &genicamInt8ArrayInterface;
+    m_int8Array.drvPvt = this;
+    m_int16Array.interfaceType = asynInt16ArrayType;
+    m_int16Array.pinterface = &genicamInt16ArrayInterface;
+    m_int16Array.drvPvt = this;
+    m_int32Array.interfaceType = asynInt32ArrayType;
+    m_int32Array.pinterface = &genicamInt32ArrayInterface;
+    m_int32Array.drvPvt = this;
+
+	GenCpSetMapCacheable();
 }
 
-asynGenicam::~asynGenicam()
+asynGenicam	*	asynGenicam::ms_pFirst	= NULL;
+
+asynGenicam	*	asynGenicam::Find( const char * portName )
 {
-	free( (void *)m_portName );
-	m_portName = NULL;
+	for ( asynGenicam * pGenicam = ms_pFirst; pGenicam != NULL; pGenicam = pGenicam->m_pNext )
+	{
+		if ( strcmp( pGenicam->m_portName, portName ) == 0 )
+			return pGenicam;
+	}
+	return NULL;
 }
 
-asynStatus	asynGenicam::AsciiToGenicam(
-	asynUser			*	pasynUser,
+void	asynGenicam::Report( FILE * fp, int details )
+{
+	fprintf( fp, "asynGenicam %s addr %d\n", m_portName, m_addr );
+	if ( m_fDeviceInfoValid )
+	{
+		fprintf( fp, "  %s %s, version %s, serial %s\n", m_deviceInfo.manufacturerName,
+				m_deviceInfo.modelName, m_deviceInfo.deviceVersion, m_deviceInfo.serialNumber );
+		if ( details >= 1 )
+		{
+			fprintf( fp, "  Family %s, user name %s\n", m_deviceInfo.familyName, m_deviceInfo.userDefinedName );
+			fprintf( fp, "  GenCP version %u.%u, capability 0x%llX, max response time %u ms\n",
+					m_deviceInfo.gencpVersion >> 16, m_deviceInfo.gencpVersion & 0xFFFF,
+					(long long unsigned int) m_deviceInfo.deviceCapability, m_deviceInfo.maxDeviceResponseTime );
+			fprintf( fp, "  Manifest 0x%llX, SBRM 0x%llX\n",
+					(long long unsigned int) m_deviceInfo.manifestTableAddress,
+					(long long unsigned int) m_deviceInfo.sbrmAddress );
+		}
+	}
+	else
+		fprintf( fp, "  BRM not read yet\n" );
+	fprintf( fp, "  Max ReadMem %zu, max WriteMem %zu bytes, baud %d\n",
+			m_maxReadMemBytes, m_maxWriteMemBytes, m_curBaud ? m_curBaud : m_origBaud );
+	for ( unsigned int iClass = 0; iClass < GENCP_RTT_NUM_CLASSES; iClass++ )
+	{
+		fprintf( fp, "  %s RTT %.2f ms, var %.2f ms, %lu samples, %lu timeouts, ack timeout %.1f ms%s\n",
+				iClass == GENCP_RTT_READ ? "ReadMem " : "WriteMem",
+				m_rtt[iClass].Srtt() * 1e3, m_rtt[iClass].RttVar() * 1e3,
+				m_rtt[iClass].NumSamples(), m_rtt[iClass].NumTimeouts(),
+				RequestTimeout( iClass, m_maxReadMemBytes, m_pasynUserSelf ? m_pasynUserSelf->timeout : 1.0 ) * 1e3,
+				m_fAdaptiveTimeout ? "" : " (adaptive timeouts off)" );
+	}
+	epicsMutexMustLock( m_scanLock );
+	fprintf( fp, "  Link utilization %.1f%% measured, %.1f%% planned for scan groups, budget %.0f%%%s\n",
+			LinkUtilization() * 100, m_linkPlanned * 100, m_linkBudget * 100,
+			m_fLinkBudgetEnforce ? " enforced" : "" );
+	for ( std::list<GenCpScanGroup>::iterator it = m_scanGroups.begin(); it != m_scanGroups.end(); ++it )
+	{
+		fprintf( fp, "  Scan group %s: %zu registers every %.3f sec at priority %d, %.1f ms per scan%s, "
+					"%lu scans, %lu overruns, %lu starved, %lu dropped, %lu errors, %lu published\n",
+				it->name.c_str(), it->regs.size(), it->period, it->priority, it->cost * 1e3,
+				it->fDisabled ? " refused by link budget" : "", it->nScans, it->nOverruns,
+				it->nStarved, it->nDropped, it->nErrors, it->nPublished );
+		if ( it->maxPeriod > it->period )
+			fprintf( fp, "    Adaptive up to %.3f sec, %lu reads skipped\n", it->maxPeriod, it->nSkipped );
+		for ( size_t iReg = 0; details >= 2 && iReg < it->regs.size(); iReg++ )
+			fprintf( fp, "    %-40s deadband %g\n", it->regs[iReg].command.c_str(), it->regs[iReg].deadband );
+	}
+	if ( m_nScanMerged > 0 )
+		fprintf( fp, "  %lu scan register reads merged across groups\n", m_nScanMerged );
+	epicsMutexUnlock( m_scanLock );
+	if ( !m_selectors.empty() )
+		fprintf( fp, "  %zu selectors, %lu unchanged selector writes skipped\n", m_selectors.size(), m_nSelectorSkips );
+	if ( m_fRegMapCache )
+		fprintf( fp, "  Map register caching on, %zu ranges%s\n", m_mapCacheable.size(),
+				m_fCacheRefresh ? ", refreshed after writes" : "" );
+	m_regCache.Report( fp, details );
+	if ( !m_noAckRegs.empty() )
+		fprintf( fp, "  %zu registers written w/o ack, %lu writes, %lu failed barriers, %lu stale acks discarded\n",
+				m_noAckRegs.size(), m_nNoAckWrites, m_nBarrierFailures, m_nStaleAcks );
+	if ( !m_arrays.empty() )
+	{
+		fprintf( fp, "  %zu array ranges, %lu reads, %lu writes, %llu bytes\n",
+				m_arrays.size(), m_nArrayReads, m_nArrayWrites, m_nArrayBytes );
+		for ( size_t iArray = 0; details >= 1 && iArray < m_arrays.size(); iArray++ )
+		{
+			if ( m_arrays[iArray].fResolved )
+				fprintf( fp, "    %s: 0x%llX, %zu bytes%s\n", m_arrays[iArray].drvInfo.c_str(),
+						(long long unsigned int) m_arrays[iArray].address, m_arrays[iArray].length,
+						m_arrays[iArray].fLittleEndian ? ", little endian" : "" );
+			else
+				fprintf( fp, "    %s: not resolved yet\n", m_arrays[iArray].drvInfo.c_str() );
+		}
+	}
+	if ( m_nWaits > 0 )
+		fprintf( fp, "  %lu waits, %lu polls, %lu timed out\n", m_nWaits, m_nWaitPolls, m_nWaitTimeouts );
+	if ( m_fBreakerOpen || m_nBreakerTrips > 0 )
+		fprintf( fp, "  breaker %s, opened %lu times, %lu requests failed at once, %lu probes\n",
+				m_fBreakerOpen ? "open" : "closed", m_nBreakerTrips, m_nBreakerRejects, m_nBreakerProbes );
+	if ( !m_presets.empty() )
+		fprintf( fp, "  %zu presets, %lu applied, %lu registers written in %lu WriteMems, %lu unchanged\n",
+				m_presets.size(), m_nPresetApplies, m_nPresetWrites, m_nPresetWriteMems, m_nPresetSkips );
+	if ( m_nReadModifyWrites > 0 )
+		fprintf( fp, "  %lu read-modify-writes, %lu read from the cache\n",
+				m_nReadModifyWrites, m_nReadModifyCached );
+	if ( m_fWriteCombine || m_nWritesCombined > 0 )
+		fprintf( fp, "  Write combining %s, %lu writes in %lu WriteMem, %lu failed, %lu writes retried, %lu lost, %zu bytes pending\n",
+				m_fWriteCombine ? "on" : "off", m_nWritesCombined, m_nCombinedSent, m_nCombineErrors,
+				m_nCombineRetried, m_nCombineLost, m_combineData.size() );
+	if ( !m_regMapDir.empty() )
+		m_regMap.Report( fp, details );
+}
+
+asynGenicam::~asynGenicam()
+{
+	if ( m_pasynUserSelf )
+	{
+		pasynManager->exceptionCallbackRemove( m_pasynUserSelf );
+		pasynManager->disconnect( m_pasynUserSelf );
+		pasynManager->freeAsynUser( m_pasynUserSelf );
+		m_pasynUserSelf = NULL;
+	}
+	free( (void *)m_portName );
+	m_portName = NULL;
+}
+
+asynStatus	asynGenicam::GenCpTransaction(
+	asynUser			*	pasynUser,
+	const void			*	pCmd,
+	size_t					sCmd,
+	void				*	pAck,
+	size_t					sAckMax,
+	size_t				*	pnAckRead )
+{
+    static const char	*	functionName	= "asynGenicam::GenCpTransaction";
+	asynStatus				status;
+	size_t					nSent			= 0;
+	size_t					sHeader			= sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDAck);
+
+	if ( pnAckRead )
+		*pnAckRead = 0;
+	if ( sAckMax < sHeader )
+		return asynError;
+
+	status = m_pasynOctetDrv->write( m_drvPvt, pasynUser, reinterpret_cast<const char *>( pCmd ), sCmd, &nSent );
+	if ( status != asynSuccess || nSent != sCmd )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s write error, sent %zu of %zu\n", functionName, m_portName, nSent, sCmd );
+		m_fInputFlushNeeded = true;
+		return asynError;
+	}
+
+	epicsTimeStamp			tSent;
+	epicsTimeGetCurrent( &tSent );
+	const GenCpCCDRequest *	pCCD		= reinterpret_cast<const GenCpCCDRequest *>(
+											reinterpret_cast<const char *>( pCmd ) + sizeof(GenCpSerialPrefix) );
+	uint16_t				requestId	= GenCpBigEndianToCpu( pCCD->ccdRequestId );
+	unsigned int			rttClass	= ( GenCpBigEndianToCpu( pCCD->ccdCommandId ) == GENCP_ID_READMEM_CMD )
+										? GENCP_RTT_READ : GENCP_RTT_WRITE;
+
+	status = GenCpReadAck( pasynUser, requestId, rttClass, sCmd, &tSent, pAck, sAckMax, pnAckRead );
+	if ( status != asynSuccess )
+		m_fInputFlushNeeded = true;
+	return status;
+}
+
+asynStatus	asynGenicam::GenCpReadAck(
+	asynUser			*	pasynUser,
+	uint16_t				requestId,
+	unsigned int			rttClass,
+	size_t					sCmd,
+	const epicsTimeStamp *	ptSent,
+	void				*	pAck,
+	size_t					sAckMax,
+	size_t				*	pnAckRead	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpReadAck";
+	asynStatus				status			= asynSuccess;
+	size_t					sHeader			= sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDAck);
+	size_t					sAckLimit		= ( sAckMax > sizeof(GenCpPendingAck) ) ? sAckMax : sizeof(GenCpPendingAck);
+	char				*	pAckBuffer		= reinterpret_cast<char *>( pAck );
+	GenCpCCDAck			*	pCCD			= reinterpret_cast<GenCpCCDAck *>( pAckBuffer + sizeof(GenCpSerialPrefix) );
+	double					userTimeout		= pasynUser->timeout;
+	double					timeout			= RequestTimeout( rttClass, sCmd + sAckMax, userTimeout );
+	bool					fPending		= false;
+	size_t					nRead			= 0;
+	size_t					sAck			= sHeader;
+	epicsTimeStamp			tStart;
+	epicsTimeStamp			tNow;
+
+	if ( pnAckRead )
+		*pnAckRead = 0;
+	if ( sAckMax < sHeader )
+		return asynError;
+
+	epicsTimeGetCurrent( &tStart );
+	while ( nRead < sAck )
+	{
+		size_t		nNew		= 0;
+		int			eomReason	= 0;
+		if ( timeout > 0 )
+		{
+			// One timeout for the whole ack, not per partial read
+			epicsTimeGetCurrent( &tNow );
+			double	remaining	= timeout - epicsTimeDiffInSeconds( &tNow, &tStart );
+			if ( remaining <= 0 )
+			{
+				status = asynTimeout;
+				break;
+			}
+			pasynUser->timeout	= remaining;
+		}
+		status = m_pasynOctetDrv->read( m_drvPvt, pasynUser, pAckBuffer + nRead, sAck - nRead, &nNew, &eomReason );
+		nRead += nNew;
+		if ( status != asynSuccess || nNew == 0 )
+			break;
+		if ( nRead == sHeader && sAck == sHeader )
+		{
+			sAck	+= GenCpBigEndianToCpu( pCCD->ccdScdLength );
+			if ( sAck > sAckLimit )
+			{
+				epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+								"%s: %s ack length %zu > max %zu\n", functionName, m_portName, sAck, sAckLimit );
+				status = asynError;
+				break;
+			}
+		}
+		if ( nRead == sAck && GenCpBigEndianToCpu( pCCD->ccdRequestId ) != requestId )
+		{
+			// Not ours, typically a device that acks writes sent w/ REQACK=0, drop it and read on
+			m_nStaleAcks++;
+			uint16_t	ackStatus	= GenCpBigEndianToCpu( pCCD->ccdStatusCode );
+			if (	ackStatus != GENCP_STATUS_SUCCESS && m_barrierError.empty()
+				&&	( m_nUnacked > 0 || m_nBarrierUnacked > 0 ) )
+			{
+				char	error[128];
+				epicsSnprintf(	error, sizeof(error), "write w/o ack, req %u, failed w/ status 0x%X",
+								GenCpBigEndianToCpu( pCCD->ccdRequestId ), ackStatus );
+				m_barrierError	= error;
+			}
+			asynPrint(	pasynUser, ASYN_TRACE_FLOW,
+						"%s: %s discarded ack for req %u while waiting for req %u\n",
+						functionName, m_portName, GenCpBigEndianToCpu( pCCD->ccdRequestId ), requestId );
+			nRead		= 0;
+			sAck		= sHeader;
+			continue;
+		}
+		if ( nRead == sAck && GenCpBigEndianToCpu( pCCD->ccdCommandId ) == GENCP_ID_PENDING_ACK )
+		{
+			uint16_t	msTimeout	= 0;
+			if ( GenCpProcessPendingAck( reinterpret_cast<GenCpPendingAck *>( pAckBuffer ), requestId, &msTimeout )
+					!= GENCP_STATUS_SUCCESS )
+			{
+				epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+								"%s: %s invalid pending ack for req %u\n", functionName, m_portName, requestId );
+				status = asynError;
+				break;
+			}
+			// Device needs more time, restart the wait for the real ack w/ the time it asked for
+			asynPrint(	pasynUser, ASYN_TRACE_FLOW,
+						"%s: %s req %u pending, %u ms more\n", functionName, m_portName, requestId, msTimeout );
+			fPending	= true;
+			timeout		= WireTime( sAckMax ) + msTimeout * 1e-3 + m_minTimeout;
+			nRead		= 0;
+			sAck		= sHeader;
+			epicsTimeGetCurrent( &tStart );
+		}
+	}
+	pasynUser->timeout	= userTimeout;
+	if ( pnAckRead )
+		*pnAckRead = nRead;
+	if ( ptSent != NULL )
+		LinkBusy( ptSent );
+
+	// Only silence counts toward the breaker, any byte shows the device is there
+	if ( nRead > 0 )
+		m_nConsecutiveTimeouts	= 0;
+	else if ( ( status == asynTimeout || status == asynSuccess ) && ++m_nConsecutiveTimeouts >= m_breakerTimeouts
+			&&	m_breakerTimeouts > 0 && !m_fBreakerOpen )
+	{
+		m_fBreakerOpen		= true;
+		m_nBreakerTrips++;
+		m_breakerInterval	= std::min( GENCP_BREAKER_MIN_PROBE_SEC, m_breakerMaxProbe );
+		epicsTimeGetCurrent( &m_tBreakerProbe );
+		epicsTimeAddSeconds( &m_tBreakerProbe, m_breakerInterval );
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s %u acks timed out in a row, failing requests until the device answers a probe\n",
+					functionName, m_portName, m_nConsecutiveTimeouts );
+	}
+
+	if ( nRead < sAck )
+	{
+		if ( status == asynSuccess )
+			status = asynTimeout;
+		if ( status == asynTimeout && rttClass < GENCP_RTT_NUM_CLASSES )
+			m_rtt[rttClass].Backoff();
+		if ( nRead > 0 || status != asynTimeout )
+			epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+							"%s: %s read %zu of %zu ack bytes\n", functionName, m_portName, nRead, sAck );
+		else
+			epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+							"%s: %s no ack for req %u in %.1f ms\n", functionName, m_portName, requestId, timeout * 1e3 );
+		return status;
+	}
+	if ( status != asynSuccess )
+		return status;
+
+	// Pending acks make the round trip ambiguous, don't sample those
+	if ( !fPending && ptSent != NULL && rttClass < GENCP_RTT_NUM_CLASSES )
+	{
+		epicsTimeGetCurrent( &tNow );
+		m_rtt[rttClass].Sample( epicsTimeDiffInSeconds( &tNow, ptSent ) - WireTime( sCmd + nRead ) );
+	}
+	return asynSuccess;
+}
+
+double	asynGenicam::RequestTimeout(
+	unsigned int			rttClass,
+	size_t					nBytes,
+	double					userTimeout	)
+{
+	if ( !m_fAdaptiveTimeout || userTimeout <= 0 || rttClass >= GENCP_RTT_NUM_CLASSES )
+		return userTimeout;
+
+	// The device must ack, or send a pending ack, within its max response time
+	double	maxResponse	= 0.0;
+	if ( m_fDeviceInfoValid && m_deviceInfo.maxDeviceResponseTime > 0 )
+		maxResponse	= m_deviceInfo.maxDeviceResponseTime * 1e-3 + m_minTimeout;
+
+	double	timeout		= m_rtt[rttClass].Timeout();
+	if ( timeout <= 0.0 || ( maxResponse > 0.0 && timeout > maxResponse ) )
+		timeout	= maxResponse;
+	if ( timeout <= 0.0 )
+		return userTimeout;
+	if ( timeout < m_minTimeout )
+		timeout	= m_minTimeout;
+	timeout	+= WireTime( nBytes );
+	return ( timeout < userTimeout ) ? timeout : userTimeout;
+}
+
+double	asynGenicam::WireTime(
+	size_t					nBytes	)
+{
+	// 8N1, 10 bits per byte
+	int		baud	= m_curBaud ? m_curBaud : m_origBaud;
+	if ( baud <= 0 )
+		return 0.0;
+	return nBytes * 10.0 / baud;
+}
+
+void	asynGenicam::ResetRtt( )
+{
+	for ( unsigned int iClass = 0; iClass < GENCP_RTT_NUM_CLASSES; iClass++ )
+		m_rtt[iClass].Reset();
+}
+
+asynStatus	asynGenicam::GenCpReadMem(
+	asynUser			*	pasynUser,
+	uint64_t				regAddr,
+	void				*	pBuffer,
+	size_t					numBytes )
+{
+    static const char	*	functionName	= "asynGenicam::GenCpReadMem";
+	GenCpReadMemPacket		readMemPacket;
+	GenCpReadMemAck			readMemAck;
+	size_t					nAckRead		= 0;
+	size_t					nBytesRead		= 0;
+	uint16_t				requestId		= m_GenCpRequestId++;
+
+	if ( numBytes == 0 || numBytes > m_maxReadMemBytes )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s invalid read size %zu, max %zu\n", functionName, m_portName, numBytes, m_maxReadMemBytes );
+		return asynError;
+	}
+
+	GENCP_STATUS	genStatus	= GenCpInitReadMemPacket( &readMemPacket, requestId, regAddr, numBytes );
+	if ( genStatus != GENCP_STATUS_SUCCESS )
+		return asynError;
+
+	asynStatus		status		= GenCpTransaction( pasynUser, &readMemPacket, sizeof(readMemPacket), &readMemAck,
+													sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDAck) + numBytes, &nAckRead );
+	if ( status != asynSuccess )
+		return status;
+
+	genStatus = GenCpProcessReadMemAck( &readMemAck, requestId, reinterpret_cast<char *>( pBuffer ), numBytes, &nBytesRead );
+	if ( genStatus != GENCP_STATUS_SUCCESS || nBytesRead != numBytes )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s ReadMem 0x%llX error 0x%X, read %zu of %zu\n", functionName, m_portName,
+						(long long unsigned int) regAddr, genStatus, nBytesRead, numBytes );
+		m_fInputFlushNeeded = true;
+		return asynError;
+	}
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::GenCpWriteMem(
+	asynUser			*	pasynUser,
+	uint64_t				regAddr,
+	const void			*	pBuffer,
+	size_t					numBytes )
+{
+    static const char	*	functionName	= "asynGenicam::GenCpWriteMem";
+	GenCpWriteMemPacket		writeMemPacket;
+	GenCpWriteMemAck		writeMemAck;
+	size_t					nBytesSend		= 0;
+	size_t					nAckRead		= 0;
+	uint16_t				requestId		= m_GenCpRequestId++;
+
+	if ( numBytes == 0 || numBytes > m_maxWriteMemBytes )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s invalid write size %zu, max %zu\n", functionName, m_portName, numBytes, m_maxWriteMemBytes );
+		return asynError;
+	}
+
+	GENCP_STATUS	genStatus	= GenCpInitWriteMemPacket(	&writeMemPacket, requestId, regAddr, numBytes,
+															reinterpret_cast<const char *>( pBuffer ), &nBytesSend );
+	if ( genStatus != GENCP_STATUS_SUCCESS )
+		return asynError;
+
+	asynStatus		status		= GenCpTransaction( pasynUser, &writeMemPacket, nBytesSend,
+													&writeMemAck, sizeof(writeMemAck), &nAckRead );
+	if ( status != asynSuccess )
+		return status;
+
+	genStatus = GenCpValidateWriteMemAck( &writeMemAck, requestId );
+	if ( genStatus != GENCP_STATUS_SUCCESS )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s WriteMem 0x%llX error 0x%X\n", functionName, m_portName,
+						(long long unsigned int) regAddr, genStatus );
+		m_fInputFlushNeeded = true;
+		return asynError;
+	}
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::GenCpReadMemBlock(
+	asynUser			*	pasynUser,
+	uint64_t				regAddr,
+	void				*	pBuffer,
+	size_t					numBytes )
+{
+	uint8_t				*	pBytes			= reinterpret_cast<uint8_t *>( pBuffer );
+	while ( numBytes > 0 )
+	{
+		size_t		nChunk	= ( numBytes < m_maxReadMemBytes ) ? numBytes : m_maxReadMemBytes;
+		asynStatus	status	= GenCpReadMem( pasynUser, regAddr, pBytes, nChunk );
+		if ( status != asynSuccess )
+			return status;
+		regAddr		+= nChunk;
+		pBytes		+= nChunk;
+		numBytes	-= nChunk;
+	}
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::GenCpWriteMemBlock(
+	asynUser			*	pasynUser,
+	uint64_t				regAddr,
+	const void			*	pBuffer,
+	size_t					numBytes )
+{
+	const uint8_t		*	pBytes			= reinterpret_cast<const uint8_t *>( pBuffer );
+	while ( numBytes > 0 )
+	{
+		size_t		nChunk	= ( numBytes < m_maxWriteMemBytes ) ? numBytes : m_maxWriteMemBytes;
+		asynStatus	status	= GenCpWriteMem( pasynUser, regAddr, pBytes, nChunk );
+		if ( status != asynSuccess )
+			return status;
+		regAddr		+= nChunk;
+		pBytes		+= nChunk;
+		numBytes	-= nChunk;
+	}
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::DrvUserCreate(
+	asynUser			*	pasynUser,
+	const char			*	drvInfo,
+	const char			**	pptypeName,
+	size_t				*	psize	)
+{
+    static const char	*	functionName	= "asynGenicam::DrvUserCreate";
+	char					reg[128];
+	char					args[2][32]		= { "", "" };
+	char				*	pEnd			= NULL;
+	unsigned long long		length			= 0;
+	size_t					sPrefix			= strlen( GENCP_ARRAY_DRVINFO_PREFIX );
+	bool					fPrefix			= strncmp( drvInfo, GENCP_ARRAY_DRVINFO_PREFIX, sPrefix ) == 0;
+	int						nScan			= sscanf( drvInfo + ( fPrefix ? sPrefix : 0 ), "%127s %31s %31s", reg, args[0], args[1] );
+	bool					fAddress		= false;
+
+	// An address has no register to bound it, so its length in bytes follows it
+	if ( nScan >= 1 )
+	{
+		strtoull( reg, &pEnd, 0 );
+		fAddress	= ( pEnd != reg && *pEnd == '\0' );
+	}
+	if ( fAddress && nScan >= 2 )
+	{
+		length	= strtoull( args[0], &pEnd, 0 );
+		if ( pEnd == args[0] || *pEnd != '\0' )
+			length	= 0;
+	}
+	int						nOrder			= fAddress ? 2 : 1;
+	const char			*	pOrder			= ( nScan > nOrder ) ? args[nOrder - 1] : "";
+	bool					fOrder			= ( strcmp( pOrder, "LE" ) == 0 || strcmp( pOrder, "BE" ) == 0 );
+	const GenCpRegMapEntry *	pEntry		= ( nScan >= 1 ) ? m_regMap.Find( reg ) : NULL;
+
+	// Only claim what is ours, other drvInfo is for the driver below
+	if (	nScan < 1 || nScan > nOrder + 1 || ( pOrder[0] != '\0' && !fOrder )
+		||	( !fPrefix && ( pEntry == NULL || ( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA ) ) ) )
+	{
+		if ( m_pasynDrvUserPrev != NULL )
+			return m_pasynDrvUserPrev->create( m_drvUserPrevPvt, pasynUser, drvInfo, pptypeName, psize );
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s invalid drvInfo %s\n", functionName, m_portName, drvInfo );
+		return asynError;
+	}
+	if ( fAddress && length == 0 )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s register range %s needs its length in bytes, e.g. %s0x20000 8192\n",
+						functionName, m_portName, drvInfo, GENCP_ARRAY_DRVINFO_PREFIX );
+		return asynError;
+	}
+
+	size_t		iArray;
+	for ( iArray = 0; iArray < m_arrays.size(); iArray++ )
+	{
+		if ( m_arrays[iArray].drvInfo == drvInfo )
+			break;
+	}
+	if ( iArray == m_arrays.size() )
+	{
+		// Feature names may only resolve once the register map is loaded at connect
+		GenCpArrayRange		range;
+		range.drvInfo		= drvInfo;
+		range.reg			= reg;
+		range.fResolved		= false;
+		range.address		= 0;
+		range.length		= static_cast<size_t>( length );
+		range.fLittleEndian	= strcmp( pOrder, "LE" ) == 0;
+		m_arrays.push_back( range );
+	}
+	pasynUser->reason	= static_cast<int>( iArray + 1 );
+	if ( pptypeName )
+		*pptypeName	= "asynGenicamArray";
+	if ( psize )
+		*psize		= sizeof(GenCpArrayRange);
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::DrvUserGetType(
+	asynUser			*	pasynUser,
+	const char			**	pptypeName,
+	size_t				*	psize	)
+{
+	if ( pasynUser->reason <= 0 && m_pasynDrvUserPrev != NULL )
+		return m_pasynDrvUserPrev->getType( m_drvUserPrevPvt, pasynUser, pptypeName, psize );
+	if ( pptypeName )
+		*pptypeName	= "asynGenicamArray";
+	if ( psize )
+		*psize		= sizeof(GenCpArrayRange);
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::DrvUserDestroy(
+	asynUser			*	pasynUser	)
+{
+	// Ranges are shared by all records naming them, so they are kept
+	if ( pasynUser->reason <= 0 && m_pasynDrvUserPrev != NULL )
+		return m_pasynDrvUserPrev->destroy( m_drvUserPrevPvt, pasynUser );
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::GenCpArrayLookup(
+	asynUser			*	pasynUser,
+	size_t					elementSize,
+	size_t				*	pnElements,
+	const GenCpArrayRange	**	ppRange	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpArrayLookup";
+	if ( pasynUser->reason <= 0 || static_cast<size_t>( pasynUser->reason ) > m_arrays.size() )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s no register range, see drvInfo of the record\n", functionName, m_portName );
+		return asynError;
+	}
+
+	GenCpArrayRange	&	range	= m_arrays[pasynUser->reason - 1];
+	if ( !range.fResolved )
+	{
+		char					*	pEnd	= NULL;
+		unsigned long long			regAddr	= strtoull( range.reg.c_str(), &pEnd, 0 );
+		const GenCpRegMapEntry	*	pEntry	= m_regMap.Find( range.reg.c_str() );
+		if ( pEnd != range.reg.c_str() && *pEnd == '\0' )
+			range.address	= regAddr;
+		else if ( pEntry != NULL && !( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA ) )
+		{
+			range.address	= pEntry->address;
+			range.length	= pEntry->length;
+			if ( range.drvInfo.find( ' ' ) == std::string::npos )
+				range.fLittleEndian	= ( pEntry->endian != GENCP_REGMAP_ENDIAN_BIG );
+		}
+		else
+		{
+			epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+							"%s: %s %s not in the register map\n", functionName, m_portName, range.reg.c_str() );
+			return asynError;
+		}
+		range.fResolved	= true;
+	}
+	if ( *pnElements > range.length / elementSize )
+		*pnElements	= range.length / elementSize;
+	*ppRange	= &range;
+	return asynSuccess;
+}
+
+/// Convert register bytes to elements, w/ a fixed size inner loop the
+/// compiler can unroll and vectorize
+template <typename T>
+static void	GenCpArrayDecode(
+	const uint8_t		*	pBytes,
+	T					*	pValue,
+	size_t					nElements,
+	bool					fLittleEndian	)
+{
+	for ( size_t iElem = 0; iElem < nElements; iElem++, pBytes += sizeof(T) )
+	{
+		uint32_t	value	= 0;
+		for ( size_t iByte = 0; iByte < sizeof(T); iByte++ )
+			value	|= static_cast<uint32_t>( pBytes[iByte] ) << ( 8 * ( fLittleEndian ? iByte : sizeof(T) - 1 - iByte ) );
+		pValue[iElem]	= static_cast<T>( value );
+	}
+}
+
+template <typename T>
+static void	GenCpArrayEncode(
+	const T				*	pValue,
+	uint8_t				*	pBytes,
+	size_t					nElements,
+	bool					fLittleEndian	)
+{
+	for ( size_t iElem = 0; iElem < nElements; iElem++, pBytes += sizeof(T) )
+	{
+		uint32_t	value	= static_cast<uint32_t>( pValue[iElem] );
+		for ( size_t iByte = 0; iByte < sizeof(T); iByte++ )
+			pBytes[iByte]	= static_cast<uint8_t>( value >> ( 8 * ( fLittleEndian ? iByte : sizeof(T) - 1 - iByte ) ) );
+	}
+}
+
+template <typename T>
+asynStatus	asynGenicam::ArrayRead(
+	asynUser			*	pasynUser,
+	T					*	pValue,
+	size_t					nElements,
+	size_t				*	pnIn	)
+{
+	const GenCpArrayRange	*	pRange	= NULL;
+	*pnIn	= 0;
+	asynStatus	status	= GenCpArrayLookup( pasynUser, sizeof(T), &nElements, &pRange );
+	if ( status != asynSuccess || nElements == 0 )
+		return status;
+
+	status	= GenCpCheckLink( pasynUser );
+	if ( status != asynSuccess )
+		return status;
+	if ( !m_combineData.empty() )
+	{
+		status	= GenCpFlushWrites( pasynUser );
+		if ( status != asynSuccess )
+			return status;
+	}
+
+	size_t		nBytes	= nElements * sizeof(T);
+	if ( !m_lostWrites.empty() && GenCpCheckLostWrites( pasynUser, pRange->address, nBytes ) != asynSuccess )
+		return asynError;
+	m_arrayBuffer.resize( nBytes );
+	status	= GenCpReadMemBlock( pasynUser, pRange->address, &m_arrayBuffer[0], nBytes );
+	if ( status != asynSuccess )
+	{
+		m_nConsecutiveErrors++;
+		return status;
+	}
+	m_nConsecutiveErrors	= 0;
+	GenCpArrayDecode( &m_arrayBuffer[0], pValue, nElements, pRange->fLittleEndian );
+	*pnIn	= nElements;
+	m_nArrayReads++;
+	m_nArrayBytes	+= nBytes;
+	return asynSuccess;
+}
+
+template <typename T>
+asynStatus	asynGenicam::ArrayWrite(
+	asynUser			*	pasynUser,
+	const T				*	pValue,
+	size_t					nElements	)
+{
+    static const char	*	functionName	= "asynGenicam::ArrayWrite";
+	const GenCpArrayRange	*	pRange		= NULL;
+	size_t						nRange		= nElements;
+	asynStatus	status	= GenCpArrayLookup( pasynUser, sizeof(T), &nRange, &pRange );
+	if ( status != asynSuccess || nElements == 0 )
+		return status;
+	if ( nRange < nElements )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s %zu elements, %s only holds %zu\n", functionName, m_portName,
+						nElements, pRange->reg.c_str(), nRange );
+		return asynError;
+	}
+
+	status	= GenCpCheckLink( pasynUser );
+	if ( status != asynSuccess )
+		return status;
+	if ( !m_combineData.empty() )
+	{
+		status	= GenCpFlushWrites( pasynUser );
+		if ( status != asynSuccess )
+			return status;
+	}
+
+	size_t		nBytes	= nElements * sizeof(T);
+	if ( !m_lostWrites.empty() && GenCpCheckLostWrites( pasynUser, pRange->address, nBytes ) != asynSuccess )
+		return asynError;
+	m_arrayBuffer.resize( nBytes );
+	GenCpArrayEncode( pValue, &m_arrayBuffer[0], nElements, pRange->fLittleEndian );
+
+	// Same as for a single write, even if only part of it made it
+	m_regCache.Invalidate( pRange->address, nBytes );
+	m_regCache.InvalidateRecent();
+	GenCpForgetSelectors( pRange->address, nBytes );
+	GenCpInvalidateDependents( pRange->address, nBytes );
+	status	= GenCpWriteMemBlock( pasynUser, pRange->address, &m_arrayBuffer[0], nBytes );
+	if ( status != asynSuccess )
+	{
+		m_nConsecutiveErrors++;
+		return status;
+	}
+	m_nConsecutiveErrors	= 0;
+	m_nArrayWrites++;
+	m_nArrayBytes	+= nBytes;
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::GenCpReadBrm(
+	asynUser			*	pasynUser	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpReadBrm";
+	uint8_t					brm[GENCP_BRM_SIZE];
+
+	asynStatus	status	= GenCpReadMemBlock( pasynUser, REG_BRM_GENCP_VERSION, brm, sizeof(brm) );
+	if ( status != asynSuccess )
+	{
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s unable to read BRM: %s\n", functionName, m_portName, pasynUser->errorMessage );
+		return status;
+	}
+
+	(void) GenCpParseBrm( brm, sizeof(brm), &m_deviceInfo );
+	m_fDeviceInfoValid	= true;
+	for ( size_t iReg = 0; iReg < sizeof(brmCacheable) / sizeof(brmCacheable[0]); iReg++ )
+		m_regCache.Update( brmCacheable[iReg].regAddr, brm + brmCacheable[iReg].regAddr, brmCacheable[iReg].numBytes );
+
+	if ( DEBUG_GENICAM >= 1 )
+		printf( "%s: %s %s %s, serial %s\n", functionName, m_portName,
+				m_deviceInfo.manufacturerName, m_deviceInfo.modelName, m_deviceInfo.serialNumber );
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::GenCpLoadRegMap(
+	asynUser			*	pasynUser	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpLoadRegMap";
+	uint64_t				nManifestEntries;
+	GenCpManifestEntry		xmlFileEntry;
+	std::string				errorMsg;
+
+	if ( !m_fDeviceInfoValid || m_deviceInfo.manifestTableAddress == 0 )
+		return asynError;
+
+	// Entry 0 is the XML for this device
+	asynStatus	status	= GenCpReadMem( pasynUser, m_deviceInfo.manifestTableAddress,
+										&nManifestEntries, sizeof(nManifestEntries) );
+	if ( status == asynSuccess && GenCpBigEndianToCpu( nManifestEntries ) == 0 )
+	{
+		epicsSnprintf( pasynUser->errorMessage, pasynUser->errorMessageSize, "empty manifest table" );
+		status = asynError;
+	}
+	if ( status == asynSuccess )
+		status = GenCpReadMemBlock( pasynUser, m_deviceInfo.manifestTableAddress + sizeof(nManifestEntries),
+									&xmlFileEntry, sizeof(xmlFileEntry) );
+	if ( status != asynSuccess )
+	{
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s unable to read manifest: %s\n", functionName, m_portName, pasynUser->errorMessage );
+		return status;
+	}
+
+	// Same camera model as last time, nothing to do
+	if (	m_regMap.IsLoaded()
+		&&	memcmp( m_regMap.Sha1(), xmlFileEntry.xmlFileSHA1, GENCP_MFT_ENTRY_SHA1_SIZE ) == 0 )
+		return asynSuccess;
+
+	// Whatever the outcome, ranges and presets resolved against the old map are stale
+	GenCpSetArrays();
+	GenCpSetPresets();
+
+	if ( m_regMap.Load( m_regMapDir.c_str(), xmlFileEntry.xmlFileSHA1, errorMsg ) == GENCP_STATUS_SUCCESS )
+	{
+		asynPrint(	pasynUser, ASYN_TRACE_FLOW,
+					"%s: %s loaded %zu entry register map\n", functionName, m_portName, m_regMap.NumEntries() );
+		return asynSuccess;
+	}
+
+	uint32_t	xmlFileSchema	= GenCpBigEndianToCpu( xmlFileEntry.xmlFileSchema );
+	uint64_t	xmlFileSize		= GenCpBigEndianToCpu( xmlFileEntry.xmlFileSize );
+	if (	!m_fRegMapCompile
+		||	GENCP_MFT_ENTRY_SCHEMA_TYPE(xmlFileSchema) != GENCP_MFT_ENTRY_SCHEMA_TYPE_UNCMP )
+	{
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s %s, compile it w/ GenCpTool --compileMap %s\n",
+					functionName, m_portName, errorMsg.c_str(), m_regMapDir.c_str() );
+		return asynError;
+	}
+	if ( xmlFileSize == 0 || xmlFileSize > GENCP_REGMAP_MAX_XML_BYTES )
+	{
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s manifest XML size %llu not in 1..%u bytes, not compiling a register map\n",
+					functionName, m_portName, (long long unsigned int) xmlFileSize, GENCP_REGMAP_MAX_XML_BYTES );
+		return asynError;
+	}
+
+	// First boot for this camera model, compile the map from the device XML once
+	std::vector<char>		xml( xmlFileSize );
+	std::vector<uint8_t>	image;
+	status = GenCpReadMemBlock( pasynUser, GenCpBigEndianToCpu( xmlFileEntry.xmlFileStart ), &xml[0], xml.size() );
+	if ( status != asynSuccess )
+	{
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s unable to read XML file: %s\n", functionName, m_portName, pasynUser->errorMessage );
+		return status;
+	}
+	if (	GenCpRegMapCompile( &xml[0], xml.size(), xmlFileEntry.xmlFileSHA1, image, errorMsg ) != GENCP_STATUS_SUCCESS
+		||	GenCpRegMapWrite( m_regMapDir.c_str(), xmlFileEntry.xmlFileSHA1, image, errorMsg ) != GENCP_STATUS_SUCCESS
+		||	m_regMap.Load( m_regMapDir.c_str(), xmlFileEntry.xmlFileSHA1, errorMsg ) != GENCP_STATUS_SUCCESS )
+	{
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s unable to compile register map: %s\n", functionName, m_portName, errorMsg.c_str() );
+		return asynError;
+	}
+
+	if ( DEBUG_GENICAM >= 1 )
+		printf( "%s: %s compiled %zu entry register map from %zu byte XML\n", functionName, m_portName,
+				m_regMap.NumEntries(), xml.size() );
+	return asynSuccess;
+}
+
+void	asynGenicam::GenCpSetMapCacheable( )
+{
+	for ( size_t iRange = 0; iRange < m_mapCacheable.size(); iRange++ )
+		m_regCache.SetCacheable( m_mapCacheable[iRange].first, m_mapCacheable[iRange].second, false );
+	m_mapCacheable.clear();
+
+	if ( m_fRegMapCache && m_regMap.IsLoaded() )
+	{
+		// Volatile registers last, so they win over cacheable features sharing their register
+		for ( int fVolatile = 0; fVolatile <= 1; fVolatile++ )
+		{
+			for ( size_t iEntry = 0; iEntry < m_regMap.NumEntries(); iEntry++ )
+			{
+				const GenCpRegMapEntry	*	pEntry	= m_regMap.Entry( iEntry );
+				if (	( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA ) || pEntry->length == 0
+					||	!( pEntry->access & GENCP_REGMAP_ACCESS_RO ) )
+					continue;
+				if ( fVolatile != ( pEntry->cache == GENCP_REGMAP_CACHE_NONE || pEntry->pollingTime != 0 ) )
+					continue;
+				m_regCache.SetCacheable( pEntry->address, pEntry->length, !fVolatile );
+				m_mapCacheable.push_back( std::make_pair( pEntry->address, pEntry->length ) );
+			}
+		}
+	}
+
+	// Identity registers stay cacheable whatever the map says
+	for ( size_t iReg = 0; iReg < sizeof(brmCacheable) / sizeof(brmCacheable[0]); iReg++ )
+		m_regCache.SetCacheable( brmCacheable[iReg].regAddr, brmCacheable[iReg].numBytes, true );
+}
+
+void	asynGenicam::GenCpSetSelectors( )
+{
+    static const char	*	functionName	= "asynGenicam::GenCpSetSelectors";
+	m_selectors.clear();
+	m_selectorState.clear();
+	for ( size_t iEntry = 0; iEntry < m_regMap.NumEntries(); iEntry++ )
+	{
+		if ( m_regMap.Entry( iEntry )->flags & GENCP_REGMAP_FLAG_SELECTOR )
+			m_selectors.insert( m_regMap.Entry( iEntry )->address );
+	}
+	for ( size_t iSelector = 0; iSelector < m_cfgSelectors.size(); iSelector++ )
+	{
+		uint64_t		regAddr;
+		if ( GenCpResolveReg( m_cfgSelectors[iSelector].c_str(), &regAddr ) )
+			m_selectors.insert( regAddr );
+		else if ( DEBUG_GENICAM >= 1 )
+			printf( "%s: %s selector %s not in the register map\n", functionName, m_portName, m_cfgSelectors[iSelector].c_str() );
+	}
+}
+
+bool	asynGenicam::GenCpResolveReg(
+	const char			*	pReg,
+	uint64_t			*	pRegAddr	)
+{
+	char					*	pEnd		= NULL;
+	unsigned long long			regAddr		= strtoull( pReg, &pEnd, 0 );
+	if ( pEnd != pReg && *pEnd == '\0' )
+	{
+		*pRegAddr	= regAddr;
+		return true;
+	}
+	const GenCpRegMapEntry	*	pEntry		= m_regMap.Find( pReg );
+	if ( pEntry == NULL || ( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA ) )
+		return false;
+	*pRegAddr	= pEntry->address;
+	return true;
+}
+
+void	asynGenicam::GenCpSetNoAck( )
+{
+    static const char	*	functionName	= "asynGenicam::GenCpSetNoAck";
+	m_noAckRegs.clear();
+	for ( size_t iReg = 0; iReg < m_cfgNoAck.size(); iReg++ )
+	{
+		uint64_t		regAddr;
+		if ( GenCpResolveReg( m_cfgNoAck[iReg].first.c_str(), &regAddr ) )
+			m_noAckRegs[regAddr]	= m_cfgNoAck[iReg].second;
+		else if ( DEBUG_GENICAM >= 1 )
+			printf( "%s: %s no ack register %s not in the register map\n", functionName, m_portName, m_cfgNoAck[iReg].first.c_str() );
+	}
+}
+
+void	asynGenicam::GenCpSetArrays( )
+{
+	for ( size_t iArray = 0; iArray < m_arrays.size(); iArray++ )
+		m_arrays[iArray].fResolved	= false;
+}
+
+void	asynGenicam::GenCpSetPresets( )
+{
+	for ( std::map<std::string, GenCpPreset>::iterator it = m_presets.begin(); it != m_presets.end(); ++it )
+	{
+		it->second.fCompiled	= false;
+		it->second.writes.clear();
+	}
+}
+
+asynStatus	asynGenicam::BarrierDone(
+	asynUser			*	pasynUser,
+	asynStatus				status	)
+{
+    static const char	*	functionName	= "asynGenicam::BarrierDone";
+	if ( status != asynSuccess && m_nBarrierUnacked > 0 )
+	{
+		// The device can't tell which one failed, only that the link or device did
+		m_nBarrierFailures++;
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s request failed after %u writes w/o ack, those may be lost: %s\n",
+					functionName, m_portName, m_nBarrierUnacked, pasynUser->errorMessage );
+	}
+	else if ( status == asynSuccess && !m_barrierError.empty() && m_nUnacked == 0 )
+	{
+		// A device that acks a write sent w/o ack anyway told us it failed, so the barrier does
+		m_nBarrierFailures++;
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s %s, before this request\n", functionName, m_portName, m_barrierError.c_str() );
+		m_fInputFlushNeeded	= true;
+		status	= asynError;
+	}
+	if ( m_nUnacked == 0 )
+		m_barrierError.clear();
+	m_nBarrierUnacked	= 0;
+	return status;
+}
+
+void	asynGenicam::GenCpForgetSelectors(
+	uint64_t				regAddr,
+	size_t					numBytes	)
+{
+	for ( GenCpRegData::iterator it = m_selectorState.begin(); it != m_selectorState.end(); )
+	{
+		if ( it->first >= regAddr + numBytes || it->first + it->second.size() <= regAddr )
+			++it;
+		else
+			m_selectorState.erase( it++ );
+	}
+}
+
+bool	asynGenicam::GenCpSelectorUnchanged(
+	uint64_t				regAddr,
+	const uint8_t		*	pData,
+	size_t					numBytes	)
+{
+	for ( GenCpRegData::iterator it = m_selectorState.begin(); it != m_selectorState.end(); )
+	{
+		if ( it->first >= regAddr + numBytes || it->first + it->second.size() <= regAddr )
+			++it;
+		else if (	it->first == regAddr && it->second.size() == numBytes
+				&&	memcmp( &it->second[0], pData, numBytes ) == 0 )
+		{
+			m_nSelectorSkips++;
+			return true;
+		}
+		else
+			m_selectorState.erase( it++ );
+	}
+	if ( m_selectors.find( regAddr ) != m_selectors.end() )
+	{
+		m_selectorPending.assign( pData, pData + numBytes );
+		m_fSelectorPending	= true;
+	}
+	return false;
+}
+
+static void	GenCpFlushProcessCallback( asynUser * pasynUser )
+{
+	reinterpret_cast<asynGenicam *>( pasynUser->userPvt )->FlushProcess( pasynUser );
+}
+
+void	asynGenicam::FlushProcess(
+	asynUser			*	pasynUser	)
+{
+	// No one waits for this request, writes it loses fail the next access to them
+	m_fFlushQueued	= false;
+	if ( GenCpCheckLink( pasynUser ) == asynSuccess )
+		GenCpFlushWrites( pasynUser );
+}
+
+int	asynGenicam::SetWriteCombine(
+	int						enable	)
+{
+	if ( enable && m_pasynUserFlush == NULL )
+	{
+		m_pasynUserFlush			= pasynManager->createAsynUser( GenCpFlushProcessCallback, 0 );
+		m_pasynUserFlush->userPvt	= this;
+		m_pasynUserFlush->timeout	= 1.0;
+		if ( pasynManager->connectDevice( m_pasynUserFlush, m_portName, m_addr ) != asynSuccess )
+		{
+			printf( "%s asynGenicamSetWriteCombine connectDevice failed: %s\n", m_portName, m_pasynUserFlush->errorMessage );
+			pasynManager->freeAsynUser( m_pasynUserFlush );
+			m_pasynUserFlush	= NULL;
+			return -1;
+		}
+	}
+	if ( !enable && GenCpFlushWrites( m_pasynUserSelf ) != asynSuccess )
+		printf( "%s asynGenicamSetWriteCombine: %s\n", m_portName, m_pasynUserSelf->errorMessage );
+	m_fWriteCombine	= ( enable != 0 );
+	return 0;
+}
+
+asynStatus	asynGenicam::GenCpFlushWrites(
+	asynUser			*	pasynUser	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpFlushWrites";
+	if ( m_combineData.empty() )
+		return asynSuccess;
+
+	asynStatus	status	= GenCpWriteMem( pasynUser, m_combineAddr, &m_combineData[0], m_combineData.size() );
+	m_nCombinedSent++;
+	if ( status != asynSuccess )
+	{
+		m_nCombineErrors++;
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s combined write of %zu bytes to 0x%llX failed, retrying each write: %s\n",
+					functionName, m_portName, m_combineData.size(),
+					(long long unsigned int) m_combineAddr, pasynUser->errorMessage );
+
+		// The writes were answered OK already, so retry them one by one and log each
+		// that still fails.  W/ the link down there's no point, log them all as lost.
+		asynStatus	writeStatus	= status;
+		size_t		offset		= 0;
+		status	= asynSuccess;
+		for ( size_t iWrite = 0; iWrite < m_combineSizes.size(); iWrite++ )
+		{
+			uint64_t	regAddr	= m_combineAddr + offset;
+			if ( writeStatus != asynTimeout && writeStatus != asynDisconnected )
+			{
+				writeStatus	= GenCpWriteMem( pasynUser, regAddr, &m_combineData[offset], m_combineSizes[iWrite] );
+				m_nCombineRetried++;
+			}
+			if ( writeStatus != asynSuccess )
+			{
+				GenCpLostWrite	lost;
+				lost.address	= regAddr;
+				lost.length		= m_combineSizes[iWrite];
+				lost.error		= pasynUser->errorMessage;
+				if ( m_lostWrites.size() >= GENCP_LOST_WRITES_MAX )
+					m_lostWrites.erase( m_lostWrites.begin() );
+				m_lostWrites.push_back( lost );
+				m_nCombineLost++;
+				status	= writeStatus;
+				asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+							"%s: %s combined write of %zu bytes to 0x%llX lost: %s\n",
+							functionName, m_portName, m_combineSizes[iWrite],
+							(long long unsigned int) regAddr, pasynUser->errorMessage );
+			}
+			offset	+= m_combineSizes[iWrite];
+		}
+	}
+	m_combineData.clear();
+	m_combineSizes.clear();
+	return status;
+}
+
+asynStatus	asynGenicam::GenCpCheckLostWrites(
+	asynUser			*	pasynUser,
+	uint64_t				regAddr,
+	size_t					numBytes	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpCheckLostWrites";
+	asynStatus				status			= asynSuccess;
+	for ( std::vector<GenCpLostWrite>::iterator it = m_lostWrites.begin(); it != m_lostWrites.end(); )
+	{
+		if ( it->address >= regAddr + numBytes || regAddr >= it->address + it->length )
+		{
+			++it;
+			continue;
+		}
+
+		// Reported once, the first one the access overlaps
+		if ( status == asynSuccess )
+			epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+							"%s: %s earlier write of %zu bytes to 0x%llX was lost: %s\n", functionName, m_portName,
+							it->length, (long long unsigned int) it->address, it->error.c_str() );
+		status	= asynError;
+		it		= m_lostWrites.erase( it );
+	}
+	return status;
+}
+
+asynStatus	asynGenicam::GenCpCombineWrite(
+	asynUser			*	pasynUser,
+	uint64_t				regAddr,
+	const uint8_t		*	pData,
+	size_t					numBytes	)
+{
+	if (	!m_combineData.empty()
+		&&	(	regAddr != m_combineAddr + m_combineData.size()
+			||	m_combineData.size() + numBytes > m_maxWriteMemBytes ) )
+	{
+		asynStatus	status	= GenCpFlushWrites( pasynUser );
+		if ( status != asynSuccess )
+			return status;
+	}
+	if ( m_combineData.empty() )
+	{
+		// Sent once the requests queued meanwhile have had their chance to add to it
+		m_combineAddr	= regAddr;
+		if ( !m_fFlushQueued && pasynManager->queueRequest( m_pasynUserFlush, asynQueuePriorityLow, 0.0 ) == asynSuccess )
+			m_fFlushQueued	= true;
+	}
+	m_combineData.insert( m_combineData.end(), pData, pData + numBytes );
+	m_combineSizes.push_back( numBytes );
+	m_nWritesCombined++;
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::GenCpReadModify(
+	asynUser			*	pasynUser,
+	const char			*	pOps,
+	unsigned int			nBits,
+	uint64_t				regAddr,
+	uint64_t			*	pValue	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpReadModify";
+	uint8_t					regBytes[sizeof(uint64_t)];
+	size_t					nBytes			= nBits / 8;
+	uint64_t				andMask			= ~0ULL;
+	uint64_t				orBits			= 0;
+	uint64_t				xorBits			= 0;
+
+	if ( !GenCpValidUintBits( nBits ) )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s unsupported register length %u\n", functionName, m_portName, nBits );
+		return asynError;
+	}
+
+	// Parse all ops first, so a malformed command reads nothing
+	if ( !GenCpParseModifyOps( pOps, &andMask, &orBits, &xorBits ) )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s invalid read-modify-write: %s\n", functionName, m_portName, pOps );
+		return asynError;
+	}
+
+	// Writes held back for combining must land before the read
+	if ( !m_combineData.empty() )
+	{
+		asynStatus	status	= GenCpFlushWrites( pasynUser );
+		if ( status != asynSuccess )
+			return status;
+	}
+	if ( m_regCache.Lookup( regAddr, regBytes, nBytes ) )
+		m_nReadModifyCached++;
+	else
+	{
+		asynStatus	status	= GenCpReadMem( pasynUser, regAddr, regBytes, nBytes );
+		if ( status != asynSuccess )
+			return status;
+		m_regCache.Update( regAddr, regBytes, nBytes );
+	}
+	m_nReadModifyWrites++;
+
+	uint64_t	value	= GenCpDecodeUint( regBytes, nBytes );
+	*pValue	= ( ( value & andMask ) | orBits ) ^ xorBits;
+	return asynSuccess;
+}
+
+void	asynGenicam::SetRecentReads(
+	double					maxAge	)
+{
+	m_recentReadAge	= ( maxAge > 0.0 ) ? maxAge : 0.0;
+	m_regCache.SetRecentAge( m_recentReadAge );
+}
+
+void	asynGenicam::GenCpInvalidateDependents(
+	uint64_t				regAddr,
+	size_t					numBytes	)
+{
+	std::vector< std::pair<uint64_t, uint32_t> >	targets;
+	m_regMap.Invalidated( regAddr, numBytes, targets );
+	if ( m_scanThread != NULL )
+	{
+		// Adaptive scan groups read these again at their base rate
+		m_scanWrites.push_back( std::make_pair( regAddr, static_cast<uint32_t>( numBytes ) ) );
+		m_scanWrites.insert( m_scanWrites.end(), targets.begin(), targets.end() );
+	}
+	for ( size_t iTarget = 0; iTarget < targets.size(); iTarget++ )
+	{
+		// A selector made stale may no longer be at the index it was last written
+		m_regCache.Invalidate( targets[iTarget].first, targets[iTarget].second );
+		GenCpForgetSelectors( targets[iTarget].first, targets[iTarget].second );
+		if (	m_fCacheRefresh
+			&&	targets[iTarget].second <= m_maxReadMemBytes
+			&&	m_regCache.IsCacheable( targets[iTarget].first, targets[iTarget].second ) )
+		{
+			std::vector<uint8_t>	&	bytes	= m_refreshRegs[targets[iTarget].first];
+			if ( bytes.size() < targets[iTarget].second )
+				bytes.resize( targets[iTarget].second );
+		}
+	}
+}
+
+asynStatus	asynGenicam::GenCpCheckLink(
+	asynUser			*	pasynUser	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpCheckLink";
+
+	// No flush or negotiation w/ a device that isn't answering
+	asynStatus	status	= GenCpBreakerCheck( pasynUser );
+	if ( status != asynSuccess )
+		return status;
+
+	// See if we need to flush input from prior error
+	if ( m_fInputFlushNeeded )
+	{
+		size_t	nRead	= 0;
+		int		eomReason;
+		char	flushBuffer[256];
+		m_pasynOctetDrv->read( m_drvPvt, pasynUser, flushBuffer, 256, &nRead, &eomReason );
+		m_fInputFlushNeeded = false;
+		if ( DEBUG_GENICAM >= 3 )
+			printf( "%s: %s Flushed %zu bytes from input\n", functionName, m_portName, nRead );
+	}
+
+	// Too many errors since an upshift, renegotiate below the current rate, once per connection
+	if ( m_curBaud > 0 && m_fallbackBaud == 0 && m_nConsecutiveErrors >= GENCP_BAUD_FALLBACK_ERRORS )
+	{
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s %u errors at %d baud, falling back to a lower rate\n", functionName,
+					m_portName, m_nConsecutiveErrors, m_curBaud );
+		m_fallbackBaud					= m_curBaud - 1;
+		m_nConsecutiveErrors			= 0;
+		m_fBootstrapNeeded				= true;
+		m_tBootstrapLast.secPastEpoch	= 0;
+	}
+
+	// Redo connect time negotiation after a reconnect, or retry one that failed
+	if ( m_fBootstrapNeeded )
+	{
+		epicsTimeStamp	tNow;
+		epicsTimeGetCurrent( &tNow );
+		if ( epicsTimeDiffInSeconds( &tNow, &m_tBootstrapLast ) >= GENCP_BOOTSTRAP_RETRY_SEC )
+			GenCpConnect( pasynUser );
+	}
+	return asynSuccess;
+}
+
+void	asynGenicam::SetBreaker(
+	unsigned int			timeouts,
+	double					maxProbe	)
+{
+	// Timeouts counted under the old setting don't count toward the new one
+	m_breakerTimeouts		= timeouts;
+	m_breakerMaxProbe		= ( maxProbe > 0.0 ) ? maxProbe : GENCP_BREAKER_MAX_PROBE_SEC;
+	m_nConsecutiveTimeouts	= 0;
+	if ( timeouts == 0 )
+		m_fBreakerOpen	= false;
+	else if ( m_fBreakerOpen )
+		m_breakerInterval	= std::min( m_breakerInterval, m_breakerMaxProbe );
+}
+
+asynStatus	asynGenicam::GenCpBreakerCheck(
+	asynUser			*	pasynUser	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpBreakerCheck";
+	if ( !m_fBreakerOpen )
+		return asynSuccess;
+
+	epicsTimeStamp		tNow;
+	epicsTimeGetCurrent( &tNow );
+	double				tWait	= epicsTimeDiffInSeconds( &m_tBreakerProbe, &tNow );
+	if ( tWait > 0.0 )
+	{
+		m_nBreakerRejects++;
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s device not responding, next probe in %.1f sec\n", functionName, m_portName, tWait );
+		return asynDisconnected;
+	}
+
+	// One short read, every other one at the original baud rate in case a power cycle reset the device's
+	uint32_t			version;
+	bool				fOrigBaud	= m_curBaud > 0 && m_origBaud > 0 && ( m_nBreakerProbes % 2 ) == 1;
+	m_nBreakerProbes++;
+	if ( fOrigBaud )
+		SetHostBaud( pasynUser, m_origBaud );
+	asynStatus			status		= GenCpReadMem( pasynUser, REG_BRM_GENCP_VERSION, &version, sizeof(version) );
+	if ( fOrigBaud && status == asynSuccess )
+		m_curBaud	= 0;
+	else if ( fOrigBaud )
+		SetHostBaud( pasynUser, m_curBaud );
+	if ( status != asynSuccess )
+	{
+		m_breakerInterval	= std::min( m_breakerInterval * 2, m_breakerMaxProbe );
+		epicsTimeGetCurrent( &m_tBreakerProbe );
+		epicsTimeAddSeconds( &m_tBreakerProbe, m_breakerInterval );
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s device not responding to probe, next in %.1f sec\n",
+						functionName, m_portName, m_breakerInterval );
+		return asynDisconnected;
+	}
+
+	// It may have been power cycled or replaced meanwhile
+	asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+				"%s: %s device answered probe, resuming requests\n", functionName, m_portName );
+	m_fBreakerOpen					= false;
+	m_nConsecutiveErrors			= 0;
+	m_fBootstrapNeeded				= true;
+	m_tBootstrapLast.secPastEpoch	= 0;
+	return asynSuccess;
+}
+
+static void	GenCpScanThreadFunc( void * pvt )
+{
+	reinterpret_cast<asynGenicam *>( pvt )->ScanThread();
+}
+
+static void	GenCpScanProcessCallback( asynUser * pasynUser )
+{
+	reinterpret_cast<asynGenicam *>( pasynUser->userPvt )->ScanProcess( pasynUser );
+}
+
+static void	GenCpScanTimeoutCallback( asynUser * pasynUser )
+{
+	reinterpret_cast<asynGenicam *>( pasynUser->userPvt )->ScanTimeout( pasynUser );
+}
+
+int	asynGenicam::AddScanGroup(
+	const char			*	pGroup,
+	double					period,
+	int						priority,
+	double					maxPeriod	)
+{
+	if ( pGroup == NULL || pGroup[0] == '\0' || !( period > 0.0 ) )
+	{
+		printf( "%s asynGenicamAddScanGroup: group name and period > 0 required.\n", m_portName );
+		return -1;
+	}
+	if ( priority < asynQueuePriorityLow || priority > asynQueuePriorityHigh )
+	{
+		printf( "%s asynGenicamAddScanGroup: priority must be 0 low, 1 medium or 2 high.\n", m_portName );
+		return -1;
+	}
+
+	epicsMutexMustLock( m_scanLock );
+	for ( std::list<GenCpScanGroup>::iterator it = m_scanGroups.begin(); it != m_scanGroups.end(); ++it )
+	{
+		if ( it->name == pGroup )
+		{
+			epicsMutexUnlock( m_scanLock );
+			printf( "%s asynGenicamAddScanGroup: group %s already exists.\n", m_portName, pGroup );
+			return -1;
+		}
+	}
+	GenCpScanGroup		group;
+	group.name			= pGroup;
+	group.period		= period;
+	group.maxPeriod		= ( maxPeriod > period ) ? maxPeriod : period;
+	group.priority		= static_cast<asynQueuePriority>( priority );
+	group.fFailing		= false;
+	group.nScans		= 0;
+	group.nOverruns		= 0;
+	group.fDisabled		= false;
+	group.cost			= 0.0;
+	group.nStarved		= 0;
+	group.nDropped		= 0;
+	group.nSkipped		= 0;
+	group.nErrors		= 0;
+	group.nPublished	= 0;
+	epicsTimeGetCurrent( &group.tNext );
+	m_scanGroups.push_back( group );
+
+	if ( m_scanThread == NULL )
+	{
+		// Own asynUser, as the scan thread runs concurrently w/ iocsh commands
+		char			threadName[64];
+		m_pasynUserScan				= pasynManager->createAsynUser( GenCpScanProcessCallback, GenCpScanTimeoutCallback );
+		m_pasynUserScan->userPvt	= this;
+		m_pasynUserScan->timeout	= 1.0;
+		if ( pasynManager->connectDevice( m_pasynUserScan, m_portName, m_addr ) != asynSuccess )
+		{
+			printf( "%s asynGenicamAddScanGroup connectDevice failed: %s\n", m_portName, m_pasynUserScan->errorMessage );
+			pasynManager->freeAsynUser( m_pasynUserScan );
+			m_pasynUserScan	= NULL;
+			m_scanGroups.pop_back();
+			epicsMutexUnlock( m_scanLock );
+			return -1;
+		}
+		epicsSnprintf( threadName, sizeof(threadName), "%sScan", m_portName );
+		m_scanThread	= epicsThreadCreate(	threadName, epicsThreadPriorityMedium,
+												epicsThreadGetStackSize( epicsThreadStackMedium ),
+												GenCpScanThreadFunc, this );
+	}
+	epicsMutexUnlock( m_scanLock );
+	epicsEventSignal( m_scanEvent );
+	return 0;
+}
+int	asynGenicam::AddScanReg(
+	const char			*	pGroup,
+	const char			*	pCommand,
+	double					deadband	)
+{
+	GenCpScanReg			reg;
+	if ( pCommand == NULL || !GenCpParseScanReg( pCommand, reg ) )
+	{
+		printf( "%s asynGenicamAddScanReg: invalid read command %s, e.g. \"U32 0x1234\" or \"N Gain\".\n",
+				m_portName, pCommand ? pCommand : "" );
+		return -1;
+	}
+	reg.deadband	= ( deadband > 0.0 ) ? deadband : 0.0;
+
+	epicsMutexMustLock( m_scanLock );
+	for ( std::list<GenCpScanGroup>::iterator it = m_scanGroups.begin(); it != m_scanGroups.end(); ++it )
+	{
+		if ( pGroup != NULL && it->name == pGroup )
+		{
+			it->regs.push_back( reg );
+			epicsMutexUnlock( m_scanLock );
+			return 0;
+		}
+	}
+	epicsMutexUnlock( m_scanLock );
+	printf( "%s asynGenicamAddScanReg: no group %s, see asynGenicamAddScanGroup.\n", m_portName, pGroup ? pGroup : "" );
+	return -1;
+}
+
+void	asynGenicam::ScanThread( )
+{
+    static const char	*	functionName	= "asynGenicam::ScanThread";
+	std::vector<GenCpScanGroup *>	dueGroups;
+	std::vector<GenCpScanGroup>		dueCopies;
+	std::vector<GenCpScanGroup *>	due;
+
+	for ( ;; )
+	{
+		double				delay	= GENCP_SCAN_IDLE_SEC;
+		bool				fRepublish;
+		epicsTimeStamp		tNow;
+		epicsTimeStamp		tDeadline;
+
+		epicsMutexMustLock( m_interruptLock );
+		fRepublish		= m_fRepublish;
+		m_fRepublish	= false;
+		epicsMutexUnlock( m_interruptLock );
+
+		m_scanPublished.clear();
+		dueGroups.clear();
+		dueCopies.clear();
+		due.clear();
+		epicsMutexMustLock( m_scanLock );
+		epicsTimeGetCurrent( &tNow );
+		for ( std::list<GenCpScanGroup>::iterator it = m_scanGroups.begin(); it != m_scanGroups.end(); ++it )
+		{
+			for ( size_t iReg = 0; fRepublish && iReg < it->regs.size(); iReg++ )
+			{
+				it->regs[iReg].fPublished	= false;
+				it->regs[iReg].countdown	= 0;
+			}
+			if ( it->fDisabled )
+				continue;
+
+			double	tUntil	= epicsTimeDiffInSeconds( &it->tNext, &tNow );
+			if ( tUntil > 0.0 )
+			{
+				delay	= std::min( delay, tUntil );
+				continue;
+			}
+
+			// A scan is stale once the group's next one is due
+			epicsTimeStamp	tGroupDeadline	= it->tNext;
+			epicsTimeAddSeconds( &tGroupDeadline, it->period );
+			if ( dueGroups.empty() || epicsTimeLessThan( &tGroupDeadline, &tDeadline ) )
+				tDeadline	= tGroupDeadline;
+			dueGroups.push_back( &*it );
+			dueCopies.push_back( *it );
+		}
+		epicsMutexUnlock( m_scanLock );
+
+		if ( !dueGroups.empty() )
+		{
+			// Groups due together are read as one scan, w/ shared registers read once
+			for ( size_t iGroup = 0; iGroup < dueCopies.size(); iGroup++ )
+				due.push_back( &dueCopies[iGroup] );
+			asynStatus	status	= GenCpScan( due, tDeadline );
+			if ( status != asynSuccess && status != asynTimeout && !dueCopies[0].fFailing )
+				asynPrint(	m_pasynUserScan, ASYN_TRACE_ERROR,
+							"%s: %s scan failed: %s\n",
+							functionName, m_portName, m_pasynUserScan->errorMessage );
+
+			// Groups are never removed and registers only appended, so the originals are still there
+			epicsMutexMustLock( m_scanLock );
+			epicsTimeGetCurrent( &tNow );
+			for ( size_t iGroup = 0; iGroup < dueGroups.size(); iGroup++ )
+			{
+				GenCpScanGroup	*	pGroup	= dueGroups[iGroup];
+				GenCpScanGroup	&	scanned	= dueCopies[iGroup];
+				for ( size_t iReg = 0; iReg < scanned.regs.size(); iReg++ )
+					pGroup->regs[iReg]	= scanned.regs[iReg];
+				pGroup->nStarved	= scanned.nStarved;
+				pGroup->nSkipped	= scanned.nSkipped;
+				pGroup->nPublished	= scanned.nPublished;
+				if ( status == asynTimeout )
+					pGroup->nDropped++;
+				else if ( status != asynSuccess )
+					pGroup->nErrors++;
+				pGroup->fFailing	= ( status != asynSuccess && status != asynTimeout );
+				pGroup->nScans++;
+
+				// Keep to the period, but skip scans missed while the link was busy
+				epicsTimeAddSeconds( &pGroup->tNext, pGroup->period );
+				if ( epicsTimeDiffInSeconds( &pGroup->tNext, &tNow ) < 0.0 )
+				{
+					pGroup->nOverruns++;
+					pGroup->tNext	= tNow;
+					epicsTimeAddSeconds( &pGroup->tNext, pGroup->period );
+				}
+				delay	= std::min( delay, epicsTimeDiffInSeconds( &pGroup->tNext, &tNow ) );
+			}
+			epicsMutexUnlock( m_scanLock );
+		}
+
+		// Clients are called w/o the port, so they may queue requests of their own
+		if ( !m_scanPublished.empty() )
+			GenCpPublish( m_scanPublished );
+		if ( delay > 0.0 )
+			epicsEventWaitWithTimeout( m_scanEvent, delay );
+	}
+}
+
+asynStatus	asynGenicam::GenCpScan(
+	std::vector<GenCpScanGroup *> &	groups,
+	const epicsTimeStamp		&	tDeadline	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpScan";
+	asynQueuePriority		basePriority	= asynQueuePriorityLow;
+	epicsTimeStamp			tNow;
+
+	for ( size_t iGroup = 0; iGroup < groups.size(); iGroup++ )
+		basePriority	= std::max( basePriority, groups[iGroup]->priority );
+
+	// Each request reads one span, so operator requests wait for at most one ReadMem
+	asynQueuePriority		priority	= basePriority;
+	m_scanGroupsDue	= groups;
+	m_fScanPlanned	= false;
+	m_scanRegData.clear();
+	m_scanResume	= 0;
+	do
+	{
+		// Requests still queued at the deadline are dropped, the next scan supersedes them
+		epicsTimeGetCurrent( &tNow );
+		double	tLeft	= epicsTimeDiffInSeconds( &tDeadline, &tNow );
+		if ( tLeft <= 0.0 )
+		{
+			m_scanStatus	= asynTimeout;
+			break;
+		}
+
+		m_scanStatus	= asynError;
+		if ( pasynManager->queueRequest(	m_pasynUserScan, priority,
+											( priority < asynQueuePriorityHigh ) ? tLeft / 2 : tLeft ) != asynSuccess )
+			break;
+		epicsEventMustWait( m_scanDone );
+		if ( m_scanStatus == asynTimeout && priority < asynQueuePriorityHigh )
+		{
+			// Starved by higher priority requests for half the time left, age the request
+			priority	= static_cast<asynQueuePriority>( priority + 1 );
+			for ( size_t iGroup = 0; iGroup < groups.size(); iGroup++ )
+				groups[iGroup]->nStarved++;
+			m_scanStatus	= asynSuccess;
+			continue;
+		}
+		priority	= basePriority;
+	}	while ( m_scanStatus == asynSuccess && m_scanResume != GENCP_READ_REGS_DONE );
+
+	if ( m_scanStatus == asynTimeout )
+		epicsSnprintf(	m_pasynUserScan->errorMessage, m_pasynUserScan->errorMessageSize,
+						"%s: %s scan dropped, not done by its deadline", functionName, m_portName );
+	m_scanGroupsDue.clear();
+	return m_scanStatus;
+}
+
+void	asynGenicam::ScanProcess(
+	asynUser			*	pasynUser	)
+{
+	m_scanStatus	= GenCpCheckLink( pasynUser );
+	if ( m_scanStatus != asynSuccess )
+	{
+		epicsEventSignal( m_scanDone );
+		return;
+	}
+	// Writes lost here fail the next access to them, not the scan
+	GenCpFlushWrites( pasynUser );
+	if ( !m_fScanPlanned )
+	{
+		if ( !m_scanWrites.empty() )
+			GenCpScanResetWritten( );
+
+		// Registers more than one group reads are merged into a single read
+		for ( size_t iGroup = 0; iGroup < m_scanGroupsDue.size(); iGroup++ )
+		{
+			GenCpRegData	groupData;
+			GenCpScanPlan( *m_scanGroupsDue[iGroup], groupData, true );
+			for ( GenCpRegData::iterator it = groupData.begin(); it != groupData.end(); ++it )
+			{
+				std::vector<uint8_t>	&	bytes	= m_scanRegData[it->first];
+				if ( !bytes.empty() )
+					m_nScanMerged++;
+				if ( bytes.size() < it->second.size() )
+					bytes.resize( it->second.size() );
+			}
+		}
+		m_fScanPlanned	= true;
+	}
+	m_scanStatus	= asynSuccess;
+	if ( !m_scanRegData.empty() )
+		m_scanStatus	= GenCpReadRegs( pasynUser, m_scanRegData, &m_scanResume, GENCP_SCAN_READS_PER_REQUEST );
+	else
+		m_scanResume	= GENCP_READ_REGS_DONE;
+
+	// Entries are resolved again as the map may change between requests
+	if ( m_scanStatus == asynSuccess && m_scanResume == GENCP_READ_REGS_DONE )
+	{
+		for ( size_t iGroup = 0; iGroup < m_scanGroupsDue.size(); iGroup++ )
+			GenCpScanUpdate( *m_scanGroupsDue[iGroup], m_scanRegData );
+	}
+	epicsEventSignal( m_scanDone );
+}
+
+void	asynGenicam::ScanTimeout(
+	asynUser			*	/*pasynUser*/	)
+{
+	m_scanStatus	= asynTimeout;
+	epicsEventSignal( m_scanDone );
+}
+
+double	asynGenicam::GenCpScanCost(
+	GenCpScanGroup		&	group	)
+{
+	GenCpRegData		regData;
+	GenCpScanPlan( group, regData, false );
+
+	// Spans merged as by GenCpReadRegs, each one ReadMem transaction
+	double		latency	= GENCP_LINK_LATENCY_SEC;
+	if ( m_rtt[GENCP_RTT_READ].NumSamples() > 0 )
+		latency	= m_rtt[GENCP_RTT_READ].Srtt();
+	size_t		sTransaction	= sizeof(GenCpReadMemPacket) + sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDAck);
+	double		cost	= 0.0;
+	uint64_t	spanStart	= 0;
+	uint64_t	spanEnd		= 0;
+	for ( GenCpRegData::iterator it = regData.begin(); ; ++it )
+	{
+		uint64_t	regEnd	= ( it != regData.end() ) ? it->first + it->second.size() : 0;
+		if (	it != regData.end() && spanEnd > 0
+			&&	it->first <= spanEnd + GENCP_FORMULA_MAX_GAP
+			&&	std::max( spanEnd, regEnd ) - spanStart <= m_maxReadMemBytes )
+		{
+			spanEnd	= std::max( spanEnd, regEnd );
+			continue;
+		}
+		if ( spanEnd > 0 )
+			cost	+= WireTime( sTransaction + ( spanEnd - spanStart ) ) + latency;
+		if ( it == regData.end() )
+			break;
+		spanStart	= it->first;
+		spanEnd		= regEnd;
+	}
+	return cost;
+}
+
+void	asynGenicam::PlanLinkBudget(
+	bool					fEnforce	)
+{
+	int				baud	= m_curBaud ? m_curBaud : m_origBaud;
+	double			planned	= 0.0;
+	double			budget;
+	std::vector<GenCpScanGroup>	groups;
+
+	// Scan groups read features via the map, which a connect may reload,
+	// so costs are figured on copies w/ the port, never waiting for it w/ m_scanLock
+	epicsMutexMustLock( m_scanLock );
+	groups.assign( m_scanGroups.begin(), m_scanGroups.end() );
+	epicsMutexUnlock( m_scanLock );
+	if ( m_pasynUserSelf == NULL || pasynManager->lockPort( m_pasynUserSelf ) != asynSuccess )
+		return;
+	for ( size_t iGroup = 0; iGroup < groups.size(); iGroup++ )
+		groups[iGroup].cost	= GenCpScanCost( groups[iGroup] );
+	pasynManager->unlockPort( m_pasynUserSelf );
+
+	// Groups added meanwhile are planned when they are added
+	epicsMutexMustLock( m_scanLock );
+	std::list<GenCpScanGroup>::iterator	it	= m_scanGroups.begin();
+	for ( size_t iGroup = 0; iGroup < groups.size(); iGroup++, ++it )
+	{
+		it->cost	= groups[iGroup].cost;
+		if ( it->fDisabled )
+			continue;
+		if ( fEnforce && m_fLinkBudgetEnforce && planned + it->cost / it->period > m_linkBudget )
+		{
+			it->fDisabled	= true;
+			printf( "%s: scan group %s refused, %.0f%% of the link would exceed the budget of %.0f%%\n",
+					m_portName, it->name.c_str(), ( planned + it->cost / it->period ) * 100, m_linkBudget * 100 );
+			continue;
+		}
+		planned	+= it->cost / it->period;
+	}
+	m_linkPlanned	= planned;
+	budget			= m_linkBudget;
+	epicsMutexUnlock( m_scanLock );
+
+	if ( !fEnforce || groups.empty() )
+		return;
+	printf( "%s: scan groups use %.0f%% of the link at %d baud, budget %.0f%%\n",
+			m_portName, planned * 100, baud, budget * 100 );
+	if ( baud <= 0 )
+		printf( "%s: baud rate unknown, link budget counts device latency only\n", m_portName );
+	if ( planned > budget )
+		printf( "%s: WARNING scan groups exceed the link budget, values will go stale\n", m_portName );
+}
+
+void	asynGenicam::SetLinkBudget(
+	double					budget,
+	bool					fEnforce	)
+{
+	epicsMutexMustLock( m_scanLock );
+	m_linkBudget			= budget;
+	m_fLinkBudgetEnforce	= fEnforce;
+	epicsMutexUnlock( m_scanLock );
+}
+
+void	asynGenicam::LinkBusy(
+	const epicsTimeStamp	*	ptSent	)
+{
+	epicsTimeStamp		tNow;
+	epicsTimeGetCurrent( &tNow );
+	if ( m_tLinkWindow.secPastEpoch == 0 )
+		m_tLinkWindow	= *ptSent;
+	double	busy	= epicsTimeDiffInSeconds( &tNow, ptSent );
+	if ( busy > 0.0 )
+		m_linkBusy	+= busy;
+
+	double	window	= epicsTimeDiffInSeconds( &tNow, &m_tLinkWindow );
+	if ( window >= GENCP_LINK_UTIL_WINDOW_SEC )
+	{
+		m_linkUtil		= std::min( 1.0, m_linkBusy / window );
+		m_linkBusy		= 0.0;
+		m_tLinkWindow	= tNow;
+	}
+}
+
+double	asynGenicam::LinkUtilization( )
+{
+	epicsTimeStamp		tNow;
+	if ( m_tLinkWindow.secPastEpoch == 0 )
+		return 0.0;
+	epicsTimeGetCurrent( &tNow );
+
+	// A window an idle link never closed counts as is
+	double	window	= epicsTimeDiffInSeconds( &tNow, &m_tLinkWindow );
+	if ( window >= 2 * GENCP_LINK_UTIL_WINDOW_SEC )
+		return std::min( 1.0, m_linkBusy / window );
+	return m_linkUtil;
+}
+
+const GenCpRegMapEntry	*	asynGenicam::GenCpScanInputs(
+	GenCpScanReg		&	reg,
+	GenCpRegData		&	regData	)
+{
+	const GenCpRegMapEntry	*	pEntry	= reg.fFeature ? m_regMap.Find( reg.name.c_str() ) : &reg.entry;
+	if ( pEntry == NULL || !( pEntry->access & GENCP_REGMAP_ACCESS_RO ) )
+		return NULL;
+	if ( pEntry->type == GENCP_REGMAP_TYPE_STRING || pEntry->type == GENCP_REGMAP_TYPE_REGISTER )
+	{
+		if ( pEntry->length == 0 || pEntry->length > m_maxReadMemBytes || ( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA ) )
+			return NULL;
+		std::vector<uint8_t>	&	bytes	= regData[pEntry->address];
+		if ( bytes.size() < pEntry->length )
+			bytes.resize( pEntry->length );
+		return pEntry;
+	}
+	return GenCpFormulaInputs( pEntry, regData, 0 ) ? pEntry : NULL;
+}
+
+void	asynGenicam::GenCpScanPlan(
+	GenCpScanGroup		&	group,
+	GenCpRegData		&	regData,
+	bool					fAdaptive	)
+{
+	for ( size_t iReg = 0; iReg < group.regs.size(); iReg++ )
+	{
+		GenCpScanReg			&	reg		= group.regs[iReg];
+		if ( fAdaptive )
+		{
+			reg.fDue	= ( reg.countdown == 0 );
+			if ( !reg.fDue )
+			{
+				reg.countdown--;
+				group.nSkipped++;
+				continue;
+			}
+		}
+		GenCpScanInputs( reg, regData );
+	}
+}
+
+void	asynGenicam::GenCpScanResetWritten( )
+{
+	// Groups being scanned are copies the scan thread writes back, so both are reset
+	epicsMutexMustLock( m_scanLock );
+	for ( std::list<GenCpScanGroup>::iterator it = m_scanGroups.begin(); it != m_scanGroups.end(); ++it )
+		GenCpScanResetWritten( *it );
+	epicsMutexUnlock( m_scanLock );
+	for ( size_t iGroup = 0; iGroup < m_scanGroupsDue.size(); iGroup++ )
+		GenCpScanResetWritten( *m_scanGroupsDue[iGroup] );
+	m_scanWrites.clear();
+}
+
+void	asynGenicam::GenCpScanResetWritten(
+	GenCpScanGroup		&	group	)
+{
+	for ( size_t iReg = 0; iReg < group.regs.size(); iReg++ )
+	{
+		GenCpScanReg	&	reg	= group.regs[iReg];
+		GenCpRegData		inputs;
+		if ( reg.countdown == 0 || GenCpScanInputs( reg, inputs ) == NULL )
+			continue;
+		for ( GenCpRegData::iterator itInput = inputs.begin(); itInput != inputs.end(); ++itInput )
+		{
+			for ( size_t iWrite = 0; iWrite < m_scanWrites.size(); iWrite++ )
+			{
+				if (	itInput->first < m_scanWrites[iWrite].first + m_scanWrites[iWrite].second
+					&&	m_scanWrites[iWrite].first < itInput->first + itInput->second.size() )
+					reg.interval	= reg.countdown	= 0;
+			}
+		}
+		if ( reg.countdown == 0 )
+			reg.interval	= 1;
+	}
+}
+
+void	asynGenicam::GenCpScanUpdate(
+	GenCpScanGroup		&	group,
+	GenCpRegData		&	regData	)
+{
+	for ( size_t iReg = 0; iReg < group.regs.size(); iReg++ )
+	{
+		GenCpScanReg			&	reg		= group.regs[iReg];
+		const GenCpRegMapEntry	*	pEntry	= reg.fFeature ? m_regMap.Find( reg.name.c_str() ) : &reg.entry;
+		char						response[GENCP_RESPONSE_MAX];
+		double						value	= 0.0;
+		GENCP_STATUS				genStatus	= GENCP_STATUS_SUCCESS;
+		if ( !reg.fDue || pEntry == NULL || !( pEntry->access & GENCP_REGMAP_ACCESS_RO ) )
+			continue;
+
+		if ( pEntry->type == GENCP_REGMAP_TYPE_STRING || pEntry->type == GENCP_REGMAP_TYPE_REGISTER )
+		{
+			GenCpRegData::iterator	it	= regData.find( pEntry->address );
+			if ( it == regData.end() || it->second.size() < pEntry->length || ( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA ) )
+				continue;
+			genStatus	= GenCpFormatRegData(	response, sizeof(response), GENCP_TY_RESP_STRING, pEntry->length,
+												pEntry->address, &it->second[0], pEntry->length, NULL );
+			if ( genStatus != GENCP_STATUS_SUCCESS )
+				continue;
+			if ( reg.fPublished && reg.lastText == response )
+			{
+				GenCpScanBackoff( group, reg, false );
+				continue;
+			}
+		}
+		else
+		{
+			if ( !GenCpEvalEntry( pEntry, regData, &value, 0 ) )
+				continue;
+			if ( reg.fPublished && fabs( value - reg.lastValue ) <= reg.deadband )
+			{
+				GenCpScanBackoff( group, reg, false );
+				continue;
+			}
+			if ( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA )
+				GenCpFormatFormula( response, sizeof(response), pEntry, m_regMap.Name( pEntry ), value );
+			else
+				genStatus	= GenCpFormatRegData(	response, sizeof(response), reg.responseType, reg.responseCount,
+													pEntry->address, &regData[pEntry->address][0], pEntry->length,
+													reg.fFeature ? pEntry : NULL );
+			if ( genStatus != GENCP_STATUS_SUCCESS )
+				continue;
+		}
+		GenCpScanBackoff( group, reg, true );
+		reg.fPublished	= true;
+		reg.lastValue	= value;
+		reg.lastText	= response;
+		group.nPublished++;
+		m_scanPublished.push_back( response );
+	}
+}
+
+void	asynGenicam::GenCpPublish(
+	const std::vector<std::string> &	published	)
+{
+	char			response[GENCP_RESPONSE_MAX];
+	epicsMutexMustLock( m_interruptLock );
+	for ( size_t iResponse = 0; iResponse < published.size(); iResponse++ )
+	{
+		for (	std::list<GenCpOctetInterrupt *>::iterator it = m_interruptUsers.begin();
+				it != m_interruptUsers.end(); ++it )
+		{
+			// Each client gets its own copy, callbacks may modify the data
+			size_t		nChars	= std::min( published[iResponse].size(), sizeof(response) - 1 );
+			memcpy( response, published[iResponse].c_str(), nChars + 1 );
+			response[nChars]	= '\0';
+			(*it)->callback( (*it)->userPvt, (*it)->pasynUser, response, nChars, ASYN_EOM_EOS );
+		}
+	}
+	epicsMutexUnlock( m_interruptLock );
+}
+
+asynStatus	asynGenicam::RegisterInterruptUser(
+	asynUser				*	pasynUser,
+	interruptCallbackOctet		callback,
+	void					*	userPvt,
+	void					**	registrarPvt	)
+{
+	GenCpOctetInterrupt		*	pInterrupt	= new GenCpOctetInterrupt;
+	pInterrupt->pasynUser			= pasynUser;
+	pInterrupt->callback			= callback;
+	pInterrupt->userPvt				= userPvt;
+	pInterrupt->lowerRegistrarPvt	= NULL;
+
+	// Serial drivers may not support octet interrupts, scan groups work regardless
+	pInterrupt->fLower	= ( m_pasynOctetDrv->registerInterruptUser(	m_drvPvt, pasynUser, callback, userPvt,
+																	&pInterrupt->lowerRegistrarPvt ) == asynSuccess );
+
+	epicsMutexMustLock( m_interruptLock );
+	m_interruptUsers.push_back( pInterrupt );
+	m_fRepublish	= true;
+	epicsMutexUnlock( m_interruptLock );
+	*registrarPvt	= pInterrupt;
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::CancelInterruptUser(
+	asynUser				*	pasynUser,
+	void					*	registrarPvt	)
+{
+	GenCpOctetInterrupt		*	pInterrupt	= reinterpret_cast<GenCpOctetInterrupt *>( registrarPvt );
+	epicsMutexMustLock( m_interruptLock );
+	std::list<GenCpOctetInterrupt *>::iterator	it	= std::find( m_interruptUsers.begin(), m_interruptUsers.end(), pInterrupt );
+	if ( it == m_interruptUsers.end() )
+	{
+		epicsMutexUnlock( m_interruptLock );
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s cancelInterruptUser: not registered", m_portName );
+		return asynError;
+	}
+	m_interruptUsers.erase( it );
+	epicsMutexUnlock( m_interruptLock );
+
+	asynStatus	status	= asynSuccess;
+	if ( pInterrupt->fLower )
+		status	= m_pasynOctetDrv->cancelInterruptUser( m_drvPvt, pasynUser, pInterrupt->lowerRegistrarPvt );
+	delete pInterrupt;
+	return status;
+}
+
+int	asynGenicam::GetHostBaud(
+	asynUser			*	pasynUser	)
+{
+	asynInterface	*	pasynInterface	= pasynManager->findInterface( pasynUser, asynOptionType, 1 );
+	char				baudString[32];
+	if ( pasynInterface == NULL )
+		return 0;
+	asynOption		*	pasynOption		= reinterpret_cast<asynOption *>( pasynInterface->pinterface );
+	if ( pasynOption->getOption( pasynInterface->drvPvt, pasynUser, "baud", baudString, sizeof(baudString) ) != asynSuccess )
+		return 0;
+	return atoi( baudString );
+}
+
+asynStatus	asynGenicam::SetHostBaud(
+	asynUser			*	pasynUser,
+	int						baud	)
+{
+	asynInterface	*	pasynInterface	= pasynManager->findInterface( pasynUser, asynOptionType, 1 );
+	char				baudString[32];
+	if ( pasynInterface == NULL )
+		return asynError;
+	asynOption		*	pasynOption		= reinterpret_cast<asynOption *>( pasynInterface->pinterface );
+	epicsSnprintf( baudString, sizeof(baudString), "%d", baud );
+	asynStatus			status			= pasynOption->setOption( pasynInterface->drvPvt, pasynUser, "baud", baudString );
+	// Drop anything received at the old rate
+	m_pasynOctetDrv->flush( m_drvPvt, pasynUser );
+	return status;
+}
+
+asynStatus	asynGenicam::GenCpHuntBaud(
+	asynUser			*	pasynUser	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpHuntBaud";
+	uint32_t				gencpVersion;
+
+	if ( m_origBaud == 0 )
+		m_origBaud = GetHostBaud( pasynUser );
+	if ( m_origBaud == 0 )
+		return asynError;
+
+	for ( int iBit = GENCP_SBRM_BAUD_NUM_RATES - 1; iBit >= 0; iBit-- )
+	{
+		int		baud	= GenCpSbrmBaudRate( iBit );
+		if ( baud > m_maxBaud && baud != m_origBaud && baud != m_curBaud )
+			continue;
+		if ( SetHostBaud( pasynUser, baud ) != asynSuccess )
+			continue;
+		if ( GenCpReadMem( pasynUser, REG_BRM_GENCP_VERSION, &gencpVersion, sizeof(gencpVersion) ) == asynSuccess )
+		{
+			m_curBaud	= ( baud == m_origBaud ) ? 0 : baud;
+			ResetRtt();
+			asynPrint(	pasynUser, ASYN_TRACE_FLOW,
+						"%s: %s found device at %d baud\n", functionName, m_portName, baud );
+			return asynSuccess;
+		}
+	}
+
+	(void) SetHostBaud( pasynUser, m_origBaud );
+	m_curBaud	= 0;
+	return asynError;
+}
+
+asynStatus	asynGenicam::GenCpNegotiateBaud(
+	asynUser			*	pasynUser,
+	uint64_t				sbrmAddress	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpNegotiateBaud";
+	asynStatus				status;
+	uint32_t				baudRegs[2];
+	uint32_t				gencpVersion;
+	uint64_t				capability;
+	int						maxBaud			= m_maxBaud;
+
+	if ( m_fallbackBaud > 0 && m_fallbackBaud < maxBaud )
+		maxBaud	= m_fallbackBaud;
+
+	// The baud rate registers are in the SBRM, which the device may not have
+	status = GenCpReadMem( pasynUser, REG_BRM_DEVICE_CAPABILITY, &capability, sizeof(capability) );
+	if ( status != asynSuccess )
+		return status;
+	if ( !( GenCpBigEndianToCpu( capability ) & GENCP_BRM_CAP_SBRM_SUPPORTED ) )
+	{
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s device has no SBRM, not upshifting\n", functionName, m_portName );
+		return asynError;
+	}
+
+	int		hostBaud	= GetHostBaud( pasynUser );
+	if ( hostBaud == 0 )
+	{
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s underlying port has no baud option, not upshifting\n", functionName, m_portName );
+		return asynError;
+	}
+	if ( m_origBaud == 0 )
+		m_origBaud = hostBaud;
+
+	// Current and supported baud rates are adjacent, read both at once
+	status = GenCpReadMem(	pasynUser, sbrmAddress + REG_SBRM_CURRENT_BAUDRATE, baudRegs, sizeof(baudRegs) );
+	if ( status != asynSuccess )
+		return status;
+	uint32_t	current		= GenCpBigEndianToCpu( baudRegs[0] );
+	uint32_t	supported	= GenCpBigEndianToCpu( baudRegs[1] );
+
+	// Try the fastest common rate first and fall back one rate at a time
+	for ( int iBit = GENCP_SBRM_BAUD_NUM_RATES - 1; iBit >= 0; iBit-- )
+	{
+		int			baud	= GenCpSbrmBaudRate( iBit );
+		uint32_t	baudBit	= 1 << iBit;
+		if ( !( supported & baudBit ) || baud > maxBaud )
+			continue;
+		if ( baud == hostBaud )
+			break;
+
+		// The device acks the change at the old rate, then switches
+		uint32_t	beBaudBit	= GenCpCpuToBigEndian( baudBit );
+		status = GenCpWriteMem( pasynUser, sbrmAddress + REG_SBRM_CURRENT_BAUDRATE, &beBaudBit, sizeof(beBaudBit) );
+		if ( status != asynSuccess )
+			continue;
+		epicsThreadSleep( GENCP_BAUD_SETTLE_SEC );
+		status = SetHostBaud( pasynUser, baud );
+		if ( status == asynSuccess )
+			status = GenCpReadMem( pasynUser, REG_BRM_GENCP_VERSION, &gencpVersion, sizeof(gencpVersion) );
+		if ( status == asynSuccess )
+		{
+			m_curBaud	= ( baud == m_origBaud ) ? 0 : baud;
+			ResetRtt();
+			asynPrint(	pasynUser, ASYN_TRACE_FLOW,
+						"%s: %s switched from %d to %d baud\n", functionName, m_portName, hostBaud, baud );
+			return asynSuccess;
+		}
+
+		// Verify failed, put the device back on the rate we know works
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s verify at %d baud failed, falling back\n", functionName, m_portName, baud );
+		uint32_t	beCurrent	= GenCpCpuToBigEndian( current );
+		(void) GenCpWriteMem( pasynUser, sbrmAddress + REG_SBRM_CURRENT_BAUDRATE, &beCurrent, sizeof(beCurrent) );
+		epicsThreadSleep( GENCP_BAUD_SETTLE_SEC );
+		(void) SetHostBaud( pasynUser, hostBaud );
+		if ( GenCpReadMem( pasynUser, REG_BRM_GENCP_VERSION, &gencpVersion, sizeof(gencpVersion) ) != asynSuccess )
+			return GenCpHuntBaud( pasynUser );
+	}
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::GenCpConnect(
+	asynUser			*	pasynUser	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpConnect";
+	asynStatus				status;
+	uint64_t				sbrmAddress;
+	uint32_t				transferLengths[2];
+
+	epicsTimeGetCurrent( &m_tBootstrapLast );
+
+	// Device may have been replaced or power cycled
+	m_regCache.InvalidateAll();
+	m_selectorState.clear();
+	m_fDeviceInfoValid	= false;
+	ResetRtt();
+	if ( m_origBaud == 0 )
+		m_origBaud = GetHostBaud( pasynUser );
+
+	// Start from the conservative default in case the device has been replaced
+	m_maxReadMemBytes	= GENCP_READMEM_MAX_BYTES;
+	m_maxWriteMemBytes	= GENCP_READMEM_MAX_BYTES;
+
+	status = GenCpReadMem( pasynUser, REG_BRM_SBRM_ADDRESS, &sbrmAddress, sizeof(sbrmAddress) );
+	if ( status != asynSuccess && m_maxBaud > 0 )
+	{
+		// Device may still be at a rate we negotiated before an IOC restart or fallback
+		status = GenCpHuntBaud( pasynUser );
+		if ( status == asynSuccess )
+			status = GenCpReadMem( pasynUser, REG_BRM_SBRM_ADDRESS, &sbrmAddress, sizeof(sbrmAddress) );
+	}
+	if ( status == asynSuccess )
+	{
+		sbrmAddress	= GenCpBigEndianToCpu( sbrmAddress );
+		status = GenCpReadMem(	pasynUser, sbrmAddress + REG_SBRM_MAX_CMD_TRANSFER_LENGTH,
+								transferLengths, sizeof(transferLengths) );
+	}
+	if ( status != asynSuccess )
+	{
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s unable to read SBRM, using %u byte packets: %s\n",
+					functionName, m_portName, GENCP_READMEM_MAX_BYTES, pasynUser->errorMessage );
+		return status;
+	}
+
+	m_maxWriteMemBytes	= GenCpMaxWriteMemPayload( GenCpBigEndianToCpu( transferLengths[0] ) );
+	m_maxReadMemBytes	= GenCpMaxReadMemPayload(  GenCpBigEndianToCpu( transferLengths[1] ) );
+	m_fBootstrapNeeded	= false;
+
+	if ( m_maxBaud > 0 )
+		(void) GenCpNegotiateBaud( pasynUser, sbrmAddress );
+
+	// Identity and capability registers in a few max size reads instead of one per record
+	if ( GenCpReadBrm( pasynUser ) == asynSuccess && !m_regMapDir.empty() )
+		(void) GenCpLoadRegMap( pasynUser );
+	GenCpSetMapCacheable();
+	GenCpSetSelectors();
+	GenCpSetNoAck();
+	GenCpSetPresets();
+
+	if ( DEBUG_GENICAM >= 1 )
+		printf( "%s: %s SBRM 0x%llX, max ReadMem %zu, max WriteMem %zu bytes\n", functionName, m_portName,
+				(long long unsigned int) sbrmAddress, m_maxReadMemBytes, m_maxWriteMemBytes );
+	asynPrint(	pasynUser, ASYN_TRACE_FLOW,
+				"%s: %s max ReadMem %zu, max WriteMem %zu bytes\n",
+				functionName, m_portName, m_maxReadMemBytes, m_maxWriteMemBytes );
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::AsciiToGenicam(
+	asynUser			*	pasynUser,
     const char			*	data,
 	size_t					maxChars,
 	const char			**	ppSendBufferRet,
@@ -424,11 +4102,66 @@ asynStatus	asynGenicam::AsciiToGenicam(
 	unsigned long long		regAddr			= 0LL;
 	int						scanCount		= -1;
 	const char			*	pEqualSign		= strchr( data, '=' );
+	size_t					regBytes		= 0;
+	GenCpUintCommand		uintCommand;
 
 	if ( ppSendBufferRet == NULL || psSendBufferRet == NULL )
 		return asynError;
 
 	m_GenCpResponsePending[0] = '\0';
+	m_fResponseLocal		  = false;
+	m_fFeature				  = false;
+	m_fFormulaResponse		  = false;
+	m_refreshRegs.clear();
+	m_fSelectorPending		  = false;
+
+	if ( pEqualSign == NULL && !m_combineData.empty() )
+	{
+		// Reads see the combined writes, and a failed one fails the read
+		asynStatus	status	= GenCpFlushWrites( pasynUser );
+		if ( status != asynSuccess )
+			return status;
+	}
+
+	if ( *data == 'N' )
+		return FeatureToGenicam( pasynUser, data, ppSendBufferRet, psSendBufferRet );
+
+	if ( *data == 'W' )
+		return WaitToGenicam( pasynUser, data, ppSendBufferRet, psSendBufferRet );
+
+	if ( *data == 'P' )
+	{
+		// Apply a preset, answered w/ OK once written
+		char		presetName[128];
+		asynStatus	status;
+		if ( sscanf( data, "P %127s", presetName ) != 1 )
+		{
+			epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+							"%s: %s Invalid GenCP command: %s\n", functionName, m_portName, data	);
+			m_fInputFlushNeeded = true;
+			return asynError;
+		}
+		if ( ( status = ApplyPreset( pasynUser, presetName ) ) != asynSuccess )
+			return status;
+		m_GenCpResponseType		= GENCP_TY_RESP_ACK;
+		*ppSendBufferRet		= NULL;
+		*psSendBufferRet		= 0;
+		m_fResponseLocal		= true;
+		m_GenCpPendingRequestId	= 0xFFFF;
+		return asynSuccess;
+	}
+
+	if ( *data == 'L' )
+	{
+		// Measured link utilization in percent, answered locally
+		snprintf( m_formulaResponse, GENCP_RESPONSE_MAX, "RLinkUtil=%.1f\n", LinkUtilization() * 100 );
+		*ppSendBufferRet		= NULL;
+		*psSendBufferRet		= 0;
+		m_fResponseLocal		= true;
+		m_fFormulaResponse		= true;
+		m_GenCpPendingRequestId	= 0xFFFF;
+		return asynSuccess;
+	}
 
 	// Parse the simple streamdevice ascii protocol and replace it w/ a GenCpReadMemPacket.
 	switch ( *data )
@@ -439,7 +4172,7 @@ asynStatus	asynGenicam::AsciiToGenicam(
 		asynPrint(	pasynUser, ASYN_TRACE_FLOW,
 					"%s %s: scanCount=%d, cmdCount=%u, regAddr=0x%llX, cGetSet=%c, intValue=%lld, command: %s\n",
 					functionName, m_portName, scanCount, cmdCount, regAddr, cGetSet, intValue, data );
-		if ( scanCount == 4 && cGetSet == '=' && cmdCount > 0 )
+		if ( scanCount == 4 && cGetSet == '=' && cmdCount > 0 && cmdCount <= m_maxWriteMemBytes )
 		{
 			assert( pEqualSign != NULL );
 			pString		= pEqualSign + 1;
@@ -450,8 +4183,9 @@ asynStatus	asynGenicam::AsciiToGenicam(
 			m_GenCpResponseCount	= cmdCount;
 			m_GenCpResponseType		= GENCP_TY_RESP_ACK;
 			m_GenCpResponseSize		= sizeof(GenCpWriteMemAck);
+			regBytes				= cmdCount;
 		}
-		else if ( scanCount == 3 && cGetSet == '?' && cmdCount > 0 )
+		else if ( scanCount == 3 && cGetSet == '?' && cmdCount > 0 && cmdCount <= m_maxReadMemBytes )
 		{
 			requestId	= m_GenCpRequestId;
 			genStatus	= GenCpInitReadMemPacket( &m_genCpReadMemPacket, m_GenCpRequestId++, regAddr, cmdCount );
@@ -460,6 +4194,7 @@ asynStatus	asynGenicam::AsciiToGenicam(
 			m_GenCpResponseCount	= cmdCount;
 			m_GenCpResponseType		= GENCP_TY_RESP_STRING;
 			m_GenCpResponseSize		= sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDAck) + cmdCount;
+			regBytes				= cmdCount;
 		}
 		else
 		{
@@ -471,11 +4206,30 @@ asynStatus	asynGenicam::AsciiToGenicam(
 		break;
 
 	case 'U':
-		scanCount = sscanf( data, "U%u %Li %c%Li", &cmdCount, &regAddr, &cGetSet, &intValue );
+		if ( GenCpParseUint( data, &uintCommand ) )
+		{
+			cmdCount	= uintCommand.nBits;
+			regAddr		= uintCommand.regAddr;
+			cGetSet		= uintCommand.cGetSet;
+			intValue	= static_cast<long long int>( uintCommand.value );
+			scanCount	= ( cGetSet == '?' ) ? 3 : 4;
+		}
+		if ( scanCount == 4 && uintCommand.pOps != NULL )
+		{
+			// Read-modify-write, done here so no other request gets in between
+			uint64_t	value;
+			asynStatus	status	= GenCpReadModify( pasynUser, uintCommand.pOps, cmdCount, regAddr, &value );
+			if ( status != asynSuccess )
+			{
+				m_fInputFlushNeeded = true;
+				return status;
+			}
+			intValue	= static_cast<long long int>( value );
+		}
 		asynPrint(	pasynUser, ASYN_TRACE_FLOW,
 					"%s %s: scanCount=%d, cmdCount=%u, regAddr=0x%llX, cGetSet=%c, intValue=%lld, command: %s\n",
 					functionName, m_portName, scanCount, cmdCount, regAddr, cGetSet, intValue, data );
-		if ( scanCount == 4 && cGetSet == '=' && cmdCount > 0 )
+		if ( scanCount == 4 && cGetSet == '=' )
 		{
 			uint16_t	value16	= static_cast<uint16_t>( intValue );
 			uint32_t	value32	= static_cast<uint32_t>( intValue );
@@ -496,15 +4250,27 @@ asynStatus	asynGenicam::AsciiToGenicam(
 			case 64:	
 				requestId	= m_GenCpRequestId;
 				genStatus	= GenCpInitWriteMemPacket(	&m_genCpWriteMemPacket, m_GenCpRequestId++, regAddr,
-														value64, psSendBufferRet );
+														value64, psSendBufferRet );
+				break;
+			default:
+				{
+				// Odd lengths, e.g. a 24 bit register, go as big endian bytes
+				uint8_t	valueBytes[sizeof(uint64_t)];
+				GenCpEncodeUint( value64, cmdCount / 8, valueBytes );
+				requestId	= m_GenCpRequestId;
+				genStatus	= GenCpInitWriteMemPacket(	&m_genCpWriteMemPacket, m_GenCpRequestId++, regAddr,
+														cmdCount / 8, reinterpret_cast<const char *>( valueBytes ),
+														psSendBufferRet );
+				}
 				break;
 			}
 			*ppSendBufferRet		= reinterpret_cast<char *>( &m_genCpWriteMemPacket );
 			m_GenCpResponseCount	= cmdCount;
 			m_GenCpResponseType		= GENCP_TY_RESP_ACK;
 			m_GenCpResponseSize		= sizeof(GenCpWriteMemAck);
+			regBytes				= cmdCount / 8;
 		}
-		else if ( scanCount == 3 && cGetSet == '?' && cmdCount > 0 )
+		else if ( scanCount == 3 && cGetSet == '?' )
 		{
 			requestId	= m_GenCpRequestId;
 			genStatus	= GenCpInitReadMemPacket( &m_genCpReadMemPacket, m_GenCpRequestId++, regAddr, cmdCount / 8 );
@@ -513,6 +4279,7 @@ asynStatus	asynGenicam::AsciiToGenicam(
 			m_GenCpResponseCount	= cmdCount;
 			m_GenCpResponseType		= GENCP_TY_RESP_UINT;
 			m_GenCpResponseSize		= sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDAck) + cmdCount / 8;
+			regBytes				= cmdCount / 8;
 		}
 		else
 			scanCount = -1;
@@ -545,53 +4312,937 @@ asynStatus	asynGenicam::AsciiToGenicam(
 			m_GenCpResponseCount	= cmdCount;
 			m_GenCpResponseType		= GENCP_TY_RESP_ACK;
 			m_GenCpResponseSize		= sizeof(GenCpWriteMemAck);
+			regBytes				= cmdCount / 8;
 		}
 		else if ( scanCount == 3 && cGetSet == '?' && cmdCount > 0 )
 		{
-			requestId	= m_GenCpRequestId;
-			genStatus	= GenCpInitReadMemPacket( &m_genCpReadMemPacket, m_GenCpRequestId++, regAddr, cmdCount / 8 );
-			*ppSendBufferRet		= reinterpret_cast<char *>( &m_genCpReadMemPacket );
-			*psSendBufferRet		= sizeof(m_genCpReadMemPacket);
-			m_GenCpResponseCount	= cmdCount;
-			if ( cmdCount == 32 )
-				m_GenCpResponseType		= GENCP_TY_RESP_FLOAT;
-			else
-				m_GenCpResponseType		= GENCP_TY_RESP_DOUBLE;
-			m_GenCpResponseSize		= sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDAck) + cmdCount / 8;
+			requestId	= m_GenCpRequestId;
+			genStatus	= GenCpInitReadMemPacket( &m_genCpReadMemPacket, m_GenCpRequestId++, regAddr, cmdCount / 8 );
+			*ppSendBufferRet		= reinterpret_cast<char *>( &m_genCpReadMemPacket );
+			*psSendBufferRet		= sizeof(m_genCpReadMemPacket);
+			m_GenCpResponseCount	= cmdCount;
+			if ( cmdCount == 32 )
+				m_GenCpResponseType		= GENCP_TY_RESP_FLOAT;
+			else
+				m_GenCpResponseType		= GENCP_TY_RESP_DOUBLE;
+			m_GenCpResponseSize		= sizeof(GenCpSerialPrefix) + sizeof(GenCpCCDAck) + cmdCount / 8;
+			regBytes				= cmdCount / 8;
+		}
+		else
+			scanCount = -1;
+		break;
+
+	case 'I':
+	default:
+		break;
+	}
+	m_GenCpRegAddr			= regAddr;
+	m_GenCpPendingRequestId	= requestId;
+	m_GenCpReadBytes		= regBytes;
+
+	if ( scanCount == -1 || genStatus != 0 )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s Invalid GenCP command: %s\n",
+						functionName, m_portName, data	);
+		m_fInputFlushNeeded = true;
+		return asynError;
+	}
+
+	if ( !m_lostWrites.empty() && GenCpCheckLostWrites( pasynUser, regAddr, regBytes ) != asynSuccess )
+	{
+		m_fInputFlushNeeded = true;
+		return asynError;
+	}
+
+	if (	m_GenCpResponseType == GENCP_TY_RESP_ACK
+		&&	GenCpSelectorUnchanged( regAddr, m_genCpWriteMemPacket.scd.scdWriteData, regBytes ) )
+	{
+		// Selector already at this index, the write would change nothing
+		*ppSendBufferRet		= NULL;
+		*psSendBufferRet		= 0;
+		m_fResponseLocal		= true;
+		requestId				= 0xFFFF;
+		m_GenCpPendingRequestId	= requestId;
+	}
+	else if ( m_GenCpResponseType == GENCP_TY_RESP_ACK )
+	{
+		// Written value may be adjusted by the device, so read it back next time
+		// A write may change any register, so no recent read before it is answered after it
+		m_regCache.Invalidate( regAddr, regBytes );
+		m_regCache.InvalidateRecent();
+		GenCpInvalidateDependents( regAddr, regBytes );
+
+		// Selector and refresh handling need the ack, so those go alone
+		if ( m_fWriteCombine && m_pasynUserFlush != NULL && !m_fSelectorPending && m_refreshRegs.empty() )
+		{
+			asynStatus	status	= GenCpCombineWrite( pasynUser, regAddr, m_genCpWriteMemPacket.scd.scdWriteData, regBytes );
+			if ( status != asynSuccess )
+				return status;
+			*ppSendBufferRet		= NULL;
+			*psSendBufferRet		= 0;
+			m_fResponseLocal		= true;
+			requestId				= 0xFFFF;
+			m_GenCpPendingRequestId	= requestId;
+		}
+		else if ( !m_combineData.empty() )
+		{
+			asynStatus	status	= GenCpFlushWrites( pasynUser );
+			if ( status != asynSuccess )
+				return status;
+		}
+
+		// Send w/o ack and answer OK at once, but every Nth write is acked as a sync barrier
+		std::map<uint64_t, unsigned int>::iterator	itNoAck	= m_noAckRegs.find( regAddr );
+		if (	*ppSendBufferRet != NULL && itNoAck != m_noAckRegs.end()
+			&&	!m_fSelectorPending && m_refreshRegs.empty()
+			&&	m_nUnacked + 1 < itNoAck->second )
+		{
+			GenCpSetWriteMemReqAck( &m_genCpWriteMemPacket, false );
+			m_fResponseLocal		= true;
+			requestId				= 0xFFFF;
+			m_GenCpPendingRequestId	= requestId;
+			m_nUnacked++;
+			m_nNoAckWrites++;
+		}
+	}
+	else if ( m_regCache.Lookup( regAddr, m_GenCpReadData, regBytes ) )
+	{
+		// Answer from the cache or an identical read just done, nothing to send
+		*ppSendBufferRet		= NULL;
+		*psSendBufferRet		= 0;
+		m_fResponseLocal		= true;
+		requestId				= 0xFFFF;
+		m_GenCpPendingRequestId	= requestId;
+	}
+
+	asynPrint(	pasynUser, ASYN_TRACE_FLOW,
+				"%s %s: responseType=%u, responseCount=%u, responseSize=%u\n",
+				functionName, m_portName, m_GenCpResponseType, m_GenCpResponseCount, m_GenCpResponseSize );
+
+	if ( requestId != 0xFFFF )
+	{
+		// Any acked request is a barrier for the writes sent w/o ack before it
+		m_nBarrierUnacked	= m_nUnacked;
+		m_nUnacked			= 0;
+		if ( DEBUG_GENICAM >= 3 )
+			printf( "REQUESTID %-5hu: Sending  %zu bytes, responseSize=%u\n",
+					requestId, *psSendBufferRet, m_GenCpResponseSize );
+	}
+
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::WaitToGenicam(
+	asynUser			*	pasynUser,
+    const char			*	data,
+	const char			**	ppSendBufferRet,
+	size_t				*	psSendBufferRet	)
+{
+    static const char	*	functionName	= "asynGenicam::WaitToGenicam";
+	GenCpWaitCommand		wait;
+	const char			*	pError			= GenCpParseWait( data, &wait );
+	const GenCpRegMapEntry *	pEntry		= NULL;
+
+	if ( pError == NULL && !wait.fAddress )
+	{
+		// A feature name brings its register's length, byte order and bit field
+		pEntry	= m_regMap.Find( wait.regName );
+		if ( pEntry == NULL || ( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA ) )
+			pError	= "unknown register";
+		else if ( wait.nBits != pEntry->length * 8 )
+			pError	= "register length doesn't match the feature";
+		else
+			wait.regAddr	= pEntry->address;
+	}
+	unsigned int			nBits			= wait.nBits;
+	uint64_t				regAddr			= wait.regAddr;
+	bool					fWrite			= wait.fWrite;
+	uint64_t				writeValue		= wait.writeValue;
+	uint64_t				mask			= wait.mask;
+	uint64_t				expected		= wait.expected;
+	bool					fEqual			= wait.fEqual;
+	double					timeout			= wait.fTimeout ? wait.timeout : std::min( pasynUser->timeout, GENCP_WAIT_MAX_SEC );
+	if (	pError == NULL && fWrite && pEntry != NULL && ( pEntry->flags & GENCP_REGMAP_FLAG_MASKED )
+		&&	!( pEntry->access & GENCP_REGMAP_ACCESS_RO ) )
+		pError	= "bit field of a write only register";
+	if ( pError != NULL )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s %s: %s\n", functionName, m_portName, pError, data	);
+		m_fInputFlushNeeded = true;
+		return asynError;
+	}
+
+	asynStatus		status	= asynSuccess;
+	size_t			nBytes	= nBits / 8;
+	bool			fLittle	= pEntry != NULL && pEntry->endian != GENCP_REGMAP_ENDIAN_BIG;
+	if ( !m_combineData.empty() )
+	{
+		status	= GenCpFlushWrites( pasynUser );
+		if ( status != asynSuccess )
+			return status;
+	}
+	if ( !m_lostWrites.empty() && GenCpCheckLostWrites( pasynUser, regAddr, nBytes ) != asynSuccess )
+		return asynError;
+	if ( fWrite )
+	{
+		uint8_t		regBytes[sizeof(uint64_t)];
+		uint64_t	rawValue	= writeValue;
+		if ( pEntry != NULL && ( pEntry->flags & GENCP_REGMAP_FLAG_MASKED ) )
+		{
+			// Bit fields are written by a read-modify-write of the register
+			status	= GenCpReadMem( pasynUser, regAddr, regBytes, nBytes );
+			if ( status != asynSuccess )
+				return status;
+			unsigned int	nFieldBits	= pEntry->msb - pEntry->lsb + 1;
+			uint64_t		fieldMask	= ( nFieldBits < 64 ) ? ( 1ULL << nFieldBits ) - 1 : ~0ULL;
+			rawValue	= GenCpDecodeUint( regBytes, nBytes );
+			if ( fLittle )
+				rawValue	= GenCpSwapBytes( rawValue, nBytes );
+			rawValue	= ( rawValue & ~( fieldMask << pEntry->lsb ) ) | ( ( writeValue & fieldMask ) << pEntry->lsb );
+		}
+		if ( fLittle )
+			rawValue	= GenCpSwapBytes( rawValue, nBytes );
+		GenCpEncodeUint( rawValue, nBytes, regBytes );
+		m_regCache.Invalidate( regAddr, nBytes );
+		m_regCache.InvalidateRecent();
+		GenCpForgetSelectors( regAddr, nBytes );
+		GenCpInvalidateDependents( regAddr, nBytes );
+		status	= GenCpWriteMem( pasynUser, regAddr, regBytes, nBytes );
+		if ( status != asynSuccess )
+			return status;
+	}
+
+	// Poll right away, then back off, all w/in this request so no queue turnaround
+	epicsTimeStamp		tStart;
+	epicsTimeStamp		tNow;
+	double				interval	= GENCP_WAIT_MIN_POLL_SEC;
+	epicsTimeGetCurrent( &tStart );
+	m_nWaits++;
+	for ( ;; )
+	{
+		// The register is expected to change, so the cache doesn't apply
+		status	= GenCpReadMem( pasynUser, regAddr, m_GenCpReadData, nBytes );
+		if ( status != asynSuccess )
+			return status;
+		m_nWaitPolls++;
+		uint64_t	value;
+		if ( pEntry != NULL )
+			value	= GenCpRegMapDecodeInt( pEntry, m_GenCpReadData );
+		else
+			value	= GenCpDecodeUint( m_GenCpReadData, nBytes );
+		if ( ( ( value & mask ) == expected ) == fEqual )
+			break;
+
+		epicsTimeGetCurrent( &tNow );
+		double		remaining	= timeout - epicsTimeDiffInSeconds( &tNow, &tStart );
+		if ( remaining <= 0.0 )
+		{
+			m_nWaitTimeouts++;
+			epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+							"%s: %s 0x%llX=0x%llX after %.3f sec: %s\n", functionName, m_portName,
+							(long long unsigned int) regAddr, (long long unsigned int) value, timeout, data	);
+			return asynTimeout;
+		}
+		epicsThreadSleep( interval < remaining ? interval : remaining );
+		interval	= ( interval * 2 < GENCP_WAIT_MAX_POLL_SEC ) ? interval * 2 : GENCP_WAIT_MAX_POLL_SEC;
+	}
+
+	// Answer w/ the value that met the condition, as a U or N read would
+	if ( pEntry != NULL )
+	{
+		m_feature	= *pEntry;
+		m_fFeature	= true;
+	}
+	m_GenCpRegAddr			= regAddr;
+	m_GenCpReadBytes		= nBytes;
+	m_GenCpResponseType		= GENCP_TY_RESP_UINT;
+	m_GenCpResponseCount	= nBits;
+	*ppSendBufferRet		= NULL;
+	*psSendBufferRet		= 0;
+	m_fResponseLocal		= true;
+	m_GenCpPendingRequestId	= 0xFFFF;
+	return asynSuccess;
+}
+
+int	asynGenicam::LoadPresets(
+	const char			*	pFileName	)
+{
+	if ( pFileName == NULL || pFileName[0] == '\0' )
+	{
+		printf( "%s asynGenicamLoadPresets: preset file name required.\n", m_portName );
+		return -1;
+	}
+	FILE	*	fp	= fopen( pFileName, "r" );
+	if ( fp == NULL )
+	{
+		printf( "%s asynGenicamLoadPresets: unable to open %s: %s\n", m_portName, pFileName, strerror( errno ) );
+		return -1;
+	}
+
+	// [name] starts a preset, followed by its write commands, one per line, # starts a comment
+	std::map<std::string, GenCpPreset>	presets;
+	GenCpPreset						*	pPreset	= NULL;
+	char								line[256];
+	int									nLine	= 0;
+	int									status	= 0;
+	while ( status == 0 && fgets( line, sizeof(line), fp ) != NULL )
+	{
+		nLine++;
+		if ( strchr( line, '\n' ) == NULL && !feof( fp ) )
+		{
+			// The rest would be read as a line of its own
+			printf( "%s asynGenicamLoadPresets: %s line %d: longer than %zu characters.\n",
+					m_portName, pFileName, nLine, sizeof(line) - 2 );
+			status	= -1;
+			break;
+		}
+		char	*	pComment	= strchr( line, '#' );
+		if ( pComment != NULL )
+			*pComment	= '\0';
+		char	*	pLine		= line + strspn( line, " \t" );
+		size_t		sLine		= strlen( pLine );
+		while ( sLine > 0 && strchr( " \t\r\n", pLine[sLine - 1] ) != NULL )
+			pLine[--sLine]	= '\0';
+		if ( sLine == 0 )
+			continue;
+		if ( pLine[0] == '[' && pLine[sLine - 1] == ']' && sLine > 2 )
+		{
+			std::string		name( pLine + 1, sLine - 2 );
+			if ( presets.find( name ) != presets.end() )
+			{
+				printf( "%s asynGenicamLoadPresets: %s line %d: preset %s defined twice.\n",
+						m_portName, pFileName, nLine, name.c_str() );
+				status	= -1;
+			}
+			pPreset				= &presets[name];
+			pPreset->file		= pFileName;
+			pPreset->fCompiled	= false;
+		}
+		else if ( pPreset == NULL || ( pLine[0] != 'U' && pLine[0] != 'N' ) || strchr( pLine, '=' ) == NULL )
+		{
+			printf( "%s asynGenicamLoadPresets: %s line %d: [name] or U or N write command expected: %s\n",
+					m_portName, pFileName, nLine, pLine );
+			status	= -1;
+		}
+		else
+			pPreset->lines.push_back( pLine );
+	}
+	fclose( fp );
+	if ( status == 0 && presets.empty() )
+	{
+		printf( "%s asynGenicamLoadPresets: no presets in %s.\n", m_portName, pFileName );
+		status	= -1;
+	}
+	if ( status != 0 )
+		return status;
+
+	if ( pasynManager->lockPort( m_pasynUserSelf ) != asynSuccess )
+	{
+		printf( "%s asynGenicamLoadPresets: unable to lock port.\n", m_portName );
+		return -1;
+	}
+	for ( std::map<std::string, GenCpPreset>::iterator it = presets.begin(); it != presets.end(); ++it )
+		m_presets[it->first]	= it->second;
+	pasynManager->unlockPort( m_pasynUserSelf );
+	return 0;
+}
+
+asynStatus	asynGenicam::GenCpCompilePreset(
+	asynUser			*	pasynUser,
+	const char			*	pName,
+	GenCpPreset			&	preset	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpCompilePreset";
+	std::map<uint64_t, GenCpPresetWrite>	batch;	// Since the last selector, by address
+	const char			*	pError			= NULL;
+	size_t					iLine;
+
+	preset.writes.clear();
+	for ( iLine = 0; iLine < preset.lines.size(); iLine++ )
+	{
+		const char			*	pLine		= preset.lines[iLine].c_str();
+		const char			*	pValue		= strchr( pLine, '=' ) + 1;
+		char				*	pEnd		= NULL;
+		char					featureName[128];
+		unsigned int			nBits		= 0;
+		long long int			regAddr		= 0;
+		uint64_t				rawValue	= 0;
+		uint64_t				mask		= ~0ULL;
+		size_t					nBytes		= 0;
+		GenCpPresetWrite		write;
+		write.fReadable		= true;
+		if ( sscanf( pLine, "U%u %Li", &nBits, &regAddr ) == 2 )
+		{
+			// Unsigned, so U64 values above 2^63 aren't clamped, negative ones still wrap
+			rawValue	= strtoull( pValue, &pEnd, 0 );
+			nBytes		= nBits / 8;
+			if ( !GenCpValidUintBits( nBits ) )
+				pError	= "unsupported register length";
+			else if ( pEnd == pValue )
+				pError	= "invalid value";
+			write.address	= regAddr;
+		}
+		else if ( sscanf( pLine, "N %127[^ \t=]", featureName ) == 1 )
+		{
+			// Encoded as FeatureToGenicam would for the N write
+			const GenCpRegMapEntry	*	pEntry	= NULL;
+			if ( !m_regMap.IsLoaded() )
+				pError	= "no register map loaded, see asynGenicamSetRegMap";
+			else if ( ( pEntry = m_regMap.Find( featureName ) ) == NULL )
+				pError	= "unknown feature";
+			else if ( ( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA ) || !( pEntry->access & GENCP_REGMAP_ACCESS_WO ) )
+				pError	= "feature is not writable";
+			else if (	pEntry->type == GENCP_REGMAP_TYPE_STRING || pEntry->type == GENCP_REGMAP_TYPE_REGISTER
+					||	pEntry->type == GENCP_REGMAP_TYPE_COMMAND )
+				pError	= "only numeric features can be preset";
+			else if ( pEntry->length == 0 || pEntry->length > sizeof(uint64_t) )
+				pError	= "unsupported register length";
+			else if ( pEntry->type == GENCP_REGMAP_TYPE_FLOAT && !( pEntry->flags & GENCP_REGMAP_FLAG_MASKED ) )
+			{
+				double		doubleValue	= strtod( pValue, &pEnd );
+				if ( pEntry->length == sizeof(float) )
+				{
+					float		floatValue	= static_cast<float>( doubleValue );
+					uint32_t	rawValue32;
+					memcpy( &rawValue32, &floatValue, sizeof(rawValue32) );
+					rawValue	= rawValue32;
+				}
+				else if ( pEntry->length == sizeof(double) )
+					memcpy( &rawValue, &doubleValue, sizeof(rawValue) );
+				else
+					pError	= "unsupported float length";
+			}
+			else
+			{
+				rawValue	= static_cast<uint64_t>( strtoll( pValue, &pEnd, 0 ) );
+				if ( pEntry->flags & GENCP_REGMAP_FLAG_MASKED )
+				{
+					unsigned int	nFieldBits	= pEntry->msb - pEntry->lsb + 1;
+					uint64_t		fieldMask	= ( nFieldBits < 64 ) ? ( 1ULL << nFieldBits ) - 1 : ~0ULL;
+					mask		= fieldMask << pEntry->lsb;
+					rawValue	= ( rawValue & fieldMask ) << pEntry->lsb;
+				}
+			}
+			if ( pError == NULL && pEnd == pValue )
+				pError	= "invalid value";
+			if ( pError == NULL )
+			{
+				nBytes			= pEntry->length;
+				write.address	= pEntry->address;
+				write.fReadable	= ( pEntry->access & GENCP_REGMAP_ACCESS_RO ) != 0;
+				if ( pEntry->endian != GENCP_REGMAP_ENDIAN_BIG )
+				{
+					rawValue	= GenCpSwapBytes( rawValue, nBytes );
+					mask		= GenCpSwapBytes( mask, nBytes );
+				}
+			}
+		}
+		else
+			pError	= "syntax error";
+		if ( pError != NULL )
+			break;
+
+		for ( size_t iByte = 0; iByte < nBytes; iByte++ )
+		{
+			write.bytes.push_back( static_cast<uint8_t>( rawValue >> ( 8 * ( nBytes - 1 - iByte ) ) ) );
+			write.mask.push_back(  static_cast<uint8_t>( mask     >> ( 8 * ( nBytes - 1 - iByte ) ) ) );
+		}
+		write.fSelector	= m_selectors.find( write.address ) != m_selectors.end();
+		if ( !write.fReadable && mask != ~0ULL )
+			pError	= "bit field of a write only register";
+		else if ( write.fSelector )
+		{
+			// Features after a selector apply to the index it selects, so keep the order
+			for ( std::map<uint64_t, GenCpPresetWrite>::iterator it = batch.begin(); it != batch.end(); ++it )
+				preset.writes.push_back( it->second );
+			batch.clear();
+			preset.writes.push_back( write );
+		}
+		else if ( batch.find( write.address ) == batch.end() )
+			batch[write.address]	= write;
+		else
+		{
+			// Bit fields of one register, or the same register twice, last value wins
+			GenCpPresetWrite	&	merged	= batch[write.address];
+			if ( merged.bytes.size() != nBytes )
+				pError	= "register written w/ another length before";
+			for ( size_t iByte = 0; pError == NULL && iByte < nBytes; iByte++ )
+			{
+				merged.bytes[iByte]	= static_cast<uint8_t>( ( merged.bytes[iByte] & ~write.mask[iByte] ) | write.bytes[iByte] );
+				merged.mask[iByte]	|= write.mask[iByte];
+			}
+			merged.fReadable	= merged.fReadable && write.fReadable;
+		}
+		if ( pError != NULL )
+			break;
+	}
+	for ( std::map<uint64_t, GenCpPresetWrite>::iterator it = batch.begin(); it != batch.end(); ++it )
+		preset.writes.push_back( it->second );
+
+	for ( size_t iWrite = 1; pError == NULL && iWrite < preset.writes.size(); iWrite++ )
+	{
+		const GenCpPresetWrite	&	prev	= preset.writes[iWrite - 1];
+		const GenCpPresetWrite	&	write	= preset.writes[iWrite];
+		if (	!prev.fSelector && !write.fSelector
+			&&	prev.address + prev.bytes.size() > write.address )
+		{
+			epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+							"%s: %s preset %s registers 0x%llX and 0x%llX overlap\n", functionName, m_portName,
+							pName, (long long unsigned int) prev.address, (long long unsigned int) write.address );
+			preset.writes.clear();
+			return asynError;
+		}
+	}
+	if ( pError != NULL )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s preset %s of %s %s: %s\n", functionName, m_portName,
+						pName, preset.file.c_str(), pError, preset.lines[iLine].c_str() );
+		preset.writes.clear();
+		return asynError;
+	}
+	preset.fCompiled	= true;
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::ApplyPreset(
+	asynUser			*	pasynUser,
+	const char			*	pName	)
+{
+    static const char	*	functionName	= "asynGenicam::ApplyPreset";
+	std::map<std::string, GenCpPreset>::iterator	itPreset	= m_presets.find( pName );
+	if ( itPreset == m_presets.end() )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s no preset %s, see asynGenicamLoadPresets\n", functionName, m_portName, pName );
+		return asynError;
+	}
+	GenCpPreset		&	preset	= itPreset->second;
+	asynStatus			status	= asynSuccess;
+	if ( !preset.fCompiled && ( status = GenCpCompilePreset( pasynUser, pName, preset ) ) != asynSuccess )
+		return status;
+	if ( !m_combineData.empty() && ( status = GenCpFlushWrites( pasynUser ) ) != asynSuccess )
+		return status;
+
+	m_nPresetApplies++;
+	for ( size_t iBatch = 0; iBatch < preset.writes.size(); )
+	{
+		// Registers between selector writes go together, each selector by itself
+		size_t		iEnd	= iBatch + 1;
+		while ( !preset.writes[iBatch].fSelector && iEnd < preset.writes.size() && !preset.writes[iEnd].fSelector )
+			iEnd++;
+
+		// Current values in as few ReadMem transactions as possible, from the cache where valid
+		GenCpRegData	regData;
+		for ( size_t iWrite = iBatch; iWrite < iEnd; iWrite++ )
+		{
+			if ( preset.writes[iWrite].fReadable )
+				regData[preset.writes[iWrite].address].resize( preset.writes[iWrite].bytes.size() );
+		}
+		status	= GenCpReadRegs( pasynUser, regData );
+		if ( status != asynSuccess )
+			return status;
+
+		// Registers that change, contiguous ones sent in one WriteMem
+		std::vector<uint8_t>	span;
+		uint64_t				spanAddr	= 0;
+		for ( size_t iWrite = iBatch; iWrite < iEnd; iWrite++ )
+		{
+			const GenCpPresetWrite	&	write	= preset.writes[iWrite];
+			std::vector<uint8_t>		value( write.bytes );
+			if ( write.fReadable )
+			{
+				const std::vector<uint8_t>	&	current	= regData[write.address];
+				for ( size_t iByte = 0; iByte < value.size(); iByte++ )
+					value[iByte]	= static_cast<uint8_t>( ( current[iByte] & ~write.mask[iByte] ) | write.bytes[iByte] );
+				if ( value == current )
+				{
+					m_nPresetSkips++;
+					continue;
+				}
+			}
+			m_nPresetWrites++;
+			if (	!span.empty() && spanAddr + span.size() == write.address
+				&&	span.size() + value.size() <= m_maxWriteMemBytes )
+			{
+				span.insert( span.end(), value.begin(), value.end() );
+				continue;
+			}
+			if ( !span.empty() && ( status = GenCpPresetWriteSpan( pasynUser, spanAddr, span ) ) != asynSuccess )
+				return status;
+			spanAddr	= write.address;
+			span		= value;
+		}
+		if ( !span.empty() && ( status = GenCpPresetWriteSpan( pasynUser, spanAddr, span ) ) != asynSuccess )
+			return status;
+		iBatch	= iEnd;
+	}
+
+	if ( !m_refreshRegs.empty() && GenCpReadRegs( pasynUser, m_refreshRegs ) != asynSuccess )
+	{
+		// Preset written, registers not refreshed are read on demand
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s unable to refresh %zu invalidated registers: %s\n",
+					functionName, m_portName, m_refreshRegs.size(), pasynUser->errorMessage );
+	}
+	m_refreshRegs.clear();
+	return asynSuccess;
+}
+
+asynStatus	asynGenicam::GenCpPresetWriteSpan(
+	asynUser			*	pasynUser,
+	uint64_t				regAddr,
+	const std::vector<uint8_t>	&	span	)
+{
+	// Also forgets the selector values the span overwrites
+	if ( GenCpSelectorUnchanged( regAddr, &span[0], span.size() ) )
+		return asynSuccess;
+
+	m_regCache.Invalidate( regAddr, span.size() );
+	m_regCache.InvalidateRecent();
+	GenCpInvalidateDependents( regAddr, span.size() );
+	asynStatus	status	= GenCpWriteMem( pasynUser, regAddr, &span[0], span.size() );
+	m_nPresetWriteMems++;
+	if ( status == asynSuccess && m_fSelectorPending )
+		m_selectorState[regAddr]	= m_selectorPending;
+	m_fSelectorPending	= false;
+	return status;
+}
+
+asynStatus	asynGenicam::FeatureToGenicam(
+	asynUser			*	pasynUser,
+    const char			*	data,
+	const char			**	ppSendBufferRet,
+	size_t				*	psSendBufferRet	)
+{
+    static const char	*	functionName	= "asynGenicam::FeatureToGenicam";
+	char					featureName[128];
+	char					cGetSet			= 0;
+	std::string				stringCommand;
+	const char			*	pValue			= strchr( data, '=' );
+	const char			*	pError			= NULL;
+	const GenCpRegMapEntry *	pEntry		= NULL;
+
+	// N FeatureName ?  or  N FeatureName =Value
+	if ( sscanf( data, "N %127[^ \t?=] %c", featureName, &cGetSet ) != 2 || ( cGetSet != '?' && cGetSet != '=' ) )
+		pError	= "syntax error";
+	else if ( !m_regMap.IsLoaded() )
+		pError	= "no register map loaded, see asynGenicamSetRegMap";
+	else if ( ( pEntry = m_regMap.Find( featureName ) ) == NULL )
+		pError	= "unknown feature";
+	else if ( cGetSet == '?' && !( pEntry->access & GENCP_REGMAP_ACCESS_RO ) )
+		pError	= "feature is not readable";
+	else if ( cGetSet == '=' && !( pEntry->access & GENCP_REGMAP_ACCESS_WO ) )
+		pError	= "feature is not writable";
+	if ( pError != NULL )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s %s: %s\n", functionName, m_portName, pError, data	);
+		m_fInputFlushNeeded = true;
+		return asynError;
+	}
+
+	if ( pEntry->flags & GENCP_REGMAP_FLAG_FORMULA )
+	{
+		// Computed features are read only, so this is a read
+		double		value;
+		asynStatus	status	= GenCpEvalFeature( pasynUser, pEntry, &value );
+		if ( status != asynSuccess )
+			return status;
+		GenCpFormatFormula( m_formulaResponse, GENCP_RESPONSE_MAX, pEntry, featureName, value );
+		*ppSendBufferRet		= NULL;
+		*psSendBufferRet		= 0;
+		m_fResponseLocal		= true;
+		m_fFormulaResponse		= true;
+		m_GenCpPendingRequestId	= 0xFFFF;
+		return asynSuccess;
+	}
+
+	pError	= GenCpFeatureCommand( pEntry, cGetSet == '=' ? pValue + 1 : NULL, stringCommand );
+	if ( pError != NULL )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s %s %s: %s\n", functionName, m_portName, featureName, pError, data	);
+		m_fInputFlushNeeded = true;
+		return asynError;
+	}
+
+	asynPrint(	pasynUser, ASYN_TRACE_FLOW,
+				"%s %s: %s -> %s\n", functionName, m_portName, data, stringCommand.c_str() );
+	asynStatus	status	= AsciiToGenicam(	pasynUser, stringCommand.c_str(), stringCommand.size(),
+											ppSendBufferRet, psSendBufferRet );
+	if ( status == asynSuccess )
+	{
+		m_feature	= *pEntry;
+		m_fFeature	= true;
+	}
+	return status;
+}
+
+GENCP_STATUS	asynGenicam::GenCpFormatFeatureData(
+	char				*	pBuffer,
+	size_t					sBuffer,
+	const GenCpRegMapEntry	*	pFeature,
+	unsigned long long		regAddr,
+	const uint8_t		*	pData,
+	size_t					nBytes	)
+{
+	if ( nBytes != pFeature->length || pFeature->length == 0 || pFeature->length > sizeof(uint64_t) )
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+
+	if ( pFeature->type == GENCP_REGMAP_TYPE_FLOAT && !( pFeature->flags & GENCP_REGMAP_FLAG_MASKED ) )
+	{
+		if ( pFeature->length != sizeof(float) && pFeature->length != sizeof(double) )
+			return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+		snprintf( pBuffer, sBuffer, "R0x%llX=%f\n", regAddr, GenCpRegMapDecode( pFeature, pData ) );
+		return GENCP_STATUS_SUCCESS;
+	}
+
+	uint64_t		rawValue	= GenCpRegMapDecodeInt( pFeature, pData );
+	if ( pFeature->flags & GENCP_REGMAP_FLAG_SIGNED )
+		snprintf( pBuffer, sBuffer, "R0x%llX=%lld\n", regAddr, static_cast<long long int>( rawValue ) );
+	else
+		snprintf( pBuffer, sBuffer, "R0x%llX=%llu (0x%llX)\n", regAddr,
+				(long long unsigned int) rawValue, (long long unsigned int) rawValue );
+	return GENCP_STATUS_SUCCESS;
+}
+
+bool	asynGenicam::GenCpFormulaInputs(
+	const GenCpRegMapEntry	*	pEntry,
+	GenCpRegData			&	regData,
+	int							depth	)
+{
+	const GenCpRegMapFormula	*	pFormula	= m_regMap.Formula( pEntry );
+	if ( pFormula == NULL )
+	{
+		if ( pEntry->length == 0 || pEntry->length > sizeof(uint64_t) )
+			return false;
+		std::vector<uint8_t>	&	bytes	= regData[pEntry->address];
+		if ( bytes.size() < pEntry->length )
+			bytes.resize( pEntry->length );
+		return true;
+	}
+	if ( depth >= GENCP_REGMAP_MAX_FORMULA_DEPTH )
+		return false;
+	for ( size_t iVar = 0; iVar < pFormula->nVars; iVar++ )
+	{
+		if ( !GenCpFormulaInputs( m_regMap.Entry( m_regMap.FormulaVars( pFormula )[iVar] ), regData, depth + 1 ) )
+			return false;
+	}
+	return true;
+}
+
+bool	asynGenicam::GenCpEvalEntry(
+	const GenCpRegMapEntry	*	pEntry,
+	const GenCpRegData		&	regData,
+	double					*	pValue,
+	int							depth	)
+{
+	const GenCpRegMapFormula	*	pFormula	= m_regMap.Formula( pEntry );
+	if ( pFormula == NULL )
+	{
+		GenCpRegData::const_iterator	it	= regData.find( pEntry->address );
+		if ( it == regData.end() || it->second.size() < pEntry->length )
+			return false;
+		*pValue	= GenCpRegMapDecode( pEntry, &it->second[0] );
+		return true;
+	}
+	if ( depth >= GENCP_REGMAP_MAX_FORMULA_DEPTH )
+		return false;
+
+	std::vector<double>		vars( pFormula->nVars );
+	for ( size_t iVar = 0; iVar < pFormula->nVars; iVar++ )
+	{
+		if ( !GenCpEvalEntry( m_regMap.Entry( m_regMap.FormulaVars( pFormula )[iVar] ), regData, &vars[iVar], depth + 1 ) )
+			return false;
+	}
+	return GenCpFormulaEval(	m_regMap.FormulaCode( pFormula ), pFormula->nCode,
+								m_regMap.FormulaConsts( pFormula ), pFormula->nConsts,
+								vars.empty() ? NULL : &vars[0], vars.size(),
+								pFormula->fInteger != 0, pValue );
+}
+
+asynStatus	asynGenicam::GenCpReadRegs(
+	asynUser			*	pasynUser,
+	GenCpRegData		&	regData,
+	uint64_t			*	pResumeAddr,
+	size_t					maxReads	)
+{
+	// Registers not in the cache, in address order, merged into spans that fit one ReadMem
+	GenCpRegData::iterator	itSpan	= regData.end();
+	uint64_t				spanEnd	= 0;
+	size_t					nReads	= 0;
+	for ( GenCpRegData::iterator it = pResumeAddr ? regData.lower_bound( *pResumeAddr ) : regData.begin(); ; ++it )
+	{
+		if ( it != regData.end() && m_regCache.Lookup( it->first, &it->second[0], it->second.size() ) )
+			continue;
+		uint64_t	regEnd	= ( it != regData.end() ) ? it->first + it->second.size() : 0;
+		if (	it != regData.end() && itSpan != regData.end()
+			&&	it->first <= spanEnd + GENCP_FORMULA_MAX_GAP
+			&&	std::max( spanEnd, regEnd ) - itSpan->first <= m_maxReadMemBytes )
+		{
+			spanEnd	= std::max( spanEnd, regEnd );
+			continue;
 		}
-		else
-			scanCount = -1;
-		break;
 
-	case 'I':
-	default:
-		break;
+		if ( itSpan != regData.end() && pResumeAddr != NULL && maxReads > 0 && nReads++ == maxReads )
+		{
+			*pResumeAddr	= itSpan->first;
+			return asynSuccess;
+		}
+		if ( itSpan != regData.end() )
+		{
+			// Read the span, or each register in it if the span read fails, e.g. on a gap w/o registers
+			std::vector<uint8_t>	span( spanEnd - itSpan->first );
+			asynStatus				status	= GenCpReadMem( pasynUser, itSpan->first, &span[0], span.size() );
+			for ( GenCpRegData::iterator itReg = itSpan; itReg != it; ++itReg )
+			{
+				if ( status == asynSuccess )
+					memcpy( &itReg->second[0], &span[itReg->first - itSpan->first], itReg->second.size() );
+				else if ( m_regCache.Lookup( itReg->first, &itReg->second[0], itReg->second.size() ) )
+					continue;
+				else if ( GenCpReadMem( pasynUser, itReg->first, &itReg->second[0], itReg->second.size() ) != asynSuccess )
+					return asynError;
+				m_regCache.Update( itReg->first, &itReg->second[0], itReg->second.size() );
+			}
+		}
+		if ( it == regData.end() )
+			break;
+		itSpan	= it;
+		spanEnd	= regEnd;
 	}
-	m_GenCpRegAddr = regAddr;
+	if ( pResumeAddr != NULL )
+		*pResumeAddr	= GENCP_READ_REGS_DONE;
+	return asynSuccess;
+}
 
-	if ( scanCount == -1 || genStatus != 0 )
+asynStatus	asynGenicam::GenCpEvalFeature(
+	asynUser				*	pasynUser,
+	const GenCpRegMapEntry	*	pEntry,
+	double					*	pValue	)
+{
+    static const char	*	functionName	= "asynGenicam::GenCpEvalFeature";
+	GenCpRegData			regData;
+	const char			*	pName			= m_regMap.Name( pEntry );
+
+	if ( !GenCpFormulaInputs( pEntry, regData, 0 ) )
 	{
 		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
-						"%s: %s Invalid GenCP command: %s\n",
-						functionName, m_portName, data	);
-		m_fInputFlushNeeded = true;
+						"%s: %s %s formula nested too deep or reads a non numeric register\n",
+						functionName, m_portName, pName );
 		return asynError;
 	}
 
-	asynPrint(	pasynUser, ASYN_TRACE_FLOW,
-				"%s %s: responseType=%u, responseCount=%u, responseSize=%u\n",
-				functionName, m_portName, m_GenCpResponseType, m_GenCpResponseCount, m_GenCpResponseSize );
-
-	if ( requestId != 0xFFFF )
+	asynStatus	status	= GenCpReadRegs( pasynUser, regData );
+	if ( status != asynSuccess )
 	{
-		if ( DEBUG_GENICAM >= 3 )
-			printf( "REQUESTID %-5hu: Sending  %zu bytes, responseSize=%u\n",
-					requestId, *psSendBufferRet, m_GenCpResponseSize );
+		asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+					"%s: %s %s unable to read formula inputs: %s\n",
+					functionName, m_portName, pName, pasynUser->errorMessage );
+		return status;
 	}
 
+	if ( !GenCpEvalEntry( pEntry, regData, pValue, 0 ) )
+	{
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s %s formula evaluation failed\n", functionName, m_portName, pName );
+		return asynError;
+	}
 	return asynSuccess;
 }
 
+GENCP_STATUS	asynGenicam::GenCpFormatReadData(
+	char				*	pBuffer,
+	size_t					sBuffer	)
+{
+	return GenCpFormatRegData(	pBuffer, sBuffer, m_GenCpResponseType, m_GenCpResponseCount, m_GenCpRegAddr,
+								m_GenCpReadData, m_GenCpReadBytes, m_fFeature ? &m_feature : NULL );
+}
+
+GENCP_STATUS	asynGenicam::GenCpFormatRegData(
+	char				*	pBuffer,
+	size_t					sBuffer,
+	unsigned int			responseType,
+	unsigned int			responseCount,
+	unsigned long long		regAddr,
+	const uint8_t		*	pData,
+	size_t					nBytes,
+	const GenCpRegMapEntry	*	pFeature	)
+{
+	uint16_t				valueUint16;
+	uint32_t				valueUint32;
+	uint64_t				valueUint64;
+	float					floatValue;
+	double					doubleValue;
+
+	if ( pFeature != NULL && responseType != GENCP_TY_RESP_STRING )
+		return GenCpFormatFeatureData( pBuffer, sBuffer, pFeature, regAddr, pData, nBytes );
+
+	switch ( responseType )
+	{
+	case GENCP_TY_RESP_STRING:
+		// Device strings are only NULL terminated if shorter than the register
+		snprintf(	pBuffer, sBuffer, "R0x%llX=%.*s\n", regAddr,
+					static_cast<int>( nBytes ), reinterpret_cast<const char *>( pData ) );
+		break;
+	case GENCP_TY_RESP_UINT:
+		switch ( responseCount )
+		{
+		case 16:
+			memcpy( &valueUint16, pData, sizeof(valueUint16) );
+			valueUint16 = GenCpBigEndianToCpu( valueUint16 );
+			snprintf( pBuffer, sBuffer, "R0x%llX=%hu (0x%02hX)\n", regAddr, valueUint16, valueUint16 );
+			break;
+		case 32:
+			memcpy( &valueUint32, pData, sizeof(valueUint32) );
+			valueUint32 = GenCpBigEndianToCpu( valueUint32 );
+			snprintf( pBuffer, sBuffer, "R0x%llX=%u (0x%04X)\n", regAddr, valueUint32, valueUint32 );
+			break;
+		case 64:
+			memcpy( &valueUint64, pData, sizeof(valueUint64) );
+			valueUint64 = GenCpBigEndianToCpu( valueUint64 );
+			snprintf( pBuffer, sBuffer, "R0x%llX=%llu (0x%08llX)\n", regAddr,
+					(long long unsigned int) valueUint64, (long long unsigned int) valueUint64 );
+			break;
+		default:
+			if ( !GenCpValidUintBits( responseCount ) || nBytes < responseCount / 8 )
+				return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+			valueUint64 = 0;
+			for ( size_t iByte = 0; iByte < responseCount / 8; iByte++ )
+				valueUint64 = ( valueUint64 << 8 ) | pData[iByte];
+			snprintf( pBuffer, sBuffer, "R0x%llX=%llu (0x%02llX)\n", regAddr,
+					(long long unsigned int) valueUint64, (long long unsigned int) valueUint64 );
+			break;
+		}
+		break;
+	case GENCP_TY_RESP_FLOAT:
+	case GENCP_TY_RESP_DOUBLE:
+		switch ( responseCount )
+		{
+		case 32:
+			memcpy( &valueUint32, pData, sizeof(valueUint32) );
+			valueUint32 = GenCpBigEndianToCpu( valueUint32 );
+			memcpy( &floatValue, &valueUint32, sizeof(floatValue) );
+			snprintf( pBuffer, sBuffer, "R0x%llX=%f\n", regAddr, floatValue );
+			break;
+		case 64:
+			memcpy( &valueUint64, pData, sizeof(valueUint64) );
+			valueUint64 = GenCpBigEndianToCpu( valueUint64 );
+			memcpy( &doubleValue, &valueUint64, sizeof(doubleValue) );
+			snprintf( pBuffer, sBuffer, "R0x%llX=%lf\n", regAddr, doubleValue );
+			break;
+		default:
+			return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+		}
+		break;
+	default:
+		return GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
+	}
+	return GENCP_STATUS_SUCCESS;
+}
+
 asynStatus	asynGenicam::GenicamToAscii(
 	asynUser			*	pasynUser,
 	char				*	pBuffer,
@@ -603,6 +5254,7 @@ asynStatus	asynGenicam::GenicamToAscii(
     static const char	*	functionName	= "asynGenicam::GenicamToAscii";
 	char					genCpResponseBuffer[GENCP_RESPONSE_MAX];
 
+	genCpResponseBuffer[0] = '\0';
 	if ( pnRead )
 		*pnRead = 0;
 	if ( eomReason )
@@ -644,6 +5296,35 @@ asynStatus	asynGenicam::GenicamToAscii(
 		return asynSuccess;
 	}
 
+	if ( m_fResponseLocal )
+	{
+		// Register data is already in m_GenCpReadData, or a formula result
+		// in m_formulaResponse, no ack to read
+		m_fResponseLocal	= false;
+		if ( DEBUG_GENICAM >= 3 )
+			printf( "%s: %s 0x%llX from cache\n", functionName, m_portName, m_GenCpRegAddr );
+		GENCP_STATUS	genStatus	= GENCP_STATUS_SUCCESS;
+		if ( m_fFormulaResponse )
+			strncpy( genCpResponseBuffer, m_formulaResponse, GENCP_RESPONSE_MAX );
+		else if ( m_GenCpResponseType == GENCP_TY_RESP_ACK )
+			strncpy( genCpResponseBuffer, "OK\n", GENCP_RESPONSE_MAX );
+		else
+			genStatus	= GenCpFormatReadData( genCpResponseBuffer, GENCP_RESPONSE_MAX );
+		if ( genStatus != GENCP_STATUS_SUCCESS )
+		{
+			fprintf( stderr, "%s: Cached response format Error: %d (0x%X)\n", functionName, genStatus, genStatus );
+			status = asynError;
+		}
+	}
+	else if ( m_fBreakerOpen )
+	{
+		// Nothing was sent, the write was failed by the breaker
+		epicsSnprintf(	pasynUser->errorMessage, pasynUser->errorMessageSize,
+						"%s: %s device not responding\n", functionName, m_portName );
+		return asynDisconnected;
+	}
+	else
+	{
 	switch ( m_GenCpResponseType )
 	{
 	case GENCP_TY_RESP_ACK:
@@ -671,7 +5352,9 @@ asynStatus	asynGenicam::GenicamToAscii(
 				functionName, m_portName, nBytesReadMax, sReadBuffer, pasynUser->timeout );
 
 	if ( pReadBuffer != NULL && sReadBuffer > 0 )
-		status = m_pasynOctetDrv->read(	m_drvPvt, pasynUser, pReadBuffer, sReadBuffer, &nRead, eomReason );
+		status = GenCpReadAck(	pasynUser, m_GenCpPendingRequestId,
+								( m_GenCpResponseType == GENCP_TY_RESP_ACK ) ? GENCP_RTT_WRITE : GENCP_RTT_READ,
+								m_sRequestSent, &m_tRequestSent, pReadBuffer, sReadBuffer, &nRead );
 	if( nRead > 0 )
 	{
 		if ( DEBUG_GENICAM >= 3 )
@@ -720,7 +5403,7 @@ asynStatus	asynGenicam::GenicamToAscii(
 	switch ( m_GenCpResponseType )
 	{
 	case GENCP_TY_RESP_ACK:
-		genStatus = GenCpValidateWriteMemAck( pWriteAck, m_GenCpRequestId-1 );
+		genStatus = GenCpValidateWriteMemAck( pWriteAck, m_GenCpPendingRequestId );
 		if ( genStatus != GENCP_STATUS_SUCCESS )
 		{
 			// TODO: Add status code to error msg translation here
@@ -729,76 +5412,43 @@ asynStatus	asynGenicam::GenicamToAscii(
 			m_fInputFlushNeeded = true;
 			status = asynError;
 		}
-		strncpy( genCpResponseBuffer, "OK\n", GENCP_RESPONSE_MAX );
-		break;
-	case GENCP_TY_RESP_STRING:
-		snprintf( genCpResponseBuffer, GENCP_RESPONSE_MAX, "R0x%LX=", m_GenCpRegAddr );
-		genStatus = GenCpProcessReadMemAck( pReadAck, m_GenCpRequestId-1, genCpResponseBuffer + strlen(genCpResponseBuffer), (size_t)(GENCP_RESPONSE_MAX - strlen(genCpResponseBuffer)), &nBytesRead );
-		if ( genStatus != GENCP_STATUS_SUCCESS )
+		else
 		{
-			// TODO: Add status code to error msg translation here
-			snprintf( genCpResponseBuffer, GENCP_RESPONSE_MAX, "ERR %d (0x%X)\n", genStatus, genStatus );
-			fprintf( stderr, "%s: ReadMemString Validate Error: %d (0x%X)\n", functionName, genStatus, genStatus );
-			m_fInputFlushNeeded = true;
-			status = asynError;
+			strncpy( genCpResponseBuffer, "OK\n", GENCP_RESPONSE_MAX );
+			if ( m_fSelectorPending )
+				m_selectorState[m_GenCpRegAddr]	= m_selectorPending;
+			if ( !m_refreshRegs.empty() && GenCpReadRegs( pasynUser, m_refreshRegs ) != asynSuccess )
+			{
+				// Write succeeded, registers not refreshed are read on demand
+				asynPrint(	pasynUser, ASYN_TRACE_ERROR,
+							"%s: %s unable to refresh %zu invalidated registers: %s\n",
+							functionName, m_portName, m_refreshRegs.size(), pasynUser->errorMessage );
+			}
+			m_refreshRegs.clear();
 		}
-		strcat( genCpResponseBuffer, "\n" );
 		break;
+	case GENCP_TY_RESP_STRING:
 	case GENCP_TY_RESP_UINT:
-		switch ( m_GenCpResponseCount )
-		{
-		case 16:
-			uint16_t	valueUint16;
-			genStatus = GenCpProcessReadMemAck( pReadAck, m_GenCpRequestId-1, &valueUint16 );
-			snprintf( genCpResponseBuffer, GENCP_RESPONSE_MAX, "R0x%llX=%hu (0x%02hX)\n", m_GenCpRegAddr, valueUint16, valueUint16 );
-			break;
-		case 32:
-			uint32_t	valueUint32;
-			genStatus = GenCpProcessReadMemAck( pReadAck, m_GenCpRequestId-1, &valueUint32 );
-			snprintf( genCpResponseBuffer, GENCP_RESPONSE_MAX, "R0x%llX=%u (0x%04X)\n", m_GenCpRegAddr, valueUint32, valueUint32 );
-			break;
-		case 64:
-			uint64_t	valueUint64;
-			genStatus = GenCpProcessReadMemAck( pReadAck, m_GenCpRequestId-1, &valueUint64 );
-			snprintf( genCpResponseBuffer, GENCP_RESPONSE_MAX, "R0x%llX=%llu (0x%08llX)\n", m_GenCpRegAddr,
-					(long long unsigned int) valueUint64, (long long unsigned int) valueUint64 );
-			break;
-		default:
-			genStatus	= GENCP_STATUS_INVALID_PARAM;
-			break;
-		}
+	case GENCP_TY_RESP_FLOAT:
+	case GENCP_TY_RESP_DOUBLE:
+		genStatus = GenCpProcessReadMemAck(	pReadAck, m_GenCpPendingRequestId,
+											reinterpret_cast<char *>( m_GenCpReadData ), m_GenCpReadBytes, &nBytesRead );
+		if ( genStatus == GENCP_STATUS_SUCCESS && nBytesRead != m_GenCpReadBytes )
+			genStatus = GENCP_STATUS_INVALID_PARAM | GENCP_SC_ERROR;
 		if ( genStatus != GENCP_STATUS_SUCCESS )
 		{
 			// TODO: Add status code to error msg translation here
 			snprintf( genCpResponseBuffer, GENCP_RESPONSE_MAX, "ERR %d (0x%X)\n", genStatus, genStatus );
-			fprintf( stderr, "%s: Uint ProcessReadMem Error: %d (0x%X)\n", functionName, genStatus, genStatus );
+			fprintf( stderr, "%s: ProcessReadMem Error: %d (0x%X)\n", functionName, genStatus, genStatus );
 			m_fInputFlushNeeded = true;
 			status = asynError;
-		}
-		break;
-	case GENCP_TY_RESP_FLOAT:
-		switch ( m_GenCpResponseCount )
-		{
-		case 32:
-			float		floatValue;
-			genStatus = GenCpProcessReadMemAck( pReadAck, m_GenCpRequestId-1, &floatValue );
-			snprintf( genCpResponseBuffer, GENCP_RESPONSE_MAX, "R0x%llX=%f\n", m_GenCpRegAddr, floatValue );
-			break;
-		case 64:
-			double		doubleValue;
-			genStatus = GenCpProcessReadMemAck( pReadAck, m_GenCpRequestId-1, &doubleValue );
-			snprintf( genCpResponseBuffer, GENCP_RESPONSE_MAX, "R0x%llX=%lf\n", m_GenCpRegAddr, doubleValue );
-			break;
-		default:
-			genStatus	= GENCP_STATUS_INVALID_PARAM;
 			break;
 		}
+		m_regCache.Update( m_GenCpRegAddr, m_GenCpReadData, nBytesRead );
+		genStatus = GenCpFormatReadData( genCpResponseBuffer, GENCP_RESPONSE_MAX );
 		if ( genStatus != GENCP_STATUS_SUCCESS )
 		{
-			// TODO: Add status code to error msg translation here
-			snprintf( genCpResponseBuffer, GENCP_RESPONSE_MAX, "ERR %d (0x%X)\n", genStatus, genStatus );
-			fprintf( stderr, "%s: Uint ProcessReadMem Error: %d (0x%X)\n", functionName, genStatus, genStatus );
-			m_fInputFlushNeeded = true;
+			fprintf( stderr, "%s: Response format Error: %d (0x%X)\n", functionName, genStatus, genStatus );
 			status = asynError;
 		}
 		break;
@@ -809,6 +5459,7 @@ asynStatus	asynGenicam::GenicamToAscii(
 		break;
 	}
 	}
+	}
 
 	{
 	size_t		nBytesResponse = strlen( genCpResponseBuffer );
@@ -834,7 +5485,8 @@ asynStatus	asynGenicam::GenicamToAscii(
 			if ( m_fInputFlushNeeded )
 			{
 				char	flushBuffer[256];
-				m_pasynOctetDrv->read(	m_drvPvt, pasynUser, flushBuffer, 256, &nRead, eomReason );
+				size_t	nFlushed	= 0;
+				m_pasynOctetDrv->read(	m_drvPvt, pasynUser, flushBuffer, 256, &nFlushed, eomReason );
 				m_fInputFlushNeeded = false;
 				if ( DEBUG_GENICAM >= 3 )
 					printf( "%s Exit: %s Flushed %zu bytes from input\n", functionName, m_portName, nBytesResponse );
@@ -878,14 +5530,387 @@ static void asynGenicamConfigCallFunc( const iocshArgBuf *args)
     asynGenicamConfig( args[0].sval, args[1].ival );
 }
 
+/* register asynGenicamSetMaxBaud*/
+static const iocshArg asynGenicamSetMaxBaudArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamSetMaxBaudArg1 =
+    { "maxBaud", iocshArgInt };
+static const iocshArg *asynGenicamSetMaxBaudArgs[] =
+{
+    &asynGenicamSetMaxBaudArg0,
+    &asynGenicamSetMaxBaudArg1,
+};
+static const iocshFuncDef asynGenicamSetMaxBaudFuncDef =
+{	"asynGenicamSetMaxBaud",
+	2,
+	asynGenicamSetMaxBaudArgs
+};
+static void asynGenicamSetMaxBaudCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamSetMaxBaud( args[0].sval, args[1].ival );
+}
+
+/* register asynGenicamSetAdaptiveTimeout*/
+static const iocshArg asynGenicamSetAdaptiveTimeoutArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamSetAdaptiveTimeoutArg1 =
+    { "enable", iocshArgInt };
+static const iocshArg asynGenicamSetAdaptiveTimeoutArg2 =
+    { "minTimeoutMs", iocshArgDouble };
+static const iocshArg *asynGenicamSetAdaptiveTimeoutArgs[] =
+{
+    &asynGenicamSetAdaptiveTimeoutArg0,
+    &asynGenicamSetAdaptiveTimeoutArg1,
+    &asynGenicamSetAdaptiveTimeoutArg2,
+};
+static const iocshFuncDef asynGenicamSetAdaptiveTimeoutFuncDef =
+{	"asynGenicamSetAdaptiveTimeout",
+	3,
+	asynGenicamSetAdaptiveTimeoutArgs
+};
+static void asynGenicamSetAdaptiveTimeoutCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamSetAdaptiveTimeout( args[0].sval, args[1].ival, args[2].dval );
+}
+
+/* register asynGenicamSetRegMap*/
+static const iocshArg asynGenicamSetRegMapArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamSetRegMapArg1 =
+    { "mapDir", iocshArgString };
+static const iocshArg asynGenicamSetRegMapArg2 =
+    { "compile", iocshArgInt };
+static const iocshArg *asynGenicamSetRegMapArgs[] =
+{
+    &asynGenicamSetRegMapArg0,
+    &asynGenicamSetRegMapArg1,
+    &asynGenicamSetRegMapArg2,
+};
+static const iocshFuncDef asynGenicamSetRegMapFuncDef =
+{	"asynGenicamSetRegMap",
+	3,
+	asynGenicamSetRegMapArgs
+};
+static void asynGenicamSetRegMapCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamSetRegMap( args[0].sval, args[1].sval, args[2].ival );
+}
+
+/* register asynGenicamSetRegCache*/
+static const iocshArg asynGenicamSetRegCacheArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamSetRegCacheArg1 =
+    { "enable", iocshArgInt };
+static const iocshArg asynGenicamSetRegCacheArg2 =
+    { "refresh", iocshArgInt };
+static const iocshArg *asynGenicamSetRegCacheArgs[] =
+{
+    &asynGenicamSetRegCacheArg0,
+    &asynGenicamSetRegCacheArg1,
+    &asynGenicamSetRegCacheArg2,
+};
+static const iocshFuncDef asynGenicamSetRegCacheFuncDef =
+{	"asynGenicamSetRegCache",
+	3,
+	asynGenicamSetRegCacheArgs
+};
+static void asynGenicamSetRegCacheCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamSetRegCache( args[0].sval, args[1].ival, args[2].ival );
+}
+
+/* register asynGenicamAddNoAckReg*/
+static const iocshArg asynGenicamAddNoAckRegArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamAddNoAckRegArg1 =
+    { "register", iocshArgString };
+static const iocshArg asynGenicamAddNoAckRegArg2 =
+    { "syncEvery", iocshArgInt };
+static const iocshArg *asynGenicamAddNoAckRegArgs[] =
+{
+    &asynGenicamAddNoAckRegArg0,
+    &asynGenicamAddNoAckRegArg1,
+    &asynGenicamAddNoAckRegArg2,
+};
+static const iocshFuncDef asynGenicamAddNoAckRegFuncDef =
+{	"asynGenicamAddNoAckReg",
+	3,
+	asynGenicamAddNoAckRegArgs
+};
+static void asynGenicamAddNoAckRegCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamAddNoAckReg( args[0].sval, args[1].sval, args[2].ival );
+}
+
+/* register asynGenicamSetWriteCombine*/
+static const iocshArg asynGenicamSetWriteCombineArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamSetWriteCombineArg1 =
+    { "enable", iocshArgInt };
+static const iocshArg *asynGenicamSetWriteCombineArgs[] =
+{
+    &asynGenicamSetWriteCombineArg0,
+    &asynGenicamSetWriteCombineArg1,
+};
+static const iocshFuncDef asynGenicamSetWriteCombineFuncDef =
+{	"asynGenicamSetWriteCombine",
+	2,
+	asynGenicamSetWriteCombineArgs
+};
+static void asynGenicamSetWriteCombineCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamSetWriteCombine( args[0].sval, args[1].ival );
+}
+
+/* register asynGenicamSetRecentReads*/
+static const iocshArg asynGenicamSetRecentReadsArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamSetRecentReadsArg1 =
+    { "maxAgeMs", iocshArgDouble };
+static const iocshArg *asynGenicamSetRecentReadsArgs[] =
+{
+    &asynGenicamSetRecentReadsArg0,
+    &asynGenicamSetRecentReadsArg1,
+};
+static const iocshFuncDef asynGenicamSetRecentReadsFuncDef =
+{	"asynGenicamSetRecentReads",
+	2,
+	asynGenicamSetRecentReadsArgs
+};
+static void asynGenicamSetRecentReadsCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamSetRecentReads( args[0].sval, args[1].dval );
+}
+
+/* register asynGenicamAddSelector*/
+static const iocshArg asynGenicamAddSelectorArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamAddSelectorArg1 =
+    { "selector", iocshArgString };
+static const iocshArg *asynGenicamAddSelectorArgs[] =
+{
+    &asynGenicamAddSelectorArg0,
+    &asynGenicamAddSelectorArg1,
+};
+static const iocshFuncDef asynGenicamAddSelectorFuncDef =
+{	"asynGenicamAddSelector",
+	2,
+	asynGenicamAddSelectorArgs
+};
+static void asynGenicamAddSelectorCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamAddSelector( args[0].sval, args[1].sval );
+}
+
+/* register asynGenicamAddScanGroup*/
+static const iocshArg asynGenicamAddScanGroupArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamAddScanGroupArg1 =
+    { "group", iocshArgString };
+static const iocshArg asynGenicamAddScanGroupArg2 =
+    { "period", iocshArgDouble };
+static const iocshArg asynGenicamAddScanGroupArg3 =
+    { "priority", iocshArgInt };
+static const iocshArg asynGenicamAddScanGroupArg4 =
+    { "maxPeriod", iocshArgDouble };
+static const iocshArg *asynGenicamAddScanGroupArgs[] =
+{
+    &asynGenicamAddScanGroupArg0,
+    &asynGenicamAddScanGroupArg1,
+    &asynGenicamAddScanGroupArg2,
+    &asynGenicamAddScanGroupArg3,
+    &asynGenicamAddScanGroupArg4,
+};
+static const iocshFuncDef asynGenicamAddScanGroupFuncDef =
+{	"asynGenicamAddScanGroup",
+	5,
+	asynGenicamAddScanGroupArgs
+};
+static void asynGenicamAddScanGroupCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamAddScanGroup( args[0].sval, args[1].sval, args[2].dval, args[3].ival, args[4].dval );
+}
+
+/* register asynGenicamAddScanReg*/
+static const iocshArg asynGenicamAddScanRegArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamAddScanRegArg1 =
+    { "group", iocshArgString };
+static const iocshArg asynGenicamAddScanRegArg2 =
+    { "command", iocshArgString };
+static const iocshArg asynGenicamAddScanRegArg3 =
+    { "deadband", iocshArgDouble };
+static const iocshArg *asynGenicamAddScanRegArgs[] =
+{
+    &asynGenicamAddScanRegArg0,
+    &asynGenicamAddScanRegArg1,
+    &asynGenicamAddScanRegArg2,
+    &asynGenicamAddScanRegArg3,
+};
+static const iocshFuncDef asynGenicamAddScanRegFuncDef =
+{	"asynGenicamAddScanReg",
+	4,
+	asynGenicamAddScanRegArgs
+};
+static void asynGenicamAddScanRegCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamAddScanReg( args[0].sval, args[1].sval, args[2].sval, args[3].dval );
+}
+
+/* register asynGenicamSetLinkBudget*/
+static const iocshArg asynGenicamSetLinkBudgetArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamSetLinkBudgetArg1 =
+    { "maxPercent", iocshArgDouble };
+static const iocshArg asynGenicamSetLinkBudgetArg2 =
+    { "enforce", iocshArgInt };
+static const iocshArg *asynGenicamSetLinkBudgetArgs[] =
+{
+    &asynGenicamSetLinkBudgetArg0,
+    &asynGenicamSetLinkBudgetArg1,
+    &asynGenicamSetLinkBudgetArg2,
+};
+static const iocshFuncDef asynGenicamSetLinkBudgetFuncDef =
+{	"asynGenicamSetLinkBudget",
+	3,
+	asynGenicamSetLinkBudgetArgs
+};
+static void asynGenicamSetLinkBudgetCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamSetLinkBudget( args[0].sval, args[1].dval, args[2].ival );
+}
+
+/* register asynGenicamSetBreaker*/
+static const iocshArg asynGenicamSetBreakerArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamSetBreakerArg1 =
+    { "timeouts", iocshArgInt };
+static const iocshArg asynGenicamSetBreakerArg2 =
+    { "maxProbeSec", iocshArgDouble };
+static const iocshArg *asynGenicamSetBreakerArgs[] =
+{
+    &asynGenicamSetBreakerArg0,
+    &asynGenicamSetBreakerArg1,
+    &asynGenicamSetBreakerArg2,
+};
+static const iocshFuncDef asynGenicamSetBreakerFuncDef =
+{	"asynGenicamSetBreaker",
+	3,
+	asynGenicamSetBreakerArgs
+};
+static void asynGenicamSetBreakerCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamSetBreaker( args[0].sval, args[1].ival, args[2].dval );
+}
+
+/* register asynGenicamLoadPresets*/
+static const iocshArg asynGenicamLoadPresetsArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamLoadPresetsArg1 =
+    { "fileName", iocshArgString };
+static const iocshArg *asynGenicamLoadPresetsArgs[] =
+{
+    &asynGenicamLoadPresetsArg0,
+    &asynGenicamLoadPresetsArg1,
+};
+static const iocshFuncDef asynGenicamLoadPresetsFuncDef =
+{	"asynGenicamLoadPresets",
+	2,
+	asynGenicamLoadPresetsArgs
+};
+static void asynGenicamLoadPresetsCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamLoadPresets( args[0].sval, args[1].sval );
+}
+
+/* register asynGenicamApplyPreset*/
+static const iocshArg asynGenicamApplyPresetArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamApplyPresetArg1 =
+    { "preset", iocshArgString };
+static const iocshArg *asynGenicamApplyPresetArgs[] =
+{
+    &asynGenicamApplyPresetArg0,
+    &asynGenicamApplyPresetArg1,
+};
+static const iocshFuncDef asynGenicamApplyPresetFuncDef =
+{	"asynGenicamApplyPreset",
+	2,
+	asynGenicamApplyPresetArgs
+};
+static void asynGenicamApplyPresetCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamApplyPreset( args[0].sval, args[1].sval );
+}
+
+/* register asynGenicamReport*/
+static const iocshArg asynGenicamReportArg0 =
+    { "portName", iocshArgString };
+static const iocshArg asynGenicamReportArg1 =
+    { "details", iocshArgInt };
+static const iocshArg *asynGenicamReportArgs[] =
+{
+    &asynGenicamReportArg0,
+    &asynGenicamReportArg1,
+};
+static const iocshFuncDef asynGenicamReportFuncDef =
+{	"asynGenicamReport",
+	2,
+	asynGenicamReportArgs
+};
+static void asynGenicamReportCallFunc( const iocshArgBuf *args)
+{
+    asynGenicamReport( args[0].sval, args[1].ival );
+}
+
+/// Plan the link budget of each port once records are running
+static void asynGenicamInitHook( initHookState state )
+{
+	if ( state != initHookAfterIocRunning )
+		return;
+	for ( asynGenicam * pGenicam = asynGenicam::ms_pFirst; pGenicam != NULL; pGenicam = pGenicam->m_pNext )
+		pGenicam->PlanLinkBudget( true );
+}
+
 static void asynGenicamRegister(void)
 {
     static int firstTime = 1;
     if ( firstTime )
 	{
         firstTime = 0;
+        initHookRegister( asynGenicamInitHook );
         iocshRegister( &asynGenicamConfigFuncDef,
             			asynGenicamConfigCallFunc );
+        iocshRegister( &asynGenicamSetMaxBaudFuncDef,
+            			asynGenicamSetMaxBaudCallFunc );
+        iocshRegister( &asynGenicamSetAdaptiveTimeoutFuncDef,
+            			asynGenicamSetAdaptiveTimeoutCallFunc );
+        iocshRegister( &asynGenicamSetRegMapFuncDef,
+            			asynGenicamSetRegMapCallFunc );
+        iocshRegister( &asynGenicamSetRegCacheFuncDef,
+            			asynGenicamSetRegCacheCallFunc );
+        iocshRegister( &asynGenicamAddNoAckRegFuncDef,
+            			asynGenicamAddNoAckRegCallFunc );
+        iocshRegister( &asynGenicamSetWriteCombineFuncDef,
+            			asynGenicamSetWriteCombineCallFunc );
+        iocshRegister( &asynGenicamSetRecentReadsFuncDef,
+            			asynGenicamSetRecentReadsCallFunc );
+        iocshRegister( &asynGenicamAddSelectorFuncDef,
+            			asynGenicamAddSelectorCallFunc );
+        iocshRegister( &asynGenicamAddScanGroupFuncDef,
+            			asynGenicamAddScanGroupCallFunc );
+        iocshRegister( &asynGenicamAddScanRegFuncDef,
+            			asynGenicamAddScanRegCallFunc );
+        iocshRegister( &asynGenicamSetLinkBudgetFuncDef,
+            			asynGenicamSetLinkBudgetCallFunc );
+        iocshRegister( &asynGenicamSetBreakerFuncDef,
+            			asynGenicamSetBreakerCallFunc );
+        iocshRegister( &asynGenicamLoadPresetsFuncDef,
+            			asynGenicamLoadPresetsCallFunc );
+        iocshRegister( &asynGenicamApplyPresetFuncDef,
+            			asynGenicamApplyPresetCallFunc );
+        iocshRegister( &asynGenicamReportFuncDef,
+            			asynGenicamReportCallFunc );
     }
 }
 
@@ -20,13 +20,29 @@
 #define	GENCP_TY_RESP_FLOAT		4
 #define	GENCP_TY_RESP_DOUBLE	5
 
-#define	GENCP_RESPONSE_MAX		128
+// Room for a max size string read plus the "R0x...=" prefix
+#define	GENCP_RESPONSE_MAX		1100
 
 #ifdef __cplusplus
 extern "C" {
 #endif  /* __cplusplus */
 
 epicsShareFunc int asynGenicamConfig( const char *	portName, int addr );
+epicsShareFunc int asynGenicamSetMaxBaud( const char *	portName, int maxBaud );
+epicsShareFunc int asynGenicamSetAdaptiveTimeout( const char *	portName, int enable, double minTimeoutMs );
+epicsShareFunc int asynGenicamSetRegMap( const char *	portName, const char * mapDir, int compile );
+epicsShareFunc int asynGenicamSetRegCache( const char *	portName, int enable, int refresh );
+epicsShareFunc int asynGenicamAddNoAckReg( const char *	portName, const char * reg, int syncEvery );
+epicsShareFunc int asynGenicamSetWriteCombine( const char *	portName, int enable );
+epicsShareFunc int asynGenicamSetRecentReads( const char *	portName, double maxAgeMs );
+epicsShareFunc int asynGenicamAddSelector( const char *	portName, const char * selector );
+epicsShareFunc int asynGenicamAddScanGroup( const char *	portName, const char * group, double period, int priority, double maxPeriod );
+epicsShareFunc int asynGenicamAddScanReg( const char *	portName, const char * group, const char * command, double deadband );
+epicsShareFunc int asynGenicamSetLinkBudget( const char *	portName, double maxPercent, int enforce );
+epicsShareFunc int asynGenicamSetBreaker( const char *	portName, int timeouts, double maxProbeSec );
+epicsShareFunc int asynGenicamLoadPresets( const char *	portName, const char * fileName );
+epicsShareFunc int asynGenicamApplyPreset( const char *	portName, const char * preset );
+epicsShareFunc int asynGenicamReport( const char *	portName, int details );
 
 #ifdef __cplusplus
 }